@@ -30,6 +30,7 @@
  */
 #include "applier.h"
 
+#include <fcntl.h>
 #include <msgpuck.h>
 
 #include "xlog.h"
@@ -37,6 +38,7 @@
 #include "fiber_cond.h"
 #include "coio.h"
 #include "coio_buf.h"
+#include "coio_file.h"
 #include "xstream.h"
 #include "wal.h"
 #include "xrow.h"
@@ -48,6 +50,14 @@
 #include "error.h"
 #include "session.h"
 #include "cfg.h"
+#include "latch.h"
+#include "schema.h"
+#include "space.h"
+#include "txn.h"
+#include "tuple_hash.h"
+#include "schema_def.h"
+#include "scoped_guard.h"
+#include "rmean.h"
 
 STRS(applier_state, applier_STATE);
 
@@ -253,41 +263,422 @@ done:
 }
 
 /**
- * Execute and process JOIN request (bootstrap the instance).
+ * A fiber receiving a stream of initial data other than the
+ * first one over a separate connection, see applier_join().
+ */
+struct applier_join_stream {
+	struct applier *applier;
+	struct fiber *fiber;
+	/** Stream index, starting from 1. */
+	uint32_t id;
+	/** Total number of streams. */
+	uint32_t count;
+	/** Vclock of the checkpoint sent by the master. */
+	const struct vclock *vclock;
+	/** Set when the fiber is done. */
+	bool is_done;
+	/** Signaled when the fiber is done. */
+	struct fiber_cond *done_cond;
+	/** Error that stopped the stream, if any. */
+	struct diag diag;
+};
+
+/**
+ * Connect to the master, request a stream of initial data and
+ * apply rows it sends until the end of the stream.
  */
 static void
-applier_join(struct applier *applier)
+applier_join_stream_recv(struct applier_join_stream *stream,
+			 struct ev_io *coio, struct ibuf *ibuf)
 {
-	/* Send JOIN request */
-	struct ev_io *coio = &applier->io;
-	struct ibuf *ibuf = &applier->ibuf;
+	struct applier *applier = stream->applier;
+	struct uri *uri = &applier->uri;
+	struct sockaddr_storage addr;
+	socklen_t addr_len = sizeof(addr);
+	coio_connect(coio, uri, (struct sockaddr *)&addr, &addr_len);
+
+	char greetingbuf[IPROTO_GREETING_SIZE];
+	coio_readn(coio, greetingbuf, IPROTO_GREETING_SIZE);
+	struct greeting greeting;
+	if (greeting_decode(greetingbuf, &greeting) != 0 ||
+	    !tt_uuid_is_equal(&greeting.uuid, &applier->uuid))
+		tnt_raise(ClientError, ER_PROTOCOL, "Invalid greeting");
+
 	struct xrow_header row;
-	xrow_encode_join_xc(&row, &INSTANCE_UUID);
+	if (uri->login != NULL) {
+		xrow_encode_auth_xc(&row, greeting.salt, greeting.salt_len,
+				    uri->login, uri->login_len,
+				    uri->password, uri->password_len);
+		coio_write_xrow(coio, &row);
+		coio_read_xrow(coio, ibuf, &row);
+		if (row.type != IPROTO_OK)
+			xrow_decode_error_xc(&row); /* auth failed */
+	}
+
+	xrow_encode_join_xc(&row, &INSTANCE_UUID, stream->vclock,
+			    stream->id, stream->count, false);
 	coio_write_xrow(coio, &row);
+	coio_read_xrow(coio, ibuf, &row);
+	if (iproto_type_is_error(row.type)) {
+		xrow_decode_error_xc(&row); /* re-throw error */
+	} else if (row.type != IPROTO_OK) {
+		tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+			  (uint32_t) row.type);
+	}
 
-	/**
-	 * Tarantool < 1.7.0: if JOIN is successful, there is no "OK"
-	 * response, but a stream of rows from checkpoint.
-	 */
-	if (applier->version_id >= version_id(1, 7, 0)) {
-		/* Decode JOIN response */
+	while (true) {
 		coio_read_xrow(coio, ibuf, &row);
-		if (iproto_type_is_error(row.type)) {
-			xrow_decode_error_xc(&row); /* re-throw error */
-		} else if (row.type != IPROTO_OK) {
+		applier->last_row_time = ev_monotonic_now(loop());
+		if (iproto_type_is_dml(row.type)) {
+			xstream_write_xc(applier->join_stream, &row);
+		} else if (row.type == IPROTO_OK) {
+			break; /* end of stream */
+		} else if (iproto_type_is_error(row.type)) {
+			xrow_decode_error_xc(&row);  /* rethrow error */
+		} else {
 			tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
 				  (uint32_t) row.type);
 		}
-		/*
-		 * Start vclock. The vclock of the checkpoint
-		 * the master is sending to the replica.
-		 * Used to initialize the replica's initial
-		 * vclock in bootstrap_from_master()
-		 */
-		xrow_decode_vclock_xc(&row, &replicaset.vclock);
+		if (ibuf_used(ibuf) == 0)
+			ibuf_reset(ibuf);
 	}
+}
 
-	applier_set_state(applier, APPLIER_INITIAL_JOIN);
+static int
+applier_join_stream_f(va_list ap)
+{
+	struct applier_join_stream *stream =
+		va_arg(ap, struct applier_join_stream *);
+	/* Rows are applied with admin privileges. */
+	current_session()->type = SESSION_TYPE_APPLIER;
+
+	struct ev_io coio;
+	struct ibuf ibuf;
+	coio_create(&coio, -1);
+	ibuf_create(&ibuf, &cord()->slabc, 1024);
+	try {
+		applier_join_stream_recv(stream, &coio, &ibuf);
+	} catch (Exception *) {
+		diag_move(diag_get(), &stream->diag);
+	}
+	coio_close(loop(), &coio);
+	ibuf_destroy(&ibuf);
+	stream->is_done = true;
+	fiber_cond_signal(stream->done_cond);
+	return 0;
+}
+
+/**
+ * Start fibers receiving streams of initial data other than
+ * the first one. Called once the first stream has delivered
+ * all rows of system spaces, because rows of other spaces
+ * can't be applied without them.
+ */
+static void
+applier_join_streams_start(struct applier *applier,
+			   struct applier_join_stream *streams,
+			   uint32_t stream_count,
+			   const struct vclock *vclock,
+			   struct fiber_cond *done_cond)
+{
+	for (uint32_t i = 1; i < stream_count; i++) {
+		struct applier_join_stream *stream = &streams[i - 1];
+		stream->applier = applier;
+		stream->id = i;
+		stream->count = stream_count;
+		stream->vclock = vclock;
+		stream->is_done = false;
+		stream->done_cond = done_cond;
+		diag_create(&stream->diag);
+
+		char name[FIBER_NAME_MAX];
+		int pos = snprintf(name, sizeof(name), "applierj%u/", i);
+		uri_format(name + pos, sizeof(name) - pos,
+			   &applier->uri, false);
+		stream->fiber = fiber_new_xc(name, applier_join_stream_f);
+		fiber_set_joinable(stream->fiber, true);
+		fiber_start(stream->fiber, stream);
+	}
+}
+
+/**
+ * Wait for streams of initial data started by
+ * applier_join_streams_start() to end and raise the first
+ * error any of them hit.
+ */
+static void
+applier_join_streams_wait(struct applier_join_stream *streams,
+			  uint32_t stream_count, struct fiber_cond *done_cond)
+{
+	for (uint32_t i = 1; i < stream_count; i++) {
+		struct applier_join_stream *stream = &streams[i - 1];
+		while (!stream->is_done) {
+			fiber_cond_wait(done_cond);
+			fiber_testcancel();
+		}
+		if (!diag_is_empty(&stream->diag)) {
+			diag_move(&stream->diag, diag_get());
+			diag_raise();
+		}
+	}
+}
+
+/** Stop streams of initial data and free them. */
+static void
+applier_join_streams_stop(struct applier_join_stream *streams,
+			  uint32_t stream_count)
+{
+	for (uint32_t i = 1; i < stream_count; i++) {
+		struct applier_join_stream *stream = &streams[i - 1];
+		if (stream->fiber == NULL)
+			continue;
+		if (!stream->is_done)
+			fiber_cancel(stream->fiber);
+		fiber_join(stream->fiber);
+		diag_destroy(&stream->diag);
+	}
+	free(streams);
+}
+
+/**
+ * Return true if a row of initial data belongs to a system
+ * space, see relay_initial_join().
+ */
+static bool
+applier_join_row_is_system(struct xrow_header *row)
+{
+	uint32_t space_id;
+	return xrow_decode_space_id(row, &space_id) == 0 &&
+	       space_id <= BOX_SYSTEM_ID_MAX;
+}
+
+/** A checkpoint file received from the master on initial join. */
+struct applier_join_file {
+	/** Link in the list of received files. */
+	struct stailq_entry in_list;
+	/** Set if this is a memtx snapshot. */
+	bool is_snap;
+	/** Length of the path without the temporary suffix. */
+	size_t path_len;
+	/** Name relative to the engine directory. */
+	const char *name;
+	/** Path the file is written to, with the temporary suffix. */
+	char path[0];
+};
+
+static const char applier_join_file_suffix[] = ".inprogress";
+
+/**
+ * Create a file to write a checkpoint file received from the
+ * master to. Snapshots go to memtx_dir, everything else goes
+ * to vinyl_dir, see relay_initial_join_files().
+ */
+static struct applier_join_file *
+applier_join_file_new(const char *name, uint32_t name_len, int *fd)
+{
+	/* Don't let the master write outside engine directories. */
+	if (name_len == 0 || name[0] == '/' ||
+	    memchr(name, '\0', name_len) != NULL ||
+	    memmem(name, name_len, "..", 2) != NULL) {
+		tnt_raise(ClientError, ER_PROTOCOL, "Invalid JOIN file name");
+	}
+	const char *snap_suffix = ".snap";
+	size_t snap_suffix_len = strlen(snap_suffix);
+	bool is_snap = name_len > snap_suffix_len &&
+		       memcmp(name + name_len - snap_suffix_len,
+			      snap_suffix, snap_suffix_len) == 0;
+	const char *dir = cfg_gets(is_snap ? "memtx_dir" : "vinyl_dir");
+	size_t dir_len = strlen(dir);
+	size_t path_len = dir_len + 1 + name_len;
+	size_t size = sizeof(struct applier_join_file) + path_len +
+		      sizeof(applier_join_file_suffix);
+	struct applier_join_file *file =
+		(struct applier_join_file *)malloc(size);
+	if (file == NULL) {
+		tnt_raise(OutOfMemory, size, "malloc",
+			  "struct applier_join_file");
+	}
+	auto file_guard = make_scoped_guard([=]{ free(file); });
+	snprintf(file->path, size - sizeof(*file), "%s/%.*s%s", dir,
+		 (int)name_len, name, applier_join_file_suffix);
+	file->is_snap = is_snap;
+	file->path_len = path_len;
+	file->name = file->path + dir_len + 1;
+
+	/* Vinyl files are stored in <space_id>/<index_id>. */
+	for (char *p = strchr(file->path + dir_len + 1, '/'); p != NULL;
+	     p = strchr(p + 1, '/')) {
+		*p = '\0';
+		int rc = coio_mkdir(file->path, 0777);
+		*p = '/';
+		if (rc != 0 && errno != EEXIST) {
+			tnt_raise(SystemError, "failed to create directory "
+				  "for '%s'", file->path);
+		}
+	}
+	*fd = coio_file_open(file->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (*fd < 0)
+		tnt_raise(SystemError, "failed to create '%s'", file->path);
+	file_guard.is_active = false;
+	return file;
+}
+
+/** Write a chunk of a received checkpoint file. */
+static void
+applier_join_file_write(struct applier_join_file *file, int fd,
+			const char *data, size_t size, off_t offset)
+{
+	while (size > 0) {
+		ssize_t n = coio_pwrite(fd, data, size, offset);
+		if (n < 0)
+			tnt_raise(SystemError, "failed to write '%s'",
+				  file->path);
+		data += n;
+		size -= n;
+		offset += n;
+	}
+}
+
+/**
+ * Receive checkpoint files the master sends instead of initial
+ * data rows and write them to engine directories. The files are
+ * given their real names only when all of them have been received
+ * so that a failed join doesn't leave a checkpoint behind.
+ */
+static void
+applier_join_files(struct applier *applier)
+{
+	struct ev_io *coio = &applier->io;
+	struct ibuf *ibuf = &applier->ibuf;
+	struct stailq files;
+	stailq_create(&files);
+	struct applier_join_file *file = NULL;
+	int fd = -1;
+	off_t offset = 0;
+	auto files_guard = make_scoped_guard([&]{
+		if (fd >= 0)
+			coio_file_close(fd);
+		struct applier_join_file *f, *next;
+		stailq_foreach_entry_safe(f, next, &files, in_list) {
+			coio_unlink(f->path);
+			free(f);
+		}
+	});
+
+	struct xrow_header row;
+	while (true) {
+		coio_read_xrow(coio, ibuf, &row);
+		applier->last_row_time = ev_monotonic_now(loop());
+		if (row.type == IPROTO_OK) {
+			break; /* end of stream */
+		} else if (iproto_type_is_error(row.type)) {
+			xrow_decode_error_xc(&row);  /* rethrow error */
+		} else if (row.type != IPROTO_JOIN_FILE) {
+			tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+				  (uint32_t) row.type);
+		}
+		const char *name, *data;
+		uint32_t name_len, size;
+		xrow_decode_join_file_xc(&row, &name, &name_len, &data, &size);
+		if (file == NULL ||
+		    file->path + file->path_len - file->name != name_len ||
+		    memcmp(file->name, name, name_len) != 0) {
+			/* The next file has started. */
+			if (fd >= 0 && coio_file_close(fd) != 0) {
+				fd = -1;
+				tnt_raise(SystemError, "failed to close '%s'",
+					  file->path);
+			}
+			fd = -1;
+			file = applier_join_file_new(name, name_len, &fd);
+			stailq_add_tail_entry(&files, file, in_list);
+			offset = 0;
+		}
+		applier_join_file_write(file, fd, data, size, offset);
+		if (offset == 0) {
+			/*
+			 * Log files carry the UUID of the instance
+			 * that wrote them in the header, and we only
+			 * read our own ones. Adopt the file.
+			 */
+			ssize_t uuid_offset =
+				xlog_meta_instance_uuid_offset(data, size);
+			if (uuid_offset >= 0) {
+				applier_join_file_write(file, fd,
+					tt_uuid_str(&INSTANCE_UUID),
+					UUID_STR_LEN, uuid_offset);
+			}
+		}
+		offset += size;
+	}
+	if (fd >= 0) {
+		int rc = coio_file_close(fd);
+		fd = -1;
+		if (rc != 0) {
+			tnt_raise(SystemError, "failed to close '%s'",
+				  file->path);
+		}
+	}
+
+	/*
+	 * The snapshot is renamed last, because it makes the
+	 * instance recover from the local directory on restart.
+	 */
+	char path[PATH_MAX];
+	for (int pass = 0; pass < 2; pass++) {
+		struct applier_join_file *f;
+		stailq_foreach_entry(f, &files, in_list) {
+			if (f->is_snap != (pass == 1))
+				continue;
+			snprintf(path, sizeof(path), "%.*s",
+				 (int)f->path_len, f->path);
+			if (coio_rename(f->path, path) != 0) {
+				tnt_raise(SystemError, "failed to rename '%s'",
+					  f->path);
+			}
+			say_info("received checkpoint file %s", path);
+		}
+	}
+	struct applier_join_file *f, *next;
+	stailq_foreach_entry_safe(f, next, &files, in_list)
+		free(f);
+	stailq_create(&files);
+}
+
+/**
+ * Receive initial data rows, possibly over several connections,
+ * see box.cfg.replication_join_streams.
+ */
+static void
+applier_join_rows(struct applier *applier, uint32_t stream_count)
+{
+	struct ev_io *coio = &applier->io;
+	struct ibuf *ibuf = &applier->ibuf;
+	struct xrow_header row;
+
+	/*
+	 * Other streams are sent from the same checkpoint as
+	 * the first one.
+	 */
+	struct vclock start_vclock;
+	vclock_copy(&start_vclock, &replicaset.vclock);
+	struct applier_join_stream *streams = NULL;
+	struct fiber_cond streams_cond;
+	fiber_cond_create(&streams_cond);
+	if (stream_count > 1) {
+		size_t size = sizeof(*streams) * (stream_count - 1);
+		streams = (struct applier_join_stream *)calloc(1, size);
+		if (streams == NULL) {
+			tnt_raise(OutOfMemory, size, "malloc",
+				  "struct applier_join_stream");
+		}
+	}
+	bool streams_started = false;
+	auto streams_guard = make_scoped_guard([&]{
+		if (streams != NULL)
+			applier_join_streams_stop(streams, stream_count);
+		fiber_cond_destroy(&streams_cond);
+	});
 
 	/*
 	 * Receive initial data.
@@ -297,6 +688,13 @@ applier_join(struct applier *applier)
 		coio_read_xrow(coio, ibuf, &row);
 		applier->last_row_time = ev_monotonic_now(loop());
 		if (iproto_type_is_dml(row.type)) {
+			if (streams != NULL && !streams_started &&
+			    !applier_join_row_is_system(&row)) {
+				applier_join_streams_start(applier, streams,
+						stream_count, &start_vclock,
+						&streams_cond);
+				streams_started = true;
+			}
 			xstream_write_xc(applier->join_stream, &row);
 		} else if (row.type == IPROTO_OK) {
 			if (applier->version_id < version_id(1, 7, 0)) {
@@ -317,6 +715,69 @@ applier_join(struct applier *applier)
 				  (uint32_t) row.type);
 		}
 	}
+	if (streams != NULL) {
+		if (!streams_started) {
+			applier_join_streams_start(applier, streams,
+						   stream_count, &start_vclock,
+						   &streams_cond);
+			streams_started = true;
+		}
+		applier_join_streams_wait(streams, stream_count,
+					  &streams_cond);
+	}
+}
+
+/**
+ * Execute and process JOIN request (bootstrap the instance).
+ */
+static void
+applier_join(struct applier *applier)
+{
+	/* Send JOIN request */
+	struct ev_io *coio = &applier->io;
+	struct ibuf *ibuf = &applier->ibuf;
+	struct xrow_header row;
+	xrow_encode_join_xc(&row, &INSTANCE_UUID, NULL, 0,
+			    replication_join_streams, replication_join_files);
+	coio_write_xrow(coio, &row);
+	uint32_t stream_count = 1;
+	applier->join_files = false;
+
+	/**
+	 * Tarantool < 1.7.0: if JOIN is successful, there is no "OK"
+	 * response, but a stream of rows from checkpoint.
+	 */
+	if (applier->version_id >= version_id(1, 7, 0)) {
+		/* Decode JOIN response */
+		coio_read_xrow(coio, ibuf, &row);
+		if (iproto_type_is_error(row.type)) {
+			xrow_decode_error_xc(&row); /* re-throw error */
+		} else if (row.type != IPROTO_OK) {
+			tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+				  (uint32_t) row.type);
+		}
+		/*
+		 * Start vclock. The vclock of the checkpoint
+		 * the master is sending to the replica.
+		 * Used to initialize the replica's initial
+		 * vclock in bootstrap_from_master()
+		 *
+		 * The master may also agree to send initial data
+		 * over several connections or as checkpoint files.
+		 */
+		xrow_decode_join_xc(&row, NULL, &replicaset.vclock, NULL,
+				    &stream_count, &applier->join_files);
+		stream_count = MAX(stream_count, 1U);
+		stream_count = MIN(stream_count,
+				   (uint32_t)replication_join_streams);
+	}
+
+	applier_set_state(applier, APPLIER_INITIAL_JOIN);
+
+	if (applier->join_files)
+		applier_join_files(applier);
+	else
+		applier_join_rows(applier, stream_count);
 	say_info("initial data received");
 
 	applier_set_state(applier, APPLIER_FINAL_JOIN);
@@ -358,6 +819,758 @@ applier_join(struct applier *applier)
 	applier_set_state(applier, APPLIER_READY);
 }
 
+enum {
+	/** Max number of rows dispatched to workers, but not applied yet. */
+	APPLIER_MAX_INFLIGHT = 1024,
+	/** Max number of rows applied in one transaction. */
+	APPLIER_TX_MAX_ROWS = 128,
+};
+
+/**
+ * A fiber applying transactions dispatched to it by the applier
+ * reader fiber, one by one in the order they were dispatched.
+ */
+struct applier_worker {
+	/** The applier this worker belongs to. */
+	struct applier *applier;
+	/** Worker fiber. */
+	struct fiber *fiber;
+	/** Transactions to apply, linked by applier_tx::in_worker. */
+	struct stailq queue;
+	/** Signaled when a transaction is added to the queue. */
+	struct fiber_cond cond;
+};
+
+/**
+ * Consecutive rows received from the master and applied by
+ * a worker in one transaction, i.e. written to WAL in one
+ * journal entry.
+ */
+struct applier_tx {
+	/** Link in applier_worker::queue. */
+	struct stailq_entry in_worker;
+	/** Link in applier::wal_queue. */
+	struct rlist in_wal_queue;
+	/** The applier that received the rows. */
+	struct applier *applier;
+	/** The worker the transaction was dispatched to. */
+	struct applier_worker *worker;
+	/** Rows to apply, linked by applier_row::in_tx. */
+	struct stailq rows;
+	/** Number of rows in the above list. */
+	int row_count;
+	/** Set if more rows may be added to the transaction. */
+	bool is_batchable;
+	/** Engine of spaces modified by the rows or NULL. */
+	struct engine *engine;
+	/** Transaction triggers ordering WAL writes. */
+	struct trigger on_prepare;
+	struct trigger on_write;
+};
+
+/** A row received from the master. */
+struct applier_row {
+	/** Link in applier_tx::rows. */
+	struct stailq_entry in_tx;
+	/** Monotonic time when the row was received. */
+	double recv_time;
+	/** The row. The body is stored right after this struct. */
+	struct xrow_header row;
+};
+
+/** How a row received from the master should be applied. */
+struct applier_route {
+	/**
+	 * Worker to apply the row or -1 if the row must be
+	 * applied after all rows received before it have been
+	 * applied and before any row received after it is applied.
+	 */
+	int worker;
+	/** Set if the row may be applied with other rows in a batch. */
+	bool is_batchable;
+	/** Engine of the space modified by the row or NULL. */
+	struct engine *engine;
+};
+
+/**
+ * Return true if the given error may be ignored while applying
+ * a row, see box.cfg.replication_skip_conflict.
+ */
+static bool
+applier_error_is_skippable(struct error *e)
+{
+	return e->type == &type_ClientError &&
+	       box_error_code(e) == ER_TUPLE_FOUND &&
+	       replication_skip_conflict;
+}
+
+/**
+ * Return true if rows modifying different keys of a space may
+ * be applied concurrently, i.e. changing one key can't affect
+ * the result of changing another.
+ */
+static bool
+applier_space_is_parallel(struct space *space)
+{
+	if (!rlist_empty(&space->parent_fkey) ||
+	    !rlist_empty(&space->child_fkey))
+		return false;
+	for (uint32_t i = 1; i < space->index_count; i++) {
+		if (space->index[i]->def->opts.is_unique)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Find out how a row should be applied. Rows modifying the same
+ * primary key always go to the same worker so that they are
+ * applied in the order they were received.
+ */
+static void
+applier_route_row(struct applier *applier, struct xrow_header *row,
+		  struct applier_route *route)
+{
+	route->worker = -1;
+	route->is_batchable = false;
+	route->engine = NULL;
+	if (!iproto_type_is_dml(row->type))
+		return;
+	struct request request;
+	struct space *space;
+	struct index *pk;
+	struct key_def *key_def;
+	const char *key;
+	uint32_t part_count;
+	if (xrow_decode_dml(row, &request,
+			    dml_request_key_map(row->type)) != 0)
+		goto serial;
+	if (request.type == IPROTO_NOP) {
+		route->worker = 0;
+		route->is_batchable = true;
+		return;
+	}
+	space = space_by_id(request.space_id);
+	/*
+	 * System spaces don't support multi-statement
+	 * transactions. Triggers may yield, which would
+	 * abort a memtx transaction.
+	 */
+	if (space == NULL || space->def->id <= BOX_SYSTEM_ID_MAX ||
+	    !rlist_empty(&space->before_replace) ||
+	    !rlist_empty(&space->on_replace))
+		goto serial;
+	route->is_batchable = true;
+	route->engine = space->engine;
+	if (applier->worker_count == 1) {
+		route->worker = 0;
+		return;
+	}
+	if (!applier_space_is_parallel(space))
+		goto serial;
+	pk = space_index(space, 0);
+	if (pk == NULL)
+		goto serial;
+	key_def = pk->def->key_def;
+	switch (request.type) {
+	case IPROTO_INSERT:
+	case IPROTO_REPLACE:
+	case IPROTO_UPSERT:
+		key = tuple_extract_key_raw(request.tuple, request.tuple_end,
+					    key_def, NULL);
+		if (key == NULL)
+			goto serial;
+		break;
+	case IPROTO_DELETE:
+	case IPROTO_UPDATE:
+		if (request.index_id != 0)
+			goto serial;
+		key = request.key;
+		break;
+	default:
+		goto serial;
+	}
+	/*
+	 * The row hasn't been validated yet. Let it be applied
+	 * serially and fail if it's malformed.
+	 */
+	part_count = mp_decode_array(&key);
+	if (part_count != key_def->part_count ||
+	    key_validate_parts(key_def, key, part_count, false) != 0)
+		goto serial;
+	route->worker = (key_hash(key, key_def) + request.space_id) %
+			applier->worker_count;
+	return;
+serial:
+	diag_clear(diag_get());
+}
+
+/** Wait for all rows dispatched to workers to be applied. */
+static void
+applier_drain(struct applier *applier)
+{
+	while (applier->inflight_count > 0)
+		fiber_cond_wait(&applier->apply_cond);
+}
+
+/**
+ * Wait for all dispatched rows to be applied and release
+ * the order latch, if held.
+ */
+static void
+applier_unlock(struct applier *applier)
+{
+	applier_drain(applier);
+	if (applier->order_latch != NULL) {
+		latch_unlock(applier->order_latch);
+		applier->order_latch = NULL;
+	}
+}
+
+/**
+ * Acquire the latch ordering changes of a replica. Rows of
+ * another replica may be dispatched only after all rows of the
+ * current one have been applied. We also give up the latch if
+ * another applier is waiting for it, otherwise we could submit
+ * a row to WAL before a row with a lesser LSN it has received.
+ */
+static void
+applier_lock(struct applier *applier, struct latch *latch)
+{
+	if (applier->order_latch == latch && rlist_empty(&latch->queue))
+		return;
+	applier_unlock(applier);
+	latch_lock(latch);
+	applier->order_latch = latch;
+}
+
+/**
+ * Raise the error a worker failed to apply a row with, if any.
+ * Wait for other dispatched rows to be discarded first.
+ */
+static void
+applier_check_error(struct applier *applier)
+{
+	if (diag_is_empty(&applier->diag))
+		return;
+	applier_drain(applier);
+	diag_move(&applier->diag, diag_get());
+	diag_raise();
+}
+
+/**
+ * Handle an error that occurred while a worker was applying
+ * a row. Return true if the error may be ignored. Otherwise
+ * all workers are stopped so that no row received after the
+ * failed one is committed, and the error is raised by the
+ * reader fiber.
+ */
+static bool
+applier_handle_error(struct applier *applier)
+{
+	if (applier_error_is_skippable(diag_last_error(diag_get()))) {
+		diag_clear(diag_get());
+		return true;
+	}
+	if (diag_is_empty(&applier->diag)) {
+		diag_move(diag_get(), &applier->diag);
+		for (int i = 0; i < applier->worker_count; i++) {
+			struct fiber *f = applier->workers[i].fiber;
+			if (f != NULL)
+				fiber_cancel(f);
+		}
+	} else if (fiber_is_cancelled()) {
+		/* Stopped because of the error above. */
+		diag_clear(diag_get());
+	} else {
+		diag_log();
+	}
+	return false;
+}
+
+/**
+ * Wait for all transactions received before this one to reach WAL.
+ * Fails if the worker was stopped, see applier_handle_error().
+ */
+static int
+applier_tx_wait_turn(struct applier_tx *tx)
+{
+	struct applier *applier = tx->applier;
+	while (rlist_first(&applier->wal_queue) != &tx->in_wal_queue) {
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			return -1;
+		}
+		fiber_cond_wait(&applier->apply_cond);
+	}
+	if (fiber_is_cancelled()) {
+		diag_set(FiberIsCancelled);
+		return -1;
+	}
+	return 0;
+}
+
+/** Let the transaction following this one go to WAL. */
+static void
+applier_tx_pass_turn(struct applier_tx *tx)
+{
+	if (rlist_empty(&tx->in_wal_queue))
+		return;
+	assert(rlist_first(&tx->applier->wal_queue) == &tx->in_wal_queue);
+	rlist_del(&tx->in_wal_queue);
+	fiber_cond_broadcast(&tx->applier->apply_cond);
+}
+
+/**
+ * Called before a dispatched transaction is prepared for commit.
+ * WAL requires LSNs of the same replica to grow, so transactions
+ * must reach WAL in the order they were received.
+ */
+static void
+applier_tx_on_prepare(struct trigger *trigger, void *event)
+{
+	(void) event;
+	if (applier_tx_wait_turn((struct applier_tx *) trigger->data) != 0)
+		diag_raise();
+}
+
+/** Called right before a dispatched transaction is submitted to WAL. */
+static void
+applier_tx_on_write(struct trigger *trigger, void *event)
+{
+	(void) event;
+	applier_tx_pass_turn((struct applier_tx *) trigger->data);
+}
+
+/**
+ * Apply a single row transaction. The row is executed concurrently
+ * with rows dispatched to other workers, and waits for its turn
+ * only before going to WAL.
+ *
+ * A row failing with an error that may be skipped is replaced
+ * with NOP so that it still promotes vclock in WAL order.
+ */
+static int
+applier_apply_single(struct applier *applier, struct applier_tx *tx)
+{
+	struct applier_row *ar = stailq_first_entry(&tx->rows,
+					struct applier_row, in_tx);
+	while (true) {
+		struct txn *txn = txn_begin(true);
+		if (txn == NULL) {
+			applier_handle_error(applier);
+			return -1;
+		}
+		txn_on_prepare(txn, &tx->on_prepare);
+		txn_on_write(txn, &tx->on_write);
+		int rc = xstream_write(applier->subscribe_stream, &ar->row);
+		/* The row may fail before the statement is started. */
+		if (in_txn() != NULL)
+			txn_rollback();
+		if (rc == 0)
+			return 0;
+		if (ar->row.type == IPROTO_NOP ||
+		    !applier_handle_error(applier))
+			return -1;
+		ar->row.type = IPROTO_NOP;
+		ar->row.bodycnt = 0;
+	}
+}
+
+/**
+ * Apply a multi-row transaction. A memtx transaction is aborted
+ * if it yields, so we can't wait for our turn to go to WAL after
+ * executing the rows and have to wait before.
+ */
+static int
+applier_apply_batch(struct applier *applier, struct applier_tx *tx)
+{
+	if (applier_tx_wait_turn(tx) != 0) {
+		applier_handle_error(applier);
+		return -1;
+	}
+	struct txn *txn = txn_begin(false);
+	if (txn == NULL) {
+		applier_handle_error(applier);
+		return -1;
+	}
+	txn_on_write(txn, &tx->on_write);
+	struct applier_row *ar;
+	stailq_foreach_entry(ar, &tx->rows, in_tx) {
+		if (xstream_write(applier->subscribe_stream, &ar->row) == 0)
+			continue;
+		/*
+		 * A failed statement is rolled back. If the error
+		 * may be skipped, write NOP instead of the row, as
+		 * applier_apply_single() does. Otherwise roll back
+		 * the whole transaction, so that none of its rows
+		 * promote vclock and all of them are received
+		 * again on resubscribe.
+		 */
+		if (!applier_handle_error(applier)) {
+			txn_rollback();
+			return -1;
+		}
+		ar->row.type = IPROTO_NOP;
+		ar->row.bodycnt = 0;
+		if (xstream_write(applier->subscribe_stream, &ar->row) != 0) {
+			applier_handle_error(applier);
+			txn_rollback();
+			return -1;
+		}
+	}
+	if (txn_commit(txn) != 0) {
+		applier_handle_error(applier);
+		return -1;
+	}
+	return 0;
+}
+
+/** Free a transaction dispatched to a worker. */
+static void
+applier_discard_tx(struct applier *applier, struct applier_tx *tx)
+{
+	assert(applier->inflight_count >= tx->row_count);
+	applier->inflight_count -= tx->row_count;
+	fiber_cond_broadcast(&applier->apply_cond);
+
+	struct applier_row *ar, *tmp;
+	stailq_foreach_entry_safe(ar, tmp, &tx->rows, in_tx)
+		free(ar);
+	free(tx);
+}
+
+/** Apply a transaction dispatched to a worker and free it. */
+static void
+applier_apply_tx(struct applier *applier, struct applier_tx *tx)
+{
+	trigger_create(&tx->on_prepare, applier_tx_on_prepare, tx, NULL);
+	trigger_create(&tx->on_write, applier_tx_on_write, tx, NULL);
+	int rc;
+	if (tx->row_count == 1)
+		rc = applier_apply_single(applier, tx);
+	else
+		rc = applier_apply_batch(applier, tx);
+	assert(in_txn() == NULL);
+	/* Let the next transaction go if this one failed. */
+	applier_tx_pass_turn(tx);
+
+	struct applier_row *ar;
+	if (rc == 0) {
+		/*
+		 * Promote the replica set vclock only once the
+		 * rows are committed so that rows that failed
+		 * to apply are received again on resubscribe.
+		 * Transactions are committed in the order they
+		 * were received and if one fails in WAL, all
+		 * following are rolled back, so a transaction
+		 * committed after a later one may not unroll
+		 * vclock.
+		 */
+		double now = ev_monotonic_now(loop());
+		stailq_foreach_entry(ar, &tx->rows, in_tx) {
+			struct xrow_header *row = &ar->row;
+			if (vclock_get(&replicaset.vclock,
+				       row->replica_id) < row->lsn) {
+				vclock_follow(&replicaset.vclock,
+					      row->replica_id, row->lsn);
+			}
+			latency_collect(&applier->apply_latency,
+					now - ar->recv_time);
+		}
+	}
+	applier_discard_tx(applier, tx);
+}
+
+static int
+applier_worker_f(va_list ap)
+{
+	struct applier_worker *worker = va_arg(ap, struct applier_worker *);
+	struct applier *applier = worker->applier;
+	/* See applier_f(). */
+	current_session()->type = SESSION_TYPE_APPLIER;
+
+	while (!fiber_is_cancelled()) {
+		if (stailq_empty(&worker->queue)) {
+			fiber_cond_wait(&worker->cond);
+			continue;
+		}
+		struct applier_tx *tx = stailq_shift_entry(&worker->queue,
+					struct applier_tx, in_worker);
+		/* No more rows may be added to the transaction. */
+		if (applier->last_tx == tx)
+			applier->last_tx = NULL;
+		applier_apply_tx(applier, tx);
+		fiber_gc();
+	}
+	/*
+	 * The worker was stopped because a row failed to apply.
+	 * Drop the rest of the queue: the rows will be received
+	 * again on resubscribe.
+	 */
+	while (!stailq_empty(&worker->queue)) {
+		struct applier_tx *tx = stailq_shift_entry(&worker->queue,
+					struct applier_tx, in_worker);
+		if (applier->last_tx == tx)
+			applier->last_tx = NULL;
+		rlist_del(&tx->in_wal_queue);
+		applier_discard_tx(applier, tx);
+	}
+	return 0;
+}
+
+/** Start box.cfg.replication_apply_workers worker fibers. */
+static void
+applier_start_workers(struct applier *applier)
+{
+	assert(applier->workers == NULL);
+	int count = replication_apply_workers;
+	applier->workers = (struct applier_worker *)
+		calloc(count, sizeof(*applier->workers));
+	if (applier->workers == NULL) {
+		tnt_raise(OutOfMemory, count * sizeof(*applier->workers),
+			  "malloc", "applier->workers");
+	}
+	for (int i = 0; i < count; i++) {
+		struct applier_worker *worker = &applier->workers[i];
+		worker->applier = applier;
+		stailq_create(&worker->queue);
+		fiber_cond_create(&worker->cond);
+	}
+	applier->worker_count = count;
+
+	char name[FIBER_NAME_MAX];
+	int pos = snprintf(name, sizeof(name), "applierx/");
+	uri_format(name + pos, sizeof(name) - pos, &applier->uri, false);
+	for (int i = 0; i < count; i++) {
+		struct applier_worker *worker = &applier->workers[i];
+		worker->fiber = fiber_new_xc(name, applier_worker_f);
+		fiber_set_joinable(worker->fiber, true);
+		fiber_start(worker->fiber, worker);
+	}
+}
+
+/**
+ * Wait for dispatched rows to be applied and stop worker fibers.
+ * Called on disconnect.
+ */
+static void
+applier_stop_workers(struct applier *applier)
+{
+	applier_unlock(applier);
+	assert(applier->last_tx == NULL);
+	applier->is_barrier = false;
+	if (!diag_is_empty(&applier->diag)) {
+		error_log(diag_last_error(&applier->diag));
+		diag_clear(&applier->diag);
+	}
+	if (applier->workers == NULL)
+		return;
+	for (int i = 0; i < applier->worker_count; i++) {
+		struct applier_worker *worker = &applier->workers[i];
+		if (worker->fiber == NULL)
+			continue;
+		fiber_cancel(worker->fiber);
+		fiber_join(worker->fiber);
+		assert(stailq_empty(&worker->queue));
+		fiber_cond_destroy(&worker->cond);
+	}
+	free(applier->workers);
+	applier->workers = NULL;
+	applier->worker_count = 0;
+}
+
+/**
+ * Dispatch a row received on SUBSCRIBE to a worker. The caller
+ * must hold the order latch of the replica the row originates
+ * from.
+ *
+ * Consecutive rows dispatched to the same worker are applied in
+ * one transaction unless the worker has already started applying
+ * the first of them, so batching never delays a row.
+ */
+static void
+applier_apply(struct applier *applier, struct xrow_header *row)
+{
+	struct applier_route route;
+	applier_route_row(applier, row, &route);
+	int i = route.worker >= 0 ? route.worker : 0;
+	struct applier_worker *worker = &applier->workers[i];
+
+	while (applier->inflight_count >= APPLIER_MAX_INFLIGHT)
+		fiber_cond_wait(&applier->apply_cond);
+	/*
+	 * A row that must be applied serially may only be
+	 * appended to a transaction that is applied serially
+	 * itself, i.e. after all rows received before it.
+	 */
+	struct applier_tx *tx = applier->last_tx;
+	bool append = (tx != NULL && tx->worker == worker &&
+		       tx->is_batchable && route.is_batchable &&
+		       tx->row_count < APPLIER_TX_MAX_ROWS &&
+		       (tx->engine == NULL || route.engine == NULL ||
+			tx->engine == route.engine) &&
+		       (route.worker >= 0 || applier->is_barrier));
+	/*
+	 * There's no need to wait for other workers if there's
+	 * only one, because it applies rows in order anyway.
+	 */
+	if (!append && applier->worker_count > 1 &&
+	    (route.worker < 0 || applier->is_barrier))
+		applier_drain(applier);
+	/*
+	 * Workers are stopped on error, so don't dispatch
+	 * the row if one failed while we were waiting.
+	 */
+	applier_check_error(applier);
+	/*
+	 * The row body points to the input buffer, which is
+	 * reused for next rows, so copy it.
+	 */
+	assert(row->bodycnt <= 1);
+	size_t body_size = row->bodycnt > 0 ? row->body[0].iov_len : 0;
+	size_t size = sizeof(struct applier_row) + body_size;
+	struct applier_row *ar = (struct applier_row *) malloc(size);
+	if (ar == NULL)
+		tnt_raise(OutOfMemory, size, "malloc", "struct applier_row");
+	ar->row = *row;
+	ar->recv_time = applier->last_row_time;
+	if (body_size > 0) {
+		memcpy(ar + 1, row->body[0].iov_base, body_size);
+		ar->row.body[0].iov_base = ar + 1;
+	}
+	if (append) {
+		stailq_add_tail_entry(&tx->rows, ar, in_tx);
+		tx->row_count++;
+		if (tx->engine == NULL)
+			tx->engine = route.engine;
+		applier->inflight_count++;
+		return;
+	}
+	tx = (struct applier_tx *) malloc(sizeof(*tx));
+	if (tx == NULL) {
+		free(ar);
+		tnt_raise(OutOfMemory, sizeof(*tx), "malloc",
+			  "struct applier_tx");
+	}
+	tx->applier = applier;
+	tx->worker = worker;
+	stailq_create(&tx->rows);
+	stailq_add_tail_entry(&tx->rows, ar, in_tx);
+	tx->row_count = 1;
+	tx->is_batchable = route.is_batchable;
+	tx->engine = route.engine;
+	applier->inflight_count++;
+	applier->is_barrier = route.worker < 0;
+	applier->last_tx = tx;
+	rlist_add_tail(&applier->wal_queue, &tx->in_wal_queue);
+	stailq_add_tail_entry(&worker->queue, tx, in_worker);
+	fiber_cond_signal(&worker->cond);
+}
+
+/**
+ * Return true if the input buffer contains a complete row so
+ * that reading it won't block.
+ */
+static bool
+applier_has_buffered_row(struct applier *applier)
+{
+	struct ibuf *in = &applier->ibuf;
+	const char *data = in->rpos;
+	if (ibuf_used(in) == 0 || mp_typeof(*data) != MP_UINT ||
+	    mp_check_uint(data, in->wpos) > 0)
+		return false;
+	uint32_t len = mp_decode_uint(&data);
+	return (size_t)(in->wpos - data) >= len;
+}
+
+/**
+ * Decompress data buffered in applier::zbuf into applier::ibuf
+ * until there is a complete row in the latter or the former is
+ * exhausted and the decompressor has flushed all its output.
+ * Doesn't read from the socket.
+ */
+static void
+applier_decompress(struct applier *applier)
+{
+	struct ibuf *in = &applier->zbuf;
+	struct ibuf *out = &applier->ibuf;
+	while ((ibuf_used(in) > 0 || applier->zstream_has_output) &&
+	       !applier_has_buffered_row(applier)) {
+		ibuf_reserve_xc(out, ZSTD_DStreamOutSize());
+		ZSTD_inBuffer src = {in->rpos, ibuf_used(in), 0};
+		ZSTD_outBuffer dst = {out->wpos, ibuf_unused(out), 0};
+		size_t rc = ZSTD_decompressStream(applier->zstream, &dst, &src);
+		if (ZSTD_isError(rc)) {
+			tnt_raise(ClientError, ER_DECOMPRESSION,
+				  ZSTD_getErrorName(rc));
+		}
+		in->rpos += src.pos;
+		out->wpos += dst.pos;
+		applier->bytes_uncompressed += dst.pos;
+		applier->zstream_has_output = dst.pos == dst.size;
+	}
+	if (ibuf_used(in) == 0)
+		ibuf_reset(in);
+}
+
+/**
+ * Read a row from a compressed stream. Raises TimedOut if no
+ * complete row arrives within the given timeout.
+ */
+static void
+applier_read_compressed_xrow(struct applier *applier,
+			     struct xrow_header *row, ev_tstamp timeout)
+{
+	ev_tstamp start, delay;
+	coio_timeout_init(&start, &delay, timeout);
+	applier_decompress(applier);
+	while (!applier_has_buffered_row(applier)) {
+		ssize_t n = coio_breadn_timeout(&applier->io, &applier->zbuf,
+						1, delay);
+		coio_timeout_update(start, &delay);
+		applier->bytes_compressed += n;
+		applier_decompress(applier);
+	}
+	/* The row is in the buffer, this won't touch the socket. */
+	coio_read_xrow(&applier->io, &applier->ibuf, row);
+}
+
+/**
+ * Switch to reading a compressed stream. Called after receiving
+ * the response to SUBSCRIBE, all data following it is compressed.
+ */
+static void
+applier_enable_compression(struct applier *applier)
+{
+	assert(applier->zstream == NULL);
+	ZSTD_DStream *zstream = ZSTD_createDStream();
+	if (zstream == NULL) {
+		tnt_raise(OutOfMemory, 0, "ZSTD_createDStream",
+			  "applier->zstream");
+	}
+	size_t rc = ZSTD_initDStream(zstream);
+	if (ZSTD_isError(rc)) {
+		ZSTD_freeDStream(zstream);
+		tnt_raise(ClientError, ER_DECOMPRESSION,
+			  ZSTD_getErrorName(rc));
+	}
+	applier->zstream = zstream;
+	applier->zstream_has_output = false;
+	applier->bytes_compressed = 0;
+	applier->bytes_uncompressed = 0;
+	/* Move data we've read ahead to the compressed buffer. */
+	struct ibuf *ibuf = &applier->ibuf;
+	size_t size = ibuf_used(ibuf);
+	if (size > 0) {
+		ibuf_reserve_xc(&applier->zbuf, size);
+		memcpy(applier->zbuf.wpos, ibuf->rpos, size);
+		applier->zbuf.wpos += size;
+		applier->bytes_compressed += size;
+	}
+	ibuf_reset(ibuf);
+}
+
 /**
  * Execute and process SUBSCRIBE request (follow updates from a master).
  */
@@ -373,7 +1586,10 @@ applier_subscribe(struct applier *applier)
 	struct vclock remote_vclock_at_subscribe;
 
 	xrow_encode_subscribe_xc(&row, &REPLICASET_UUID, &INSTANCE_UUID,
-				 &replicaset.vclock);
+				 &replicaset.vclock, replication_compression ?
+				 IPROTO_COMPRESSION_ZSTD :
+				 IPROTO_COMPRESSION_NONE, replication_spaces,
+				 replication_space_count, replication_batch_delay);
 	coio_write_xrow(coio, &row);
 
 	if (applier->state == APPLIER_READY) {
@@ -410,10 +1626,16 @@ applier_subscribe(struct applier *applier)
 		}
 		/*
 		 * In case of successful subscribe, the server
-		 * responds with its current vclock.
+		 * responds with its current vclock and tells
+		 * whether it is going to compress the stream.
 		 */
+		uint32_t compression;
 		vclock_create(&remote_vclock_at_subscribe);
-		xrow_decode_vclock_xc(&row, &remote_vclock_at_subscribe);
+		xrow_decode_subscribe_xc(&row, NULL, NULL,
+					 &remote_vclock_at_subscribe, NULL,
+					 &compression, NULL, NULL);
+		if (compression == IPROTO_COMPRESSION_ZSTD)
+			applier_enable_compression(applier);
 	}
 	/**
 	 * Tarantool < 1.6.7:
@@ -439,6 +1661,7 @@ applier_subscribe(struct applier *applier)
 	}
 
 	applier->lag = TIMEOUT_INFINITY;
+	applier_start_workers(applier);
 
 	/*
 	 * Process a stream of rows from the binary log.
@@ -461,17 +1684,36 @@ applier_subscribe(struct applier *applier)
 		    applier->lag <= replication_sync_lag &&
 		    vclock_compare(&remote_vclock_at_subscribe,
 				   &replicaset.vclock) <= 0) {
-			/* Applier is synced, switch to "follow". */
+			/*
+			 * Applier is synced, switch to "follow"
+			 * as soon as all received rows are applied.
+			 */
+			applier_drain(applier);
+			applier_check_error(applier);
 			applier_set_state(applier, APPLIER_FOLLOW);
 		}
 
+		/*
+		 * Don't block other appliers on the order latch
+		 * while waiting for data from the network.
+		 */
+		if (applier->zstream != NULL)
+			applier_decompress(applier);
+		if (!applier_has_buffered_row(applier)) {
+			applier_unlock(applier);
+			applier_check_error(applier);
+		}
+
 		/*
 		 * Tarantool < 1.7.7 does not send periodic heartbeat
 		 * messages so we can't assume that if we haven't heard
 		 * from the master for quite a while the connection is
 		 * broken - the master might just be idle.
 		 */
-		if (applier->version_id < version_id(1, 7, 7)) {
+		if (applier->zstream != NULL) {
+			applier_read_compressed_xrow(applier, &row,
+					replication_disconnect_timeout());
+		} else if (applier->version_id < version_id(1, 7, 7)) {
 			coio_read_xrow(coio, ibuf, &row);
 		} else {
 			double timeout = replication_disconnect_timeout();
@@ -496,45 +1738,35 @@ applier_subscribe(struct applier *applier)
 		applier->last_row_time = ev_monotonic_now(loop());
 
 		if (vclock_get(&replicaset.vclock, row.replica_id) < row.lsn) {
-			/**
-			 * Promote the replica set vclock before
-			 * applying the row. If there is an
-			 * exception (conflict) applying the row,
-			 * the row is skipped when the replication
-			 * is resumed.
-			 */
-			vclock_follow(&replicaset.vclock, row.replica_id,
-				      row.lsn);
 			struct replica *replica = replica_by_id(row.replica_id);
 			struct latch *latch = (replica ? &replica->order_latch :
 					       &replicaset.applier.order_latch);
 			/*
 			 * In a full mesh topology, the same set
 			 * of changes may arrive via two
-			 * concurrently running appliers. Thanks
-			 * to vclock_follow() above, the first row
-			 * in the set will be skipped - but the
-			 * remaining may execute out of order,
-			 * when the following xstream_write()
-			 * yields on WAL. Hence we need a latch to
-			 * strictly order all changes which belong
-			 * to the same server id.
+			 * concurrently running appliers. The
+			 * replica set vclock is promoted only
+			 * when a row is committed, see
+			 * applier_apply_tx(), so we need a latch
+			 * to strictly order all changes which
+			 * belong to the same server id. The
+			 * latch is released only after all rows
+			 * dispatched under it are committed, so
+			 * check vclock again once we have it.
 			 */
-			latch_lock(latch);
-			int res = xstream_write(applier->subscribe_stream, &row);
-			latch_unlock(latch);
-			if (res != 0) {
-				struct error *e = diag_last_error(diag_get());
-				/**
-				 * Silently skip ER_TUPLE_FOUND error if such
-				 * option is set in config.
-				 */
-				if (e->type == &type_ClientError &&
-				    box_error_code(e) == ER_TUPLE_FOUND &&
-				    replication_skip_conflict)
-					diag_clear(diag_get());
-				else
-					diag_raise();
+			applier_lock(applier, latch);
+		}
+		if (vclock_get(&replicaset.vclock, row.replica_id) < row.lsn) {
+			applier_apply(applier, &row);
+
+			latency_collect(&applier->recv_latency,
+					applier->lag);
+			rmean_collect(applier->rmean,
+				      REPLICATION_STAT_ROWS, 1);
+			for (int i = 0; i < row.bodycnt; i++) {
+				rmean_collect(applier->rmean,
+					      REPLICATION_STAT_BYTES,
+					      row.body[i].iov_len);
 			}
 		}
 		if (applier->state == APPLIER_SYNC ||
@@ -550,6 +1782,7 @@ static inline void
 applier_disconnect(struct applier *applier, enum applier_state state)
 {
 	applier_set_state(applier, state);
+	applier_stop_workers(applier);
 	if (applier->writer != NULL) {
 		fiber_cancel(applier->writer);
 		fiber_join(applier->writer);
@@ -559,6 +1792,11 @@ applier_disconnect(struct applier *applier, enum applier_state state)
 	coio_close(loop(), &applier->io);
 	/* Clear all unparsed input. */
 	ibuf_reinit(&applier->ibuf);
+	ibuf_reinit(&applier->zbuf);
+	if (applier->zstream != NULL) {
+		ZSTD_freeDStream(applier->zstream);
+		applier->zstream = NULL;
+	}
 	fiber_gc();
 }
 
@@ -701,6 +1939,7 @@ applier_new(const char *uri, struct xstream *join_stream,
 	}
 	coio_create(&applier->io, -1);
 	ibuf_create(&applier->ibuf, &cord()->slabc, 1024);
+	ibuf_create(&applier->zbuf, &cord()->slabc, 1024);
 
 	/* uri_parse() sets pointers to applier->source buffer */
 	snprintf(applier->source, sizeof(applier->source), "%s", uri);
@@ -709,14 +1948,37 @@ applier_new(const char *uri, struct xstream *join_stream,
 	assert(rc == 0 && applier->uri.service != NULL);
 	(void) rc;
 
+	applier->rmean = rmean_new(replication_stat_strs,
+				   REPLICATION_STAT_LAST);
+	if (applier->rmean == NULL)
+		goto fail_rmean;
+	if (latency_create(&applier->recv_latency) != 0)
+		goto fail_recv_latency;
+	if (latency_create(&applier->apply_latency) != 0)
+		goto fail_apply_latency;
+
 	applier->join_stream = join_stream;
 	applier->subscribe_stream = subscribe_stream;
 	applier->last_row_time = ev_monotonic_now(loop());
 	rlist_create(&applier->on_state);
 	fiber_cond_create(&applier->resume_cond);
 	fiber_cond_create(&applier->writer_cond);
+	rlist_create(&applier->wal_queue);
+	fiber_cond_create(&applier->apply_cond);
+	diag_create(&applier->diag);
 
 	return applier;
+
+fail_apply_latency:
+	latency_destroy(&applier->recv_latency);
+fail_recv_latency:
+	rmean_delete(applier->rmean);
+fail_rmean:
+	diag_set(OutOfMemory, 0, "malloc", "applier stat");
+	ibuf_destroy(&applier->zbuf);
+	ibuf_destroy(&applier->ibuf);
+	free(applier);
+	return NULL;
 }
 
 void
@@ -724,10 +1986,17 @@ applier_delete(struct applier *applier)
 {
 	assert(applier->reader == NULL && applier->writer == NULL);
 	ibuf_destroy(&applier->ibuf);
-	assert(applier->io.fd == -1);
+	ibuf_destroy(&applier->zbuf);
+	assert(applier->io.fd == -1 && applier->zstream == NULL);
 	trigger_destroy(&applier->on_state);
 	fiber_cond_destroy(&applier->resume_cond);
 	fiber_cond_destroy(&applier->writer_cond);
+	assert(applier->workers == NULL && applier->order_latch == NULL);
+	fiber_cond_destroy(&applier->apply_cond);
+	diag_destroy(&applier->diag);
+	latency_destroy(&applier->apply_latency);
+	latency_destroy(&applier->recv_latency);
+	rmean_delete(applier->rmean);
 	free(applier);
 }
 
@@ -36,8 +36,11 @@
 #include <tarantool_ev.h>
 
 #include <small/ibuf.h>
+#include <zstd.h>
 
+#include "diag.h"
 #include "fiber_cond.h"
+#include "latency.h"
 #include "trigger.h"
 #include "trivia/util.h"
 #include "tt_uuid.h"
@@ -46,6 +49,10 @@
 #include "xrow.h"
 
 struct xstream;
+struct latch;
+struct rmean;
+struct applier_worker;
+struct applier_tx;
 
 enum { APPLIER_SOURCE_MAXLEN = 1024 }; /* enough to fit URI with passwords */
 
@@ -84,6 +91,18 @@ struct applier {
 	ev_tstamp last_row_time;
 	/** Number of seconds this replica is behind the remote master */
 	ev_tstamp lag;
+	/**
+	 * Time between a commit of a row on the master and its
+	 * receipt by this replica, for rows received on SUBSCRIBE.
+	 */
+	struct latency recv_latency;
+	/**
+	 * Time between a receipt of a row and a commit of the
+	 * transaction applying it to the local WAL.
+	 */
+	struct latency apply_latency;
+	/** Rate of rows received, see enum replication_stat. */
+	struct rmean *rmean;
 	/** The last box_error_code() logged to avoid log flooding */
 	uint32_t last_logged_errcode;
 	/** Remote instance UUID */
@@ -107,6 +126,27 @@ struct applier {
 	struct ev_io io;
 	/** Input buffer */
 	struct ibuf ibuf;
+	/**
+	 * Streaming decompression context or NULL if the master
+	 * sends rows uncompressed. Set on SUBSCRIBE if both sides
+	 * agree on compression, see box.cfg.replication_compression.
+	 */
+	ZSTD_DStream *zstream;
+	/**
+	 * Compressed data read from the socket, but not yet
+	 * decompressed into ibuf.
+	 */
+	struct ibuf zbuf;
+	/**
+	 * Set if the last call to ZSTD_decompressStream() filled
+	 * the output buffer, i.e. the decompressor may still hold
+	 * data even if zbuf is empty.
+	 */
+	bool zstream_has_output;
+	/** Number of bytes of compressed data received. */
+	uint64_t bytes_compressed;
+	/** Number of bytes of rows decompressed. */
+	uint64_t bytes_uncompressed;
 	/** Triggers invoked on state change */
 	struct rlist on_state;
 	/**
@@ -118,8 +158,52 @@ struct applier {
 	struct fiber_cond resume_cond;
 	/** xstream to process rows during initial JOIN */
 	struct xstream *join_stream;
+	/**
+	 * Set if the master sent checkpoint files rather than
+	 * rows on initial JOIN, see box.cfg.replication_join_files.
+	 * The files must be recovered from before final JOIN.
+	 */
+	bool join_files;
 	/** xstream to process rows during final JOIN and SUBSCRIBE */
 	struct xstream *subscribe_stream;
+	/**
+	 * Fibers applying rows received on SUBSCRIBE, see
+	 * box.cfg.replication_apply_workers.
+	 */
+	struct applier_worker *workers;
+	/** Number of entries in the workers array. */
+	int worker_count;
+	/** Number of rows dispatched to workers, but not applied yet. */
+	int inflight_count;
+	/**
+	 * The last dispatched transaction if no worker has
+	 * started applying it yet so that more rows may be
+	 * added to it, otherwise NULL.
+	 */
+	struct applier_tx *last_tx;
+	/**
+	 * Set if the last dispatched transaction must be applied
+	 * after all transactions dispatched before it and before
+	 * any transaction dispatched after it.
+	 */
+	bool is_barrier;
+	/**
+	 * Transactions dispatched to workers that have not been
+	 * submitted to WAL yet, in the order they were received.
+	 * A transaction may be submitted only when it is at the
+	 * head of the list.
+	 */
+	struct rlist wal_queue;
+	/** Signaled when a dispatched row is submitted or applied. */
+	struct fiber_cond apply_cond;
+	/** The first error a worker failed to apply a row with. */
+	struct diag diag;
+	/**
+	 * Latch ordering changes of the replica whose rows are
+	 * being dispatched, or NULL. Held by the reader fiber
+	 * until all dispatched rows are applied.
+	 */
+	struct latch *order_latch;
 };
 
 /**
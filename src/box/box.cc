@@ -70,6 +70,7 @@
 #include "gc.h"
 #include "checkpoint.h"
 #include "sql.h"
+#include "sql_stmt_cache.h"
 #include "systemd.h"
 #include "call.h"
 #include "func.h"
@@ -436,6 +437,90 @@ box_check_replication_connect_timeout(void)
 	return timeout;
 }
 
+static int
+box_check_replication_apply_workers(void)
+{
+	int count = cfg_geti("replication_apply_workers");
+	if (count < 1 || count > REPLICATION_APPLY_WORKERS_MAX) {
+		tnt_raise(ClientError, ER_CFG, "replication_apply_workers",
+			  tt_sprintf("the value must be in range [1, %d]",
+				     REPLICATION_APPLY_WORKERS_MAX));
+	}
+	return count;
+}
+
+static int
+box_check_replication_join_streams(void)
+{
+	int count = cfg_geti("replication_join_streams");
+	if (count < 1 || count > REPLICATION_JOIN_STREAMS_MAX) {
+		tnt_raise(ClientError, ER_CFG, "replication_join_streams",
+			  tt_sprintf("the value must be in range [1, %d]",
+				     REPLICATION_JOIN_STREAMS_MAX));
+	}
+	return count;
+}
+
+/**
+ * Return the space id stored in the i-th entry of
+ * box.cfg.replication_spaces or raise an error if
+ * it isn't a valid user space id.
+ */
+static uint32_t
+box_check_replication_space(int i)
+{
+	const char *str = cfg_getarr_elem("replication_spaces", i);
+	char *end = NULL;
+	long long id = str != NULL ? strtoll(str, &end, 10) : 0;
+	if (end == NULL || end == str || *end != '\0' ||
+	    id <= BOX_SYSTEM_ID_MAX || id > BOX_SPACE_MAX) {
+		tnt_raise(ClientError, ER_CFG, "replication_spaces",
+			  "the value must be a list of user space ids");
+	}
+	return id;
+}
+
+static int
+box_check_sql_cache_count(void)
+{
+	int count = cfg_geti("sql_cache_count");
+	if (count < 0) {
+		tnt_raise(ClientError, ER_CFG, "sql_cache_count",
+			  "the value must be greater or equal to 0");
+	}
+	return count;
+}
+
+static int64_t
+box_check_sql_temp_memory_max(void)
+{
+	int64_t size = cfg_geti64("sql_temp_memory_max");
+	if (size < 0) {
+		tnt_raise(ClientError, ER_CFG, "sql_temp_memory_max",
+			  "the value must be greater or equal to 0");
+	}
+	return size;
+}
+
+static void
+box_check_replication_spaces(void)
+{
+	int count = cfg_getarr_size("replication_spaces");
+	for (int i = 0; i < count; i++)
+		box_check_replication_space(i);
+}
+
+static double
+box_check_replication_batch_delay(void)
+{
+	double delay = cfg_getd("replication_batch_delay");
+	if (delay < 0) {
+		tnt_raise(ClientError, ER_CFG, "replication_batch_delay",
+			  "the value must be greater or equal to 0");
+	}
+	return delay;
+}
+
 static int
 box_check_replication_connect_quorum(void)
 {
@@ -606,6 +691,12 @@ box_check_config()
 	box_check_replication_connect_timeout();
 	box_check_replication_connect_quorum();
 	box_check_replication_sync_lag();
+	box_check_replication_apply_workers();
+	box_check_replication_join_streams();
+	box_check_replication_spaces();
+	box_check_replication_batch_delay();
+	box_check_sql_cache_count();
+	box_check_sql_temp_memory_max();
 	box_check_readahead(cfg_geti("readahead"));
 	box_check_checkpoint_count(cfg_geti("checkpoint_count"));
 	box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
@@ -723,6 +814,66 @@ box_set_replication_skip_conflict(void)
 	replication_skip_conflict = cfg_geti("replication_skip_conflict");
 }
 
+void
+box_set_replication_apply_workers(void)
+{
+	replication_apply_workers = box_check_replication_apply_workers();
+}
+
+void
+box_set_replication_compression(void)
+{
+	replication_compression = cfg_geti("replication_compression");
+}
+
+void
+box_set_replication_join_streams(void)
+{
+	replication_join_streams = box_check_replication_join_streams();
+}
+
+void
+box_set_replication_join_files(void)
+{
+	replication_join_files = cfg_geti("replication_join_files");
+}
+
+int
+box_space_id_cmp(const void *a, const void *b)
+{
+	uint32_t id_a = *(const uint32_t *)a;
+	uint32_t id_b = *(const uint32_t *)b;
+	return id_a < id_b ? -1 : id_a > id_b;
+}
+
+void
+box_set_replication_spaces(void)
+{
+	uint32_t *spaces = NULL;
+	int count = cfg_getarr_size("replication_spaces");
+	if (count > 0) {
+		spaces = (uint32_t *) malloc(sizeof(*spaces) * count);
+		if (spaces == NULL) {
+			tnt_raise(OutOfMemory, sizeof(*spaces) * count,
+				  "malloc", "replication_spaces");
+		}
+		auto guard = make_scoped_guard([=] { free(spaces); });
+		for (int i = 0; i < count; i++)
+			spaces[i] = box_check_replication_space(i);
+		qsort(spaces, count, sizeof(*spaces), box_space_id_cmp);
+		guard.is_active = false;
+	}
+	free(replication_spaces);
+	replication_spaces = spaces;
+	replication_space_count = count;
+}
+
+void
+box_set_replication_batch_delay(void)
+{
+	replication_batch_delay = box_check_replication_batch_delay();
+}
+
 void
 box_listen(void)
 {
@@ -861,6 +1012,18 @@ box_set_net_msg_max(void)
 				IPROTO_FIBER_POOL_SIZE_FACTOR);
 }
 
+void
+box_set_sql_cache_count(void)
+{
+	sql_stmt_cache_set_count(box_check_sql_cache_count());
+}
+
+void
+box_set_sql_temp_memory_max(void)
+{
+	sql_set_temp_memory_max(box_check_sql_temp_memory_max());
+}
+
 /* }}} configuration bindings */
 
 /**
@@ -1158,6 +1321,25 @@ box_upsert(uint32_t space_id, uint32_t index_id, const char *tuple,
 	return box_process1(&request, result);
 }
 
+int
+box_delete_range(uint32_t space_id, uint32_t index_id, const char *key,
+		 const char *key_end, const char *end_key,
+		 const char *end_key_end)
+{
+	mp_tuple_assert(key, key_end);
+	mp_tuple_assert(end_key, end_key_end);
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = IPROTO_DELETE_RANGE;
+	request.space_id = space_id;
+	request.index_id = index_id;
+	request.key = key;
+	request.key_end = key_end;
+	request.end_key = end_key;
+	request.end_key_end = end_key_end;
+	return box_process1(&request, NULL);
+}
+
 /**
  * Trigger space truncation by bumping a counter
  * in _truncate space.
@@ -1350,6 +1532,69 @@ box_process_auth(struct auth_request *request, const char *salt)
 	authenticate(user, len, salt, request->scramble);
 }
 
+/**
+ * Send a stream of initial data other than the first one to
+ * a joining replica, see box_process_join().
+ *
+ * => JOIN { INSTANCE_UUID: replica_uuid, VCLOCK: start_vclock,
+ *           JOIN_STREAM_ID: stream_id,
+ *           JOIN_STREAM_COUNT: stream_count }
+ * <= OK { VCLOCK: start_vclock }
+ * <= INSERT
+ *    ...
+ * <= INSERT
+ * <= OK { VCLOCK: start_vclock } - end of the stream.
+ */
+static void
+box_process_join_stream(struct ev_io *io, struct xrow_header *header,
+			const struct tt_uuid *instance_uuid,
+			struct vclock *start_vclock, uint32_t stream_id,
+			uint32_t stream_count)
+{
+	if (stream_id >= stream_count ||
+	    stream_count > REPLICATION_JOIN_STREAMS_MAX) {
+		tnt_raise(ClientError, ER_PROTOCOL,
+			  "Invalid JOIN stream id or count");
+	}
+	/*
+	 * The stream must be sent from the same checkpoint as
+	 * the first one. Pin it until we are done.
+	 */
+	struct checkpoint_iterator it;
+	checkpoint_iterator_init(&it);
+	const struct vclock *vclock;
+	while ((vclock = checkpoint_iterator_next(&it)) != NULL) {
+		if (vclock_compare(vclock, start_vclock) == 0)
+			break;
+	}
+	if (vclock == NULL)
+		tnt_raise(ClientError, ER_MISSING_SNAPSHOT);
+
+	struct gc_consumer *gc = gc_consumer_register(
+		tt_sprintf("replica %s join stream %u",
+			   tt_uuid_str(instance_uuid), stream_id),
+		start_vclock, GC_CONSUMER_SNAP);
+	if (gc == NULL)
+		diag_raise();
+	auto gc_guard = make_scoped_guard([=]{
+		gc_consumer_unregister(gc);
+	});
+
+	struct xrow_header row;
+	xrow_encode_vclock_xc(&row, start_vclock);
+	row.sync = header->sync;
+	coio_write_xrow(io, &row);
+
+	relay_initial_join(io->fd, header->sync, start_vclock,
+			   stream_id, stream_count);
+	say_info("initial data stream %u sent.", stream_id);
+
+	/* Send end of stream marker */
+	xrow_encode_vclock_xc(&row, start_vclock);
+	row.sync = header->sync;
+	coio_write_xrow(io, &row);
+}
+
 void
 box_process_join(struct ev_io *io, struct xrow_header *header)
 {
@@ -1359,10 +1604,17 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 	 *
 	 * Replica => Master
 	 *
-	 * => JOIN { INSTANCE_UUID: replica_uuid }
-	 * <= OK { VCLOCK: start_vclock }
+	 * => JOIN { INSTANCE_UUID: replica_uuid, JOIN_STREAM_ID: 0,
+	 *           JOIN_STREAM_COUNT: stream_count, JOIN_FILES: true }
+	 * <= OK { VCLOCK: start_vclock, JOIN_STREAM_COUNT: stream_count,
+	 *         JOIN_FILES: true }
 	 *    Replica has enough permissions and master is ready for JOIN.
 	 *     - start_vclock - vclock of the latest master's checkpoint.
+	 *     - stream_count - number of streams initial data is split
+	 *       into, may be less than requested. Stream keys are
+	 *       omitted if there's only one stream.
+	 *     - JOIN_FILES - set if the master sends checkpoint files
+	 *       rather than rows, omitted otherwise.
 	 *
 	 * <= INSERT
 	 *    ...
@@ -1371,6 +1623,16 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 	 *    use REPLICA_ID, LSN and other fields for internal purposes.
 	 *    ...
 	 * <= INSERT
+	 *
+	 * or, if JOIN_FILES is set,
+	 *
+	 * <= JOIN_FILE { FILE_NAME: name, DATA: chunk }
+	 *    ...
+	 *    Checkpoint files as they are stored on the master's disk,
+	 *    one after another, each split into chunks.
+	 *    ...
+	 * <= JOIN_FILE { FILE_NAME: name, DATA: chunk }
+	 *
 	 * <= OK { VCLOCK: stop_vclock } - end of initial JOIN stage.
 	 *     - `stop_vclock` - master's vclock when it's done
 	 *     done sending rows from the snapshot (i.e. vclock
@@ -1392,13 +1654,23 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 	 *  - Cluster UUID in _schema space
 	 *  - Registration of master in _cluster space
 	 *  - Registration of the new replica in _cluster space
+	 *
+	 * If stream_count > 1, the replica opens another connection
+	 * for each other stream of initial data, see
+	 * box_process_join_stream(). The first stream has rows of
+	 * system spaces and a share of rows of other spaces.
 	 */
 
 	assert(header->type == IPROTO_JOIN);
 
 	/* Decode JOIN request */
 	struct tt_uuid instance_uuid = uuid_nil;
-	xrow_decode_join_xc(header, &instance_uuid);
+	struct vclock stream_vclock;
+	uint32_t stream_id, stream_count;
+	bool files;
+	vclock_create(&stream_vclock);
+	xrow_decode_join_xc(header, &instance_uuid, &stream_vclock,
+			    &stream_id, &stream_count, &files);
 
 	/* Check that bootstrap has been finished */
 	if (!is_box_configured)
@@ -1430,6 +1702,19 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 			  "wal_mode = 'none'");
 	}
 
+	if (stream_id > 0) {
+		box_process_join_stream(io, header, &instance_uuid,
+					&stream_vclock, stream_id,
+					stream_count);
+		return;
+	}
+	stream_count = MAX(stream_count, 1U);
+	stream_count = MIN(stream_count,
+			   (uint32_t)REPLICATION_JOIN_STREAMS_MAX);
+	/* Files are sent over one connection. */
+	if (files)
+		stream_count = 1;
+
 	/* Remember start vclock. */
 	struct vclock start_vclock;
 	/*
@@ -1451,16 +1736,41 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 		gc_consumer_unregister(gc);
 	});
 
+	/*
+	 * Unlike rows, checkpoint files are not opened all at
+	 * once, so pin them until they are sent.
+	 */
+	struct gc_consumer *files_gc = NULL;
+	if (files) {
+		files_gc = gc_consumer_register(
+			tt_sprintf("replica %s join files",
+				   tt_uuid_str(&instance_uuid)),
+			&start_vclock, GC_CONSUMER_SNAP);
+		if (files_gc == NULL)
+			diag_raise();
+	}
+	auto files_gc_guard = make_scoped_guard([=]{
+		if (files_gc != NULL)
+			gc_consumer_unregister(files_gc);
+	});
+
 	/* Respond to JOIN request with start_vclock. */
 	struct xrow_header row;
-	xrow_encode_vclock_xc(&row, &start_vclock);
+	xrow_encode_join_response_xc(&row, &start_vclock, stream_count,
+				     files);
 	row.sync = header->sync;
 	coio_write_xrow(io, &row);
 
 	/*
-	 * Initial stream: feed replica with dirty data from engines.
+	 * Initial stream: feed replica with dirty data from engines
+	 * or with checkpoint files.
 	 */
-	relay_initial_join(io->fd, header->sync, &start_vclock);
+	if (files) {
+		relay_initial_join_files(io->fd, header->sync, &start_vclock);
+	} else {
+		relay_initial_join(io->fd, header->sync, &start_vclock,
+				   0, stream_count);
+	}
 	say_info("initial data sent.");
 
 	/**
@@ -1513,9 +1823,16 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	struct tt_uuid replicaset_uuid = uuid_nil, replica_uuid = uuid_nil;
 	struct vclock replica_clock;
 	uint32_t replica_version_id;
+	uint32_t compression;
+	const char *space_filter;
+	double batch_delay;
 	vclock_create(&replica_clock);
 	xrow_decode_subscribe_xc(header, &replicaset_uuid, &replica_uuid,
-				 &replica_clock, &replica_version_id);
+				 &replica_clock, &replica_version_id,
+				 &compression, &space_filter, &batch_delay);
+	/* Fall back on plain stream if we don't know the method. */
+	if (compression != IPROTO_COMPRESSION_ZSTD)
+		compression = IPROTO_COMPRESSION_NONE;
 
 	/* Forbid connection to itself */
 	if (tt_uuid_is_equal(&replica_uuid, &INSTANCE_UUID))
@@ -1553,12 +1870,13 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	/*
 	 * Send a response to SUBSCRIBE request, tell
 	 * the replica how many rows we have in stock for it,
-	 * and identify ourselves with our own replica id.
+	 * whether the stream will be compressed, and identify
+	 * ourselves with our own replica id.
 	 */
 	struct xrow_header row;
 	struct vclock current_vclock;
 	wal_checkpoint(&current_vclock, true);
-	xrow_encode_vclock_xc(&row, &current_vclock);
+	xrow_encode_subscribe_response_xc(&row, &current_vclock, compression);
 	/*
 	 * Identify the message with the replica id of this
 	 * instance, this is the only way for a replica to find
@@ -1583,7 +1901,50 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	 * indefinitely).
 	 */
 	relay_subscribe(replica, io->fd, header->sync, &replica_clock,
-			replica_version_id);
+			replica_version_id, compression, space_filter,
+			batch_delay);
+}
+
+void
+box_process_cdc(struct ev_io *io, struct xrow_header *header)
+{
+	assert(header->type == IPROTO_CDC);
+
+	/* Check that bootstrap has been finished */
+	if (!is_box_configured)
+		tnt_raise(ClientError, ER_LOADING);
+
+	struct vclock vclock;
+	uint32_t client_version_id = 0;
+	const char *space_filter;
+	double batch_delay;
+	vclock_create(&vclock);
+	xrow_decode_subscribe_xc(header, NULL, NULL, &vclock, &client_version_id,
+				 NULL, &space_filter, &batch_delay);
+
+	/* Check permissions */
+	access_check_universe_xc(PRIV_R);
+
+	/* There's nothing to stream with disabled WAL */
+	if (wal_mode() == WAL_NONE) {
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Change data capture",
+			  "wal_mode = 'none'");
+	}
+
+	/*
+	 * Respond with the current vclock so that the client
+	 * knows when it has caught up.
+	 */
+	struct xrow_header row;
+	struct vclock current_vclock;
+	wal_checkpoint(&current_vclock, false);
+	xrow_encode_subscribe_response_xc(&row, &current_vclock,
+					  IPROTO_COMPRESSION_NONE);
+	row.sync = header->sync;
+	coio_write_xrow(io, &row);
+
+	relay_cdc(io->fd, header->sync, &vclock, client_version_id,
+		  space_filter, batch_delay);
 }
 
 void
@@ -1737,11 +2098,29 @@ bootstrap_from_master(struct replica *master)
 	assert(!tt_uuid_is_nil(&INSTANCE_UUID));
 	applier_resume_to_state(applier, APPLIER_INITIAL_JOIN, TIMEOUT_INFINITY);
 
-	/*
-	 * Process initial data (snapshot or dirty disk data).
-	 */
-	engine_begin_initial_recovery_xc(NULL);
-	applier_resume_to_state(applier, APPLIER_FINAL_JOIN, TIMEOUT_INFINITY);
+	if (!applier->join_files) {
+		/*
+		 * Process initial data (snapshot or dirty disk data).
+		 */
+		engine_begin_initial_recovery_xc(NULL);
+		applier_resume_to_state(applier, APPLIER_FINAL_JOIN,
+					TIMEOUT_INFINITY);
+	} else {
+		/*
+		 * Wait for checkpoint files and recover from them
+		 * as from a backup. replicaset.vclock is set to the
+		 * checkpoint vclock by now and is advanced by final
+		 * data, which is what vinyl needs to skip rows that
+		 * are already on disk.
+		 */
+		applier_resume_to_state(applier, APPLIER_FINAL_JOIN,
+					TIMEOUT_INFINITY);
+		engine_begin_initial_recovery_xc(&replicaset.vclock);
+		struct memtx_engine *memtx;
+		memtx = (struct memtx_engine *)engine_by_name("memtx");
+		assert(memtx != NULL);
+		memtx_engine_recover_snapshot_xc(memtx, &replicaset.vclock);
+	}
 
 	/*
 	 * Process final data (WALs).
@@ -2008,12 +2387,20 @@ box_cfg_xc(void)
 	box_check_replicaset_uuid(&replicaset_uuid);
 
 	box_set_net_msg_max();
+	box_set_sql_cache_count();
+	box_set_sql_temp_memory_max();
 	box_set_checkpoint_count();
 	box_set_too_long_threshold();
 	box_set_replication_timeout();
 	box_set_replication_connect_timeout();
 	box_set_replication_connect_quorum();
 	box_set_replication_skip_conflict();
+	box_set_replication_apply_workers();
+	box_set_replication_compression();
+	box_set_replication_join_streams();
+	box_set_replication_join_files();
+	box_set_replication_spaces();
+	box_set_replication_batch_delay();
 	replication_sync_lag = box_check_replication_sync_lag();
 	xstream_create(&join_stream, apply_initial_join_row);
 	xstream_create(&subscribe_stream, apply_row);
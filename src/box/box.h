@@ -164,6 +164,14 @@ box_process_join(struct ev_io *io, struct xrow_header *header);
 void
 box_process_subscribe(struct ev_io *io, struct xrow_header *header);
 
+/**
+ * Stream rows committed after the vclock given in the request
+ * to a change data capture client. Like SUBSCRIBE, never returns
+ * unless there is an error.
+ */
+void
+box_process_cdc(struct ev_io *io, struct xrow_header *header);
+
 void
 box_process_vote(struct ballot *ballot);
 
@@ -174,6 +182,13 @@ box_process_vote(struct ballot *ballot);
 void
 box_check_config();
 
+/**
+ * qsort() and bsearch() comparator for arrays of space ids,
+ * see box.cfg.replication_spaces.
+ */
+int
+box_space_id_cmp(const void *a, const void *b);
+
 void box_listen(void);
 void box_set_replication(void);
 void box_set_log_level(void);
@@ -193,7 +208,15 @@ void box_set_replication_timeout(void);
 void box_set_replication_connect_timeout(void);
 void box_set_replication_connect_quorum(void);
 void box_set_replication_skip_conflict(void);
+void box_set_replication_apply_workers(void);
+void box_set_replication_compression(void);
+void box_set_replication_join_streams(void);
+void box_set_replication_join_files(void);
+void box_set_replication_spaces(void);
+void box_set_replication_batch_delay(void);
 void box_set_net_msg_max(void);
+void box_set_sql_cache_count(void);
+void box_set_sql_temp_memory_max(void);
 
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -347,6 +370,28 @@ box_upsert(uint32_t space_id, uint32_t index_id, const char *tuple,
 	   const char *tuple_end, const char *ops, const char *ops_end,
 	   int index_base, box_tuple_t **result);
 
+/**
+ * Execute a DELETE_RANGE request: delete all tuples whose key
+ * is greater than or equal to \a key and less than \a end_key.
+ * Partial keys are compared by prefix. An empty key means that
+ * the corresponding side of the range is unbounded.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier, must be 0 (primary key)
+ * \param key encoded begin of the range in MsgPack Array format
+ * \param key_end the end of encoded \a key.
+ * \param end_key encoded end of the range in MsgPack Array format
+ * \param end_key_end the end of encoded \a end_key.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \sa \code box.space[space_id].index[index_id]:delete_range(key,
+ * end_key) \endcode
+ */
+API_EXPORT int
+box_delete_range(uint32_t space_id, uint32_t index_id, const char *key,
+		 const char *key_end, const char *end_key,
+		 const char *end_key_end);
+
 /**
  * Truncate space.
  *
@@ -223,6 +223,8 @@ struct errcode_record {
 	/*168 */_(ER_DROP_FK_CONSTRAINT,	"Failed to drop foreign key constraint '%s': %s") \
 	/*169 */_(ER_NO_SUCH_CONSTRAINT,	"Constraint %s does not exist") \
 	/*170 */_(ER_CONSTRAINT_EXISTS,		"Constraint %s already exists") \
+	/*171 */_(ER_SQL_STMT_NOT_FOUND,	"Prepared statement with id %u does not exist") \
+	/*172 */_(ER_SQL_TEMP_MEMORY,		"Temporary tables of SQL statement take %llu bytes. Check 'sql_temp_memory_max' configuration option.") \
 
 /*
  * !IMPORTANT! Please follow instructions at start of the file
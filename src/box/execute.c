@@ -38,10 +38,12 @@
 #include "small/obuf.h"
 #include "diag.h"
 #include "sql.h"
+#include "sql_stmt_cache.h"
 #include "xrow.h"
 #include "schema.h"
 #include "port.h"
 #include "tuple.h"
+#include "session.h"
 
 const char *sql_type_strs[] = {
 	NULL,
@@ -245,6 +247,42 @@ sql_bind_list_decode(struct sql_request *request, const char *data,
 	return 0;
 }
 
+/**
+ * Decode IPROTO_OPTIONS map of an EXECUTE request. Unknown
+ * options are ignored.
+ * @param request Request to decode to.
+ * @param data Options map.
+ *
+ * @retval  0 Success.
+ * @retval -1 Format error.
+ */
+static int
+sql_options_decode(struct sql_request *request, const char *data)
+{
+	/* An empty Lua table is encoded as an array. */
+	if (mp_typeof(*data) != MP_MAP)
+		return 0;
+	uint32_t map_size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < map_size; ++i) {
+		if (mp_typeof(*data) != MP_STR)
+			return -1;
+		uint32_t len;
+		const char *key = mp_decode_str(&data, &len);
+		if (len != strlen("chunk_size") ||
+		    memcmp(key, "chunk_size", len) != 0) {
+			mp_next(&data);
+			continue;
+		}
+		if (mp_typeof(*data) != MP_UINT)
+			return -1;
+		uint64_t chunk_size = mp_decode_uint(&data);
+		if (chunk_size > UINT32_MAX)
+			return -1;
+		request->chunk_size = chunk_size;
+	}
+	return 0;
+}
+
 int
 xrow_decode_sql(const struct xrow_header *row, struct sql_request *request,
 		struct region *region)
@@ -266,12 +304,15 @@ error:
 
 	uint32_t map_size = mp_decode_map(&data);
 	request->sql_text = NULL;
+	request->stmt_id = 0;
 	request->bind = NULL;
 	request->bind_count = 0;
+	request->chunk_size = 0;
 	request->sync = row->sync;
 	for (uint32_t i = 0; i < map_size; ++i) {
 		uint8_t key = *data;
-		if (key != IPROTO_SQL_BIND && key != IPROTO_SQL_TEXT) {
+		if (key != IPROTO_SQL_BIND && key != IPROTO_SQL_TEXT &&
+		    key != IPROTO_STMT_ID && key != IPROTO_OPTIONS) {
 			mp_check(&data, end);   /* skip the key */
 			mp_check(&data, end);   /* skip the value */
 			continue;
@@ -282,11 +323,22 @@ error:
 		if (key == IPROTO_SQL_BIND) {
 			if (sql_bind_list_decode(request, value, region) != 0)
 				return -1;
+		} else if (key == IPROTO_STMT_ID) {
+			if (mp_typeof(*value) != MP_UINT)
+				goto error;
+			request->stmt_id = mp_decode_uint(&value);
+		} else if (key == IPROTO_OPTIONS) {
+			if (row->type != IPROTO_EXECUTE ||
+			    sql_options_decode(request, value) != 0)
+				goto error;
 		} else {
+			if (mp_typeof(*value) != MP_STR)
+				goto error;
 			request->sql_text = value;
 		}
 	}
-	if (request->sql_text == NULL) {
+	if (request->sql_text == NULL &&
+	    (row->type != IPROTO_EXECUTE || request->stmt_id == 0)) {
 		diag_set(ClientError, ER_MISSING_REQUEST_FIELD,
 			 iproto_key_name(IPROTO_SQL_TEXT));
 		return -1;
@@ -550,17 +602,106 @@ sql_get_description(struct sqlite3_stmt *stmt, struct obuf *out,
 	return 0;
 }
 
+/**
+ * Port to push a chunk of a result set. It wraps a tuple port
+ * so that the whole chunk is a single push message - an array
+ * of rows, like box.session.push() of a Lua table would send.
+ */
+struct port_sql_chunk {
+	const struct port_vtab *vtab;
+	/** Tuple port with rows of the chunk. */
+	struct port *rows;
+};
+static_assert(sizeof(struct port_sql_chunk) <= sizeof(struct port),
+	      "sizeof(struct port_sql_chunk) must be <= sizeof(struct port)");
+
+static int
+port_sql_chunk_dump_msgpack(struct port *base, struct obuf *out)
+{
+	struct port_sql_chunk *port = (struct port_sql_chunk *) base;
+	size_t size = mp_sizeof_array(1);
+	char *buf = obuf_alloc(out, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "obuf_alloc", "buf");
+		return -1;
+	}
+	mp_encode_array(buf, 1);
+	if (port_dump_msgpack(port->rows, out) < 0)
+		return -1;
+	return 1;
+}
+
+static void
+port_sql_chunk_destroy(struct port *base)
+{
+	/* The rows are owned by the caller. */
+	(void) base;
+}
+
+static const struct port_vtab port_sql_chunk_vtab = {
+	.dump_msgpack = port_sql_chunk_dump_msgpack,
+	.dump_msgpack_16 = NULL,
+	.dump_plain = NULL,
+	.destroy = port_sql_chunk_destroy,
+};
+
+/**
+ * Push the rows collected in @a port to the current session
+ * and empty the port, so that a big result set does not
+ * have to be kept in memory until the statement is done.
+ * Then wait until the chunk is flushed: a statement may
+ * produce rows faster than the client reads them, and the
+ * output buffer would hold the whole result set otherwise.
+ * @param port Tuple port with the rows.
+ * @param sync Sync of the request.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error or the fiber is cancelled.
+ */
+static int
+sql_push_chunk(struct port *port, uint64_t sync)
+{
+	struct port chunk;
+	struct port_sql_chunk *chunk_port = (struct port_sql_chunk *) &chunk;
+	chunk_port->vtab = &port_sql_chunk_vtab;
+	chunk_port->rows = port;
+	struct session *session = current_session();
+	int rc = session_push(session, sync, &chunk);
+	port_destroy(&chunk);
+	port_destroy(port);
+	port_tuple_create(port);
+	if (rc != 0)
+		return -1;
+	return session_flush(session);
+}
+
 static inline int
 sql_execute(sqlite3 *db, struct sqlite3_stmt *stmt, struct port *port,
-	    struct region *region)
+	    struct region *region, uint32_t chunk_size, uint64_t sync)
 {
 	int rc, column_count = sqlite3_column_count(stmt);
+	uint32_t schema_version = box_schema_version();
 	if (column_count > 0) {
 		/* Either ROW or DONE or ERROR. */
 		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
 			if (sql_row_to_port(stmt, column_count, region,
 					    port) != 0)
 				return -1;
+			if (chunk_size == 0 ||
+			    port_tuple(port)->size < (int) chunk_size)
+				continue;
+			if (sql_push_chunk(port, sync) != 0)
+				return -1;
+			/*
+			 * The statement refers to spaces and
+			 * indexes, which could be dropped while
+			 * the chunk was being flushed.
+			 */
+			if (box_schema_version() != schema_version) {
+				diag_set(ClientError, ER_SQL_EXECUTE,
+					 "schema version has changed");
+				return -1;
+			}
 		}
 		assert(rc == SQLITE_DONE || rc != SQLITE_OK);
 	} else {
@@ -575,35 +716,102 @@ sql_execute(sqlite3 *db, struct sqlite3_stmt *stmt, struct port *port,
 	return 0;
 }
 
-int
-sql_prepare_and_execute(const struct sql_request *request,
-			struct sql_response *response, struct region *region)
+/**
+ * Get a compiled statement for a request from the statement
+ * cache. Return it with sql_stmt_cache_put() after use.
+ */
+static struct sqlite3_stmt *
+sql_request_stmt(const struct sql_request *request, uint32_t *stmt_id)
 {
+	*stmt_id = request->stmt_id;
+	if (request->sql_text == NULL)
+		return sql_stmt_cache_get(NULL, 0, stmt_id);
 	const char *sql = request->sql_text;
 	uint32_t len;
 	sql = mp_decode_str(&sql, &len);
-	struct sqlite3_stmt *stmt;
-	sqlite3 *db = sql_get();
-	if (db == NULL) {
-		diag_set(ClientError, ER_LOADING);
-		return -1;
-	}
-	if (sqlite3_prepare_v2(db, sql, len, &stmt, NULL) != SQLITE_OK) {
-		diag_set(ClientError, ER_SQL_EXECUTE, sqlite3_errmsg(db));
+	return sql_stmt_cache_get(sql, len, stmt_id);
+}
+
+int
+sql_prepare_and_execute(const struct sql_request *request,
+			struct sql_response *response, struct region *region)
+{
+	uint32_t stmt_id;
+	struct sqlite3_stmt *stmt = sql_request_stmt(request, &stmt_id);
+	if (stmt == NULL)
 		return -1;
-	}
-	assert(stmt != NULL);
 	port_tuple_create(&response->port);
 	response->prep_stmt = stmt;
+	response->stmt_id = stmt_id;
 	response->sync = request->sync;
 	if (sql_bind(request, stmt) == 0 &&
-	    sql_execute(db, stmt, &response->port, region) == 0)
+	    sql_execute(sql_get(), stmt, &response->port, region,
+			request->chunk_size, request->sync) == 0)
 		return 0;
 	port_destroy(&response->port);
-	sqlite3_finalize(stmt);
+	sql_stmt_cache_put(stmt, stmt_id);
 	return -1;
 }
 
+int
+sql_prepare(const struct sql_request *request,
+	    struct sql_response *response)
+{
+	assert(request->sql_text != NULL);
+	uint32_t stmt_id;
+	struct sqlite3_stmt *stmt = sql_request_stmt(request, &stmt_id);
+	if (stmt == NULL)
+		return -1;
+	/*
+	 * The statement isn't cached if sql_cache_count is 0 or
+	 * on OOM. Id 0 is never valid, EXECUTE would reject it.
+	 */
+	if (stmt_id == 0) {
+		sql_stmt_cache_put(stmt, stmt_id);
+		diag_set(ClientError, ER_SQL,
+			 "prepared statement can't be cached");
+		return -1;
+	}
+	port_tuple_create(&response->port);
+	response->prep_stmt = stmt;
+	response->stmt_id = stmt_id;
+	response->sync = request->sync;
+	return 0;
+}
+
+int
+sql_prepare_response_dump(struct sql_response *response, struct obuf *out)
+{
+	struct obuf_svp header_svp;
+	struct sqlite3_stmt *stmt = (struct sqlite3_stmt *) response->prep_stmt;
+	int rc = -1;
+	if (iproto_prepare_header(out, &header_svp,
+				  IPROTO_SQL_HEADER_LEN) != 0)
+		goto finish;
+	uint32_t stmt_id = response->stmt_id;
+	int bind_count = sqlite3_bind_parameter_count(stmt);
+	size_t size = mp_sizeof_uint(IPROTO_STMT_ID) +
+		      mp_sizeof_uint(stmt_id) +
+		      mp_sizeof_uint(IPROTO_BIND_COUNT) +
+		      mp_sizeof_uint(bind_count);
+	char *buf = obuf_alloc(out, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "obuf_alloc", "buf");
+		obuf_rollback_to_svp(out, &header_svp);
+		goto finish;
+	}
+	buf = mp_encode_uint(buf, IPROTO_STMT_ID);
+	buf = mp_encode_uint(buf, stmt_id);
+	buf = mp_encode_uint(buf, IPROTO_BIND_COUNT);
+	buf = mp_encode_uint(buf, bind_count);
+	iproto_reply_sql(out, &header_svp, response->sync, schema_version, 2);
+	rc = 0;
+finish:
+	port_destroy(&response->port);
+	sql_stmt_cache_put(stmt, response->stmt_id);
+	return rc;
+}
+
 int
 sql_response_dump(struct sql_response *response, struct obuf *out)
 {
@@ -654,6 +862,6 @@ err:
 			 keys);
 finish:
 	port_destroy(&response->port);
-	sqlite3_finalize(stmt);
+	sql_stmt_cache_put(stmt, response->stmt_id);
 	return rc;
 }
@@ -52,15 +52,23 @@ struct region;
 struct sql_bind;
 struct xrow_header;
 
-/** EXECUTE request. */
+/** EXECUTE or PREPARE request. */
 struct sql_request {
 	uint64_t sync;
-	/** SQL statement text. */
+	/** SQL statement text or NULL if stmt_id is set. */
 	const char *sql_text;
+	/** Id of a prepared statement, see sql_prepare(). */
+	uint32_t stmt_id;
 	/** Array of parameters. */
 	struct sql_bind *bind;
 	/** Length of the @bind. */
 	uint32_t bind_count;
+	/**
+	 * Maximal number of result set rows sent in one
+	 * IPROTO_CHUNK push, 0 if the whole result set is sent
+	 * in the response.
+	 */
+	uint32_t chunk_size;
 };
 
 /** Response on EXECUTE request. */
@@ -71,6 +79,8 @@ struct sql_response {
 	struct port port;
 	/** Prepared SQL statement with metadata. */
 	void *prep_stmt;
+	/** Id of the statement in the statement cache or 0. */
+	uint32_t stmt_id;
 };
 
 /**
@@ -110,7 +120,27 @@ int
 sql_response_dump(struct sql_response *response, struct obuf *out);
 
 /**
- * Parse the EXECUTE request.
+ * Dump a response on PREPARE into @an out buffer. The response
+ * is destroyed.
+ * +----------------------------------------------+
+ * | IPROTO_OK, sync, schema_version   ...        | iproto_header
+ * +----------------------------------------------+---------------
+ * | IPROTO_BODY: {                               |
+ * |     IPROTO_STMT_ID: number,                  | iproto_body
+ * |     IPROTO_BIND_COUNT: number                |
+ * | }                                            |
+ * +----------------------------------------------+
+ * @param response PREPARE response.
+ * @param out Output buffer.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+sql_prepare_response_dump(struct sql_response *response, struct obuf *out);
+
+/**
+ * Parse the EXECUTE or PREPARE request.
  * @param row Encoded data.
  * @param[out] request Request to decode to.
  * @param region Allocator.
@@ -124,6 +154,9 @@ xrow_decode_sql(const struct xrow_header *row, struct sql_request *request,
 
 /**
  * Prepare and execute an SQL statement.
+ * If the request has non-zero chunk_size, every chunk_size rows
+ * of the result set are pushed to the session as soon as they
+ * are fetched, and the response keeps only the rest of them.
  * @param request IProto request.
  * @param[out] response Response to store result.
  * @param region Runtime allocator for temporary objects
@@ -136,6 +169,23 @@ int
 sql_prepare_and_execute(const struct sql_request *request,
 			struct sql_response *response, struct region *region);
 
+/**
+ * Compile an SQL statement and keep it in the statement cache
+ * so that it can be executed by id. The id is assigned by the
+ * cache and is not reused while the statement stays cached.
+ * PREPARE of a cached text returns the id it already has.
+ * Fails if the statement can't be cached, e.g. when the cache
+ * is disabled by sql_cache_count = 0.
+ * @param request IProto request.
+ * @param[out] response Response to store the statement in.
+ *
+ * @retval  0 Success.
+ * @retval -1 Client or memory error.
+ */
+int
+sql_prepare(const struct sql_request *request,
+	    struct sql_response *response);
+
 #if defined(__cplusplus)
 } /* extern "C" { */
 #include "diag.h"
@@ -30,6 +30,8 @@
  */
 #include "index.h"
 #include "tuple.h"
+#include "tuple_hash.h"
+#include "salad/hll.h"
 #include "say.h"
 #include "schema.h"
 #include "user_def.h"
@@ -493,6 +495,8 @@ index_create(struct index *index, struct engine *engine,
 	index->engine = engine;
 	index->def = def;
 	index->space_cache_version = space_cache_version;
+	index->ndv = NULL;
+	index->ndv_count = 0;
 	return 0;
 }
 
@@ -505,8 +509,71 @@ index_delete(struct index *index)
 	 * the index is primary or secondary.
 	 */
 	struct index_def *def = index->def;
+	struct hll *ndv = index->ndv;
 	index->vtab->destroy(index);
 	index_def_delete(def);
+	free(ndv);
+}
+
+/**
+ * Number of key prefixes of an index the SQL planner may need
+ * to estimate. A full key of a unique index matches one tuple,
+ * so it doesn't need a sketch.
+ */
+static inline uint32_t
+index_ndv_part_count(struct index *index)
+{
+	uint32_t part_count = index->def->key_def->part_count;
+	return index->def->opts.is_unique ? part_count - 1 : part_count;
+}
+
+void
+index_ndv_add(struct index *index, const struct tuple *old_tuple,
+	      const struct tuple *new_tuple)
+{
+	struct key_def *key_def = index->def->key_def;
+	uint32_t part_count = index_ndv_part_count(index);
+	if (part_count == 0)
+		return;
+	/* A replace which doesn't change the key adds nothing. */
+	if (old_tuple != NULL &&
+	    tuple_compare(old_tuple, new_tuple, key_def) == 0)
+		return;
+	if (index->ndv == NULL) {
+		index->ndv = (struct hll *)malloc(part_count *
+						  sizeof(struct hll));
+		/* Statistics are optional, ignore OOM. */
+		if (index->ndv == NULL)
+			return;
+		for (uint32_t i = 0; i < part_count; i++)
+			hll_create(&index->ndv[i]);
+	}
+	uint32_t *hashes = (uint32_t *)alloca(part_count * sizeof(uint32_t));
+	tuple_hash_key_prefixes(new_tuple, key_def, part_count, hashes);
+	for (uint32_t i = 0; i < part_count; i++)
+		hll_add(&index->ndv[i], hashes[i]);
+	if (old_tuple == NULL)
+		index->ndv_count++;
+}
+
+uint64_t
+index_ndv_estimate(struct index *index, uint32_t part_count)
+{
+	assert(part_count > 0);
+	assert(part_count <= index->def->key_def->part_count);
+	if (index->ndv == NULL || part_count > index_ndv_part_count(index))
+		return 0;
+	/*
+	 * Tuples stored before the statistics were created,
+	 * e.g. vinyl data recovered from disk, are not
+	 * accounted. Don't trust the sketch unless it has
+	 * seen at least a half of the index.
+	 */
+	ssize_t size = index_size(index);
+	if (size <= 0 || index->ndv_count < (uint64_t)size / 2)
+		return 0;
+	uint64_t ndv = hll_estimate(&index->ndv[part_count - 1]);
+	return MIN(MAX(ndv, 1), (uint64_t)size);
 }
 
 int
@@ -527,6 +594,9 @@ index_build(struct index *index, struct index *pk)
 			 index->def->name);
 	}
 
+	struct space *space = space_by_id(index->def->space_id);
+	bool has_ndv = space != NULL && space_has_ndv(space);
+
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
 	if (it == NULL)
 		return -1;
@@ -542,6 +612,8 @@ index_build(struct index *index, struct index *pk)
 		rc = index_build_next(index, tuple);
 		if (rc != 0)
 			break;
+		if (has_ndv)
+			index_ndv_add(index, NULL, tuple);
 	}
 	iterator_delete(it);
 	if (rc != 0)
@@ -418,6 +418,18 @@ struct index_vtab {
 	struct iterator *(*create_iterator)(struct index *index,
 			enum iterator_type type,
 			const char *key, uint32_t part_count);
+	/**
+	 * Create an index iterator that is only guaranteed to
+	 * return the fields indexed by this index and the primary
+	 * key parts, i.e. the fields of index_def::cmp_def. Other
+	 * fields of returned tuples may be missing or nil. Engines
+	 * that store full tuples in all indexes simply use
+	 * create_iterator here, while vinyl can skip primary index
+	 * lookups for secondary indexes.
+	 */
+	struct iterator *(*create_key_iterator)(struct index *index,
+			enum iterator_type type,
+			const char *key, uint32_t part_count);
 	/**
 	 * Create an ALL iterator with personal read view so further
 	 * index modifications will not affect the iteration results.
@@ -456,6 +468,16 @@ struct index {
 	struct index_def *def;
 	/* Space cache version at the time of construction. */
 	uint32_t space_cache_version;
+	/**
+	 * Sketches of the number of distinct values of key
+	 * prefixes: ndv[i] counts the first i + 1 key parts.
+	 * Used by the SQL planner when there is no statistics
+	 * collected by ANALYZE. Allocated on demand, see
+	 * index_ndv_add().
+	 */
+	struct hll *ndv;
+	/** Number of tuples accounted in ndv. */
+	uint64_t ndv_count;
 };
 
 /**
@@ -502,6 +524,26 @@ index_create(struct index *index, struct engine *engine,
 void
 index_delete(struct index *index);
 
+/**
+ * Account a tuple stored in an index in the index statistics
+ * used by the SQL planner. @a old_tuple is the tuple replaced
+ * by @a new_tuple, if any. Deletions are not accounted: the
+ * estimates are good as long as data is mostly inserted or
+ * replaced rather than deleted. The caller must check that
+ * the space needs the statistics, see space_has_ndv().
+ */
+void
+index_ndv_add(struct index *index, const struct tuple *old_tuple,
+	      const struct tuple *new_tuple);
+
+/**
+ * Estimate the number of distinct values of the first
+ * @a part_count key parts of an index. Return 0 if not enough
+ * tuples have been accounted to trust the estimate.
+ */
+uint64_t
+index_ndv_estimate(struct index *index, uint32_t part_count);
+
 /** Build this index based on the contents of another index. */
 int
 index_build(struct index *index, struct index *pk);
@@ -610,6 +652,13 @@ index_create_iterator(struct index *index, enum iterator_type type,
 	return index->vtab->create_iterator(index, type, key, part_count);
 }
 
+static inline struct iterator *
+index_create_key_iterator(struct index *index, enum iterator_type type,
+			  const char *key, uint32_t part_count)
+{
+	return index->vtab->create_key_iterator(index, type, key, part_count);
+}
+
 static inline struct snapshot_iterator *
 index_create_snapshot_iterator(struct index *index)
 {
@@ -153,6 +153,13 @@ struct index_opts {
 	double run_size_ratio;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/**
+	 * Store full tuples in a secondary index so that reads
+	 * from it don't need to look up the primary index.
+	 * Only makes sense for vinyl, because memtx indexes
+	 * reference full tuples anyway.
+	 */
+	bool is_covering;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -212,6 +219,8 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->is_covering != o2->is_covering)
+		return o1->is_covering < o2->is_covering ? -1 : 1;
 	return 0;
 }
 
@@ -40,6 +40,7 @@
 
 #include "version.h"
 #include "fiber.h"
+#include "fiber_cond.h"
 #include "cbus.h"
 #include "say.h"
 #include "sio.h"
@@ -105,6 +106,12 @@ struct iproto_kharon {
 	 * iproto_msg.wpos).
 	 */
 	struct iproto_wpos wpos;
+	/**
+	 * True if a tx fiber waits for the pushed data to be
+	 * flushed. Then iproto returns the message only when
+	 * all data up to wpos is written to the socket.
+	 */
+	bool wait_flush;
 };
 
 /**
@@ -300,9 +307,23 @@ iproto_process_push(struct cmsg *m);
 static void
 tx_end_push(struct cmsg *m);
 
+/**
+ * Send Kharon back to tx with the last flushed position.
+ * @param con iproto connection.
+ */
+static void
+net_end_push(struct iproto_connection *con);
+
+/**
+ * Kharon is sent back to tx explicitly by iproto, since it
+ * may have to wait for the output to be flushed.
+ */
 static const struct cmsg_hop push_route[] = {
-	{ iproto_process_push, &tx_pipe },
-	{ tx_end_push, NULL }
+	{ iproto_process_push, NULL },
+};
+
+static const struct cmsg_hop push_return_route[] = {
+	{ tx_end_push, NULL },
 };
 
 
@@ -433,8 +454,15 @@ struct iproto_connection
 	 *                 <--- notification ----
 	 * [write ends]
 	 *                          ...
+	 *
+	 * If a push requires to wait for the flush (see
+	 * iproto_session_flush()), iproto holds Kharon until the
+	 * output is written to the socket or the connection is
+	 * closed.
 	 */
 	struct iproto_kharon kharon;
+	/** True if Kharon is held by iproto. */
+	bool is_push_held;
 	/**
 	 * The following fields are used exclusively by the tx thread.
 	 * Align them to prevent false-sharing.
@@ -450,6 +478,12 @@ struct iproto_connection
 		 * return.
 		 */
 		bool is_push_pending;
+		/** Number of fibers waiting for a flush. */
+		int flush_waiters;
+		/** Number of Kharon trips completed so far. */
+		uint64_t push_trip_count;
+		/** Signaled when Kharon returns. */
+		struct fiber_cond push_cond;
 	} tx;
 	/** Authentication salt. */
 	char salt[IPROTO_SALT_SIZE];
@@ -564,6 +598,9 @@ iproto_connection_close(struct iproto_connection *con)
 		 * is done only once.
 		 */
 		con->p_ibuf->wpos -= con->parse_size;
+		/* Nothing is going to be flushed anymore. */
+		if (con->is_push_held)
+			net_end_push(con);
 	}
 	/*
 	 * If the connection has no outstanding requests in the
@@ -962,6 +999,8 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 		}
 		if (ev_is_active(&con->output))
 			ev_io_stop(con->loop, &con->output);
+		if (con->is_push_held)
+			net_end_push(con);
 	} catch (Exception *e) {
 		e->log();
 		iproto_connection_close(con);
@@ -996,8 +1035,12 @@ iproto_connection_new(int fd)
 	/* It may be very awkward to allocate at close. */
 	cmsg_init(&con->disconnect, disconnect_route);
 	con->is_disconnected = false;
+	con->is_push_held = false;
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = false;
+	con->tx.flush_waiters = 0;
+	con->tx.push_trip_count = 0;
+	fiber_cond_create(&con->tx.push_cond);
 	return con;
 }
 
@@ -1101,6 +1144,8 @@ static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
 	call_route,                             /* IPROTO_CALL */
 	sql_route,                              /* IPROTO_EXECUTE */
 	NULL,                                   /* IPROTO_NOP */
+	process1_route,                         /* IPROTO_DELETE_RANGE */
+	sql_route,                              /* IPROTO_PREPARE */
 };
 
 static const struct cmsg_hop join_route[] = {
@@ -1142,6 +1187,7 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 	case IPROTO_UPDATE:
 	case IPROTO_DELETE:
 	case IPROTO_UPSERT:
+	case IPROTO_DELETE_RANGE:
 		if (xrow_decode_dml(&msg->header, &msg->dml,
 				    dml_request_key_map(type)))
 			goto error;
@@ -1156,6 +1202,7 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		cmsg_init(&msg->base, call_route);
 		break;
 	case IPROTO_EXECUTE:
+	case IPROTO_PREPARE:
 		if (xrow_decode_sql(&msg->header, &msg->sql, &fiber()->gc))
 			goto error;
 		cmsg_init(&msg->base, sql_route);
@@ -1168,6 +1215,7 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		*stop_input = true;
 		break;
 	case IPROTO_SUBSCRIBE:
+	case IPROTO_CDC:
 		cmsg_init(&msg->base, subscribe_route);
 		*stop_input = true;
 		break;
@@ -1584,8 +1632,17 @@ tx_process_sql(struct cmsg *m)
 
 	if (tx_check_schema(msg->header.schema_version))
 		goto error;
-	assert(msg->header.type == IPROTO_EXECUTE);
 	tx_inject_delay();
+	if (msg->header.type == IPROTO_PREPARE) {
+		if (sql_prepare(&msg->sql, &response) != 0)
+			goto error;
+		out = msg->connection->tx.p_obuf;
+		if (sql_prepare_response_dump(&response, out) != 0)
+			goto error;
+		iproto_wpos_create(&msg->wpos, out);
+		return;
+	}
+	assert(msg->header.type == IPROTO_EXECUTE);
 	if (sql_prepare_and_execute(&msg->sql, &response, &fiber()->gc) != 0)
 		goto error;
 	/*
@@ -1625,6 +1682,10 @@ tx_process_join_subscribe(struct cmsg *m)
 			 */
 			box_process_subscribe(&con->input, &msg->header);
 			break;
+		case IPROTO_CDC:
+			/* Same as SUBSCRIBE. */
+			box_process_cdc(&con->input, &msg->header);
+			break;
 		default:
 			unreachable();
 		}
@@ -1885,6 +1946,16 @@ iproto_session_sync(struct session *session)
 
 /** {{{ IPROTO_PUSH implementation. */
 
+static void
+net_end_push(struct iproto_connection *con)
+{
+	struct iproto_kharon *kharon = &con->kharon;
+	kharon->wpos = con->wpos;
+	con->is_push_held = false;
+	cmsg_init(&kharon->base, push_return_route);
+	cpipe_push(&tx_pipe, &kharon->base);
+}
+
 static void
 iproto_process_push(struct cmsg *m)
 {
@@ -1892,9 +1963,16 @@ iproto_process_push(struct cmsg *m)
 	struct iproto_connection *con =
 		container_of(kharon, struct iproto_connection, kharon);
 	con->wend = kharon->wpos;
-	kharon->wpos = con->wpos;
-	if (evio_has_fd(&con->output) && !ev_is_active(&con->output))
-		ev_feed_event(con->loop, &con->output, EV_WRITE);
+	if (evio_has_fd(&con->output)) {
+		if (!ev_is_active(&con->output))
+			ev_feed_event(con->loop, &con->output, EV_WRITE);
+		if (kharon->wait_flush) {
+			/* Released by iproto_connection_on_output(). */
+			con->is_push_held = true;
+			return;
+		}
+	}
+	net_end_push(con);
 }
 
 /**
@@ -1907,6 +1985,7 @@ tx_begin_push(struct iproto_connection *con)
 	assert(! con->tx.is_push_sent);
 	cmsg_init(&con->kharon.base, push_route);
 	iproto_wpos_create(&con->kharon.wpos, con->tx.p_obuf);
+	con->kharon.wait_flush = con->tx.flush_waiters > 0;
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = true;
 	cpipe_push(&net_pipe, (struct cmsg *) &con->kharon);
@@ -1920,6 +1999,8 @@ tx_end_push(struct cmsg *m)
 		container_of(kharon, struct iproto_connection, kharon);
 	tx_accept_wpos(con, &kharon->wpos);
 	con->tx.is_push_sent = false;
+	con->tx.push_trip_count++;
+	fiber_cond_broadcast(&con->tx.push_cond);
 	if (con->tx.is_push_pending)
 		tx_begin_push(con);
 }
@@ -1955,6 +2036,48 @@ iproto_session_push(struct session *session, uint64_t sync, struct port *port)
 	return 0;
 }
 
+/**
+ * Wait until the data pushed to a remote client is written to
+ * the socket, so that pushes don't pile up in the output
+ * buffer when they are produced faster than the client reads
+ * them.
+ * @param session iproto session.
+ *
+ * @retval -1 The fiber is cancelled.
+ * @retval  0 Success, the data is flushed or the connection is
+ *            closed.
+ */
+static int
+iproto_session_flush(struct session *session)
+{
+	struct iproto_connection *con =
+		(struct iproto_connection *) session->meta.connection;
+	/*
+	 * Kharon travelling now may have left before the last
+	 * push and without the flush request, so the data is
+	 * only known to be flushed after the next trip.
+	 */
+	uint64_t trip = con->tx.push_trip_count + 1;
+	con->tx.flush_waiters++;
+	if (! con->tx.is_push_sent) {
+		tx_begin_push(con);
+	} else {
+		con->tx.is_push_pending = true;
+		trip++;
+	}
+	int rc = 0;
+	while (con->tx.push_trip_count < trip) {
+		fiber_cond_wait(&con->tx.push_cond);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			rc = -1;
+			break;
+		}
+	}
+	con->tx.flush_waiters--;
+	return rc;
+}
+
 /** }}} */
 
 /** Initialize the iproto subsystem and start network io thread */
@@ -1973,6 +2096,7 @@ iproto_init()
 		/* .push = */ iproto_session_push,
 		/* .fd = */ iproto_session_fd,
 		/* .sync = */ iproto_session_sync,
+		/* .flush = */ iproto_session_flush,
 	};
 	session_vtab_registry[SESSION_TYPE_BINARY] = iproto_session_vtab;
 }
@@ -89,6 +89,10 @@ const unsigned char iproto_key_type[IPROTO_KEY_MAX] =
 	/* 0x29 */	MP_MAP, /* IPROTO_BALLOT */
 	/* 0x2a */	MP_MAP, /* IPROTO_TUPLE_META */
 	/* 0x2b */	MP_MAP, /* IPROTO_OPTIONS */
+	/* 0x2c */	MP_ARRAY, /* IPROTO_END_KEY */
+	/* 0x2d */	MP_UINT, /* IPROTO_COMPRESSION */
+	/* 0x2e */	MP_UINT, /* IPROTO_JOIN_STREAM_ID */
+	/* 0x2f */	MP_UINT, /* IPROTO_JOIN_STREAM_COUNT */
 	/* }}} */
 };
 
@@ -107,6 +111,8 @@ const char *iproto_type_strs[] =
 	"CALL",
 	"EXECUTE",
 	NULL, /* NOP */
+	"DELETE_RANGE",
+	"PREPARE",
 };
 
 #define bit(c) (1ULL<<IPROTO_##c)
@@ -124,6 +130,8 @@ const uint64_t iproto_body_key_map[IPROTO_TYPE_STAT_MAX] = {
 	0,                                                     /* CALL */
 	0,                                                     /* EXECUTE */
 	0,                                                     /* NOP */
+	bit(SPACE_ID) | bit(KEY) | bit(END_KEY),               /* DELETE_RANGE */
+	0,                                                     /* PREPARE */
 };
 #undef bit
 
@@ -172,18 +180,18 @@ const char *iproto_key_strs[IPROTO_KEY_MAX] = {
 	"ballot",           /* 0x29 */
 	"tuple meta",       /* 0x2a */
 	"options",          /* 0x2b */
-	NULL,               /* 0x2c */
-	NULL,               /* 0x2d */
-	NULL,               /* 0x2e */
-	NULL,               /* 0x2f */
+	"end key",          /* 0x2c */
+	"compression",      /* 0x2d */
+	"join stream id",   /* 0x2e */
+	"join stream count", /* 0x2f */
 	"data",             /* 0x30 */
 	"error",            /* 0x31 */
 	"metadata",         /* 0x32 */
-	NULL,               /* 0x33 */
-	NULL,               /* 0x34 */
-	NULL,               /* 0x35 */
-	NULL,               /* 0x36 */
-	NULL,               /* 0x37 */
+	"join files",       /* 0x33 */
+	"file name",        /* 0x34 */
+	"space filter",     /* 0x35 */
+	"space name",       /* 0x36 */
+	"batch delay",      /* 0x37 */
 	NULL,               /* 0x38 */
 	NULL,               /* 0x39 */
 	NULL,               /* 0x3a */
@@ -195,6 +203,8 @@ const char *iproto_key_strs[IPROTO_KEY_MAX] = {
 	"SQL text",         /* 0x40 */
 	"SQL bind",         /* 0x41 */
 	"SQL info",         /* 0x42 */
+	"statement id",     /* 0x43 */
+	"bind count",       /* 0x44 */
 };
 
 const char *vy_page_info_key_strs[VY_PAGE_INFO_KEY_MAX] = {
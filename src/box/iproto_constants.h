@@ -91,6 +91,10 @@ enum iproto_key {
 	IPROTO_BALLOT = 0x29,
 	IPROTO_TUPLE_META = 0x2a,
 	IPROTO_OPTIONS = 0x2b,
+	IPROTO_END_KEY = 0x2c, /* DELETE_RANGE */
+	IPROTO_COMPRESSION = 0x2d, /* SUBSCRIBE */
+	IPROTO_JOIN_STREAM_ID = 0x2e, /* JOIN */
+	IPROTO_JOIN_STREAM_COUNT = 0x2f, /* JOIN */
 
 	/* Leave a gap between request keys and response keys */
 	IPROTO_DATA = 0x30,
@@ -104,6 +108,16 @@ enum iproto_key {
 	 */
 	IPROTO_METADATA = 0x32,
 
+	/*
+	 * Replication keys (body) that didn't fit in the gap
+	 * of request keys.
+	 */
+	IPROTO_JOIN_FILES = 0x33, /* JOIN */
+	IPROTO_FILE_NAME = 0x34, /* JOIN_FILE */
+	IPROTO_SPACE_FILTER = 0x35, /* SUBSCRIBE, CDC */
+	IPROTO_SPACE_NAME = 0x36, /* CDC */
+	IPROTO_BATCH_DELAY = 0x37, /* SUBSCRIBE, CDC */
+
 	/* Leave a gap between response keys and SQL keys. */
 	IPROTO_SQL_TEXT = 0x40,
 	IPROTO_SQL_BIND = 0x41,
@@ -113,6 +127,8 @@ enum iproto_key {
 	 * }
 	 */
 	IPROTO_SQL_INFO = 0x42,
+	IPROTO_STMT_ID = 0x43,
+	IPROTO_BIND_COUNT = 0x44,
 	IPROTO_KEY_MAX
 };
 
@@ -131,13 +147,25 @@ enum iproto_ballot_key {
 	IPROTO_BALLOT_GC_VCLOCK = 0x03,
 };
 
+/**
+ * Compression of the replication stream, requested by a replica
+ * in IPROTO_COMPRESSION of SUBSCRIBE and confirmed by the master
+ * in the response. A master that doesn't know the key ignores
+ * it, so the stream stays uncompressed.
+ */
+enum iproto_compression {
+	IPROTO_COMPRESSION_NONE = 0,
+	IPROTO_COMPRESSION_ZSTD = 1,
+};
+
 #define bit(c) (1ULL<<IPROTO_##c)
 
 #define IPROTO_HEAD_BMAP (bit(REQUEST_TYPE) | bit(SYNC) | bit(REPLICA_ID) |\
 			  bit(LSN) | bit(SCHEMA_VERSION))
 #define IPROTO_DML_BODY_BMAP (bit(SPACE_ID) | bit(INDEX_ID) | bit(LIMIT) |\
 			      bit(OFFSET) | bit(ITERATOR) | bit(INDEX_BASE) |\
-			      bit(KEY) | bit(TUPLE) | bit(OPS) | bit(TUPLE_META))
+			      bit(KEY) | bit(TUPLE) | bit(OPS) | bit(TUPLE_META) |\
+			      bit(END_KEY))
 
 static inline bool
 xrow_header_has_key(const char *pos, const char *end)
@@ -194,6 +222,10 @@ enum iproto_type {
 	IPROTO_EXECUTE = 11,
 	/** No operation. Treated as DML, used to bump LSN. */
 	IPROTO_NOP = 12,
+	/** Delete all keys in range [KEY, END_KEY) */
+	IPROTO_DELETE_RANGE = 13,
+	/** Compile an SQL statement for later execution. */
+	IPROTO_PREPARE = 14,
 	/** The maximum typecode used for box.stat() */
 	IPROTO_TYPE_STAT_MAX,
 
@@ -207,6 +239,10 @@ enum iproto_type {
 	IPROTO_VOTE_DEPRECATED = 67,
 	/** Vote request command for master election */
 	IPROTO_VOTE = 68,
+	/** A chunk of a checkpoint file sent on JOIN */
+	IPROTO_JOIN_FILE = 69,
+	/** Stream committed rows to a change data capture client */
+	IPROTO_CDC = 70,
 
 	/** Vinyl run info stored in .index file */
 	VY_INDEX_RUN_INFO = 100,
@@ -274,7 +310,8 @@ static inline bool
 iproto_type_is_dml(uint32_t type)
 {
 	return (type >= IPROTO_SELECT && type <= IPROTO_DELETE) ||
-		type == IPROTO_UPSERT || type == IPROTO_NOP;
+		type == IPROTO_UPSERT || type == IPROTO_NOP ||
+		type == IPROTO_DELETE_RANGE;
 }
 
 /**
@@ -316,7 +353,8 @@ iproto_type_is_request(uint32_t type)
 static inline bool
 iproto_type_is_sync(uint32_t type)
 {
-	return type == IPROTO_JOIN || type == IPROTO_SUBSCRIBE;
+	return type == IPROTO_JOIN || type == IPROTO_SUBSCRIBE ||
+	       type == IPROTO_CDC;
 }
 
 /** This is an error. */
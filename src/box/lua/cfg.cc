@@ -252,6 +252,28 @@ lbox_cfg_set_net_msg_max(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_sql_cache_count(struct lua_State *L)
+{
+	try {
+		box_set_sql_cache_count();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_sql_temp_memory_max(struct lua_State *L)
+{
+	try {
+		box_set_sql_temp_memory_max();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_worker_pool_threads(struct lua_State *L)
 {
@@ -302,6 +324,66 @@ lbox_cfg_set_replication_skip_conflict(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_apply_workers(struct lua_State *L)
+{
+	try {
+		box_set_replication_apply_workers();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_replication_compression(struct lua_State *L)
+{
+	(void) L;
+	box_set_replication_compression();
+	return 0;
+}
+
+static int
+lbox_cfg_set_replication_join_streams(struct lua_State *L)
+{
+	try {
+		box_set_replication_join_streams();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_replication_join_files(struct lua_State *L)
+{
+	(void) L;
+	box_set_replication_join_files();
+	return 0;
+}
+
+static int
+lbox_cfg_set_replication_spaces(struct lua_State *L)
+{
+	try {
+		box_set_replication_spaces();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_replication_batch_delay(struct lua_State *L)
+{
+	try {
+		box_set_replication_batch_delay();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 void
 box_lua_cfg_init(struct lua_State *L)
 {
@@ -328,8 +410,16 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_replication_timeout", lbox_cfg_set_replication_timeout},
 		{"cfg_set_replication_connect_quorum", lbox_cfg_set_replication_connect_quorum},
 		{"cfg_set_replication_skip_conflict", lbox_cfg_set_replication_skip_conflict},
+		{"cfg_set_replication_apply_workers", lbox_cfg_set_replication_apply_workers},
+		{"cfg_set_replication_compression", lbox_cfg_set_replication_compression},
+		{"cfg_set_replication_join_streams", lbox_cfg_set_replication_join_streams},
+		{"cfg_set_replication_join_files", lbox_cfg_set_replication_join_files},
+		{"cfg_set_replication_spaces", lbox_cfg_set_replication_spaces},
+		{"cfg_set_replication_batch_delay", lbox_cfg_set_replication_batch_delay},
 		{"cfg_set_replication_connect_timeout", lbox_cfg_set_replication_connect_timeout},
 		{"cfg_set_net_msg_max", lbox_cfg_set_net_msg_max},
+		{"cfg_set_sql_cache_count", lbox_cfg_set_sql_cache_count},
+		{"cfg_set_sql_temp_memory_max", lbox_cfg_set_sql_temp_memory_max},
 		{NULL, NULL}
 	};
 
@@ -461,6 +461,7 @@ tarantool_lua_console_init(struct lua_State *L)
 		/* .push = */ console_session_push,
 		/* .fd = */ console_session_fd,
 		/* .sync = */ generic_session_sync,
+		/* .flush = */ generic_session_flush,
 	};
 	session_vtab_registry[SESSION_TYPE_CONSOLE] = console_session_vtab;
 	session_vtab_registry[SESSION_TYPE_REPL] = console_session_vtab;
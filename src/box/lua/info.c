@@ -44,13 +44,16 @@
 #include "box/relay.h"
 #include "box/iproto.h"
 #include "box/wal.h"
+#include "box/iproto_constants.h"
 #include "box/replication.h"
 #include "box/info.h"
 #include "box/gc.h"
 #include "box/checkpoint.h"
 #include "box/engine.h"
 #include "box/vinyl.h"
+#include "latency.h"
 #include "main.h"
+#include "rmean.h"
 #include "version.h"
 #include "box/box.h"
 #include "lua/utils.h"
@@ -70,6 +73,68 @@ lbox_pushvclock(struct lua_State *L, const struct vclock *vclock)
 	luaL_setmaphint(L, -1); /* compact flow */
 }
 
+/**
+ * Push byte counters of a compressed replication stream
+ * to the table on top of the stack.
+ */
+static void
+lbox_pushcompression(lua_State *L, uint64_t compressed,
+		     uint64_t uncompressed)
+{
+	lua_pushstring(L, "compression");
+	lua_pushstring(L, "zstd");
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "compressed_bytes");
+	luaL_pushuint64(L, compressed);
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "uncompressed_bytes");
+	luaL_pushuint64(L, uncompressed);
+	lua_settable(L, -3);
+}
+
+/**
+ * Push percentiles of a replication latency counter to the
+ * table on top of the stack.
+ */
+static void
+lbox_pushlatency(lua_State *L, const char *name, struct latency *latency)
+{
+	static const int pcts[] = {50, 75, 90, 95, 99};
+	lua_pushstring(L, name);
+	lua_createtable(L, 0, lengthof(pcts));
+	for (size_t i = 0; i < lengthof(pcts); i++) {
+		lua_pushfstring(L, "p%d", pcts[i]);
+		lua_pushnumber(L, latency_get(latency, pcts[i]));
+		lua_settable(L, -3);
+	}
+	lua_settable(L, -3);
+}
+
+/**
+ * Push rate counters of a replication stream to the table
+ * on top of the stack, see enum replication_stat.
+ */
+static void
+lbox_pushreplicationstat(lua_State *L, struct rmean *rmean)
+{
+	for (int i = 0; i < REPLICATION_STAT_LAST; i++) {
+		lua_pushstring(L, replication_stat_strs[i]);
+		lua_createtable(L, 0, 2);
+
+		lua_pushstring(L, "rps");
+		lua_pushnumber(L, rmean_mean(rmean, i));
+		lua_settable(L, -3);
+
+		lua_pushstring(L, "total");
+		luaL_pushint64(L, rmean_total(rmean, i));
+		lua_settable(L, -3);
+
+		lua_settable(L, -3);
+	}
+}
+
 static void
 lbox_pushapplier(lua_State *L, struct applier *applier)
 {
@@ -102,6 +167,19 @@ lbox_pushapplier(lua_State *L, struct applier *applier)
 		lua_pushlstring(L, name, total);
 		lua_settable(L, -3);
 
+		if (applier->zstream != NULL) {
+			lbox_pushcompression(L, applier->bytes_compressed,
+					     applier->bytes_uncompressed);
+		}
+
+		lbox_pushreplicationstat(L, applier->rmean);
+
+		lua_pushstring(L, "latency");
+		lua_createtable(L, 0, 2);
+		lbox_pushlatency(L, "receive", &applier->recv_latency);
+		lbox_pushlatency(L, "apply", &applier->apply_latency);
+		lua_settable(L, -3);
+
 		struct error *e = diag_last_error(&applier->reader->diag);
 		if (e != NULL) {
 			lua_pushstring(L, "message");
@@ -118,6 +196,19 @@ lbox_pushrelay(lua_State *L, struct relay *relay)
 	lua_pushstring(L, "vclock");
 	lbox_pushvclock(L, relay_vclock(relay));
 	lua_settable(L, -3);
+
+	if (relay_compression(relay) != IPROTO_COMPRESSION_NONE) {
+		uint64_t compressed, uncompressed;
+		relay_bytes(relay, &compressed, &uncompressed);
+		lbox_pushcompression(L, compressed, uncompressed);
+	}
+
+	lbox_pushreplicationstat(L, relay_rmean(relay));
+
+	lua_pushstring(L, "latency");
+	lua_createtable(L, 0, 1);
+	lbox_pushlatency(L, "send", relay_send_latency(relay));
+	lua_settable(L, -3);
 }
 
 static void
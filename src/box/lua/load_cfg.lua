@@ -75,10 +75,18 @@ local default_cfg = {
     replication_connect_timeout = 30,
     replication_connect_quorum = nil, -- connect all
     replication_skip_conflict = false,
+    replication_apply_workers = 1,
+    replication_compression = false,
+    replication_join_streams = 1,
+    replication_join_files = false,
+    replication_spaces = nil, -- all spaces
+    replication_batch_delay = 0,
     feedback_enabled      = true,
     feedback_host         = "https://feedback.tarantool.io",
     feedback_interval     = 3600,
     net_msg_max           = 768,
+    sql_cache_count       = 256,
+    sql_temp_memory_max   = 0,
 }
 
 -- types of available options
@@ -136,10 +144,18 @@ local template_cfg = {
     replication_connect_timeout = 'number',
     replication_connect_quorum = 'number',
     replication_skip_conflict = 'boolean',
+    replication_apply_workers = 'number',
+    replication_compression = 'boolean',
+    replication_join_streams = 'number',
+    replication_join_files = 'boolean',
+    replication_spaces = 'number, table',
+    replication_batch_delay = 'number',
     feedback_enabled      = 'boolean',
     feedback_host         = 'string',
     feedback_interval     = 'number',
     net_msg_max           = 'number',
+    sql_cache_count       = 'number',
+    sql_temp_memory_max   = 'number',
 }
 
 local function normalize_uri(port)
@@ -230,7 +246,15 @@ local dynamic_cfg = {
     instance_uuid           = check_instance_uuid,
     replicaset_uuid         = check_replicaset_uuid,
     replication_skip_conflict = private.cfg_set_replication_skip_conflict,
+    replication_apply_workers = private.cfg_set_replication_apply_workers,
+    replication_compression = private.cfg_set_replication_compression,
+    replication_join_streams = private.cfg_set_replication_join_streams,
+    replication_join_files = private.cfg_set_replication_join_files,
+    replication_spaces = private.cfg_set_replication_spaces,
+    replication_batch_delay = private.cfg_set_replication_batch_delay,
     net_msg_max             = private.cfg_set_net_msg_max,
+    sql_cache_count         = private.cfg_set_sql_cache_count,
+    sql_temp_memory_max     = private.cfg_set_sql_temp_memory_max,
 }
 
 local dynamic_cfg_skip_at_load = {
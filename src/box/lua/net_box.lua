@@ -94,6 +94,7 @@ local method_encoder = {
     upsert  = internal.encode_upsert,
     select  = internal.encode_select,
     execute = internal.encode_execute,
+    prepare = internal.encode_prepare,
     get     = internal.encode_select,
     min     = internal.encode_select,
     max     = internal.encode_select,
@@ -118,6 +119,7 @@ local method_decoder = {
     upsert  = decode_nil,
     select  = internal.decode_select,
     execute = internal.decode_execute,
+    prepare = internal.decode_prepare,
     get     = decode_get,
     min     = decode_get,
     max     = decode_get,
@@ -1150,12 +1152,25 @@ end
 function remote_methods:execute(query, parameters, sql_opts, netbox_opts)
     check_remote_arg(self, "execute")
     if sql_opts ~= nil then
-        box.error(box.error.UNSUPPORTED, "execute", "options")
+        for k, v in pairs(sql_opts) do
+            if k ~= 'chunk_size' then
+                box.error(box.error.UNSUPPORTED, "execute", "options")
+            end
+            if type(v) ~= 'number' or v <= 0 then
+                box.error(box.error.ILLEGAL_PARAMS,
+                          "chunk_size should be a positive number")
+            end
+        end
     end
     return self:_request('execute', netbox_opts, query, parameters or {},
                          sql_opts or {})
 end
 
+function remote_methods:prepare(query, netbox_opts)
+    check_remote_arg(self, "prepare")
+    return self:_request('prepare', netbox_opts, query)
+end
+
 function remote_methods:wait_state(state, timeout)
     check_remote_arg(self, 'wait_state')
     if timeout == nil then
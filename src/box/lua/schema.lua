@@ -695,6 +695,7 @@ local index_options = {
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    covering = 'boolean',
 }
 
 --
@@ -800,6 +801,7 @@ box.schema.index.create = function(space_id, name, options)
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
             bloom_fpr = options.bloom_fpr,
+            covering = options.covering,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -1353,6 +1355,11 @@ base_index_mt.delete = function(index, key)
     check_index_arg(index, 'delete')
     return internal.delete(index.space_id, index.id, keify(key));
 end
+base_index_mt.delete_range = function(index, begin_key, end_key)
+    check_index_arg(index, 'delete_range')
+    return internal.delete_range(index.space_id, index.id, keify(begin_key),
+                                 keify(end_key));
+end
 
 base_index_mt.stat = function(index)
     return internal.stat(index.space_id, index.id);
@@ -1450,6 +1457,10 @@ space_mt.delete = function(space, key)
     check_space_arg(space, 'delete')
     return check_primary_index(space):delete(key)
 end
+space_mt.delete_range = function(space, begin_key, end_key)
+    check_space_arg(space, 'delete_range')
+    return check_primary_index(space):delete_range(begin_key, end_key)
+end
 -- Assumes that spaceno has a TREE (NUM) primary key
 -- inserts a tuple after getting the next value of the
 -- primary key and returns it back to the user
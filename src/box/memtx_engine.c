@@ -36,6 +36,7 @@
 #include <small/mempool.h>
 
 #include "fiber.h"
+#include "bit/bit.h"
 #include "errinj.h"
 #include "coio_file.h"
 #include "tuple.h"
@@ -1205,6 +1206,100 @@ struct tuple_format_vtab memtx_tuple_format_vtab = {
 	memtx_tuple_new,
 };
 
+/**
+ * Find the size class of an ephemeral tuple block. The size is
+ * rounded up to one of four steps between powers of two, so at
+ * most a quarter of a block is wasted.
+ * @param size Size of the tuple.
+ * @param[out] class_size Size of blocks of the class.
+ * @retval Index of the class in the arena free lists.
+ */
+static inline uint32_t
+memtx_ephemeral_size_class(size_t size, size_t *class_size)
+{
+	uint64_t n = MAX(size, 16) - 1;
+	int k = 63 - bit_clz_u64(n);
+	uint32_t step = (n >> (k - 2)) & 3;
+	*class_size = (size_t)(step + 5) << (k - 2);
+	uint32_t idx = (k - 3) * 4 + step;
+	assert(idx < MEMTX_EPHEMERAL_SIZE_CLASS_MAX);
+	return idx;
+}
+
+struct tuple *
+memtx_ephemeral_tuple_new(struct tuple_format *format, const char *data,
+			  const char *end)
+{
+	struct memtx_ephemeral_arena *arena =
+		(struct memtx_ephemeral_arena *)format->engine;
+	assert(mp_typeof(*data) == MP_ARRAY);
+	size_t tuple_len = end - data;
+	size_t meta_size = tuple_format_meta_size(format);
+	size_t total = sizeof(struct tuple) + meta_size + tuple_len;
+
+	ERROR_INJECT(ERRINJ_TUPLE_ALLOC, {
+		diag_set(OutOfMemory, total, "region", "ephemeral tuple");
+		return NULL;
+	});
+	if (unlikely(total > arena->memtx->max_tuple_size)) {
+		diag_set(ClientError, ER_MEMTX_MAX_TUPLE_SIZE, total);
+		error_log(diag_last_error(diag_get()));
+		return NULL;
+	}
+	size_t size;
+	uint32_t size_class = memtx_ephemeral_size_class(total, &size);
+	struct tuple *tuple = arena->free_list[size_class];
+	if (tuple != NULL) {
+		arena->free_list[size_class] = *(void **)tuple;
+		arena->free_size -= size;
+	} else {
+		tuple = region_aligned_alloc(&arena->region, size,
+					     alignof(uint64_t));
+		if (tuple == NULL) {
+			diag_set(OutOfMemory, size, "region",
+				 "ephemeral tuple");
+			return NULL;
+		}
+	}
+	tuple->refs = 0;
+	assert(tuple_len <= UINT32_MAX); /* bsize is UINT32_MAX */
+	tuple->bsize = tuple_len;
+	/*
+	 * The format is not referenced: the tuple can't outlive
+	 * the space, which owns both the format and the arena.
+	 */
+	tuple->format_id = tuple_format_id(format);
+	tuple->data_offset = sizeof(struct tuple) + meta_size;
+	char *raw = (char *) tuple + tuple->data_offset;
+	uint32_t *field_map = (uint32_t *) raw;
+	memcpy(raw, data, tuple_len);
+	if (tuple_init_field_map(format, field_map, raw)) {
+		memtx_ephemeral_tuple_delete(format, tuple);
+		return NULL;
+	}
+	return tuple;
+}
+
+void
+memtx_ephemeral_tuple_delete(struct tuple_format *format,
+			     struct tuple *tuple)
+{
+	struct memtx_ephemeral_arena *arena =
+		(struct memtx_ephemeral_arena *)format->engine;
+	assert(tuple->refs == 0);
+	size_t size;
+	uint32_t size_class = memtx_ephemeral_size_class(tuple_size(tuple),
+							 &size);
+	*(void **)tuple = arena->free_list[size_class];
+	arena->free_list[size_class] = tuple;
+	arena->free_size += size;
+}
+
+struct tuple_format_vtab memtx_ephemeral_tuple_format_vtab = {
+	memtx_ephemeral_tuple_delete,
+	memtx_ephemeral_tuple_new,
+};
+
 /**
  * Allocate a block of size MEMTX_EXTENT_SIZE for memtx index
  */
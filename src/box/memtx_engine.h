@@ -207,6 +207,27 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple);
 /** Tuple format vtab for memtx engine. */
 extern struct tuple_format_vtab memtx_tuple_format_vtab;
 
+/**
+ * Allocate a tuple of an ephemeral space on the space arena,
+ * reusing a block of a deleted tuple if possible. The arena is
+ * stored in format->engine. @sa tuple_new().
+ */
+struct tuple *
+memtx_ephemeral_tuple_new(struct tuple_format *format, const char *data,
+			  const char *end);
+
+/**
+ * Put a tuple of an ephemeral space to the arena free list.
+ * The memory is returned only when the space is dropped.
+ * @sa tuple_delete().
+ */
+void
+memtx_ephemeral_tuple_delete(struct tuple_format *format,
+			     struct tuple *tuple);
+
+/** Tuple format vtab for memtx ephemeral spaces. */
+extern struct tuple_format_vtab memtx_ephemeral_tuple_format_vtab;
+
 enum {
 	MEMTX_EXTENT_SIZE = 16 * 1024,
 	MEMTX_SLAB_SIZE = 4 * 1024 * 1024
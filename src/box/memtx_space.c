@@ -46,6 +46,8 @@
 static void
 memtx_space_destroy(struct space *space)
 {
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	region_destroy(&memtx_space->ephemeral_arena.region);
 	free(space);
 }
 
@@ -53,6 +55,15 @@ static size_t
 memtx_space_bsize(struct space *space)
 {
 	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	/*
+	 * Tuples of an ephemeral space are not accounted one
+	 * by one, account the arena without free blocks.
+	 */
+	if (space->def->opts.is_ephemeral) {
+		struct memtx_ephemeral_arena *arena =
+			&memtx_space->ephemeral_arena;
+		return region_used(&arena->region) - arena->free_size;
+	}
 	return memtx_space->bsize;
 }
 
@@ -126,6 +137,8 @@ memtx_space_replace_build_next(struct space *space, struct tuple *old_tuple,
 	}
 	if (index_build_next(space->index[0], new_tuple) != 0)
 		return -1;
+	if (space_has_ndv(space))
+		index_ndv_add(space->index[0], NULL, new_tuple);
 	memtx_space_update_bsize(space, NULL, new_tuple);
 	tuple_ref(new_tuple);
 	return 0;
@@ -540,8 +553,8 @@ memtx_space_execute_upsert(struct space *space, struct txn *txn,
 }
 
 /**
- * This function simply creates new memtx tuple, refs it and calls space's
- * replace function. In constrast to original memtx_space_execute_replace(), it
+ * This function simply creates new tuple on the space arena, refs it and
+ * calls space's replace function. In constrast to original memtx_space_execute_replace(), it
  * doesn't handle any transaction routine.
  * Ephemeral spaces shouldn't be involved in transaction routine, since
  * they are used only for internal purposes. Moreover, ephemeral spaces
@@ -554,14 +567,14 @@ memtx_space_ephemeral_replace(struct space *space, const char *tuple,
 				      const char *tuple_end)
 {
 	struct memtx_space *memtx_space = (struct memtx_space *)space;
-	struct tuple *new_tuple = memtx_tuple_new(space->format, tuple,
-						  tuple_end);
+	struct tuple *new_tuple = memtx_ephemeral_tuple_new(space->format,
+							    tuple, tuple_end);
 	if (new_tuple == NULL)
 		return -1;
 	struct tuple *old_tuple;
 	if (memtx_space->replace(space, NULL, new_tuple,
 				 DUP_REPLACE_OR_INSERT, &old_tuple) != 0) {
-		memtx_tuple_delete(space->format, new_tuple);
+		memtx_ephemeral_tuple_delete(space->format, new_tuple);
 		return -1;
 	}
 	if (old_tuple != NULL)
@@ -740,11 +753,18 @@ memtx_space_create_index(struct space *space, struct index_def *index_def)
 		return sequence_data_index_new(memtx, index_def);
 	}
 
+	/* SQL creates ephemeral spaces with TREE indexes only. */
+	assert(!space->def->opts.is_ephemeral || index_def->type == TREE);
 	switch (index_def->type) {
 	case HASH:
 		return (struct index *)memtx_hash_index_new(memtx, index_def);
-	case TREE:
-		return (struct index *)memtx_tree_index_new(memtx, index_def);
+	case TREE: {
+		struct memtx_tree_index *index =
+			memtx_tree_index_new(memtx, index_def);
+		if (index != NULL)
+			index->is_ephemeral = space->def->opts.is_ephemeral;
+		return (struct index *)index;
+	}
 	case RTREE:
 		return (struct index *)memtx_rtree_index_new(memtx, index_def);
 	case BITSET:
@@ -900,6 +920,8 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 			break;
 		assert(old_tuple == NULL); /* Guaranteed by DUP_INSERT. */
 		(void) old_tuple;
+		if (space_has_ndv(src_space))
+			index_ndv_add(new_index, NULL, tuple);
 		/*
 		 * All tuples stored in a memtx space must be
 		 * referenced by the primary index.
@@ -939,6 +961,7 @@ static const struct space_vtab memtx_space_vtab = {
 	/* .execute_delete = */ memtx_space_execute_delete,
 	/* .execute_update = */ memtx_space_execute_update,
 	/* .execute_upsert = */ memtx_space_execute_upsert,
+	/* .execute_delete_range = */ generic_space_execute_delete_range,
 	/* .ephemeral_replace = */ memtx_space_ephemeral_replace,
 	/* .ephemeral_delete = */ memtx_space_ephemeral_delete,
 	/* .init_system_space = */ memtx_init_system_space,
@@ -979,14 +1002,26 @@ memtx_space_new(struct memtx_engine *memtx,
 	rlist_foreach_entry(index_def, key_list, link)
 		keys[key_count++] = index_def->key_def;
 
+	struct tuple_format_vtab *vtab = def->opts.is_ephemeral ?
+					 &memtx_ephemeral_tuple_format_vtab :
+					 &memtx_tuple_format_vtab;
 	struct tuple_format *format =
-		tuple_format_new(&memtx_tuple_format_vtab, keys, key_count, 0,
+		tuple_format_new(vtab, keys, key_count, 0,
 				 def->fields, def->field_count, def->dict);
 	if (format == NULL) {
 		free(memtx_space);
 		return NULL;
 	}
-	format->engine = memtx;
+	region_create(&memtx_space->ephemeral_arena.region,
+		      &memtx->slab_cache);
+	memset(memtx_space->ephemeral_arena.free_list, 0,
+	       sizeof(memtx_space->ephemeral_arena.free_list));
+	memtx_space->ephemeral_arena.free_size = 0;
+	memtx_space->ephemeral_arena.memtx = memtx;
+	if (def->opts.is_ephemeral)
+		format->engine = &memtx_space->ephemeral_arena;
+	else
+		format->engine = memtx;
 	format->is_temporary = def->opts.is_temporary;
 	format->exact_field_count = def->exact_field_count;
 	tuple_format_ref(format);
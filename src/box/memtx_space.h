@@ -31,6 +31,7 @@
  * SUCH DAMAGE.
  */
 #include "space.h"
+#include <small/region.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -38,6 +39,31 @@ extern "C" {
 
 struct memtx_engine;
 
+enum {
+	/** Number of size classes of an ephemeral space arena. */
+	MEMTX_EPHEMERAL_SIZE_CLASS_MAX = 4 * 32,
+};
+
+/**
+ * Arena for tuples of an ephemeral space. It is freed all at
+ * once when the space is dropped, instead of returning tuples
+ * to the memtx allocator one by one. Memory is taken from the
+ * memtx slab cache, so it is accounted in memtx_memory.
+ */
+struct memtx_ephemeral_arena {
+	/** Engine the arena takes memory from. */
+	struct memtx_engine *memtx;
+	/** Memory of the tuples. */
+	struct region region;
+	/**
+	 * Blocks of deleted tuples by size class, reused for
+	 * new tuples of the same class.
+	 */
+	void *free_list[MEMTX_EPHEMERAL_SIZE_CLASS_MAX];
+	/** Total size of blocks in the free lists. */
+	size_t free_size;
+};
+
 struct memtx_space {
 	struct space base;
 	/* Number of bytes used in memory by tuples in the space. */
@@ -48,6 +74,8 @@ struct memtx_space {
 	 */
 	int (*replace)(struct space *, struct tuple *, struct tuple *,
 		       enum dup_replace_mode, struct tuple **);
+	/** Arena for tuples of an ephemeral space. */
+	struct memtx_ephemeral_arena ephemeral_arena;
 };
 
 /**
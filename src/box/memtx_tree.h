@@ -99,6 +99,12 @@ struct memtx_tree_index {
 	size_t build_array_size, build_array_alloc_size;
 	struct memtx_gc_task gc_task;
 	struct memtx_tree_iterator gc_iterator;
+	/**
+	 * Set if the index belongs to an ephemeral space. Its
+	 * tuples are freed along with the space arena, so they
+	 * need not be unreferenced on destruction.
+	 */
+	bool is_ephemeral;
 };
 
 struct memtx_tree_index *
@@ -350,6 +350,22 @@ recover_current_wal:
 	region_free(&fiber()->gc);
 }
 
+void
+recovery_drop_log(struct recovery *r)
+{
+	if (xlog_cursor_is_open(&r->cursor)) {
+		xlog_cursor_close(&r->cursor, false);
+		trigger_run_xc(&r->on_close_log, NULL);
+	}
+	/*
+	 * Forget about the last scanned WAL so that the next
+	 * call to recover_remaining_wals() looks up the WAL to
+	 * continue from by the recovery vclock, as if it was
+	 * the first scan.
+	 */
+	r->cursor.state = XLOG_CURSOR_NEW;
+}
+
 void
 recovery_finalize(struct recovery *r)
 {
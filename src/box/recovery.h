@@ -83,6 +83,15 @@ recovery_follow_local(struct recovery *r, struct xstream *stream,
 void
 recovery_stop_local(struct recovery *r);
 
+/**
+ * Close the current WAL, if any, without reading it up to the
+ * end. Used when rows following the recovery vclock are fetched
+ * from elsewhere: the next call to recover_remaining_wals() will
+ * open the WAL containing the recovery vclock.
+ */
+void
+recovery_drop_log(struct recovery *r);
+
 void
 recovery_finalize(struct recovery *r);
 
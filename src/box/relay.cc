@@ -32,20 +32,34 @@
 
 #include "trivia/config.h"
 #include "trivia/util.h"
+#include "assoc.h"
+#include "box.h"
 #include "cbus.h"
 #include "cfg.h"
 #include "errinj.h"
 #include "fiber.h"
+#include "fio.h"
 #include "say.h"
+#include "scoped_guard.h"
+#include "small/ibuf.h"
+#include "small/obuf.h"
 
 #include "coio.h"
 #include "coio_task.h"
 #include "engine.h"
 #include "gc.h"
+#include "index.h"
 #include "iproto_constants.h"
+#include "latency.h"
 #include "recovery.h"
 #include "replication.h"
+#include "rmean.h"
+#include "schema.h"
+#include "sio.h"
+#include "space.h"
 #include "trigger.h"
+#include "tuple.h"
+#include "tuple_update.h"
 #include "vclock.h"
 #include "version.h"
 #include "xrow.h"
@@ -53,6 +67,9 @@
 #include "xstream.h"
 #include "wal.h"
 
+#include <fcntl.h>
+#include <zstd.h>
+
 /**
  * Cbus message to send status updates from relay to tx thread.
  */
@@ -63,6 +80,20 @@ struct relay_status_msg {
 	struct relay *relay;
 	/** Replica vclock. */
 	struct vclock vclock;
+	/** Bytes written to the socket, see relay::bytes_compressed. */
+	uint64_t bytes_compressed;
+	/** Bytes of rows sent, see relay::bytes_uncompressed. */
+	uint64_t bytes_uncompressed;
+	/** Rows sent, see relay::rows_sent. */
+	uint64_t rows_sent;
+	/** Bytes of row bodies sent, see relay::bytes_sent. */
+	uint64_t bytes_sent;
+	/**
+	 * Latency of rows sent since the previous status message,
+	 * see relay::send_latency. Merged to relay::tx::send_latency
+	 * and reset by the tx thread.
+	 */
+	struct latency send_latency;
 };
 
 /**
@@ -96,6 +127,13 @@ struct relay {
 	struct xstream stream;
 	/** Vclock to stop playing xlogs */
 	struct vclock stop_vclock;
+	/**
+	 * Position in the in-memory ring of recent WAL rows or
+	 * -1 if rows are read from WAL files, see wal_ring_read().
+	 */
+	int64_t wal_ring_pos;
+	/** Buffer for rows read from the WAL ring. */
+	struct ibuf wal_ring_buf;
 	/** Remote replica */
 	struct replica *replica;
 	/** WAL event watcher. */
@@ -131,15 +169,139 @@ struct relay {
 	double last_row_tm;
 	/** Relay sync state. */
 	enum relay_state state;
+	/**
+	 * Compression of the stream sent to the replica, as
+	 * negotiated on SUBSCRIBE, see enum iproto_compression.
+	 */
+	uint32_t compression;
+	/**
+	 * Streaming compression context or NULL if the stream
+	 * isn't compressed. Rows are compressed one by one into
+	 * zbuf, which is flushed to the socket at the end of each
+	 * batch of rows, see relay_flush().
+	 */
+	ZSTD_CStream *zstream;
+	/** Compressed data not written to the socket yet. */
+	struct ibuf zbuf;
+	/** Number of bytes of compressed data written to the socket. */
+	uint64_t bytes_compressed;
+	/** Number of bytes of rows passed to the compressor. */
+	uint64_t bytes_uncompressed;
+	/**
+	 * Rows not written to the socket yet if the stream isn't
+	 * compressed. Rows are copied here as they are read from
+	 * the WAL and written with one writev() at the end of each
+	 * batch of rows, see relay_flush().
+	 */
+	struct obuf wbuf;
+	/**
+	 * Set if rows are accumulated in relay::wbuf. Join relays
+	 * write rows to the socket one by one.
+	 */
+	bool is_buffered;
+	/**
+	 * Max time rows may be held in relay::wbuf or relay::zbuf
+	 * after the end of a batch so that rows of the following
+	 * batches are sent with the same write, as requested by
+	 * the peer on SUBSCRIBE. 0 means rows are written at the
+	 * end of each batch.
+	 */
+	double batch_delay;
+	/**
+	 * Time when the oldest row not written to the socket was
+	 * sent, or 0 if all rows have been written.
+	 */
+	double batch_start;
+	/** Number of WAL rows sent to the peer. */
+	uint64_t rows_sent;
+	/** Number of bytes of bodies of WAL rows sent to the peer. */
+	uint64_t bytes_sent;
+	/**
+	 * Time between a commit of a WAL row and its sending to
+	 * the peer, for rows sent since the last status message.
+	 * Swapped with relay::status_msg::send_latency on each
+	 * status message so that the relay thread doesn't touch
+	 * the histogram while the tx thread reads it.
+	 */
+	struct latency send_latency;
+	/**
+	 * Initial join stream sent by this relay and the number
+	 * of streams, see relay_initial_join().
+	 */
+	uint32_t join_stream_id;
+	uint32_t join_stream_count;
+	/** Number of rows of user spaces seen by initial join. */
+	uint64_t join_row_count;
+	/**
+	 * Sorted ids of user spaces the replica wants to receive
+	 * rows of, as requested on SUBSCRIBE, or NULL if it wants
+	 * all rows. Rows of other user spaces are sent as NOPs,
+	 * see relay_send_row().
+	 */
+	uint32_t *space_filter;
+	/** Number of entries in relay::space_filter. */
+	uint32_t space_filter_size;
+	/**
+	 * Garbage collector consumer of a relay streaming rows
+	 * to a CDC client, see relay_cdc(). Replica relays use
+	 * replica::gc instead.
+	 */
+	struct gc_consumer *gc;
+	/**
+	 * Copies of _space tuples by space id, maintained by a
+	 * CDC relay to attach space names to rows. Loaded from
+	 * the space cache on start and updated as _space rows
+	 * written after that are streamed. NULL for replica
+	 * relays.
+	 */
+	struct mh_i32ptr_t *space_defs;
+	/** Local vclock at the moment space_defs were loaded. */
+	struct vclock space_defs_vclock;
 
 	struct {
 		/* Align to prevent false-sharing with tx thread */
 		alignas(CACHELINE_SIZE)
 		/** Known relay vclock. */
 		struct vclock vclock;
+		/** Last reported relay::bytes_compressed. */
+		uint64_t bytes_compressed;
+		/** Last reported relay::bytes_uncompressed. */
+		uint64_t bytes_uncompressed;
+		/** Last reported relay::rows_sent. */
+		uint64_t rows_sent;
+		/** Last reported relay::bytes_sent. */
+		uint64_t bytes_sent;
+		/** Rate of rows sent, see enum replication_stat. */
+		struct rmean *rmean;
+		/** All relay::send_latency observations reported. */
+		struct latency send_latency;
 	} tx;
 };
 
+enum {
+	/** zstd compression level of the replication stream. */
+	RELAY_COMPRESSION_LEVEL = 3,
+	/**
+	 * Compressed data is written to the socket as soon as
+	 * this much of it accumulates, without waiting for the
+	 * end of the batch.
+	 */
+	RELAY_ZBUF_WRITE_SIZE = 128 * 1024,
+	/**
+	 * Rows are written to the socket as soon as this much
+	 * of them accumulates, without waiting for the end of
+	 * the batch.
+	 */
+	RELAY_WBUF_WRITE_SIZE = 128 * 1024,
+	/**
+	 * Number of consecutive rows of user spaces sent in
+	 * the same initial join stream.
+	 */
+	RELAY_JOIN_CHUNK_ROWS = 4096,
+	/** Size of a chunk of a checkpoint file sent on JOIN. */
+	RELAY_JOIN_FILE_CHUNK_SIZE = 1024 * 1024,
+};
+
 struct diag*
 relay_get_diag(struct relay *relay)
 {
@@ -158,9 +320,39 @@ relay_vclock(const struct relay *relay)
 	return &relay->tx.vclock;
 }
 
+uint32_t
+relay_compression(const struct relay *relay)
+{
+	return relay->compression;
+}
+
+void
+relay_bytes(const struct relay *relay, uint64_t *compressed,
+	    uint64_t *uncompressed)
+{
+	*compressed = relay->tx.bytes_compressed;
+	*uncompressed = relay->tx.bytes_uncompressed;
+}
+
+struct rmean *
+relay_rmean(struct relay *relay)
+{
+	return relay->tx.rmean;
+}
+
+struct latency *
+relay_send_latency(struct relay *relay)
+{
+	return &relay->tx.send_latency;
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet);
 static void
+relay_flush(struct relay *relay);
+static void
+relay_check_batch(struct relay *relay);
+static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
 static void
 relay_send_row(struct xstream *stream, struct xrow_header *row);
@@ -174,12 +366,33 @@ relay_new(struct replica *replica)
 			  "struct relay");
 		return NULL;
 	}
+	relay->tx.rmean = rmean_new(replication_stat_strs,
+				    REPLICATION_STAT_LAST);
+	if (relay->tx.rmean == NULL)
+		goto fail_rmean;
+	if (latency_create(&relay->tx.send_latency) != 0)
+		goto fail_tx_latency;
+	if (latency_create(&relay->status_msg.send_latency) != 0)
+		goto fail_msg_latency;
+	if (latency_create(&relay->send_latency) != 0)
+		goto fail_latency;
 	relay->replica = replica;
 	fiber_cond_create(&relay->reader_cond);
 	diag_create(&relay->diag);
 	stailq_create(&relay->pending_gc);
 	relay->state = RELAY_OFF;
 	return relay;
+
+fail_latency:
+	latency_destroy(&relay->status_msg.send_latency);
+fail_msg_latency:
+	latency_destroy(&relay->tx.send_latency);
+fail_tx_latency:
+	rmean_delete(relay->tx.rmean);
+fail_rmean:
+	diag_set(OutOfMemory, 0, "malloc", "relay stat");
+	free(relay);
+	return NULL;
 }
 
 static void
@@ -209,6 +422,16 @@ relay_cancel(struct relay *relay)
 	}
 }
 
+/** Free _space tuples cached by a CDC relay. */
+static void
+relay_space_defs_delete(struct mh_i32ptr_t *space_defs)
+{
+	mh_int_t i;
+	mh_foreach(space_defs, i)
+		free(mh_i32ptr_node(space_defs, i)->val);
+	mh_i32ptr_delete(space_defs);
+}
+
 static void
 relay_stop(struct relay *relay)
 {
@@ -221,6 +444,15 @@ relay_stop(struct relay *relay)
 	if (relay->r != NULL)
 		recovery_delete(relay->r);
 	relay->r = NULL;
+	if (relay->zstream != NULL)
+		ZSTD_freeCStream(relay->zstream);
+	relay->zstream = NULL;
+	free(relay->space_filter);
+	relay->space_filter = NULL;
+	relay->space_filter_size = 0;
+	if (relay->space_defs != NULL)
+		relay_space_defs_delete(relay->space_defs);
+	relay->space_defs = NULL;
 	relay->state = RELAY_STOPPED;
 	/*
 	 * Needed to track whether relay thread is running or not
@@ -237,6 +469,10 @@ relay_delete(struct relay *relay)
 		relay_stop(relay);
 	fiber_cond_destroy(&relay->reader_cond);
 	diag_destroy(&relay->diag);
+	latency_destroy(&relay->send_latency);
+	latency_destroy(&relay->status_msg.send_latency);
+	latency_destroy(&relay->tx.send_latency);
+	rmean_delete(relay->tx.rmean);
 	TRASH(relay);
 	free(relay);
 }
@@ -257,17 +493,163 @@ relay_set_cord_name(int fd)
 }
 
 void
-relay_initial_join(int fd, uint64_t sync, struct vclock *vclock)
+relay_initial_join(int fd, uint64_t sync, struct vclock *vclock,
+		   uint32_t stream_id, uint32_t stream_count)
 {
+	assert(stream_id < stream_count);
 	struct relay *relay = relay_new(NULL);
 	if (relay == NULL)
 		diag_raise();
 	relay_start(relay, fd, sync, relay_send_initial_join_row);
+	relay->join_stream_id = stream_id;
+	relay->join_stream_count = stream_count;
 	engine_join_xc(vclock, &relay->stream);
 	relay_stop(relay);
 	relay_delete(relay);
 }
 
+/** A checkpoint file to send on JOIN. */
+struct relay_join_file {
+	/** Link in relay_join_files::list. */
+	struct stailq_entry in_list;
+	/** Name relative to the engine directory. */
+	const char *name;
+	/** Path to the file. */
+	char path[0];
+};
+
+/** Checkpoint files to send on JOIN. */
+struct relay_join_files {
+	/** List of relay_join_file objects, in backup order. */
+	struct stailq list;
+	/** The relay sending the files. */
+	struct relay *relay;
+};
+
+/** Callback passed to engine_backup() to collect files to send. */
+static int
+relay_join_files_add(const char *path, void *arg)
+{
+	struct relay_join_files *files = (struct relay_join_files *)arg;
+	/*
+	 * Snapshots live in memtx_dir, everything else
+	 * belongs to vinyl. The replica relies on this to
+	 * choose the directory to put a file to.
+	 */
+	const char *dir = cfg_gets("vinyl_dir");
+	size_t path_len = strlen(path);
+	if (path_len > strlen(".snap") &&
+	    strcmp(path + path_len - strlen(".snap"), ".snap") == 0)
+		dir = cfg_gets("memtx_dir");
+	size_t dir_len = strlen(dir);
+	if (path_len <= dir_len + 1 || strncmp(path, dir, dir_len) != 0 ||
+	    path[dir_len] != '/') {
+		diag_set(ClientError, ER_UNSUPPORTED, "Replication",
+			 tt_sprintf("sending file %s", path));
+		return -1;
+	}
+	size_t size = sizeof(struct relay_join_file) + path_len + 1;
+	struct relay_join_file *file = (struct relay_join_file *)malloc(size);
+	if (file == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "struct relay_join_file");
+		return -1;
+	}
+	memcpy(file->path, path, path_len + 1);
+	file->name = file->path + dir_len + 1;
+	stailq_add_tail_entry(&files->list, file, in_list);
+	return 0;
+}
+
+/** Send a checkpoint file in chunks. */
+static int
+relay_send_join_file(struct relay *relay, struct relay_join_file *file,
+		     char *buf)
+{
+	int fd = open(file->path, O_RDONLY);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open '%s' file", file->path);
+		return -1;
+	}
+	int rc = 0;
+	struct xrow_header row;
+	do {
+		ssize_t size = fio_read(fd, buf, RELAY_JOIN_FILE_CHUNK_SIZE);
+		if (size < 0) {
+			diag_set(SystemError, "failed to read '%s' file",
+				 file->path);
+			rc = -1;
+			break;
+		}
+		if (xrow_encode_join_file(&row, file->name, buf, size) != 0) {
+			rc = -1;
+			break;
+		}
+		try {
+			relay_send(relay, &row);
+		} catch (Exception *) {
+			rc = -1;
+			break;
+		}
+		/* Empty files are sent as one empty chunk. */
+		if (size < RELAY_JOIN_FILE_CHUNK_SIZE)
+			break;
+	} while (true);
+	close(fd);
+	return rc;
+}
+
+/**
+ * Invoked from a thread to feed checkpoint files, so as not
+ * to block tx on disk reads.
+ */
+static int
+relay_initial_join_files_f(va_list ap)
+{
+	struct relay_join_files *files = va_arg(ap, struct relay_join_files *);
+	char *buf = (char *)malloc(RELAY_JOIN_FILE_CHUNK_SIZE);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, RELAY_JOIN_FILE_CHUNK_SIZE,
+			 "malloc", "buf");
+		return -1;
+	}
+	int rc = 0;
+	struct relay_join_file *file;
+	stailq_foreach_entry(file, &files->list, in_list) {
+		rc = relay_send_join_file(files->relay, file, buf);
+		if (rc != 0)
+			break;
+		say_info("sent checkpoint file %s", file->path);
+	}
+	free(buf);
+	return rc;
+}
+
+void
+relay_initial_join_files(int fd, uint64_t sync, struct vclock *vclock)
+{
+	struct relay *relay = relay_new(NULL);
+	if (relay == NULL)
+		diag_raise();
+	relay_start(relay, fd, sync, relay_send_initial_join_row);
+	struct relay_join_files files;
+	stailq_create(&files.list);
+	files.relay = relay;
+	auto guard = make_scoped_guard([&]{
+		struct relay_join_file *file, *next;
+		stailq_foreach_entry_safe(file, next, &files.list, in_list)
+			free(file);
+		relay_stop(relay);
+		relay_delete(relay);
+	});
+	if (engine_backup(vclock, relay_join_files_add, &files) != 0)
+		diag_raise();
+
+	struct cord cord;
+	if (cord_costart(&cord, "initial_join", relay_initial_join_files_f,
+			 &files) != 0 || cord_cojoin(&cord) != 0)
+		diag_raise();
+}
+
 int
 relay_final_join_f(va_list ap)
 {
@@ -330,7 +712,18 @@ static void
 tx_status_update(struct cmsg *msg)
 {
 	struct relay_status_msg *status = (struct relay_status_msg *)msg;
-	vclock_copy(&status->relay->tx.vclock, &status->vclock);
+	struct relay *relay = status->relay;
+	vclock_copy(&relay->tx.vclock, &status->vclock);
+	relay->tx.bytes_compressed = status->bytes_compressed;
+	relay->tx.bytes_uncompressed = status->bytes_uncompressed;
+	rmean_collect(relay->tx.rmean, REPLICATION_STAT_ROWS,
+		      status->rows_sent - relay->tx.rows_sent);
+	rmean_collect(relay->tx.rmean, REPLICATION_STAT_BYTES,
+		      status->bytes_sent - relay->tx.bytes_sent);
+	relay->tx.rows_sent = status->rows_sent;
+	relay->tx.bytes_sent = status->bytes_sent;
+	latency_merge(&relay->tx.send_latency, &status->send_latency);
+	latency_reset(&status->send_latency);
 	static const struct cmsg_hop route[] = {
 		{relay_status_update, NULL}
 	};
@@ -345,17 +738,24 @@ static void
 tx_gc_advance(struct cmsg *msg)
 {
 	struct relay_gc_msg *m = (struct relay_gc_msg *)msg;
-	gc_consumer_advance(m->relay->replica->gc, &m->vclock);
+	struct relay *relay = m->relay;
+	/* CDC relays aren't attached to a replica. */
+	gc_consumer_advance(relay->replica != NULL ? relay->replica->gc :
+			    relay->gc, &m->vclock);
 	free(m);
 }
 
+/**
+ * Schedule garbage collection of WAL files preceding the
+ * relay vclock once the replica confirms it has received
+ * all rows up to it.
+ */
 static void
-relay_on_close_log_f(struct trigger *trigger, void * /* event */)
+relay_add_pending_gc(struct relay *relay)
 {
 	static const struct cmsg_hop route[] = {
 		{tx_gc_advance, NULL}
 	};
-	struct relay *relay = (struct relay *)trigger->data;
 	struct relay_gc_msg *m = (struct relay_gc_msg *)malloc(sizeof(*m));
 	if (m == NULL) {
 		say_warn("failed to allocate relay gc message");
@@ -372,6 +772,13 @@ relay_on_close_log_f(struct trigger *trigger, void * /* event */)
 	stailq_add_tail_entry(&relay->pending_gc, m, in_pending);
 }
 
+static void
+relay_on_close_log_f(struct trigger *trigger, void * /* event */)
+{
+	struct relay *relay = (struct relay *)trigger->data;
+	relay_add_pending_gc(relay);
+}
+
 /**
  * Invoke pending garbage collection requests.
  *
@@ -395,6 +802,63 @@ relay_schedule_pending_gc(struct relay *relay, const struct vclock *vclock)
 		cpipe_push(&relay->tx_pipe, &gc_msg->msg);
 }
 
+/**
+ * Send rows following the relay vclock from the in-memory ring
+ * of recent WAL rows. Returns false if the rows aren't in the
+ * ring, in which case they must be read from WAL files.
+ */
+static bool
+relay_send_from_wal_ring(struct relay *relay, unsigned events)
+{
+	struct recovery *r = relay->r;
+	struct ibuf *buf = &relay->wal_ring_buf;
+	bool is_positioned = relay->wal_ring_pos >= 0;
+	while (true) {
+		ibuf_reset(buf);
+		ssize_t size = wal_ring_read(&relay->wal_ring_pos,
+					     &r->vclock, buf);
+		if (size < 0) {
+			relay->wal_ring_pos = -1;
+			return false;
+		}
+		if (!is_positioned) {
+			/*
+			 * Switching from WAL files to the ring.
+			 * Close the current WAL so that we start
+			 * from the right file if we have to fall
+			 * back on reading files.
+			 */
+			recovery_drop_log(r);
+			is_positioned = true;
+		}
+		if (size == 0)
+			break;
+		const char *data = buf->rpos;
+		const char *data_end = data + size;
+		while (data < data_end) {
+			struct wal_ring_row hdr;
+			memcpy(&hdr, data, sizeof(hdr));
+			data += sizeof(hdr);
+			const char *row_end = data + hdr.size;
+			if (hdr.lsn <= vclock_get(&r->vclock, hdr.replica_id)) {
+				data = row_end;
+				continue; /* already sent, skip */
+			}
+			struct xrow_header row;
+			xrow_header_decode_xc(&row, &data, row_end);
+			vclock_follow(&r->vclock, row.replica_id, row.lsn);
+			xstream_write_xc(&relay->stream, &row);
+		}
+	}
+	/*
+	 * WAL files are not closed while we are reading from
+	 * memory, so collect them on rotation.
+	 */
+	if ((events & WAL_EVENT_ROTATE) != 0)
+		relay_add_pending_gc(relay);
+	return true;
+}
+
 static void
 relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 {
@@ -407,8 +871,20 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
-		recover_remaining_wals(relay->r, &relay->stream, NULL,
-				       (events & WAL_EVENT_ROTATE) != 0);
+		/*
+		 * Rows we need may still be in memory. If they
+		 * aren't, fall back on reading WAL files. Rescan
+		 * the WAL directory in this case, because it
+		 * could have been rotated while we were reading
+		 * from memory.
+		 */
+		bool scan_dir = (events & WAL_EVENT_ROTATE) != 0 ||
+				relay->wal_ring_pos >= 0;
+		if (!relay_send_from_wal_ring(relay, events)) {
+			recover_remaining_wals(relay->r, &relay->stream,
+					       NULL, scan_dir);
+		}
+		relay_check_batch(relay);
 	} catch (Exception *e) {
 		e->log();
 		diag_move(diag_get(), &relay->diag);
@@ -467,6 +943,7 @@ relay_send_heartbeat(struct relay *relay)
 	xrow_encode_timestamp(&row, instance_id, ev_now(loop()));
 	try {
 		relay_send(relay, &row);
+		relay_flush(relay);
 	} catch (Exception *e) {
 		e->log();
 	}
@@ -493,6 +970,12 @@ relay_subscribe_f(va_list ap)
 		RLIST_LINK_INITIALIZER, relay_on_close_log_f, relay, NULL
 	};
 	trigger_add(&r->on_close_log, &on_close_log);
+	relay->wal_ring_pos = -1;
+	ibuf_create(&relay->wal_ring_buf, &cord()->slabc, 16 * 1024);
+	ibuf_create(&relay->zbuf, &cord()->slabc, 16 * 1024);
+	obuf_create(&relay->wbuf, &cord()->slabc, 16 * 1024);
+	relay->is_buffered = true;
+	relay->batch_start = 0;
 	wal_set_watcher(&relay->wal_watcher, cord_name(cord()),
 			relay_process_wal_event, cbus_process);
 
@@ -519,8 +1002,12 @@ relay_subscribe_f(va_list ap)
 		if (inj != NULL && inj->dparam != 0)
 			timeout = inj->dparam;
 
-		fiber_cond_wait_deadline(&relay->reader_cond,
-					 relay->last_row_tm + timeout);
+		double deadline = relay->last_row_tm + timeout;
+		if (relay->batch_start > 0) {
+			deadline = MIN(deadline, relay->batch_start +
+					relay->batch_delay);
+		}
+		fiber_cond_wait_deadline(&relay->reader_cond, deadline);
 
 		/*
 		 * The fiber can be woken by IO cancel, by a timeout of
@@ -528,6 +1015,15 @@ relay_subscribe_f(va_list ap)
 		 * Handle cbus messages first.
 		 */
 		cbus_process(&relay->endpoint);
+		/* Write out rows held for longer than the batch delay. */
+		try {
+			relay_check_batch(relay);
+		} catch (Exception *e) {
+			e->log();
+			diag_move(diag_get(), &relay->diag);
+			fiber_cancel(fiber());
+			continue;
+		}
 		/* Check for a heartbeat timeout. */
 		if (ev_monotonic_now(loop()) - relay->last_row_tm > timeout)
 			relay_send_heartbeat(relay);
@@ -550,6 +1046,13 @@ relay_subscribe_f(va_list ap)
 		};
 		cmsg_init(&relay->status_msg.msg, route);
 		vclock_copy(&relay->status_msg.vclock, send_vclock);
+		relay->status_msg.bytes_compressed = relay->bytes_compressed;
+		relay->status_msg.bytes_uncompressed =
+			relay->bytes_uncompressed;
+		relay->status_msg.rows_sent = relay->rows_sent;
+		relay->status_msg.bytes_sent = relay->bytes_sent;
+		SWAP(relay->status_msg.send_latency.histogram,
+		     relay->send_latency.histogram);
 		relay->status_msg.relay = relay;
 		cpipe_push(&relay->tx_pipe, &relay->status_msg.msg);
 		/* Collect xlog files received by the replica. */
@@ -559,6 +1062,10 @@ relay_subscribe_f(va_list ap)
 	say_crit("exiting the relay loop");
 	trigger_clear(&on_close_log);
 	wal_clear_watcher(&relay->wal_watcher, cbus_process);
+	ibuf_destroy(&relay->wal_ring_buf);
+	ibuf_destroy(&relay->zbuf);
+	relay->is_buffered = false;
+	obuf_destroy(&relay->wbuf);
 	if (!fiber_is_dead(reader))
 		fiber_cancel(reader);
 	fiber_join(reader);
@@ -578,10 +1085,58 @@ relay_subscribe_f(va_list ap)
 	return diag_is_empty(diag_get()) ? 0: -1;
 }
 
+/**
+ * Decode the space filter sent by the replica on SUBSCRIBE
+ * and store it in the relay sorted so that it can be looked
+ * up with bsearch().
+ */
+static void
+relay_set_space_filter(struct relay *relay, const char *data)
+{
+	assert(relay->space_filter == NULL);
+	if (data == NULL)
+		return;
+	uint32_t size = mp_decode_array(&data);
+	/* An empty filter lets no user space through. */
+	size_t alloc_size = sizeof(*relay->space_filter) * MAX(size, 1);
+	uint32_t *filter = (uint32_t *) malloc(alloc_size);
+	if (filter == NULL) {
+		tnt_raise(OutOfMemory, alloc_size, "malloc",
+			  "relay->space_filter");
+	}
+	for (uint32_t i = 0; i < size; i++)
+		filter[i] = mp_decode_uint(&data);
+	qsort(filter, size, sizeof(*filter), box_space_id_cmp);
+	relay->space_filter = filter;
+	relay->space_filter_size = size;
+}
+
+/**
+ * Return true if a row must be sent to the replica as is,
+ * false if it modifies a user space filtered out by the
+ * replica. Rows of system spaces are always sent, because
+ * the replica needs the same schema as the master.
+ */
+static bool
+relay_space_filter_has_row(struct relay *relay, struct xrow_header *row)
+{
+	if (relay->space_filter == NULL)
+		return true;
+	uint32_t space_id;
+	if (xrow_decode_space_id(row, &space_id) != 0 ||
+	    space_id <= BOX_SYSTEM_ID_MAX)
+		return true;
+	return bsearch(&space_id, relay->space_filter,
+		       relay->space_filter_size, sizeof(space_id),
+		       box_space_id_cmp) != NULL;
+}
+
 /** Replication acceptor fiber handler. */
 void
 relay_subscribe(struct replica *replica, int fd, uint64_t sync,
-		struct vclock *replica_clock, uint32_t replica_version_id)
+		struct vclock *replica_clock, uint32_t replica_version_id,
+		uint32_t compression, const char *space_filter,
+		double batch_delay)
 {
 	assert(replica->id != REPLICA_ID_NIL);
 	struct relay *relay = replica->relay;
@@ -603,6 +1158,37 @@ relay_subscribe(struct replica *replica, int fd, uint64_t sync,
 			diag_raise();
 	}
 
+	relay_set_space_filter(relay, space_filter);
+	auto filter_guard = make_scoped_guard([=] {
+		free(relay->space_filter);
+		relay->space_filter = NULL;
+		relay->space_filter_size = 0;
+	});
+
+	assert(relay->zstream == NULL);
+	if (compression == IPROTO_COMPRESSION_ZSTD) {
+		relay->zstream = ZSTD_createCStream();
+		if (relay->zstream == NULL) {
+			tnt_raise(OutOfMemory, 0, "ZSTD_createCStream",
+				  "relay->zstream");
+		}
+		size_t rc = ZSTD_initCStream(relay->zstream,
+					     RELAY_COMPRESSION_LEVEL);
+		if (ZSTD_isError(rc)) {
+			ZSTD_freeCStream(relay->zstream);
+			relay->zstream = NULL;
+			tnt_raise(ClientError, ER_COMPRESSION,
+				  ZSTD_getErrorName(rc));
+		}
+	}
+	relay->compression = compression;
+	relay->batch_delay = batch_delay;
+	filter_guard.is_active = false;
+	relay->bytes_compressed = relay->bytes_uncompressed = 0;
+	relay->tx.bytes_compressed = relay->tx.bytes_uncompressed = 0;
+	relay->rows_sent = relay->bytes_sent = 0;
+	relay->tx.rows_sent = relay->tx.bytes_sent = 0;
+
 	relay_start(relay, fd, sync, relay_send_row);
 	vclock_copy(&relay->local_vclock_at_subscribe, &replicaset.vclock);
 	relay->r = recovery_new(cfg_gets("wal_dir"),
@@ -623,17 +1209,168 @@ relay_subscribe(struct replica *replica, int fd, uint64_t sync,
 		diag_raise();
 }
 
+/** Write compressed data accumulated in relay::zbuf to the socket. */
+static void
+relay_write_zbuf(struct relay *relay)
+{
+	struct ibuf *out = &relay->zbuf;
+	size_t size = ibuf_used(out);
+	if (size == 0)
+		return;
+	coio_write(&relay->io, out->rpos, size);
+	relay->bytes_compressed += size;
+	ibuf_reset(out);
+}
+
+/**
+ * Feed a row to the compression stream. The output is buffered
+ * in relay::zbuf until relay_flush() is called or the buffer
+ * grows big enough.
+ */
+static void
+relay_compress_xrow(struct relay *relay, struct xrow_header *packet)
+{
+	struct ibuf *out = &relay->zbuf;
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_to_iovec_xc(packet, iov);
+	for (int i = 0; i < iovcnt; i++) {
+		ZSTD_inBuffer in = {iov[i].iov_base, iov[i].iov_len, 0};
+		while (in.pos < in.size) {
+			ibuf_reserve_xc(out, ZSTD_CStreamOutSize());
+			ZSTD_outBuffer dst = {out->wpos, ibuf_unused(out), 0};
+			size_t rc = ZSTD_compressStream(relay->zstream,
+							&dst, &in);
+			if (ZSTD_isError(rc)) {
+				tnt_raise(ClientError, ER_COMPRESSION,
+					  ZSTD_getErrorName(rc));
+			}
+			out->wpos += dst.pos;
+		}
+		relay->bytes_uncompressed += iov[i].iov_len;
+	}
+	if (ibuf_used(out) >= RELAY_ZBUF_WRITE_SIZE)
+		relay_write_zbuf(relay);
+}
+
+/** Write rows accumulated in relay::wbuf to the socket. */
+static void
+relay_write_wbuf(struct relay *relay)
+{
+	struct obuf *out = &relay->wbuf;
+	size_t size = obuf_size(out);
+	if (size == 0)
+		return;
+	coio_writev(&relay->io, out->iov, out->pos + 1, size);
+	obuf_reset(out);
+}
+
+/**
+ * Append a row to relay::wbuf. The row is written to the socket
+ * when relay_flush() is called or the buffer grows big enough.
+ */
+static void
+relay_buffer_xrow(struct relay *relay, struct xrow_header *packet)
+{
+	struct obuf *out = &relay->wbuf;
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_to_iovec_xc(packet, iov);
+	for (int i = 0; i < iovcnt; i++) {
+		if (obuf_dup(out, iov[i].iov_base, iov[i].iov_len) !=
+		    iov[i].iov_len) {
+			tnt_raise(OutOfMemory, iov[i].iov_len,
+				  "obuf_dup", "relay->wbuf");
+		}
+	}
+	if (obuf_size(out) >= RELAY_WBUF_WRITE_SIZE)
+		relay_write_wbuf(relay);
+}
+
+/**
+ * Write all rows sent so far to the socket. If the stream is
+ * compressed, make them decodable by the replica first. Called
+ * at the end of a batch of rows so that the compressor sees as
+ * much data as possible while the replica doesn't have to wait
+ * for the next batch, see relay_check_batch().
+ */
+static void
+relay_flush(struct relay *relay)
+{
+	relay->batch_start = 0;
+	if (relay->zstream == NULL) {
+		relay_write_wbuf(relay);
+		return;
+	}
+	struct ibuf *out = &relay->zbuf;
+	size_t rc;
+	do {
+		ibuf_reserve_xc(out, ZSTD_CStreamOutSize());
+		ZSTD_outBuffer dst = {out->wpos, ibuf_unused(out), 0};
+		rc = ZSTD_flushStream(relay->zstream, &dst);
+		if (ZSTD_isError(rc)) {
+			tnt_raise(ClientError, ER_COMPRESSION,
+				  ZSTD_getErrorName(rc));
+		}
+		out->wpos += dst.pos;
+	} while (rc != 0);
+	relay_write_zbuf(relay);
+}
+
+/**
+ * Called at the end of each batch of rows and on wakeups of the
+ * relay loop. Write out rows sent so far unless the peer allowed
+ * to hold them for longer, so that the rows of the next batches
+ * are sent with the same write. This saves syscalls when rows
+ * are committed at a high rate in small transactions.
+ */
+static void
+relay_check_batch(struct relay *relay)
+{
+	if (relay->batch_start > 0 &&
+	    ev_monotonic_now(loop()) - relay->batch_start >=
+	    relay->batch_delay)
+		relay_flush(relay);
+}
+
 static void
 relay_send(struct relay *relay, struct xrow_header *packet)
 {
 	packet->sync = relay->sync;
 	relay->last_row_tm = ev_monotonic_now(loop());
-	coio_write_xrow(&relay->io, packet);
+	if (relay->batch_start == 0)
+		relay->batch_start = relay->last_row_tm;
+	if (relay->zstream != NULL)
+		relay_compress_xrow(relay, packet);
+	else if (relay->is_buffered)
+		relay_buffer_xrow(relay, packet);
+	else
+		coio_write_xrow(&relay->io, packet);
 	fiber_gc();
 
 	struct errinj *inj = errinj(ERRINJ_RELAY_TIMEOUT, ERRINJ_DOUBLE);
-	if (inj != NULL && inj->dparam > 0)
+	if (inj != NULL && inj->dparam > 0) {
+		/* Let the peer see the row before sleeping. */
+		if (relay->is_buffered)
+			relay_flush(relay);
 		fiber_sleep(inj->dparam);
+	}
+}
+
+/**
+ * Return true if an initial join row belongs to the stream
+ * sent by the relay. All streams see the same rows in the same
+ * order, because they are read from the same checkpoint.
+ */
+static bool
+relay_join_stream_has_row(struct relay *relay, struct xrow_header *row)
+{
+	if (relay->join_stream_count <= 1)
+		return true;
+	uint32_t space_id;
+	if (xrow_decode_space_id(row, &space_id) != 0 ||
+	    space_id <= BOX_SYSTEM_ID_MAX)
+		return relay->join_stream_id == 0;
+	uint64_t chunk = relay->join_row_count++ / RELAY_JOIN_CHUNK_ROWS;
+	return chunk % relay->join_stream_count == relay->join_stream_id;
 }
 
 static void
@@ -644,16 +1381,18 @@ relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 	 * Ignore replica local requests as we don't need to promote
 	 * vclock while sending a snapshot.
 	 */
-	if (row->group_id != GROUP_LOCAL)
+	if (row->group_id != GROUP_LOCAL &&
+	    relay_join_stream_has_row(relay, row))
 		relay_send(relay, row);
 }
 
-/** Send a single row to the client. */
+/**
+ * Transform rows the peer doesn't need to IPROTO_NOP so as to
+ * promote its vclock without sending the row bodies.
+ */
 static void
-relay_send_row(struct xstream *stream, struct xrow_header *packet)
+relay_filter_row(struct relay *relay, struct xrow_header *packet)
 {
-	struct relay *relay = container_of(stream, struct relay, stream);
-	assert(iproto_type_is_dml(packet->type));
 	/*
 	 * Transform replica local requests to IPROTO_NOP so as to
 	 * promote vclock on the replica without actually modifying
@@ -664,6 +1403,38 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 		packet->group_id = GROUP_DEFAULT;
 		packet->bodycnt = 0;
 	}
+	/*
+	 * Do the same to rows of user spaces the replica isn't
+	 * interested in: it still needs to advance its vclock
+	 * past them, but doesn't need their bodies.
+	 */
+	if (packet->type != IPROTO_NOP &&
+	    !relay_space_filter_has_row(relay, packet)) {
+		packet->type = IPROTO_NOP;
+		packet->bodycnt = 0;
+	}
+}
+
+/** Account a WAL row sent to the peer in relay statistics. */
+static void
+relay_collect_row_stat(struct relay *relay, struct xrow_header *packet)
+{
+	relay->rows_sent++;
+	for (int i = 0; i < packet->bodycnt; i++)
+		relay->bytes_sent += packet->body[i].iov_len;
+	if (packet->tm > 0) {
+		latency_collect(&relay->send_latency,
+				ev_now(loop()) - packet->tm);
+	}
+}
+
+/** Send a single row to the client. */
+static void
+relay_send_row(struct xstream *stream, struct xrow_header *packet)
+{
+	struct relay *relay = container_of(stream, struct relay, stream);
+	assert(iproto_type_is_dml(packet->type));
+	relay_filter_row(relay, packet);
 	/*
 	 * We're feeding a WAL, thus responding to SUBSCRIBE request.
 	 * In that case, only send a row if it is not from the same replica
@@ -676,6 +1447,242 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 	if (packet->replica_id != relay->replica->id ||
 	    packet->lsn <= vclock_get(&relay->local_vclock_at_subscribe,
 				      packet->replica_id)) {
+		relay_collect_row_stat(relay, packet);
 		relay_send(relay, packet);
 	}
 }
+
+/**
+ * Remember a copy of a _space tuple in a CDC relay, replacing
+ * the old tuple of the same space if any.
+ */
+static void
+relay_space_defs_put(struct relay *relay, const char *data,
+		     const char *data_end)
+{
+	const char *field = data;
+	if (mp_typeof(*field) != MP_ARRAY ||
+	    mp_decode_array(&field) <= BOX_SPACE_FIELD_NAME ||
+	    mp_typeof(*field) != MP_UINT)
+		return;
+	uint32_t id = mp_decode_uint(&field);
+	size_t size = data_end - data;
+	char *copy = (char *) malloc(size);
+	if (copy == NULL)
+		tnt_raise(OutOfMemory, size, "malloc", "space def");
+	memcpy(copy, data, size);
+	const struct mh_i32ptr_node_t node = { id, copy };
+	struct mh_i32ptr_node_t old, *p_old = &old;
+	mh_int_t k = mh_i32ptr_put(relay->space_defs, &node, &p_old, NULL);
+	if (k == mh_end(relay->space_defs)) {
+		free(copy);
+		tnt_raise(OutOfMemory, sizeof(node), "mh_i32ptr_put",
+			  "space def");
+	}
+	if (p_old != NULL)
+		free(p_old->val);
+}
+
+/**
+ * Look up a _space tuple cached by a CDC relay.
+ * Returns NULL if the space is unknown.
+ */
+static const char *
+relay_space_def(struct relay *relay, uint32_t id, const char **data_end)
+{
+	mh_int_t k = mh_i32ptr_find(relay->space_defs, id, NULL);
+	if (k == mh_end(relay->space_defs))
+		return NULL;
+	const char *data = (const char *)
+		mh_i32ptr_node(relay->space_defs, k)->val;
+	*data_end = data;
+	mp_next(data_end);
+	return data;
+}
+
+/**
+ * Load _space tuples to a CDC relay from the space cache.
+ *
+ * The stream may start from a vclock older than the cache,
+ * and we don't restore _space as of that vclock, so rows
+ * written before the load get the names spaces have now.
+ */
+static void
+relay_space_defs_load(struct relay *relay)
+{
+	assert(relay->space_defs == NULL);
+	vclock_copy(&relay->space_defs_vclock, &replicaset.vclock);
+	relay->space_defs = mh_i32ptr_new();
+	if (relay->space_defs == NULL) {
+		tnt_raise(OutOfMemory, sizeof(*relay->space_defs),
+			  "mh_i32ptr_new", "space defs");
+	}
+	struct space *space = space_cache_find_xc(BOX_SPACE_ID);
+	struct index *index = index_find_system_xc(space, 0);
+	struct iterator *it = index_create_iterator_xc(index, ITER_ALL,
+						       NULL, 0);
+	IteratorGuard iter_guard(it);
+	struct tuple *tuple;
+	while ((tuple = iterator_next_xc(it)) != NULL) {
+		uint32_t size;
+		const char *data = tuple_data_range(tuple, &size);
+		relay_space_defs_put(relay, data, data + size);
+	}
+}
+
+/**
+ * Apply a _space row streamed by a CDC relay to its cache of
+ * _space tuples so that rows following it get the new name.
+ * Rows written before the cache was loaded are already
+ * reflected in it and are ignored.
+ */
+static void
+relay_space_defs_follow(struct relay *relay, struct xrow_header *row)
+{
+	if (row->lsn <= vclock_get(&relay->space_defs_vclock,
+				   row->replica_id))
+		return;
+	struct request request;
+	xrow_decode_dml_xc(row, &request, dml_request_key_map(row->type));
+	if (request.type == IPROTO_INSERT || request.type == IPROTO_REPLACE) {
+		relay_space_defs_put(relay, request.tuple, request.tuple_end);
+		return;
+	}
+	const char *key = request.key;
+	if (request.type == IPROTO_UPSERT)
+		key = request.tuple;
+	if (key == NULL || mp_typeof(*key) != MP_ARRAY ||
+	    mp_decode_array(&key) == 0 || mp_typeof(*key) != MP_UINT)
+		return;
+	uint32_t id = mp_decode_uint(&key);
+	const char *old_end;
+	const char *old = relay_space_def(relay, id, &old_end);
+	const char *data = NULL;
+	uint32_t size;
+	switch (request.type) {
+	case IPROTO_DELETE:
+		if (old != NULL) {
+			mh_int_t k = mh_i32ptr_find(relay->space_defs,
+						    id, NULL);
+			free(mh_i32ptr_node(relay->space_defs, k)->val);
+			mh_i32ptr_del(relay->space_defs, k, NULL);
+		}
+		return;
+	case IPROTO_UPDATE:
+		if (old == NULL)
+			return;
+		data = tuple_update_execute(region_aligned_alloc_cb,
+					    &fiber()->gc, request.tuple,
+					    request.tuple_end, old, old_end,
+					    &size, request.index_base, NULL);
+		break;
+	case IPROTO_UPSERT:
+		if (old == NULL) {
+			relay_space_defs_put(relay, request.tuple,
+					     request.tuple_end);
+			return;
+		}
+		data = tuple_upsert_execute(region_aligned_alloc_cb,
+					    &fiber()->gc, request.ops,
+					    request.ops_end, old, old_end,
+					    &size, request.index_base, true,
+					    NULL);
+		break;
+	default:
+		return;
+	}
+	if (data == NULL)
+		diag_raise();
+	relay_space_defs_put(relay, data, data + size);
+}
+
+/**
+ * Attach the name of the space a row belongs to to the row
+ * body. The new body is allocated on the fiber region.
+ */
+static void
+relay_add_space_name(struct xrow_header *row, const char *name,
+		     uint32_t name_len)
+{
+	assert(row->bodycnt == 1);
+	const char *data = (const char *) row->body[0].iov_base;
+	const char *data_end = data + row->body[0].iov_len;
+	uint32_t map_size = mp_decode_map(&data);
+	size_t size = mp_sizeof_map(map_size + 1) + (data_end - data) +
+		      mp_sizeof_uint(IPROTO_SPACE_NAME) +
+		      mp_sizeof_str(name_len);
+	char *buf = (char *) region_alloc_xc(&fiber()->gc, size);
+	char *pos = mp_encode_map(buf, map_size + 1);
+	memcpy(pos, data, data_end - data);
+	pos += data_end - data;
+	pos = mp_encode_uint(pos, IPROTO_SPACE_NAME);
+	pos = mp_encode_str(pos, name, name_len);
+	assert(pos == buf + size);
+	row->body[0].iov_base = buf;
+	row->body[0].iov_len = size;
+}
+
+/** Send a single row to a CDC client. */
+static void
+relay_send_cdc_row(struct xstream *stream, struct xrow_header *packet)
+{
+	struct relay *relay = container_of(stream, struct relay, stream);
+	assert(iproto_type_is_dml(packet->type));
+	relay_filter_row(relay, packet);
+	uint32_t space_id;
+	if (packet->type != IPROTO_NOP &&
+	    xrow_decode_space_id(packet, &space_id) == 0) {
+		if (space_id == BOX_SPACE_ID)
+			relay_space_defs_follow(relay, packet);
+		const char *def_end;
+		const char *def = relay_space_def(relay, space_id, &def_end);
+		if (def != NULL) {
+			mp_decode_array(&def);
+			for (int i = 0; i < BOX_SPACE_FIELD_NAME; i++)
+				mp_next(&def);
+			uint32_t name_len;
+			const char *name = mp_decode_str(&def, &name_len);
+			relay_add_space_name(packet, name, name_len);
+		}
+	}
+	relay_collect_row_stat(relay, packet);
+	relay_send(relay, packet);
+}
+
+void
+relay_cdc(int fd, uint64_t sync, struct vclock *vclock,
+	  uint32_t client_version_id, const char *space_filter,
+	  double batch_delay)
+{
+	struct relay *relay = relay_new(NULL);
+	if (relay == NULL)
+		diag_raise();
+	auto relay_guard = make_scoped_guard([=] {
+		relay_stop(relay);
+		relay_delete(relay);
+	});
+	relay->gc = gc_consumer_register(tt_sprintf("cdc %s",
+						    sio_socketname(fd)),
+					 vclock, GC_CONSUMER_WAL);
+	if (relay->gc == NULL)
+		diag_raise();
+	auto gc_guard = make_scoped_guard([=] {
+		gc_consumer_unregister(relay->gc);
+	});
+	relay_set_space_filter(relay, space_filter);
+	relay_space_defs_load(relay);
+	relay->batch_delay = batch_delay;
+
+	relay_start(relay, fd, sync, relay_send_cdc_row);
+	relay->r = recovery_new(cfg_gets("wal_dir"),
+				cfg_geti("force_recovery"), vclock);
+	vclock_copy(&relay->tx.vclock, vclock);
+	relay->version_id = client_version_id;
+
+	int rc = cord_costart(&relay->cord, tt_sprintf("cdc_%p", relay),
+			      relay_subscribe_f, relay);
+	if (rc == 0)
+		rc = cord_cojoin(&relay->cord);
+	if (rc != 0)
+		diag_raise();
+}
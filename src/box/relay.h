@@ -37,8 +37,10 @@
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct latency;
 struct relay;
 struct replica;
+struct rmean;
 struct tt_uuid;
 struct vclock;
 
@@ -85,6 +87,35 @@ relay_get_state(const struct relay *relay);
 const struct vclock *
 relay_vclock(const struct relay *relay);
 
+/**
+ * Return compression of the stream sent to the replica,
+ * see enum iproto_compression.
+ */
+uint32_t
+relay_compression(const struct relay *relay);
+
+/**
+ * Get the number of bytes sent to the replica after and before
+ * compression, as last reported by the relay thread.
+ */
+void
+relay_bytes(const struct relay *relay, uint64_t *compressed,
+	    uint64_t *uncompressed);
+
+/**
+ * Get the rate of rows and bytes sent to the replica, see
+ * enum replication_stat.
+ */
+struct rmean *
+relay_rmean(struct relay *relay);
+
+/**
+ * Get the latency between a commit of a row and its sending
+ * to the replica, as last reported by the relay thread.
+ */
+struct latency *
+relay_send_latency(struct relay *relay);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -92,12 +123,34 @@ relay_vclock(const struct relay *relay);
 /**
  * Send initial JOIN rows to the replica
  *
- * @param fd        client connection
- * @param sync      sync from incoming JOIN request
- * @param vclock    vclock of the last checkpoint
+ * The initial data may be split among several streams sent
+ * over different connections. Rows of system spaces are sent
+ * in the first stream, because the replica needs them to
+ * apply other rows. The rest are distributed among all the
+ * streams in chunks.
+ *
+ * @param fd           client connection
+ * @param sync         sync from incoming JOIN request
+ * @param vclock       vclock of the checkpoint to send
+ * @param stream_id    index of the stream to send
+ * @param stream_count number of streams
  */
 void
-relay_initial_join(int fd, uint64_t sync, struct vclock *vclock);
+relay_initial_join(int fd, uint64_t sync, struct vclock *vclock,
+		   uint32_t stream_id, uint32_t stream_count);
+
+/**
+ * Send files of a checkpoint to the replica as is instead of
+ * initial JOIN rows. A file name is sent relative to the engine
+ * directory, i.e. memtx_dir for snapshots and vinyl_dir for
+ * the rest.
+ *
+ * @param fd           client connection
+ * @param sync         sync from incoming JOIN request
+ * @param vclock       vclock of the checkpoint to send
+ */
+void
+relay_initial_join_files(int fd, uint64_t sync, struct vclock *vclock);
 
 /**
  * Send final JOIN rows to the replica.
@@ -112,10 +165,45 @@ relay_final_join(struct replica *replica, int fd, uint64_t sync,
 /**
  * Subscribe a replica to updates.
  *
+ * @param compression compression of the stream,
+ *                    see enum iproto_compression.
+ * @param space_filter MsgPack array of ids of user spaces
+ *                     the replica wants to receive rows of or
+ *                     NULL if it wants all rows.
+ * @param batch_delay max time rows may be held to be sent
+ *                    with one write, 0 to send rows as soon
+ *                    as they are read from the WAL.
  * @return none.
  */
 void
 relay_subscribe(struct replica *replica, int fd, uint64_t sync,
-		struct vclock *replica_vclock, uint32_t replica_version_id);
+		struct vclock *replica_vclock, uint32_t replica_version_id,
+		uint32_t compression, const char *space_filter,
+		double batch_delay);
+
+/**
+ * Stream rows committed after the given vclock to a change data
+ * capture client. Works the same way as a replica relay, but
+ * the client doesn't have to be registered in the replica set
+ * and each row of a space has the space name attached to it.
+ * The name is the one the space had when the request was
+ * received or, for rows written after that, when the row was
+ * written. WAL files are kept until the client acknowledges
+ * rows stored in them by sending its vclock back, as a replica
+ * does, provided it sends its version in the request.
+ *
+ * @param fd           client connection
+ * @param sync         sync from incoming CDC request
+ * @param vclock       vclock to start streaming from
+ * @param client_version_id client version or 0 if not sent
+ * @param space_filter MsgPack array of ids of user spaces to
+ *                     stream or NULL to stream all spaces
+ * @param batch_delay  max time rows may be held to be sent
+ *                     with one write, see relay_subscribe()
+ */
+void
+relay_cdc(int fd, uint64_t sync, struct vclock *vclock,
+	  uint32_t client_version_id, const char *space_filter,
+	  double batch_delay);
 
 #endif /* TARANTOOL_REPLICATION_RELAY_H_INCLUDED */
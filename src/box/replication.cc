@@ -52,6 +52,18 @@ double replication_connect_timeout = 30.0; /* seconds */
 int replication_connect_quorum = REPLICATION_CONNECT_QUORUM_ALL;
 double replication_sync_lag = 10.0; /* seconds */
 bool replication_skip_conflict = false;
+int replication_apply_workers = 1;
+bool replication_compression = false;
+int replication_join_streams = 1;
+bool replication_join_files = false;
+uint32_t *replication_spaces = NULL;
+uint32_t replication_space_count = 0;
+double replication_batch_delay = 0;
+
+const char *replication_stat_strs[] = {
+	"rows",
+	"bytes",
+};
 
 struct replicaset replicaset;
 
@@ -103,6 +115,7 @@ replication_free(void)
 		relay_cancel(replica->relay);
 
 	free(replicaset.replica_by_id);
+	free(replication_spaces);
 	fiber_cond_destroy(&replicaset.applier.cond);
 }
 
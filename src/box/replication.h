@@ -98,6 +98,27 @@ struct gc_consumer;
 
 static const int REPLICATION_CONNECT_QUORUM_ALL = INT_MAX;
 
+/** Max value of box.cfg.replication_apply_workers. */
+static const int REPLICATION_APPLY_WORKERS_MAX = 64;
+
+/** Max value of box.cfg.replication_join_streams. */
+static const int REPLICATION_JOIN_STREAMS_MAX = 16;
+
+/**
+ * Rate counters of a replication stream, maintained by appliers
+ * and relays and reported in box.info.replication.
+ */
+enum replication_stat {
+	/** Rows received or sent. */
+	REPLICATION_STAT_ROWS,
+	/** Bytes of row bodies received or sent. */
+	REPLICATION_STAT_BYTES,
+	REPLICATION_STAT_LAST,
+};
+
+/** Names of replication stream rate counters. */
+extern const char *replication_stat_strs[];
+
 /**
  * Network timeout. Determines how often master and slave exchange
  * heartbeat messages. Set by box.cfg.replication_timeout.
@@ -131,6 +152,61 @@ extern double replication_sync_lag;
  */
 extern bool replication_skip_conflict;
 
+/**
+ * Number of fibers an applier uses to apply rows received from
+ * the master concurrently. Rows touching different keys may be
+ * applied in parallel, which lets their WAL writes be batched.
+ * If set to 1, rows are applied strictly in order. A new value
+ * takes effect when an applier (re)subscribes.
+ */
+extern int replication_apply_workers;
+
+/**
+ * If set, an applier asks the master to compress the stream of
+ * rows it sends with zstd. Masters that don't support it send
+ * the stream as is. A new value takes effect when an applier
+ * (re)subscribes.
+ */
+extern bool replication_compression;
+
+/**
+ * Number of connections a replica bootstrapping from a master
+ * receives the initial data over. The master sends each of
+ * them from a separate thread, while the replica applies rows
+ * as they arrive and builds indexes in bulk in the end.
+ */
+extern int replication_join_streams;
+
+/**
+ * If set, a replica bootstrapping from a master asks it to send
+ * the files of its last checkpoint as is instead of rows, then
+ * recovers from them as from a backup. This saves the replica
+ * from re-inserting and re-dumping vinyl data. Masters that
+ * don't support it send rows.
+ */
+extern bool replication_join_files;
+
+/**
+ * Sorted ids of user spaces this instance wants to receive rows
+ * of when subscribed to a master, see box.cfg.replication_spaces.
+ * Rows of other user spaces are replaced with NOPs by the master
+ * relay so that the vclock still advances. Rows of system spaces
+ * are always received. NULL means all spaces.
+ */
+extern uint32_t *replication_spaces;
+
+/** Number of entries in replication_spaces. */
+extern uint32_t replication_space_count;
+
+/**
+ * Max time, in seconds, a master relay may hold rows committed
+ * on the master before sending them to this instance, so as to
+ * send more rows with one write. 0 means the relay sends rows
+ * as soon as it reads them from the WAL. A new value takes
+ * effect when an applier (re)subscribes.
+ */
+extern double replication_batch_delay;
+
 /**
  * Wait for the given period of time before trying to reconnect
  * to a master.
@@ -49,6 +49,7 @@ static struct session_vtab generic_session_vtab = {
 	/* .push = */ generic_session_push,
 	/* .fd = */ generic_session_fd,
 	/* .sync = */ generic_session_sync,
+	/* .flush = */ generic_session_flush,
 };
 
 struct session_vtab session_vtab_registry[] = {
@@ -320,3 +321,10 @@ generic_session_sync(struct session *session)
 	(void) session;
 	return 0;
 }
+
+int
+generic_session_flush(struct session *session)
+{
+	(void) session;
+	return 0;
+}
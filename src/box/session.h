@@ -136,6 +136,16 @@ struct session_vtab {
 	 */
 	int64_t
 	(*sync)(struct session *session);
+	/**
+	 * Wait until the data pushed into a session is written
+	 * to its data channel. Yields if the data is buffered.
+	 * @param session Session to flush.
+	 *
+	 * @retval  0 Success.
+	 * @retval -1 Error, e.g. the fiber is cancelled.
+	 */
+	int
+	(*flush)(struct session *session);
 };
 
 extern struct session_vtab session_vtab_registry[];
@@ -317,6 +327,12 @@ session_sync(struct session *session)
 	return session_vtab_registry[session->type].sync(session);
 }
 
+static inline int
+session_flush(struct session *session)
+{
+	return session_vtab_registry[session->type].flush(session);
+}
+
 /**
  * In a common case, a session does not support push. This
  * function always returns -1 and sets ER_UNSUPPORTED error.
@@ -332,6 +348,13 @@ generic_session_fd(struct session *session);
 int64_t
 generic_session_sync(struct session *session);
 
+/**
+ * Return 0 from any session: pushes, if supported, are
+ * written at once.
+ */
+int
+generic_session_flush(struct session *session);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 
@@ -66,6 +66,13 @@ struct space_vtab {
 	int (*execute_update)(struct space *, struct txn *,
 			      struct request *, struct tuple **result);
 	int (*execute_upsert)(struct space *, struct txn *, struct request *);
+	/**
+	 * Delete all tuples whose primary key falls in range
+	 * [request->key, request->end_key). An empty key stands
+	 * for an unbounded side of the range.
+	 */
+	int (*execute_delete_range)(struct space *, struct txn *,
+				    struct request *);
 
 	int (*ephemeral_replace)(struct space *, const char *, const char *);
 
@@ -246,6 +253,31 @@ space_index(struct space *space, uint32_t id)
 	return NULL;
 }
 
+/**
+ * Check if the SQL planner needs statistics of a space, see
+ * index_ndv_add(). They are only maintained for user spaces
+ * created with SQL.
+ */
+static inline bool
+space_has_ndv(struct space *space)
+{
+	return space->def->id > BOX_SYSTEM_ID_MAX &&
+	       space->def->opts.sql != NULL;
+}
+
+/**
+ * Account a tuple written to a space in statistics of all
+ * its indexes, see index_ndv_add().
+ */
+static inline void
+space_ndv_add(struct space *space, const struct tuple *old_tuple,
+	      const struct tuple *new_tuple)
+{
+	assert(space_has_ndv(space));
+	for (uint32_t i = 0; i < space->index_count; i++)
+		index_ndv_add(space->index[i], old_tuple, new_tuple);
+}
+
 /**
  * Return key_def of the index identified by id or NULL
  * if there is no such index.
@@ -455,6 +487,8 @@ space_fill_index_map(struct space *space);
  */
 size_t generic_space_bsize(struct space *);
 int generic_space_apply_initial_join_row(struct space *, struct request *);
+int generic_space_execute_delete_range(struct space *, struct txn *,
+				       struct request *);
 int generic_space_ephemeral_replace(struct space *, const char *, const char *);
 int generic_space_ephemeral_delete(struct space *, const char *);
 void generic_init_system_space(struct space *);
@@ -56,6 +56,7 @@ const struct space_opts space_opts_default = {
 	/* .view = */ false,
 	/* .sql        = */ NULL,
 	/* .checks     = */ NULL,
+	/* .is_ephemeral = */ false,
 };
 
 const struct opt_def space_opts_reg[] = {
@@ -68,6 +68,12 @@ struct space_opts {
 	char *sql;
 	/** SQL Checks expressions list. */
 	struct ExprList *checks;
+	/**
+	 * The space is ephemeral: it is created by SQL for
+	 * a single statement and is never visible in the
+	 * schema. The option is set at runtime only.
+	 */
+	bool is_ephemeral;
 };
 
 extern const struct space_opts space_opts_default;
@@ -31,6 +31,7 @@
 #include <assert.h>
 #include "field_def.h"
 #include "sql.h"
+#include "sql_stmt_cache.h"
 /*
  * Both Tarantool and SQLite codebases declare Index, hence the
  * workaround below.
@@ -61,6 +62,13 @@ static sqlite3 *db = NULL;
 
 static const char nil_key[] = { 0x90 }; /* Empty MsgPack array. */
 
+enum {
+	/** Number of tuples read by the first refill of a batch. */
+	SQL_CURSOR_BATCH_MIN = 8,
+	/** Max number of tuples read ahead by a batched cursor. */
+	SQL_CURSOR_BATCH_MAX = 1024,
+};
+
 static const uint32_t default_sql_flags = SQLITE_ShortColNames
 					  | SQLITE_EnableTrigger
 					  | SQLITE_AutoIndex
@@ -88,6 +96,7 @@ sql_init()
 		sqlite3_close(db);
 		panic("failed to initialize SQL Schema subsystem");
 	}
+	sql_stmt_cache_init();
 }
 
 void
@@ -114,6 +123,7 @@ sql_load_schema()
 void
 sql_free()
 {
+	sql_stmt_cache_free();
 	sqlite3_close(db); db = NULL;
 }
 
@@ -175,7 +185,7 @@ static int
 cursor_seek(BtCursor *pCur, int *pRes);
 
 static int
-cursor_advance(BtCursor *pCur, int *pRes);
+cursor_advance(BtCursor *pCur, int *pRes, bool is_seek);
 
 const char *tarantoolErrorMessage()
 {
@@ -259,7 +269,7 @@ int tarantoolSqlite3Next(BtCursor *pCur, int *pRes)
 		return SQLITE_OK;
 	}
 	assert(iterator_direction(pCur->iter_type) > 0);
-	return cursor_advance(pCur, pRes);
+	return cursor_advance(pCur, pRes, false);
 }
 
 /*
@@ -274,7 +284,7 @@ int tarantoolSqlite3Previous(BtCursor *pCur, int *pRes)
 		return SQLITE_OK;
 	}
 	assert(iterator_direction(pCur->iter_type) < 0);
-	return cursor_advance(pCur, pRes);
+	return cursor_advance(pCur, pRes, false);
 }
 
 int tarantoolSqlite3MovetoUnpacked(BtCursor *pCur, UnpackedRecord *pIdxKey,
@@ -324,6 +334,15 @@ int tarantoolSqlite3MovetoUnpacked(BtCursor *pCur, UnpackedRecord *pIdxKey,
 		res_success = 0;
 		break;
 	}
+	if (pIdxKey->opcode != OP_SeekLT && pIdxKey->opcode != OP_SeekLE &&
+	    pIdxKey->opcode != OP_SeekGE && pIdxKey->opcode != OP_SeekGT) {
+		/*
+		 * A lookup by key must find the tuple regardless
+		 * of the conditions of the loop the cursor is used
+		 * in, so drop the filters.
+		 */
+		pCur->filter_count = 0;
+	}
 	rc = cursor_seek(pCur, pRes);
 	if (*pRes == 0) {
 		*pRes = res_success;
@@ -407,11 +426,20 @@ tarantoolSqlite3EphemeralCreate(BtCursor *pCur, uint32_t field_count,
 				 ON_CONFLICT_ACTION_NONE, coll, id,
 				 SORT_ORDER_ASC);
 	}
+	int rc = sql_ephemeral_index_create(pCur, field_count,
+					    ephemer_key_def);
+	key_def_delete(ephemer_key_def);
+	return rc;
+}
 
+int
+sql_ephemeral_index_create(struct BtCursor *pCur, uint32_t field_count,
+			   struct key_def *key_def)
+{
+	assert(pCur->curFlags & BTCF_TEphemCursor);
 	struct index_def *ephemer_index_def =
 		index_def_new(0, 0, "ephemer_idx", strlen("ephemer_idx"), TREE,
-			      &index_opts_default, ephemer_key_def, NULL);
-	key_def_delete(ephemer_key_def);
+			      &index_opts_default, key_def, NULL);
 	if (ephemer_index_def == NULL)
 		return SQL_TARANTOOL_ERROR;
 
@@ -573,9 +601,10 @@ sql_delete_by_key(struct space *space, char *key, uint32_t key_size)
 }
 
 /*
- * Delete all tuples from space. It is worth noting, that truncate can't
- * be applied to ephemeral space, so this routine manually deletes
- * tuples one by one.
+ * Delete all tuples from space. Tuples of an ephemeral space are
+ * not freed one by one, so instead of deleting them the space is
+ * replaced with a new empty one and the old space is dropped
+ * along with all its memory. The cursor is left invalid.
  *
  * @param pCur Cursor pointing to ephemeral space.
  *
@@ -586,29 +615,61 @@ int tarantoolSqlite3EphemeralClearTable(BtCursor *pCur)
 	assert(pCur);
 	assert(pCur->curFlags & BTCF_TEphemCursor);
 
-	struct iterator *it = index_create_iterator(*pCur->space->index,
-						    ITER_ALL, nil_key,
-						    0 /* part_count */);
-	if (it == NULL) {
-		pCur->eState = CURSOR_INVALID;
-		return SQL_TARANTOOL_ITERATOR_FAIL;
+	struct space *space = pCur->space;
+	struct index_def *index_def = index_def_dup(pCur->index->def);
+	if (index_def == NULL)
+		return SQL_TARANTOOL_ERROR;
+	struct rlist key_list;
+	rlist_create(&key_list);
+	rlist_add_entry(&key_list, index_def, link);
+	struct space *new_space = space_new_ephemeral(space->def, &key_list);
+	index_def_delete(index_def);
+	if (new_space == NULL)
+		return SQL_TARANTOOL_ERROR;
+
+	if (pCur->iter != NULL) {
+		iterator_delete(pCur->iter);
+		pCur->iter = NULL;
+	}
+	if (pCur->last_tuple != NULL) {
+		tuple_unref(pCur->last_tuple);
+		pCur->last_tuple = NULL;
 	}
+	sql_cursor_batch_reset(pCur);
+	pCur->eState = CURSOR_INVALID;
+	space_delete(space);
+	pCur->space = new_space;
+	pCur->index = *new_space->index;
+	return SQLITE_OK;
+}
 
-	struct tuple *tuple;
-	char *key;
-	uint32_t  key_size;
+/** Limit of memory of ephemeral spaces of one statement. */
+static size_t sql_temp_memory_max = 0;
 
-	while (iterator_next(it, &tuple) == 0 && tuple != NULL) {
-		key = tuple_extract_key(tuple, it->index->def->key_def,
-					&key_size);
-		if (space_ephemeral_delete(pCur->space, key) != 0) {
-			iterator_delete(it);
-			return SQL_TARANTOOL_DELETE_FAIL;
-		}
-	}
-	iterator_delete(it);
+void
+sql_set_temp_memory_max(size_t size)
+{
+	sql_temp_memory_max = size;
+}
 
-	return SQLITE_OK;
+int
+sql_ephemeral_check_memory(struct Vdbe *p)
+{
+	if (sql_temp_memory_max == 0)
+		return SQLITE_OK;
+	size_t used = 0;
+	for (int i = 0; i < p->nCursor; ++i) {
+		struct VdbeCursor *c = p->apCsr[i];
+		if (c == NULL || c->eCurType != CURTYPE_TARANTOOL ||
+		    (c->uc.pCursor->curFlags & BTCF_TEphemCursor) == 0 ||
+		    c->uc.pCursor->space == NULL)
+			continue;
+		used += space_bsize(c->uc.pCursor->space);
+	}
+	if (used <= sql_temp_memory_max)
+		return SQLITE_OK;
+	diag_set(ClientError, ER_SQL_TEMP_MEMORY, (unsigned long long) used);
+	return SQL_TARANTOOL_ERROR;
 }
 
 /*
@@ -1015,6 +1076,7 @@ cursor_seek(BtCursor *pCur, int *pRes)
 		box_iterator_free(pCur->iter);
 		pCur->iter = NULL;
 	}
+	sql_cursor_batch_reset(pCur);
 	const char *key = (const char *)pCur->key;
 	uint32_t part_count = mp_decode_array(&key);
 	if (key_validate(pCur->index->def, pCur->iter_type, key, part_count)) {
@@ -1026,9 +1088,14 @@ cursor_seek(BtCursor *pCur, int *pRes)
 	struct txn *txn = NULL;
 	if (space->def->id != 0 && txn_begin_ro_stmt(space, &txn) != 0)
 		return SQL_TARANTOOL_ERROR;
-	struct iterator *it =
-		index_create_iterator(pCur->index, pCur->iter_type, key,
-				      part_count);
+	struct iterator *it;
+	if ((pCur->curFlags & BTCF_KeyOnly) != 0) {
+		it = index_create_key_iterator(pCur->index, pCur->iter_type,
+					       key, part_count);
+	} else {
+		it = index_create_iterator(pCur->index, pCur->iter_type, key,
+					   part_count);
+	}
 	if (it == NULL) {
 		if (txn != NULL)
 			txn_rollback_stmt();
@@ -1040,33 +1107,185 @@ cursor_seek(BtCursor *pCur, int *pRes)
 	pCur->iter = it;
 	pCur->eState = CURSOR_VALID;
 
-	return cursor_advance(pCur, pRes);
+	return cursor_advance(pCur, pRes, true);
 }
 
 /*
- * Move cursor to the next entry in space.
+ * Read the next batch of tuples from the iterator of a batched
+ * cursor. The batch size starts from SQL_CURSOR_BATCH_MIN and
+ * doubles on each refill up to SQL_CURSOR_BATCH_MAX, so that
+ * a cursor which is repositioned after a few rows (e.g. the
+ * inner loop of a join) doesn't read much more than it uses,
+ * while a long scan fetches tuples in big batches.
+ *
+ * @param cur Batched cursor with an exhausted batch.
+ *
+ * @retval 0 on success, -1 otherwise.
+ */
+static int
+cursor_batch_fill(BtCursor *cur)
+{
+	assert((cur->curFlags & BTCF_Batch) != 0);
+	assert(cur->batch_pos == cur->batch_count);
+	extern int sql_batch_count;
+	sql_batch_count++;
+	cur->batch_pos = 0;
+	cur->batch_count = 0;
+	if (cur->batch_size == 0)
+		cur->batch_size = SQL_CURSOR_BATCH_MIN;
+	else if (cur->batch_size < SQL_CURSOR_BATCH_MAX)
+		cur->batch_size *= 2;
+	if (cur->batch_size > cur->batch_alloc) {
+		size_t size = cur->batch_size * sizeof(struct tuple *);
+		struct tuple **batch = realloc(cur->batch, size);
+		if (batch == NULL) {
+			diag_set(OutOfMemory, size, "realloc", "batch");
+			return -1;
+		}
+		cur->batch = batch;
+		cur->batch_alloc = cur->batch_size;
+	}
+	while (cur->batch_count < cur->batch_size) {
+		struct tuple *tuple;
+		if (iterator_next(cur->iter, &tuple) != 0) {
+			sql_cursor_batch_reset(cur);
+			return -1;
+		}
+		if (tuple == NULL)
+			break;
+		tuple_ref(tuple);
+		cur->batch[cur->batch_count++] = tuple;
+	}
+	return 0;
+}
+
+/*
+ * Fetch the next tuple from the iterator or the batch of a cursor.
+ * The returned tuple is referenced.
+ *
+ * @retval 0 on success, -1 otherwise.
+ */
+static int
+cursor_fetch(BtCursor *cur, struct tuple **ret)
+{
+	if ((cur->curFlags & BTCF_Batch) != 0) {
+		/* The batch already holds a reference. */
+		if (cur->batch_pos == cur->batch_count &&
+		    cursor_batch_fill(cur) != 0)
+			return -1;
+		*ret = cur->batch_pos < cur->batch_count ?
+		       cur->batch[cur->batch_pos++] : NULL;
+		return 0;
+	}
+	if (iterator_next(cur->iter, ret) != 0)
+		return -1;
+	if (*ret != NULL)
+		tuple_ref(*ret);
+	return 0;
+}
+
+/*
+ * Check if a tuple may satisfy the filters pushed down to a
+ * cursor. Only integer and nil fields are checked, for other
+ * types the comparison is left to VDBE, which knows how to apply
+ * affinity.
+ */
+static bool
+cursor_filter_match(BtCursor *cur, struct tuple *tuple)
+{
+	for (uint32_t i = 0; i < cur->filter_count; i++) {
+		const struct sql_cursor_filter *filter = &cur->filters[i];
+		const char *field = tuple_field(tuple, filter->fieldno);
+		if (field == NULL)
+			continue;
+		int cmp;
+		switch (mp_typeof(*field)) {
+		case MP_NIL:
+			/* Comparison with NULL is never true. */
+			return false;
+		case MP_UINT: {
+			uint64_t value = mp_decode_uint(&field);
+			if (value > INT64_MAX)
+				cmp = 1;
+			else
+				cmp = (int64_t)value < filter->value ? -1 :
+				      (int64_t)value > filter->value;
+			break;
+		}
+		case MP_INT: {
+			int64_t value = mp_decode_int(&field);
+			cmp = value < filter->value ? -1 :
+			      value > filter->value;
+			break;
+		}
+		default:
+			continue;
+		}
+		bool is_match;
+		switch (filter->op) {
+		case OP_Eq: is_match = cmp == 0; break;
+		case OP_Lt: is_match = cmp < 0; break;
+		case OP_Le: is_match = cmp <= 0; break;
+		case OP_Gt: is_match = cmp > 0; break;
+		default:    is_match = cmp >= 0; break;
+		}
+		if (!is_match)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Move cursor to the next entry in space, skipping tuples which
+ * don't match the cursor filters.
  * New tuple is refed and saved in cursor.
  * Tuple from previous call is unrefed.
  *
  * @param pCur Cursor which contains space and tuple.
  * @param[out] pRes Flag which is 0 if reached end of space, 1 otherwise.
+ * @param is_seek True if the cursor has just been positioned.
  *
  * @retval SQLITE_OK on success, SQLITE_TARANTOOL_ERROR otherwise.
  */
 static int
-cursor_advance(BtCursor *pCur, int *pRes)
+cursor_advance(BtCursor *pCur, int *pRes, bool is_seek)
 {
 	assert(pCur->iter != NULL);
 
 	struct tuple *tuple;
-	if (iterator_next(pCur->iter, &tuple) != 0)
-		return SQL_TARANTOOL_ITERATOR_FAIL;
+	int skipped = 0;
+	while (true) {
+		if (cursor_fetch(pCur, &tuple) != 0)
+			return SQL_TARANTOOL_ITERATOR_FAIL;
+		if (tuple == NULL || pCur->filter_count == 0 ||
+		    cursor_filter_match(pCur, tuple))
+			break;
+		tuple_unref(tuple);
+		skipped++;
+	}
+	if (skipped > 0) {
+		/*
+		 * Account skipped tuples as if they were stepped
+		 * over by VDBE, which doesn't count the tuple the
+		 * cursor is positioned at by Rewind or Seek.
+		 */
+		extern int sql_search_count;
+		if (is_seek && tuple == NULL)
+			skipped--;
+		sql_search_count += skipped;
+	}
 	if (pCur->last_tuple)
 		box_tuple_unref(pCur->last_tuple);
 	if (tuple) {
-		box_tuple_ref(tuple);
 		*pRes = 0;
 	} else {
+		/*
+		 * The iterator is not needed anymore: free it,
+		 * so that the statement doesn't look as if it
+		 * still reads the space (see vdbe_may_yield()).
+		 */
+		iterator_delete(pCur->iter);
+		pCur->iter = NULL;
 		pCur->eState = CURSOR_INVALID;
 		*pRes = 1;
 	}
@@ -1523,10 +1742,12 @@ sql_debug_info(struct info_handler *h)
 	extern int sql_search_count;
 	extern int sql_sort_count;
 	extern int sql_found_count;
+	extern int sql_batch_count;
 	info_begin(h);
 	info_append_int(h, "sql_search_count", sql_search_count);
 	info_append_int(h, "sql_sort_count", sql_sort_count);
 	info_append_int(h, "sql_found_count", sql_found_count);
+	info_append_int(h, "sql_batch_count", sql_batch_count);
 	info_end(h);
 }
 
@@ -47,6 +47,13 @@ sql_load_schema();
 void
 sql_free();
 
+/**
+ * Set the max size of memory taken by ephemeral spaces of one
+ * SQL statement. 0 means no limit.
+ */
+void
+sql_set_temp_memory_max(size_t size);
+
 /**
  * struct sqlite3 *
  * sql_get();
@@ -1595,6 +1595,15 @@ load_stat_to_index(struct sqlite3 *db, const char *sql_select_load,
 	return 0;
 }
 
+enum {
+	/**
+	 * Min number of tuples in an index for its distinct
+	 * value estimates to be used by the planner instead
+	 * of default_tuple_est[].
+	 */
+	SQL_NDV_STAT_MIN_ROWS = 1000,
+};
+
 /**
  * default_tuple_est[] array contains default information
  * which is used when we don't have real space, e.g. temporary
@@ -1652,6 +1661,20 @@ index_field_tuple_est(struct Index *idx, uint32_t field)
 		if (field == tnt_idx->def->key_def->part_count &&
 		    tnt_idx->def->opts.is_unique)
 			return 0;
+		/*
+		 * Use the number of distinct values maintained
+		 * by the index, but not for small spaces: any
+		 * plan is cheap for them, while the relative
+		 * error of the estimate is large.
+		 */
+		uint64_t ndv;
+		ssize_t size = index_size(tnt_idx);
+		if (field > 0 && size >= SQL_NDV_STAT_MIN_ROWS &&
+		    (ndv = index_ndv_estimate(tnt_idx, field)) > 0) {
+			log_est_t est = sqlite3LogEst(size) -
+					sqlite3LogEst(ndv);
+			return est > 0 ? est : 0;
+		}
 		return default_tuple_est[field + 1 >= 6 ? 6 : field];
 	}
 	return tnt_idx->def->opts.stat->tuple_log_est[field];
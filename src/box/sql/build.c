@@ -1084,6 +1084,15 @@ vdbe_emit_open_cursor(struct Parse *parse_context, int cursor, int index_id,
 				 index_id, 0, (void *) space, P4_SPACEPTR);
 }
 
+int
+vdbe_emit_open_read_cursor(struct Parse *parse_context, int cursor,
+			   int index_id, struct space *space)
+{
+	assert(space != NULL);
+	return sqlite3VdbeAddOp4(parse_context->pVdbe, OP_OpenRead, cursor,
+				 index_id, 0, (void *) space, P4_SPACEPTR);
+}
+
 /*
  * Measure the number of characters needed to output the given
  * identifier.  The number returned includes any quotes used
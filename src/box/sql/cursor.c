@@ -40,6 +40,10 @@ sql_cursor_cleanup(struct BtCursor *cursor)
 		iterator_delete(cursor->iter);
 	if (cursor->last_tuple)
 		tuple_unref(cursor->last_tuple);
+	sql_cursor_batch_reset(cursor);
+	free(cursor->batch);
+	cursor->batch = NULL;
+	cursor->batch_alloc = 0;
 	free(cursor->key);
 	cursor->key = NULL;
 	cursor->iter = NULL;
@@ -47,6 +51,16 @@ sql_cursor_cleanup(struct BtCursor *cursor)
 	cursor->eState = CURSOR_INVALID;
 }
 
+void
+sql_cursor_batch_reset(struct BtCursor *cursor)
+{
+	for (uint32_t i = cursor->batch_pos; i < cursor->batch_count; i++)
+		tuple_unref(cursor->batch[i]);
+	cursor->batch_pos = 0;
+	cursor->batch_count = 0;
+	cursor->batch_size = 0;
+}
+
 /*
  * Initialize memory that will be converted into a BtCursor object.
  */
@@ -62,9 +76,13 @@ sql_cursor_close(struct BtCursor *cursor)
 	assert(cursor->space != NULL);
 	assert((cursor->curFlags & BTCF_TaCursor) ||
 	       (cursor->curFlags & BTCF_TEphemCursor));
+	/*
+	 * Release tuples first: tuples of an ephemeral space
+	 * are freed along with the space.
+	 */
+	sql_cursor_cleanup(cursor);
 	if (cursor->curFlags & BTCF_TEphemCursor)
 		tarantoolSqlite3EphemeralDrop(cursor);
-	sql_cursor_cleanup(cursor);
 }
 
 #ifndef NDEBUG			/* The next routine used only within assert() statements */
@@ -34,6 +34,26 @@
 
 typedef struct BtCursor BtCursor;
 
+enum {
+	/** Max number of filters pushed down to a cursor. */
+	SQL_CURSOR_FILTER_MAX = 4,
+};
+
+/**
+ * Comparison of a tuple field with an integer constant pushed
+ * down from WHERE clause to a cursor, see OP_CursorFilter.
+ * Tuples which definitely fail the comparison are skipped by the
+ * cursor and never reach VDBE.
+ */
+struct sql_cursor_filter {
+	/** Number of the field to compare. */
+	uint32_t fieldno;
+	/** Comparison opcode: OP_Eq, OP_Lt, OP_Le, OP_Gt, OP_Ge. */
+	int op;
+	/** Constant to compare the field with. */
+	int64_t value;
+};
+
 /*
  * A cursor contains a particular entry either from Tarantrool or
  * Sorter. Tarantool cursor is able to point to ordinary table or
@@ -51,6 +71,23 @@ struct BtCursor {
 	enum iterator_type iter_type;
 	struct tuple *last_tuple;
 	char *key;		/* Saved key that was cursor last known position */
+	/**
+	 * Tuples read ahead from the iterator by a cursor with
+	 * BTCF_Batch flag. Each of them is referenced.
+	 */
+	struct tuple **batch;
+	/** Number of slots allocated for the batch. */
+	uint32_t batch_alloc;
+	/** Max number of tuples to read on the next refill. */
+	uint32_t batch_size;
+	/** Number of tuples in the batch. */
+	uint32_t batch_count;
+	/** Position of the next tuple to return from the batch. */
+	uint32_t batch_pos;
+	/** Filters pushed down from WHERE clause. */
+	struct sql_cursor_filter filters[SQL_CURSOR_FILTER_MAX];
+	/** Number of filters in use. */
+	uint32_t filter_count;
 };
 
 void sqlite3CursorZero(BtCursor *);
@@ -76,6 +113,32 @@ int sqlite3CursorPayload(BtCursor *, u32 offset, u32 amt, void *);
 void
 sql_cursor_cleanup(struct BtCursor *cursor);
 
+/**
+ * Add a filter to a cursor. Does nothing if the cursor already
+ * has SQL_CURSOR_FILTER_MAX filters: filters only let the cursor
+ * skip tuples early, all conditions are checked by VDBE anyway.
+ */
+static inline void
+sql_cursor_add_filter(struct BtCursor *cursor, uint32_t fieldno, int op,
+		      int64_t value)
+{
+	if (cursor->filter_count == SQL_CURSOR_FILTER_MAX)
+		return;
+	struct sql_cursor_filter *filter =
+		&cursor->filters[cursor->filter_count++];
+	filter->fieldno = fieldno;
+	filter->op = op;
+	filter->value = value;
+}
+
+/**
+ * Release the tuples read ahead by a batched cursor, which
+ * haven't been returned yet. Called when the cursor is
+ * repositioned.
+ */
+void
+sql_cursor_batch_reset(struct BtCursor *cursor);
+
 #ifndef NDEBUG
 int sqlite3CursorIsValid(BtCursor *);
 #endif
@@ -86,6 +149,8 @@ int sqlite3CursorIsValidNN(BtCursor *);
  */
 #define BTCF_TaCursor     0x80	/* Tarantool cursor, pTaCursor valid */
 #define BTCF_TEphemCursor 0x40	/* Tarantool cursor to ephemeral table  */
+#define BTCF_Batch        0x20	/* Read tuples from iterator in batches */
+#define BTCF_KeyOnly      0x10	/* Only index key fields are needed */
 
 /*
  * Potential values for BtCursor.eState.
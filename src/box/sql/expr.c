@@ -2679,7 +2679,7 @@ sqlite3CodeSubselect(Parse * pParse,	/* Parsing context */
 		jmpIfDynamic = sqlite3VdbeAddOp0(v, OP_Once);
 		VdbeCoverage(v);
 	}
-	if (pParse->explain == 2) {
+	if (pParse->explain >= 2) {
 		char *zMsg =
 		    sqlite3MPrintf(pParse->db, "EXECUTE %s%s SUBQUERY %d",
 				   jmpIfDynamic >= 0 ? "" : "CORRELATED ",
@@ -54,7 +54,10 @@ sqlite3OpenTable(Parse * pParse,	/* Generate code into this VDBE */
 
 	struct space *space = space_by_id(pTab->def->id);
 	assert(space->index_count > 0);
-	vdbe_emit_open_cursor(pParse, iCur, 0, space);
+	if (opcode == OP_OpenRead)
+		vdbe_emit_open_read_cursor(pParse, iCur, 0, space);
+	else
+		vdbe_emit_open_cursor(pParse, iCur, 0, space);
 	VdbeComment((v, "%s", pTab->def->name));
 }
 
@@ -116,9 +116,15 @@ ecmd ::= explain cmdx SEMI. {
 ecmd ::= SEMI. {
   sqlite3ErrorMsg(pParse, "syntax error: empty request");
 }
+// EXPLAIN ANALYZE runs the statement, so ANALYZE right after
+// EXPLAIN always starts EXPLAIN ANALYZE rather than the ANALYZE
+// command. The precedence below resolves that conflict.
+%nonassoc EXPLAIN.
+%nonassoc ANALYZE.
 explain ::= .
 explain ::= EXPLAIN.              { pParse->explain = 1; }
 explain ::= EXPLAIN QUERY PLAN.   { pParse->explain = 2; }
+explain ::= EXPLAIN ANALYZE.      { pParse->explain = 3; }
 cmdx ::= cmd.
 
 // Define operator precedence early so that this is the first occurrence
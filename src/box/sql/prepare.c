@@ -253,10 +253,15 @@ sqlite3Prepare(sqlite3 * db,	/* Database handle. */
 		static const char *const azColName[] = {
 			"addr", "opcode", "p1", "p2", "p3", "p4", "p5",
 			    "comment",
-			"selectid", "order", "from", "detail"
+			"selectid", "order", "from", "detail",
+			"loops", "rows", "time"
 		};
 		int iFirst, mx;
-		if (sParse.explain == 2) {
+		if (sParse.explain == 3) {
+			sqlite3VdbeSetNumCols(sParse.pVdbe, 7);
+			iFirst = 8;
+			mx = 15;
+		} else if (sParse.explain == 2) {
 			sqlite3VdbeSetNumCols(sParse.pVdbe, 4);
 			iFirst = 8;
 			mx = 12;
@@ -1351,7 +1351,7 @@ selectOpName(int id)
 static void
 explainTempTable(Parse * pParse, const char *zUsage)
 {
-	if (pParse->explain == 2) {
+	if (pParse->explain >= 2) {
 		Vdbe *v = pParse->pVdbe;
 		char *zMsg =
 		    sqlite3MPrintf(pParse->db, "USE TEMP B-TREE FOR %s",
@@ -1386,7 +1386,7 @@ explainComposite(Parse * pParse,	/* Parse context */
 {
 	assert(op == TK_UNION || op == TK_EXCEPT || op == TK_INTERSECT
 	       || op == TK_ALL);
-	if (pParse->explain == 2) {
+	if (pParse->explain >= 2) {
 		Vdbe *v = pParse->pVdbe;
 		char *zMsg =
 		    sqlite3MPrintf(pParse->db,
@@ -5399,7 +5399,7 @@ updateAccumulator(Parse * pParse, AggInfo * pAggInfo)
 static void
 explain_simple_count(struct Parse *parse_context, const char *table_name)
 {
-	if (parse_context->explain == 2) {
+	if (parse_context->explain >= 2) {
 		char *zEqp = sqlite3MPrintf(parse_context->db, "B+tree count %s",
 					    table_name);
 		sqlite3VdbeAddOp4(parse_context->pVdbe, OP_Explain,
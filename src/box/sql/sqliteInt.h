@@ -600,6 +600,12 @@ sqlite3_column_value(sqlite3_stmt *,
 int
 sqlite3_finalize(sqlite3_stmt * pStmt);
 
+int
+sqlite3_reset(sqlite3_stmt * pStmt);
+
+int
+sqlite3_clear_bindings(sqlite3_stmt * pStmt);
+
 int
 sqlite3_exec(sqlite3 *,	/* An open database */
 	     const char *sql,	/* SQL to be evaluated */
@@ -964,6 +970,9 @@ int
 sqlite3_bind_zeroblob64(sqlite3_stmt *, int,
 			sqlite3_uint64);
 
+int
+sqlite3_bind_parameter_count(sqlite3_stmt *);
+
 int
 sqlite3_stmt_busy(sqlite3_stmt *);
 
@@ -2842,7 +2851,11 @@ struct Parse {
 
 	Token sLastToken;	/* The last token parsed */
 	ynVar nVar;		/* Number of '?' variables seen in the SQL so far */
-	u8 explain;		/* True if the EXPLAIN flag is found on the query */
+	/**
+	 * 1 for EXPLAIN, 2 for EXPLAIN QUERY PLAN, 3 for
+	 * EXPLAIN ANALYZE, 0 otherwise.
+	 */
+	u8 explain;
 	int nHeight;		/* Expression tree height of current sub-select */
 	int iSelectId;		/* ID of current select for EXPLAIN output */
 	int iNextSelectId;	/* Next available select ID for EXPLAIN output */
@@ -2897,6 +2910,7 @@ struct Parse {
 #define OPFLAG_LENGTHARG     0x40	/* OP_Column only used for length() */
 #define OPFLAG_TYPEOFARG     0x80	/* OP_Column only used for typeof() */
 #define OPFLAG_SEEKEQ        0x02	/* OP_Open** cursor uses EQ seek only */
+#define OPFLAG_KEY_ONLY      0x04	/* OP_OpenRead: only key fields are read */
 #define OPFLAG_FORDELETE     0x08	/* OP_Open should use BTREE_FORDELETE */
 #define OPFLAG_P2ISREG       0x10	/* P2 to OP_Open** is a register number */
 #define OPFLAG_PERMUTE       0x01	/* OP_Compare: use the permutation */
@@ -3485,6 +3499,21 @@ int
 vdbe_emit_open_cursor(struct Parse *parse, int cursor, int index_id,
 		      struct space *space);
 
+/**
+ * Same as vdbe_emit_open_cursor(), but the cursor is opened
+ * with OP_OpenRead. Such a cursor may read tuples ahead in
+ * batches if the statement doesn't modify any space.
+ *
+ * @param parse_context Parse context.
+ * @param cursor Number of cursor to be created.
+ * @param index_id index id.
+ * @param space Pointer to space object.
+ * @retval address of last opcode.
+ */
+int
+vdbe_emit_open_read_cursor(struct Parse *parse, int cursor, int index_id,
+			   struct space *space);
+
 int sqlite3ParseUri(const char *, const char *, unsigned int *,
 		    sqlite3_vfs **, char **, char **);
 
@@ -96,6 +96,24 @@ int tarantoolSqlite3RenameTrigger(const char *zTriggerName,
 /* Interface for ephemeral tables. */
 int tarantoolSqlite3EphemeralCreate(BtCursor * pCur, uint32_t filed_count,
 				    struct key_def *def);
+
+/**
+ * Create ephemeral space indexed by an arbitrary key and set
+ * cursor to the first entry. Unlike tarantoolSqlite3EphemeralCreate()
+ * the primary index covers only fields listed in @a key_def, so
+ * the space can be searched by a prefix of the key. Used for
+ * automatic indexes built by the query planner for joins.
+ *
+ * @param pCur Cursor which will point to the new ephemeral space.
+ * @param field_count Number of fields in ephemeral space.
+ * @param key_def Definition of the primary index key.
+ *
+ * @retval SQLITE_OK on success, SQLITE_TARANTOOL_ERROR otherwise.
+ */
+int
+sql_ephemeral_index_create(struct BtCursor *pCur, uint32_t field_count,
+			   struct key_def *key_def);
+
 /**
  * Insert tuple into ephemeral space.
  * In contrast to ordinary spaces, there is no need to create and
@@ -113,6 +131,17 @@ int tarantoolSqlite3EphemeralDelete(BtCursor * pCur);
 int tarantoolSqlite3EphemeralCount(BtCursor * pCur, i64 * pnEntry);
 int tarantoolSqlite3EphemeralDrop(BtCursor * pCur);
 int tarantoolSqlite3EphemeralClearTable(BtCursor * pCur);
+
+/**
+ * Check that ephemeral spaces open by a VDBE program fit into
+ * the limit set by sql_set_temp_memory_max().
+ *
+ * @param p VDBE program.
+ *
+ * @retval SQLITE_OK on success, SQLITE_TARANTOOL_ERROR otherwise.
+ */
+int
+sql_ephemeral_check_memory(struct Vdbe *p);
 int tarantoolSqlite3EphemeralGetMaxId(BtCursor * pCur, uint32_t fieldno,
 				       uint64_t * max_id);
 
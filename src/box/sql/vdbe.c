@@ -52,6 +52,7 @@
 #include "box/schema.h"
 #include "box/space.h"
 #include "box/sequence.h"
+#include "clock.h"
 
 /*
  * Invoke this macro on memory cells just prior to changing the
@@ -131,6 +132,17 @@ updateMaxBlobsize(Mem *p)
 int sql_found_count = 0;
 #endif
 
+/*
+ * The next global variable is incremented each time a cursor of
+ * a read-only statement reads a batch of tuples ahead. The test
+ * procedures use this information to make sure that scans are
+ * batched when they should be. This variable has no function
+ * other than to help verify the correct operation of the library.
+ */
+#ifdef SQLITE_TEST
+int sql_batch_count = 0;
+#endif
+
 /*
  * Test a register to see if it exceeds the current maximum blob size.
  * If it does, record the new maximum blob size.
@@ -568,6 +580,29 @@ out2Prerelease(Vdbe *p, VdbeOp *pOp)
 	}
 }
 
+/**
+ * Check if the statement may yield while sorting: it runs outside
+ * of a transaction and a trigger program, and none of its cursors
+ * to non-ephemeral spaces has an iterator, so no fiber can change
+ * the data the statement is positioned at.
+ */
+static bool
+vdbe_may_yield(const Vdbe *p)
+{
+	if (in_txn() != NULL || p->pFrame != NULL)
+		return false;
+	for (int i = 0; i < p->nCursor; i++) {
+		const VdbeCursor *pC = p->apCsr[i];
+		if (pC == NULL || pC->eCurType != CURTYPE_TARANTOOL)
+			continue;
+		const BtCursor *pCur = pC->uc.pCursor;
+		if ((pCur->curFlags & BTCF_TEphemCursor) == 0 &&
+		    pCur->iter != NULL)
+			return false;
+	}
+	return true;
+}
+
 /*
  * Execute as much of a VDBE program as we can.
  * This is the core of sqlite3_step().
@@ -599,6 +634,8 @@ int sqlite3VdbeExec(Vdbe *p)
 #ifdef VDBE_PROFILE
 	u64 start;                 /* CPU clock count at start of opcode */
 #endif
+	u64 *op_time = NULL;       /* EXPLAIN ANALYZE time of the current op */
+	u64 op_start = 0;          /* Time at start of opcode */
 	struct session *user_session = current_session();
 	/*** INSERT STACK UNION HERE ***/
 
@@ -612,7 +649,7 @@ int sqlite3VdbeExec(Vdbe *p)
 	assert(p->rc==SQLITE_OK || (p->rc&0xff)==SQLITE_BUSY);
 	p->rc = SQLITE_OK;
 	p->iCurrentTime = 0;
-	assert(p->explain==0);
+	assert(p->explain==0 || p->explain==3);
 	p->pResultSet = 0;
 	db->busyHandler.nBusy = 0;
 	if (db->u1.isInterrupted) goto abort_due_to_interrupt;
@@ -663,9 +700,13 @@ int sqlite3VdbeExec(Vdbe *p)
 		start = sqlite3Hwtime();
 #endif
 		nVmStep++;
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
-		if (p->anExec) p->anExec[(int)(pOp-aOp)]++;
-#endif
+		if (p->anExec != NULL) {
+			p->anExec[(int)(pOp-aOp)]++;
+			op_time = &p->anTime[(int)(pOp-aOp)];
+			op_start = clock_monotonic64();
+		} else {
+			op_time = NULL;
+		}
 
 		/* Only allow tracing if SQLITE_DEBUG is defined.
 		 */
@@ -3054,6 +3095,10 @@ case OP_TTransaction: {
  * id in P2. Give the new cursor an identifier of P1. The P1
  * values need not be contiguous but all P1 values should be
  * small integers. It is an error for P1 to be negative.
+ *
+ * If P5 has OPFLAG_KEY_ONLY bit set and the statement doesn't
+ * modify any space, the cursor reads only fields stored in the
+ * index, so the engine may skip fetching full tuples.
  */
 /* Opcode: ReopenIdx P1 P2 P3 P4 P5
  * Synopsis: index id = P2, space ptr = P4
@@ -3079,7 +3124,7 @@ case OP_ReopenIdx: {
 	VdbeCursor *pCur;
 	BtCursor *pBtCur;
 
-	assert(pOp->p5==0 || pOp->p5==OPFLAG_SEEKEQ);
+	assert((pOp->p5 & ~(OPFLAG_SEEKEQ | OPFLAG_KEY_ONLY)) == 0);
 	pCur = p->apCsr[pOp->p1];
 	p2 = pOp->p2;
 	if (pCur && pCur->uc.pCursor->space == pOp->p4.space &&
@@ -3091,7 +3136,8 @@ case OP_ReopenIdx: {
 case OP_OpenRead:
 case OP_OpenWrite:
 
-	assert(pOp->opcode==OP_OpenWrite || pOp->p5==0 || pOp->p5==OPFLAG_SEEKEQ);
+	assert(pOp->opcode == OP_OpenWrite ||
+	       (pOp->p5 & ~(OPFLAG_SEEKEQ | OPFLAG_KEY_ONLY)) == 0);
 	if (box_schema_version() != p->schema_ver &&
 	    (pOp->p5 & OPFLAG_SYSTEMSP) == 0) {
 		p->expired = 1;
@@ -3119,6 +3165,24 @@ case OP_OpenWrite:
 	pCur->nullRow = 1;
 	pBtCur = pCur->uc.pCursor;
 	pBtCur->curFlags |= BTCF_TaCursor;
+	/*
+	 * A read-only statement can't modify the space under
+	 * the cursor, so tuples may be read ahead. Vinyl
+	 * iterators are not batched: reading ahead would widen
+	 * the transaction read set and may yield for disk reads
+	 * of tuples that are never used.
+	 */
+	if (pOp->opcode == OP_OpenRead && p->is_read_only &&
+	    space_is_memtx(space))
+		pBtCur->curFlags |= BTCF_Batch;
+	/*
+	 * The planner has found that only fields stored in the
+	 * index are used, so there is no need to fetch full
+	 * tuples (see index_create_key_iterator()).
+	 */
+	if (pOp->opcode == OP_OpenRead && p->is_read_only &&
+	    (pOp->p5 & OPFLAG_KEY_ONLY) != 0)
+		pBtCur->curFlags |= BTCF_KeyOnly;
 	pBtCur->space = space;
 	pBtCur->index = index;
 	pBtCur->eState = CURSOR_INVALID;
@@ -3140,6 +3204,18 @@ open_cursor_set_hints:
  *
  * This opcode creates Tarantool's ephemeral table and sets cursor P1 to it.
  */
+/**
+ * Opcode: OpenAutoindex P1 P2 * P4 *
+ * Synopsis:
+ * @param P1 index of new cursor to be created.
+ * @param P2 number of columns in a new table.
+ * @param P4 key def of the new table index.
+ *
+ * This opcode works like OP_OpenTEphemeral, but the ephemeral
+ * table is indexed by the key from P4 instead of all its columns.
+ * It is used to build automatic indexes for joins.
+ */
+case OP_OpenAutoindex:
 case OP_OpenTEphemeral: {
 	VdbeCursor *pCx;
 	BtCursor *pBtCur;
@@ -3156,10 +3232,16 @@ case OP_OpenTEphemeral: {
 	pBtCur->eState = CURSOR_INVALID;
 	pBtCur->curFlags = BTCF_TEphemCursor;
 
-	rc = tarantoolSqlite3EphemeralCreate(pCx->uc.pCursor, pOp->p2,
-					     pOp->p4.key_def);
-	pCx->key_def = pCx->uc.pCursor->index->def->key_def;
+	if (pOp->opcode == OP_OpenAutoindex) {
+		assert(pOp->p4type == P4_KEYDEF);
+		rc = sql_ephemeral_index_create(pCx->uc.pCursor, pOp->p2,
+						pOp->p4.key_def);
+	} else {
+		rc = tarantoolSqlite3EphemeralCreate(pCx->uc.pCursor, pOp->p2,
+						     pOp->p4.key_def);
+	}
 	if (rc) goto abort_due_to_error;
+	pCx->key_def = pCx->uc.pCursor->index->def->key_def;
 	break;
 }
 
@@ -3265,6 +3347,39 @@ case OP_ColumnsUsed: {
 }
 #endif
 
+/* Opcode: CursorFilter P1 P2 P3 P4 P5
+ * Synopsis: field P2 op P4 r[P3]
+ *
+ * Push a comparison of field P2 of tuples read by cursor P1 with
+ * the integer in register P3 down to the cursor. P4 is the opcode
+ * of the comparison: OP_Eq, OP_Lt, OP_Le, OP_Gt or OP_Ge. If P5
+ * is not 0, the filters pushed before are dropped.
+ *
+ * The cursor skips tuples which fail the comparison, but the
+ * condition must be checked by VDBE anyway. If register P3 does
+ * not hold an integer, the filter is not set.
+ */
+case OP_CursorFilter: {
+	VdbeCursor *pC;
+	BtCursor *pCrsr;
+
+	assert(pOp->p1>=0 && pOp->p1<p->nCursor);
+	assert(pOp->p4type == P4_INT32);
+	pC = p->apCsr[pOp->p1];
+	assert(pC != NULL && pC->eCurType == CURTYPE_TARANTOOL);
+	pCrsr = pC->uc.pCursor;
+	if (pOp->p5 != 0)
+		pCrsr->filter_count = 0;
+	pIn3 = &aMem[pOp->p3];
+	if ((pCrsr->curFlags & BTCF_TaCursor) != 0 &&
+	    (pIn3->flags & (MEM_Int | MEM_Real | MEM_Str | MEM_Blob |
+			    MEM_Null)) == MEM_Int) {
+		sql_cursor_add_filter(pCrsr, pOp->p2, pOp->p4.i,
+				      pIn3->u.i);
+	}
+	break;
+}
+
 /* Opcode: SeekGE P1 P2 P3 P4 P5
  * Synopsis: key=r[P3@P4]
  *
@@ -4080,7 +4195,15 @@ case OP_Rewind: {        /* jump */
 	pC->seekOp = OP_Rewind;
 #endif
 	if (isSorter(pC)) {
-		rc = sqlite3VdbeSorterRewind(pC, &res);
+		bool may_yield = vdbe_may_yield(p);
+		rc = sqlite3VdbeSorterRewind(pC, may_yield, &res);
+		if (rc == SQLITE_OK && may_yield &&
+		    box_schema_version() != p->schema_ver) {
+			p->expired = 1;
+			rc = SQLITE_ERROR;
+			sqlite3VdbeError(p, "schema version has changed: " \
+					    "need to re-compile SQL statement");
+		}
 	} else {
 		assert(pC->eCurType==CURTYPE_TARANTOOL);
 		pCrsr = pC->uc.pCursor;
@@ -4276,6 +4399,8 @@ case OP_IdxInsert: {        /* in2 */
 			rc = tarantoolSqlite3EphemeralInsert(pBtCur->space,
 							     pIn2->z,
 							     pIn2->z + pIn2->n);
+			if (rc == SQLITE_OK)
+				rc = sql_ephemeral_check_memory(p);
 		} else {
 			unreachable();
 		}
@@ -4528,6 +4653,8 @@ case OP_ResetSorter: {
 		assert(pC->uc.pCursor->curFlags & BTCF_TEphemCursor);
 		rc = tarantoolSqlite3EphemeralClearTable(pC->uc.pCursor);
 		if (rc) goto abort_due_to_error;
+		/* The table is replaced with a new one. */
+		pC->key_def = pC->uc.pCursor->index->def->key_def;
 	}
 	break;
 }
@@ -4796,9 +4923,7 @@ case OP_Program: {        /* jump */
 		pFrame->aOp = p->aOp;
 		pFrame->nOp = p->nOp;
 		pFrame->token = pProgram->token;
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 		pFrame->anExec = p->anExec;
-#endif
 
 		pEnd = &VdbeFrameMem(pFrame)[pFrame->nChildMem];
 		for(pMem=VdbeFrameMem(pFrame); pMem!=pEnd; pMem++) {
@@ -4828,9 +4953,7 @@ case OP_Program: {        /* jump */
 	p->apCsr = (VdbeCursor **)&aMem[p->nMem];
 	p->aOp = aOp = pProgram->aOp;
 	p->nOp = pProgram->nOp;
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 	p->anExec = 0;
-#endif
 	pOp = &aOp[-1];
 
 	break;
@@ -5264,6 +5387,8 @@ default: {          /* This is really OP_Noop and OP_Explain */
  ****************************************************************************/
 		}
 
+		if (op_time != NULL)
+			*op_time += clock_monotonic64() - op_start;
 #ifdef VDBE_PROFILE
 		{
 			u64 endTime = sqlite3Hwtime();
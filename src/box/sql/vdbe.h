@@ -344,10 +344,7 @@ void sqlite3VdbeSetLineNumber(Vdbe *, int);
 #define VDBE_OFFSET_LINENO(x) 0
 #endif
 
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 void sqlite3VdbeScanStatus(Vdbe *, int, int, int, LogEst, const char *);
-#else
-#define sqlite3VdbeScanStatus(a,b,c,d,e)
-#endif
+void sqlite3VdbeScanStatusEnd(Vdbe *, int, int);
 
 #endif				/* SQLITE_VDBE_H */
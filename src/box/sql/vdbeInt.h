@@ -326,6 +326,7 @@ struct ScanStatus {
 	int addrExplain;	/* OP_Explain for loop */
 	int addrLoop;		/* Address of "loops" counter */
 	int addrVisit;		/* Address of "rows visited" counter */
+	int addrEnd;		/* First address past the loop */
 	int iSelectID;		/* The "Select-ID" for this loop */
 	LogEst nEst;		/* Estimated output rows per loop */
 	char *zName;		/* Name of table or index */
@@ -393,6 +394,7 @@ struct Vdbe {
 	bft changeCntOn:1;	/* True to update the change-counter */
 	bft runOnlyOnce:1;	/* Automatically expire on reset */
 	bft isPrepareV2:1;	/* True if prepared with prepare_v2() */
+	bft is_read_only:1;	/* True if the program doesn't modify spaces */
 	u32 aCounter[5];	/* Counters used by sqlite3_stmt_status() */
 	char *zSql;		/* Text of the SQL statement that generated this */
 	void *pFree;		/* Free this when deleting the vdbe */
@@ -404,11 +406,20 @@ struct Vdbe {
 	AuxData *pAuxData;	/* Linked list of auxdata allocations */
 	/* Anonymous savepoint for aborts only */
 	Savepoint *anonymous_savepoint;
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
-	i64 *anExec;		/* Number of times each op has been executed */
+	/**
+	 * Number of times each op has been executed. Allocated
+	 * for EXPLAIN ANALYZE only, NULL otherwise.
+	 */
+	i64 *anExec;
+	/** Nanoseconds spent in each op, same as anExec. */
+	u64 *anTime;
 	int nScan;		/* Entries in aScan[] */
-	ScanStatus *aScan;	/* Scan definitions for sqlite3_stmt_scanstatus() */
-#endif
+	ScanStatus *aScan;	/* Loops reported by EXPLAIN ANALYZE */
+	/**
+	 * Next op to look for OP_Explain in when EXPLAIN ANALYZE
+	 * lists its report, -1 if the program is not run yet.
+	 */
+	int iScanOp;
 };
 
 /*
@@ -438,6 +449,7 @@ void sqlite3VdbeDeleteAuxData(sqlite3 *, AuxData **, int, int);
 
 int sqlite3VdbeExec(Vdbe *);
 int sqlite3VdbeList(Vdbe *);
+int sqlite3VdbeListScans(Vdbe *);
 int
 sql_txn_begin(Vdbe *p);
 Savepoint *
@@ -484,7 +496,7 @@ void sqlite3VdbeSorterReset(sqlite3 *, VdbeSorter *);
 void sqlite3VdbeSorterClose(sqlite3 *, VdbeCursor *);
 int sqlite3VdbeSorterRowkey(const VdbeCursor *, Mem *);
 int sqlite3VdbeSorterNext(sqlite3 *, const VdbeCursor *, int *);
-int sqlite3VdbeSorterRewind(const VdbeCursor *, int *);
+int sqlite3VdbeSorterRewind(const VdbeCursor *, bool, int *);
 int sqlite3VdbeSorterWrite(const VdbeCursor *, Mem *);
 int sqlite3VdbeSorterCompare(const VdbeCursor *, Mem *, int, int *);
 
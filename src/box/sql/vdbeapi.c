@@ -502,6 +502,13 @@ sqlite3Step(Vdbe * p)
 	int rc;
 
 	assert(p);
+	if (p->explain == 3 && p->iScanOp >= 0) {
+		/*
+		 * EXPLAIN ANALYZE has run the program to the end,
+		 * only its report is left.
+		 */
+		return sqlite3VdbeListScans(p);
+	}
 	if (p->magic != VDBE_MAGIC_RUN) {
 		/* We used to require that sqlite3_reset() be called before retrying
 		 * sqlite3_step() after any error or after SQLITE_DONE.  But beginning
@@ -563,7 +570,21 @@ sqlite3Step(Vdbe * p)
 		db->nVdbeActive++;
 		p->pc = 0;
 	}
-	if (p->explain) {
+	if (p->explain == 3) {
+		/*
+		 * Run the program discarding its result rows and
+		 * then give the collected statistics instead.
+		 */
+		db->nVdbeExec++;
+		do {
+			rc = sqlite3VdbeExec(p);
+		} while (rc == SQLITE_ROW);
+		db->nVdbeExec--;
+		if (rc == SQLITE_DONE) {
+			p->iScanOp = 0;
+			rc = sqlite3VdbeListScans(p);
+		}
+	} else if (p->explain) {
 		rc = sqlite3VdbeList(p);
 	} else {
 		db->nVdbeExec++;
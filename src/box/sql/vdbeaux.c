@@ -657,8 +657,26 @@ resolveP2Values(Vdbe * p, int *pMaxFuncArgs)
 	Op *pOp;
 	Parse *pParse = p->pParse;
 	int *aLabel = pParse->aLabel;
+	p->is_read_only = 1;
 	pOp = &p->aOp[p->nOp - 1];
 	while (1) {
+		/*
+		 * Spaces can be modified only through cursors
+		 * opened with OpenWrite, system space opcodes used
+		 * by DDL and by triggers.
+		 */
+		switch (pOp->opcode) {
+		case OP_OpenWrite:
+		case OP_SInsert:
+		case OP_SDelete:
+		case OP_Clear:
+		case OP_RenameTable:
+		case OP_DropTable:
+		case OP_DropIndex:
+		case OP_Program:
+			p->is_read_only = 0;
+			break;
+		}
 
 		/* Only JUMP opcodes and the short list of special opcodes in the switch
 		 * below need to be considered.  The mkopcodeh.sh generator script groups
@@ -752,9 +770,8 @@ sqlite3VdbeTakeOpArray(Vdbe * p, int *pnOp, int *pnMaxArg)
 	return aOp;
 }
 
-#if defined(SQLITE_ENABLE_STMT_SCANSTATUS)
 /*
- * Add an entry to the array of counters managed by sqlite3_stmt_scanstatus().
+ * Add an entry to the array of loops reported by EXPLAIN ANALYZE.
  */
 void
 sqlite3VdbeScanStatus(Vdbe * p,			/* VM to add scanstatus() to */
@@ -772,12 +789,28 @@ sqlite3VdbeScanStatus(Vdbe * p,			/* VM to add scanstatus() to */
 		pNew->addrExplain = addrExplain;
 		pNew->addrLoop = addrLoop;
 		pNew->addrVisit = addrVisit;
+		pNew->addrEnd = addrLoop;
 		pNew->nEst = nEst;
 		pNew->zName = sqlite3DbStrDup(p->db, zName);
 		p->aScan = aNew;
 	}
 }
-#endif
+
+/*
+ * Set the end address of the loop that starts at addrLoop, so
+ * that EXPLAIN ANALYZE can sum the time spent in its ops.
+ */
+void
+sqlite3VdbeScanStatusEnd(Vdbe * p, int addrLoop, int addrEnd)
+{
+	int i;
+	for (i = 0; i < p->nScan; i++) {
+		if (p->aScan[i].addrLoop == addrLoop) {
+			p->aScan[i].addrEnd = addrEnd;
+			break;
+		}
+	}
+}
 
 /*
  * Change the value of the opcode, or P1, P2, P3, or P5 operands
@@ -1725,6 +1758,88 @@ sqlite3VdbeList(Vdbe * p)
 	return rc;
 }
 
+/*
+ * Give the report of EXPLAIN ANALYZE once sqlite3VdbeExec() has
+ * run the program to the end.
+ *
+ * The interface is the same as sqlite3VdbeList(). Like for
+ * EXPLAIN QUERY PLAN, a row is returned for each OP_Explain
+ * instruction, but it is extended with the number of times the
+ * loop was started, the number of rows it visited and the
+ * seconds spent in the loop, inner loops included. These columns
+ * are NULL for instructions that do not describe a loop.
+ */
+int
+sqlite3VdbeListScans(Vdbe * p)
+{
+	Mem *pMem = &p->aMem[1];
+	int i = p->iScanOp;
+
+	assert(p->explain == 3 && p->iScanOp >= 0);
+	assert(p->nMem > 7);
+	releaseMemArray(pMem, 7);
+	p->pResultSet = 0;
+	while (i < p->nOp && p->aOp[i].opcode != OP_Explain)
+		i++;
+	if (i >= p->nOp) {
+		p->iScanOp = -1;
+		p->rc = SQLITE_OK;
+		return SQLITE_DONE;
+	}
+	p->iScanOp = i + 1;
+	Op *pOp = &p->aOp[i];
+	ScanStatus *pScan = NULL;
+	for (int j = 0; j < p->nScan; j++) {
+		if (p->aScan[j].addrExplain == i) {
+			pScan = &p->aScan[j];
+			break;
+		}
+	}
+
+	pMem->flags = MEM_Int;
+	pMem->u.i = pOp->p1;	/* Select id */
+	pMem++;
+
+	pMem->flags = MEM_Int;
+	pMem->u.i = pOp->p2;	/* Order */
+	pMem++;
+
+	pMem->flags = MEM_Int;
+	pMem->u.i = pOp->p3;	/* From */
+	pMem++;
+
+	pMem->flags = MEM_Static | MEM_Str | MEM_Term;
+	pMem->z = pOp->p4.z;	/* Detail */
+	pMem->n = sqlite3Strlen30(pMem->z);
+	pMem++;
+
+	if (pScan != NULL) {
+		u64 time = 0;
+		for (int j = pScan->addrLoop; j < pScan->addrEnd; j++)
+			time += p->anTime[j];
+		pMem->flags = MEM_Int;
+		pMem->u.i = p->anExec[pScan->addrLoop];	/* Loops */
+		pMem++;
+
+		pMem->flags = MEM_Int;
+		pMem->u.i = p->anExec[pScan->addrVisit];	/* Rows */
+		pMem++;
+
+		pMem->flags = MEM_Real;
+		pMem->u.r = (double) time / 1e9;	/* Time */
+	} else {
+		pMem->flags = MEM_Null;
+		pMem++;
+		pMem->flags = MEM_Null;
+		pMem++;
+		pMem->flags = MEM_Null;
+	}
+
+	p->pResultSet = &p->aMem[1];
+	p->rc = SQLITE_OK;
+	return SQLITE_ROW;
+}
+
 #ifdef SQLITE_DEBUG
 /*
  * Print the SQL that was used to generate a VDBE program.
@@ -1860,6 +1975,11 @@ sqlite3VdbeRewind(Vdbe * p)
 	p->cacheCtr = 1;
 	p->iStatement = 0;
 	p->nFkConstraint = 0;
+	p->iScanOp = -1;
+	if (p->anExec != NULL) {
+		memset(p->anExec, 0, p->nOp * sizeof(i64));
+		memset(p->anTime, 0, p->nOp * sizeof(u64));
+	}
 #ifdef VDBE_PROFILE
 	for (i = 0; i < p->nOp; i++) {
 		p->aOp[i].cnt = 0;
@@ -1954,9 +2074,12 @@ sqlite3VdbeMakeReady(Vdbe * p,	/* The VDBE */
 		p->apArg = allocSpace(&x, p->apArg, nArg * sizeof(Mem *));
 		p->apCsr =
 		    allocSpace(&x, p->apCsr, nCursor * sizeof(VdbeCursor *));
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
-		p->anExec = allocSpace(&x, p->anExec, p->nOp * sizeof(i64));
-#endif
+		if (pParse->explain == 3) {
+			p->anExec = allocSpace(&x, p->anExec,
+					       p->nOp * sizeof(i64));
+			p->anTime = allocSpace(&x, p->anTime,
+					       p->nOp * sizeof(u64));
+		}
 		if (x.nNeeded == 0)
 			break;
 		x.pSpace = p->pFree = sqlite3DbMallocRawNN(db, x.nNeeded);
@@ -1977,9 +2100,6 @@ sqlite3VdbeMakeReady(Vdbe * p,	/* The VDBE */
 		p->nMem = nMem;
 		initMemArray(p->aMem, nMem, db, MEM_Undefined);
 		memset(p->apCsr, 0, nCursor * sizeof(VdbeCursor *));
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
-		memset(p->anExec, 0, p->nOp * sizeof(i64));
-#endif
 	}
 	sqlite3VdbeRewind(p);
 }
@@ -2035,9 +2155,7 @@ sqlite3VdbeFrameRestore(VdbeFrame * pFrame)
 {
 	Vdbe *v = pFrame->v;
 	closeCursorsInFrame(v);
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 	v->anExec = pFrame->anExec;
-#endif
 	v->aOp = pFrame->aOp;
 	v->nOp = pFrame->nOp;
 	v->aMem = pFrame->aMem;
@@ -2755,15 +2873,9 @@ sqlite3VdbeClearObject(sqlite3 * db, Vdbe * p)
 	vdbeFreeOpArray(db, p->aOp, p->nOp);
 	sqlite3DbFree(db, p->aColName);
 	sqlite3DbFree(db, p->zSql);
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
-	{
-		int i;
-		for (i = 0; i < p->nScan; i++) {
-			sqlite3DbFree(db, p->aScan[i].zName);
-		}
-		sqlite3DbFree(db, p->aScan);
-	}
-#endif
+	for (int i = 0; i < p->nScan; i++)
+		sqlite3DbFree(db, p->aScan[i].zName);
+	sqlite3DbFree(db, p->aScan);
 }
 
 /*
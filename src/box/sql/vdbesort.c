@@ -158,6 +158,8 @@
  */
 #include "sqliteInt.h"
 #include "vdbeInt.h"
+#include "coio_task.h"
+#include "third_party/qsort_arg.h"
 
 /*
  * If SQLITE_DEBUG_SORTER_THREADS is defined, this module outputs various
@@ -175,6 +177,20 @@
  */
 #define SQLITE_MAX_PMASZ    (1<<29)
 
+enum {
+	/**
+	 * Minimal number of records in an in-memory list to sort
+	 * it as an array with qsort_arg() rather than with the
+	 * merge sort. qsort_arg() uses several threads on large
+	 * arrays. When the statement allows it (see
+	 * sqlite3VdbeSorterRewind()), the sort is done in a coio
+	 * thread, so that the tx thread isn't blocked.
+	 */
+	SORTER_ARRAY_SORT_MIN = 16 * 1024,
+	/** Max number of key parts for the array sort. */
+	SORTER_ARRAY_SORT_MAX_PARTS = 16,
+};
+
 /*
  * Private objects used by the sorter
  */
@@ -353,6 +369,7 @@ struct VdbeSorter {
 	u8 iPrev;		/* Previous thread used to flush PMA */
 	u8 nTask;		/* Size of aTask[] array */
 	u8 typeMask;
+	u8 bMayYield;		/* True if the sort may yield */
 	SortSubtask aTask[1];	/* One or more subtasks */
 };
 
@@ -1333,6 +1350,115 @@ vdbeSorterGetCompare(VdbeSorter * p)
 	return vdbeSorterCompare;
 }
 
+/** Return the record following @a p in an unsorted list. */
+static inline SorterRecord *
+vdbeSorterListNext(SorterList *pList, SorterRecord *p)
+{
+	if (pList->aMemory == NULL)
+		return p->u.pNext;
+	if ((u8 *)p == pList->aMemory)
+		return NULL;
+	return (SorterRecord *)&pList->aMemory[p->u.iNext];
+}
+
+/** An element of an array sorted by vdbeSorterSortArray(). */
+struct sorter_array_entry {
+	SorterRecord *record;
+	/** Insertion order of the record, keeps the sort stable. */
+	uint32_t seq;
+};
+
+/**
+ * Compare two sorter records. Unlike vdbeSorterCompare(), doesn't
+ * use any shared state, so it may be called from several threads
+ * at once.
+ */
+static int
+vdbeSorterCompareEntries(const void *a, const void *b, void *arg)
+{
+	const struct sorter_array_entry *e1 = a;
+	const struct sorter_array_entry *e2 = b;
+	struct key_def *key_def = arg;
+	Mem mem[SORTER_ARRAY_SORT_MAX_PARTS];
+	struct UnpackedRecord r2;
+	memset(&r2, 0, sizeof(r2));
+	r2.key_def = key_def;
+	r2.aMem = mem;
+	r2.nField = key_def->part_count;
+
+	const char *key1 = SRVAL(e1->record);
+	const char *key2 = SRVAL(e2->record);
+	uint32_t n = mp_decode_array(&key1);
+	n = MIN(n, mp_decode_array(&key2));
+	n = MIN(n, key_def->part_count);
+	for (uint32_t i = 0; i < n; i++) {
+		u32 len = sqlite3VdbeMsgpackGet((const unsigned char *)key2,
+						&mem[i]);
+		if (len == 0)
+			mp_next(&key2);
+		else
+			key2 += len;
+		int rc = sqlite3VdbeCompareMsgpack(&key1, &r2, i);
+		if (rc != 0) {
+			if (key_def->parts[i].sort_order != SORT_ORDER_ASC)
+				rc = -rc;
+			return rc;
+		}
+	}
+	return e1->seq < e2->seq ? -1 : e1->seq > e2->seq;
+}
+
+static ssize_t
+vdbeSorterSortArrayF(va_list ap)
+{
+	struct sorter_array_entry *entries =
+		va_arg(ap, struct sorter_array_entry *);
+	uint32_t count = va_arg(ap, uint32_t);
+	struct key_def *key_def = va_arg(ap, struct key_def *);
+	qsort_arg(entries, count, sizeof(*entries),
+		  vdbeSorterCompareEntries, key_def);
+	return 0;
+}
+
+/**
+ * Sort a large in-memory list of records: collect them into an
+ * array, sort it with qsort_arg() and relink the list in the
+ * sorted order.
+ */
+static int
+vdbeSorterSortArray(SortSubtask *pTask, SorterList *pList, uint32_t count)
+{
+	struct key_def *key_def = pTask->pSorter->key_def;
+	struct sorter_array_entry *entries =
+		sqlite3Malloc(count * sizeof(*entries));
+	if (entries == NULL)
+		return SQLITE_NOMEM_BKPT;
+	/* The list is in reverse order of insertion. */
+	SorterRecord *p = pList->pList;
+	for (uint32_t i = count; i > 0; i--) {
+		entries[i - 1].record = p;
+		entries[i - 1].seq = i - 1;
+		p = vdbeSorterListNext(pList, p);
+	}
+	/*
+	 * Records are private to the sorter, so they may be
+	 * sorted in another thread, but only if the statement
+	 * allows to yield.
+	 */
+	if (pTask->pSorter->bMayYield == 0 ||
+	    coio_call(vdbeSorterSortArrayF, entries, count, key_def) != 0) {
+		qsort_arg(entries, count, sizeof(*entries),
+			  vdbeSorterCompareEntries, key_def);
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		entries[i].record->u.pNext =
+			i + 1 < count ? entries[i + 1].record : NULL;
+	}
+	pList->pList = entries[0].record;
+	sqlite3_free(entries);
+	return SQLITE_OK;
+}
+
 /*
  * Sort the linked list of records headed at pTask->pList. Return
  * SQLITE_OK if successful, or an SQLite error code (i.e. SQLITE_NOMEM) if
@@ -1353,6 +1479,16 @@ vdbeSorterSort(SortSubtask * pTask, SorterList * pList)
 	p = pList->pList;
 	pTask->xCompare = vdbeSorterGetCompare(pTask->pSorter);
 
+	if (pTask->pSorter->key_def->part_count <=
+	    SORTER_ARRAY_SORT_MAX_PARTS) {
+		uint32_t count = 0;
+		for (SorterRecord *r = p; r != NULL;
+		     r = vdbeSorterListNext(pList, r))
+			count++;
+		if (count >= SORTER_ARRAY_SORT_MIN)
+			return vdbeSorterSortArray(pTask, pList, count);
+	}
+
 	aSlot =
 	    (SorterRecord **) sqlite3MallocZero(64 * sizeof(SorterRecord *));
 	if (!aSlot) {
@@ -2641,10 +2777,12 @@ vdbeSorterSetupMerge(VdbeSorter * pSorter)
 /*
  * Once the sorter has been populated by calls to sqlite3VdbeSorterWrite,
  * this function is called to prepare for iterating through the records
- * in sorted order.
+ * in sorted order. If may_yield is true, a large in-memory list is
+ * sorted in a coio thread, and the caller must check that the schema
+ * hasn't changed while the fiber was waiting for it.
  */
 int
-sqlite3VdbeSorterRewind(const VdbeCursor * pCsr, int *pbEof)
+sqlite3VdbeSorterRewind(const VdbeCursor * pCsr, bool may_yield, int *pbEof)
 {
 	VdbeSorter *pSorter;
 	int rc = SQLITE_OK;	/* Return code */
@@ -2660,7 +2798,9 @@ sqlite3VdbeSorterRewind(const VdbeCursor * pCsr, int *pbEof)
 	if (pSorter->bUsePMA == 0) {
 		if (pSorter->list.pList) {
 			*pbEof = 0;
+			pSorter->bMayYield = may_yield;
 			rc = vdbeSorterSort(&pSorter->aTask[0], &pSorter->list);
+			pSorter->bMayYield = 0;
 		} else {
 			*pbEof = 1;
 		}
@@ -674,7 +674,6 @@ translateColumnToCopy(Vdbe * v,		/* The VDBE containing code to translate */
 	}
 }
 
-#ifndef SQLITE_OMIT_AUTOMATIC_INDEX
 /*
  * Return TRUE if the WHERE clause term pTerm is of a form where it
  * could be used with an index to access pSrc, assuming an appropriate
@@ -695,227 +694,191 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
 		return 0;
 	if (pTerm->u.leftColumn < 0)
 		return 0;
-	aff = pSrc->pTab->aCol[pTerm->u.leftColumn].affinity;
+	aff = pSrc->pTab->def->fields[pTerm->u.leftColumn].affinity;
 	if (!sqlite3IndexAffinityOk(pTerm->pExpr, aff))
 		return 0;
 	return 1;
 }
-#endif
 
-#ifndef SQLITE_OMIT_AUTOMATIC_INDEX
-/*
- * Generate code to construct the Index object for an automatic index
- * and to set up the WhereLevel object pLevel so that the code generator
- * makes use of the automatic index.
+/**
+ * Generate code to construct the Index object for an automatic
+ * index and to set up the WhereLevel object so that the code
+ * generator makes use of the automatic index.
+ *
+ * The automatic index is an ephemeral space filled with all
+ * tuples of the indexed table on the first iteration of the
+ * loop. Its key consists of the columns compared with == in
+ * the WHERE clause followed by the primary key columns, which
+ * keep the key unique. Tuples are stored as is (columns not
+ * used by the query are replaced with NULLs), so OP_Column
+ * opcodes need no translation when they are redirected from
+ * the table cursor to the index cursor.
+ *
+ * @param parse The parsing context.
+ * @param wc The WHERE clause.
+ * @param src The FROM clause term to get the next index.
+ * @param not_ready Mask of cursors that are not available.
+ * @param level Write new index here.
  */
 static void
-constructAutomaticIndex(Parse * pParse,			/* The parsing context */
-			WhereClause * pWC,		/* The WHERE clause */
-			struct SrcList_item *pSrc,	/* The FROM clause term to get the next index */
-			Bitmask notReady,		/* Mask of cursors that are not available */
-			WhereLevel * pLevel)		/* Write new index here */
+constructAutomaticIndex(struct Parse *parse, struct WhereClause *wc,
+			struct SrcList_item *src, Bitmask not_ready,
+			struct WhereLevel *level)
 {
-	int nKeyCol;		/* Number of columns in the constructed index */
-	WhereTerm *pTerm;	/* A single term of the WHERE clause */
-	WhereTerm *pWCEnd;	/* End of pWC->a[] */
-	Index *pIdx;		/* Object describing the transient index */
-	Vdbe *v;		/* Prepared statement under construction */
-	int addrInit;		/* Address of the initialization bypass jump */
-	Table *pTable;		/* The table being indexed */
-	int addrTop;		/* Top of the index fill loop */
-	int regRecord;		/* Register holding an index record */
-	int n;			/* Column counter */
-	int i;			/* Loop counter */
-	int mxBitCol;		/* Maximum column in pSrc->colUsed */
-	struct coll *pColl;		/* Collating sequence to on a column */
-	WhereLoop *pLoop;	/* The Loop object */
-	char *zNotUsed;		/* Extra space on the end of pIdx */
-	Bitmask idxCols;	/* Bitmap of columns used for indexing */
-	Bitmask extraCols;	/* Bitmap of additional columns */
-	u8 sentWarning = 0;	/* True if a warnning has been issued */
-	Expr *pPartial = 0;	/* Partial Index Expression */
-	int iContinue = 0;	/* Jump here to skip excluded rows */
-	struct SrcList_item *pTabItem;	/* FROM clause term being indexed */
-	int addrCounter = 0;	/* Address where integer counter is initialized */
-	int regBase;		/* Array of registers where record is assembled */
-
-	/* Generate code to skip over the creation and initialization of the
-	 * transient index on 2nd and subsequent iterations of the loop.
+	struct sqlite3 *db = parse->db;
+	struct Vdbe *v = parse->pVdbe;
+	assert(v != NULL);
+	struct Table *table = src->pTab;
+	struct space *space = space_by_id(table->def->id);
+	assert(space != NULL && space->index_count > 0);
+	struct key_def *pk_def = space->index[0]->def->key_def;
+	struct WhereLoop *loop = level->pWLoop;
+	struct Expr *partial = NULL;
+
+	/*
+	 * Generate code to skip over the creation and
+	 * initialization of the transient index on 2nd and
+	 * subsequent iterations of the loop.
 	 */
-	v = pParse->pVdbe;
-	assert(v != 0);
-	addrInit = sqlite3VdbeAddOp0(v, OP_Once);
+	int addr_init = sqlite3VdbeAddOp0(v, OP_Once);
 	VdbeCoverage(v);
 
-	/* Count the number of columns that will be added to the index
-	 * and used to match WHERE clause constraints
+	/*
+	 * Collect terms that will be used to match WHERE clause
+	 * constraints.
 	 */
-	nKeyCol = 0;
-	pTable = pSrc->pTab;
-	pWCEnd = &pWC->a[pWC->nTerm];
-	pLoop = pLevel->pWLoop;
-	idxCols = 0;
-	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
-		Expr *pExpr = pTerm->pExpr;
-		assert(!ExprHasProperty(pExpr, EP_FromJoin)	/* prereq always non-zero */
-		       ||pExpr->iRightJoinTable != pSrc->iCursor	/*   for the right-hand   */
-		       || pLoop->prereq != 0);	/*   table of a LEFT JOIN */
-		if (pLoop->prereq == 0
-		    && (pTerm->wtFlags & TERM_VIRTUAL) == 0
-		    && !ExprHasProperty(pExpr, EP_FromJoin)
-		    && sqlite3ExprIsTableConstant(pExpr, pSrc->iCursor)) {
-			pPartial = sqlite3ExprAnd(pParse->db, pPartial,
-						  sqlite3ExprDup(pParse->db,
-								 pExpr, 0));
-		}
-		if (termCanDriveIndex(pTerm, pSrc, notReady)) {
-			int iCol = pTerm->u.leftColumn;
-			Bitmask cMask =
-			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
-			testcase(iCol == BMS);
-			testcase(iCol == BMS - 1);
-			if (!sentWarning) {
-				sqlite3_log(SQLITE_WARNING_AUTOINDEX,
-					    "automatic index on %s(%s)",
-					    pTable->def->name,
-					    pTable->aCol[iCol].zName);
-				sentWarning = 1;
-			}
-			if ((idxCols & cMask) == 0) {
-				if (whereLoopResize
-				    (pParse->db, pLoop, nKeyCol + 1)) {
-					goto end_auto_index_create;
-				}
-				pLoop->aLTerm[nKeyCol++] = pTerm;
-				idxCols |= cMask;
-			}
+	uint32_t key_count = 0;
+	Bitmask idx_cols = 0;
+	struct WhereTerm *wc_end = &wc->a[wc->nTerm];
+	for (struct WhereTerm *term = wc->a; term < wc_end; term++) {
+		struct Expr *expr = term->pExpr;
+		if (loop->prereq == 0 && (term->wtFlags & TERM_VIRTUAL) == 0 &&
+		    !ExprHasProperty(expr, EP_FromJoin) &&
+		    sqlite3ExprIsTableConstant(expr, src->iCursor)) {
+			partial = sqlite3ExprAnd(db, partial,
+						 sqlite3ExprDup(db, expr, 0));
 		}
+		if (!termCanDriveIndex(term, src, not_ready))
+			continue;
+		int col = term->u.leftColumn;
+		Bitmask mask = col >= BMS ? MASKBIT(BMS - 1) : MASKBIT(col);
+		if ((idx_cols & mask) != 0)
+			continue;
+		if (whereLoopResize(db, loop, key_count + 1) != 0)
+			goto end_auto_index_create;
+		loop->aLTerm[key_count++] = term;
+		idx_cols |= mask;
 	}
-	assert(nKeyCol > 0);
-	pLoop->nEq = pLoop->nLTerm = nKeyCol;
-	pLoop->wsFlags = WHERE_COLUMN_EQ | WHERE_IDX_ONLY | WHERE_INDEXED
-	    | WHERE_AUTO_INDEX;
-
-	/* Count the number of additional columns needed to create a
-	 * covering index.  A "covering index" is an index that contains all
-	 * columns that are needed by the query.  With a covering index, the
-	 * original table never needs to be accessed.  Automatic indices must
-	 * be a covering index because the index will not be updated if the
-	 * original table changes and the index and table cannot both be used
-	 * if they go out of sync.
+	assert(key_count > 0);
+	loop->nEq = loop->nLTerm = key_count;
+	loop->wsFlags = WHERE_COLUMN_EQ | WHERE_IDX_ONLY | WHERE_INDEXED |
+			WHERE_AUTO_INDEX;
+
+	/*
+	 * Primary key columns are appended to the key to make it
+	 * unique. They are appended even if they are among the
+	 * key columns, since a key column may be compared using
+	 * a collation other than the primary key one.
 	 */
-	extraCols = pSrc->colUsed & (~idxCols | MASKBIT(BMS - 1));
-	mxBitCol = MIN(BMS - 1, pTable->def->field_count);
-	testcase(pTable->def->field_count == BMS - 1);
-	testcase(pTable->def->field_count == BMS - 2);
-	for (i = 0; i < mxBitCol; i++) {
-		if (extraCols & MASKBIT(i))
-			nKeyCol++;
+	uint32_t part_count = key_count + pk_def->part_count;
+	struct key_def *key_def = key_def_new(part_count);
+	if (key_def == NULL) {
+		parse->rc = SQL_TARANTOOL_ERROR;
+		parse->nErr++;
+		goto end_auto_index_create;
+	}
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct Expr *expr = loop->aLTerm[i]->pExpr;
+		uint32_t coll_id;
+		struct coll *coll =
+			sql_binary_compare_coll_seq(parse, expr->pLeft,
+						    expr->pRight, &coll_id);
+		key_def_set_part(key_def, i, loop->aLTerm[i]->u.leftColumn,
+				 FIELD_TYPE_SCALAR, ON_CONFLICT_ACTION_NONE,
+				 coll, coll_id, SORT_ORDER_ASC);
 	}
-	if (pSrc->colUsed & MASKBIT(BMS - 1)) {
-		nKeyCol += pTable->def->field_count - BMS + 1;
+	for (uint32_t i = 0; i < pk_def->part_count; i++) {
+		struct key_part *part = &pk_def->parts[i];
+		key_def_set_part(key_def, key_count + i, part->fieldno,
+				 FIELD_TYPE_SCALAR, ON_CONFLICT_ACTION_NONE,
+				 part->coll, part->coll_id, SORT_ORDER_ASC);
 	}
 
-	/* Construct the Index object to describe this index */
-	pIdx = sqlite3DbMallocZero(pParse->db, sizeof(*pIdx));
-	if (pIdx == 0)
+	/* Construct the Index object to describe this index. */
+	struct Index *idx = sqlite3DbMallocZero(db, sizeof(*idx));
+	if (idx == NULL) {
+		key_def_delete(key_def);
+		goto end_auto_index_create;
+	}
+	idx->def = index_def_new(table->def->id, BOX_INDEX_MAX, "auto-index",
+				 strlen("auto-index"), TREE,
+				 &index_opts_default, key_def, NULL);
+	key_def_delete(key_def);
+	if (idx->def == NULL) {
+		sqlite3DbFree(db, idx);
+		parse->rc = SQL_TARANTOOL_ERROR;
+		parse->nErr++;
 		goto end_auto_index_create;
-	pLoop->pIndex = pIdx;
-	pIdx->zName = "auto-index";
-	pIdx->pTable = pTable;
-	n = 0;
-	idxCols = 0;
-	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
-		if (termCanDriveIndex(pTerm, pSrc, notReady)) {
-			int iCol = pTerm->u.leftColumn;
-			Bitmask cMask =
-			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
-			testcase(iCol == BMS - 1);
-			testcase(iCol == BMS);
-			if ((idxCols & cMask) == 0) {
-				Expr *pX = pTerm->pExpr;
-				idxCols |= cMask;
-				pIdx->aiColumn[n] = pTerm->u.leftColumn;
-				n++;
-			}
-		}
 	}
-	assert((u32) n == pLoop->nEq);
+	idx->pTable = table;
+	idx->index_type = SQL_INDEX_TYPE_NON_UNIQUE;
+	loop->pIndex = idx;
+
+	/* Create the automatic index. */
+	uint32_t field_count = table->def->field_count;
+	level->iIdxCur = parse->nTab++;
+	sqlite3VdbeAddOp2(v, OP_OpenAutoindex, level->iIdxCur, field_count);
+	sql_vdbe_set_p4_key_def(parse, idx);
+	VdbeComment((v, "for %s", table->def->name));
 
-	/* Add additional columns needed to make the automatic index into
-	 * a covering index
+	/*
+	 * Fill the automatic index with content. Only columns
+	 * which are used by the query or are part of the key are
+	 * read from the table.
 	 */
-	for (i = 0; i < mxBitCol; i++) {
-		if (extraCols & MASKBIT(i)) {
-			pIdx->aiColumn[n] = i;
-			n++;
-		}
-	}
-	if (pSrc->colUsed & MASKBIT(BMS - 1)) {
-		for (i = BMS - 1; i < (int)pTable->def->field_count; i++) {
-			pIdx->aiColumn[n] = i;
-			n++;
-		}
-	}
-	assert(n == nKeyCol);
-	pIdx->aiColumn[n] = XN_ROWID;
-
-	/* Create the automatic index */
-	assert(pLevel->iIdxCur >= 0);
-	pLevel->iIdxCur = pParse->nTab++;
-	sqlite3VdbeAddOp2(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol + 1);
-	sql_vdbe_set_p4_key_def(pParse, pIdx);
-	VdbeComment((v, "for %s", pTable->def->name));
-
-	/* Fill the automatic index with content */
-	sqlite3ExprCachePush(pParse);
-	pTabItem = &pWC->pWInfo->pTabList->a[pLevel->iFrom];
-	if (pTabItem->fg.viaCoroutine) {
-		int regYield = pTabItem->regReturn;
-		addrCounter = sqlite3VdbeAddOp2(v, OP_Integer, 0, 0);
-		sqlite3VdbeAddOp3(v, OP_InitCoroutine, regYield, 0,
-				  pTabItem->addrFillSub);
-		addrTop = sqlite3VdbeAddOp1(v, OP_Yield, regYield);
-		VdbeCoverage(v);
-		VdbeComment((v, "next row of \"%s\"", pTabItem->pTab->zName));
-	} else {
-		addrTop = sqlite3VdbeAddOp1(v, OP_Rewind, pLevel->iTabCur);
-		VdbeCoverage(v);
-	}
-	if (pPartial) {
-		iContinue = sqlite3VdbeMakeLabel(v);
-		sqlite3ExprIfFalse(pParse, pPartial, iContinue,
+	Bitmask used = src->colUsed | idx_cols;
+	sqlite3ExprCachePush(parse);
+	int addr_top = sqlite3VdbeAddOp1(v, OP_Rewind, level->iTabCur);
+	VdbeCoverage(v);
+	int label_continue = 0;
+	if (partial != NULL) {
+		label_continue = sqlite3VdbeMakeLabel(v);
+		sqlite3ExprIfFalse(parse, partial, label_continue,
 				   SQLITE_JUMPIFNULL);
-		pLoop->wsFlags |= WHERE_PARTIALIDX;
+		loop->wsFlags |= WHERE_PARTIALIDX;
 	}
-	regRecord = sqlite3GetTempReg(pParse);
-	regBase = sql_generate_index_key(pParse, pIdx, pLevel->iTabCur,
-					 regRecord, NULL, NULL, 0);
-	sqlite3VdbeAddOp2(v, OP_IdxInsert, pLevel->iIdxCur, regRecord);
-	if (pPartial)
-		sql_resolve_part_idx_label(v, iContinue);
-	if (pTabItem->fg.viaCoroutine) {
-		sqlite3VdbeChangeP2(v, addrCounter, regBase + n);
-		translateColumnToCopy(v, addrTop, pLevel->iTabCur,
-				      pTabItem->regResult, 1);
-		sqlite3VdbeGoto(v, addrTop);
-		pTabItem->fg.viaCoroutine = 0;
-	} else {
-		sqlite3VdbeAddOp2(v, OP_Next, pLevel->iTabCur, addrTop + 1);
-		VdbeCoverage(v);
+	int reg_base = sqlite3GetTempRange(parse, field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		Bitmask mask = i >= BMS - 1 ? MASKBIT(BMS - 1) : MASKBIT(i);
+		bool is_key_part = key_def_find(idx->def->key_def, i) != NULL;
+		if ((used & mask) != 0 || is_key_part) {
+			sqlite3ExprCodeGetColumnOfTable(v, table->def,
+							level->iTabCur, i,
+							reg_base + i);
+		} else {
+			sqlite3VdbeAddOp2(v, OP_Null, 0, reg_base + i);
+		}
 	}
+	int reg_record = sqlite3GetTempReg(parse);
+	sqlite3VdbeAddOp3(v, OP_MakeRecord, reg_base, field_count,
+			  reg_record);
+	sqlite3VdbeAddOp2(v, OP_IdxInsert, level->iIdxCur, reg_record);
+	if (partial != NULL)
+		sqlite3VdbeResolveLabel(v, label_continue);
+	sqlite3VdbeAddOp2(v, OP_Next, level->iTabCur, addr_top + 1);
+	VdbeCoverage(v);
 	sqlite3VdbeChangeP5(v, SQLITE_STMTSTATUS_AUTOINDEX);
-	sqlite3VdbeJumpHere(v, addrTop);
-	sqlite3ReleaseTempReg(pParse, regRecord);
-	sqlite3ExprCachePop(pParse);
+	sqlite3VdbeJumpHere(v, addr_top);
+	sqlite3ReleaseTempReg(parse, reg_record);
+	sqlite3ReleaseTempRange(parse, reg_base, field_count);
+	sqlite3ExprCachePop(parse);
 
-	/* Jump here when skipping the initialization */
-	sqlite3VdbeJumpHere(v, addrInit);
+	/* Jump here when skipping the initialization. */
+	sqlite3VdbeJumpHere(v, addr_init);
 
  end_auto_index_create:
-	sqlite3ExprDelete(pParse->db, pPartial);
+	sql_expr_delete(db, partial, false);
 }
-#endif				/* SQLITE_OMIT_AUTOMATIC_INDEX */
 
 /*
  * Estimate the location of a particular key among all keys in an
@@ -1772,9 +1735,10 @@ whereLoopInit(WhereLoop * p)
 static void
 whereLoopClearUnion(sqlite3 * db, WhereLoop * p)
 {
-	if ((p->wsFlags & WHERE_AUTO_INDEX) != 0 &&
-	    (p->wsFlags & WHERE_AUTO_INDEX) != 0 && p->pIndex != 0) {
+	if ((p->wsFlags & WHERE_AUTO_INDEX) != 0 && p->pIndex != 0) {
 		sqlite3DbFree(db, p->pIndex->zColAff);
+		if (p->pIndex->def != NULL)
+			index_def_delete(p->pIndex->def);
 		sqlite3DbFree(db, p->pIndex);
 		p->pIndex = 0;
 	}
@@ -2811,6 +2775,36 @@ whereUsablePartialIndex(int iTab, WhereClause * pWC, Expr * pWhere)
 	return 0;
 }
 
+/**
+ * Check if all columns of a table referenced by the query can
+ * be read from a secondary index without fetching full tuples.
+ * Keys of secondary indexes are extended with the primary key
+ * parts (see index_def::cmp_def), so these columns are stored
+ * in the index as well.
+ *
+ * @param space Space the index belongs to.
+ * @param iid Index identifier.
+ * @param col_used Mask of columns used by the query.
+ * @retval true if the index contains all used columns.
+ */
+static bool
+index_is_key_only(struct space *space, uint32_t iid, Bitmask col_used)
+{
+	if (iid == 0 || (col_used & MASKBIT(BMS - 1)) != 0)
+		return false;
+	struct index *index = space_index(space, iid);
+	if (index == NULL)
+		return false;
+	struct key_def *cmp_def = index->def->cmp_def;
+	Bitmask key_cols = 0;
+	for (uint32_t i = 0; i < cmp_def->part_count; ++i) {
+		uint32_t fieldno = cmp_def->parts[i].fieldno;
+		if (fieldno < BMS - 1)
+			key_cols |= MASKBIT(fieldno);
+	}
+	return (col_used & ~key_cols) == 0;
+}
+
 /*
  * Add all WhereLoop objects for a single table of the join where the table
  * is identified by pBuilder->pNew->iTab.
@@ -2872,6 +2866,9 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 	pSrc = pTabList->a + pNew->iTab;
 	pTab = pSrc->pTab;
 	pWC = pBuilder->pWC;
+	struct space *space = NULL;
+	if ((pTab->tabFlags & TF_Ephemeral) == 0 && !pTab->def->opts.is_view)
+		space = space_by_id(pTab->def->id);
 
 	if (pSrc->pIBIndex) {
 		/* An INDEXED BY clause specifies a particular index to use */
@@ -2937,16 +2934,21 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 		pProbe = &fake_index;
 	}
 
-#ifndef SQLITE_OMIT_AUTOMATIC_INDEX
 	/* Automatic indexes */
-	LogEst rSize = pTab->nRowLogEst;
+	rSize = sql_space_tuple_log_count(pTab);
 	LogEst rLogSize = estLog(rSize);
 	struct session *user_session = current_session();
+	assert(sqlite3LogEst(1000) == SQL_AUTOINDEX_MIN_ROWS_LOG_EST);
 	if (!pBuilder->pOrSet	/* Not part of an OR optimization */
-	    && (pWInfo->wctrlFlags & WHERE_OR_SUBCLAUSE) == 0 && (user_session->sql_flags & SQLITE_AutoIndex) != 0 && pSrc->pIBIndex == 0	/* Has no INDEXED BY clause */
+	    && (pWInfo->wctrlFlags & WHERE_OR_SUBCLAUSE) == 0
+	    && (pWInfo->wctrlFlags & WHERE_ONEPASS_DESIRED) == 0
+	    && (user_session->sql_flags & SQLITE_AutoIndex) != 0
+	    && pSrc->pIBIndex == 0	/* Has no INDEXED BY clause */
 	    && !pSrc->fg.notIndexed	/* Has no NOT INDEXED clause */
-	    && HasRowid(pTab)	/* Not WITHOUT ROWID table. (FIXME: Why not?) */
-	    &&!pSrc->fg.isCorrelated	/* Not a correlated subquery */
+	    && space != NULL	/* Not a view or a subquery */
+	    && space->index_count > 0
+	    && rSize >= SQL_AUTOINDEX_MIN_ROWS_LOG_EST
+	    && !pSrc->fg.isCorrelated	/* Not a correlated subquery */
 	    && !pSrc->fg.isRecursive	/* Not a recursive common table expression. */
 	    ) {
 		/* Generate auto-index WhereLoops */
@@ -2963,18 +2965,9 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 				pNew->aLTerm[0] = pTerm;
 				/* TUNING: One-time cost for computing the automatic index is
 				 * estimated to be X*N*log2(N) where N is the number of rows in
-				 * the table being indexed and where X is 7 (LogEst=28) for normal
-				 * tables or 1.375 (LogEst=4) for views and subqueries.  The value
-				 * of X is smaller for views and subqueries so that the query planner
-				 * will be more aggressive about generating automatic indexes for
-				 * those objects, since there is no opportunity to add schema
-				 * indexes on subqueries and views.
+				 * the table being indexed and where X is 7 (LogEst=28).
 				 */
-				pNew->rSetup = rLogSize + rSize + 4;
-				if (pTab->pSelect == 0
-				    && (pTab->tabFlags & TF_Ephemeral) == 0) {
-					pNew->rSetup += 24;
-				}
+				pNew->rSetup = rLogSize + rSize + 28;
 				if (pNew->rSetup < 0)
 					pNew->rSetup = 0;
 				/* TUNING: Each index lookup yields 20 rows in the table.  This
@@ -2992,7 +2985,6 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 			}
 		}
 	}
-#endif				/* SQLITE_OMIT_AUTOMATIC_INDEX */
 
 	/* Loop over all indices
 	 */
@@ -3033,6 +3025,11 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 				break;
 		} else {
 			pNew->wsFlags = WHERE_IDX_ONLY | WHERE_INDEXED;
+			bool is_key_only = space != NULL &&
+				index_is_key_only(space, pProbe->def->iid,
+						  pSrc->colUsed);
+			if (is_key_only)
+				pNew->wsFlags |= WHERE_KEY_ONLY;
 			/* Full scan via index */
 			pNew->iSortIdx = b ? iSortIdx : 0;
 
@@ -3046,6 +3043,14 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 			 * are not really store any data (only pointers to tuples).
 			 */
 			int notPkPenalty = IsPrimaryKeyIndex(pProbe) ? 0 : 4;
+			/*
+			 * Vinyl secondary indexes store only key
+			 * parts on disk, so a scan of such an index
+			 * that doesn't need full tuples is cheaper
+			 * than a scan of the primary key.
+			 */
+			if (is_key_only && !space_is_memtx(space))
+				notPkPenalty = -2;
 			pNew->rRun = rSize + 16 + notPkPenalty;
 			whereLoopOutputAdjust(pWC, pNew, rSize);
 			rc = whereLoopInsert(pBuilder, pNew);
@@ -4768,27 +4773,42 @@ sqlite3WhereBegin(Parse * pParse,	/* The parser context */
 			pLevel->iIdxCur = iIndexCur;
 			assert(iIndexCur >= 0);
 			if (op) {
+				uint32_t iid;
 				if (pIx != NULL) {
 					uint32_t space_id =
 						pIx->pTable->def->id;
-					struct space *space =
-						space_by_id(space_id);
-					vdbe_emit_open_cursor(pParse, iIndexCur,
-							      pIx->def->iid,
-							      space);
+					space = space_by_id(space_id);
+					iid = pIx->def->iid;
+				} else {
+					iid = idx_def->iid;
+				}
+				/*
+				 * Cursors of read-only loops are opened
+				 * with OpenRead, so that VDBE may use
+				 * read-only optimizations for them.
+				 */
+				if (op == OP_OpenRead) {
+					vdbe_emit_open_read_cursor(pParse,
+								   iIndexCur,
+								   iid, space);
 				} else {
 					vdbe_emit_open_cursor(pParse, iIndexCur,
-							      idx_def->iid,
-							      space);
+							      iid, space);
 				}
+				u16 p5 = 0;
 				if ((pLoop->wsFlags & WHERE_CONSTRAINT) != 0
 				    && (pLoop->
 					wsFlags & (WHERE_COLUMN_RANGE |
 						   WHERE_SKIPSCAN)) == 0
 				    && (pWInfo->
 					wctrlFlags & WHERE_ORDERBY_MIN) == 0) {
-					sqlite3VdbeChangeP5(v, OPFLAG_SEEKEQ);	/* Hint to COMDB2 */
+					p5 |= OPFLAG_SEEKEQ;	/* Hint to COMDB2 */
 				}
+				if (op == OP_OpenRead &&
+				    (pLoop->wsFlags & WHERE_KEY_ONLY) != 0)
+					p5 |= OPFLAG_KEY_ONLY;
+				if (p5 != 0)
+					sqlite3VdbeChangeP5(v, p5);
 				if (pIx != NULL)
 					VdbeComment((v, "%s", pIx->def->name));
 				else
@@ -4834,22 +4854,20 @@ sqlite3WhereBegin(Parse * pParse,	/* The parser context */
 		int wsFlags;
 		pLevel = &pWInfo->a[ii];
 		wsFlags = pLevel->pWLoop->wsFlags;
-#ifndef SQLITE_OMIT_AUTOMATIC_INDEX
 		if ((pLevel->pWLoop->wsFlags & WHERE_AUTO_INDEX) != 0) {
 			constructAutomaticIndex(pParse, &pWInfo->sWC,
 						&pTabList->a[pLevel->iFrom],
 						notReady, pLevel);
-			if (db->mallocFailed)
+			if (db->mallocFailed || pParse->nErr != 0)
 				goto whereBeginError;
 		}
-#endif
 		addrExplain =
 		    sqlite3WhereExplainOneScan(pParse, pTabList, pLevel, ii,
 					       pLevel->iFrom, wctrlFlags);
 		pLevel->addrBody = sqlite3VdbeCurrentAddr(v);
 		notReady = sqlite3WhereCodeOneLoopStart(pWInfo, ii, notReady);
 		pWInfo->iContinue = pLevel->addrCont;
-		if ((wsFlags & WHERE_MULTI_OR) == 0
+		if (pParse->explain == 3 && (wsFlags & WHERE_MULTI_OR) == 0
 		    && (wctrlFlags & WHERE_OR_SUBCLAUSE) == 0) {
 			sqlite3WhereAddScanStatus(v, pTabList, pLevel,
 						  addrExplain);
@@ -4960,6 +4978,10 @@ sqlite3WhereEnd(WhereInfo * pWInfo)
 			}
 			sqlite3VdbeJumpHere(v, addr);
 		}
+		if (pParse->explain == 3) {
+			sqlite3VdbeScanStatusEnd(v, pLevel->addrBody,
+						 sqlite3VdbeCurrentAddr(v));
+		}
 		VdbeModuleComment((v, "End WHERE-loop%d: %s", i,
 				   pWInfo->pTabList->a[pLevel->iFrom].pTab->
 				   def->name));
@@ -106,9 +106,7 @@ struct WhereLevel {
 	} u;
 	struct WhereLoop *pWLoop;	/* The selected WhereLoop object */
 	Bitmask notReady;	/* FROM entries not usable at this level */
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 	int addrVisit;		/* Address at which row is visited */
-#endif
 };
 
 /*
@@ -463,15 +461,11 @@ int sqlite3WhereExplainOneScan(Parse * pParse,	/* Parse context */
 			       int iFrom,	/* Value for "from" column of output */
 			       u16 wctrlFlags	/* Flags passed to sqlite3WhereBegin() */
     );
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 void sqlite3WhereAddScanStatus(Vdbe * v,	/* Vdbe to add scanstatus entry to */
 			       SrcList * pSrclist,	/* FROM clause pLvl reads data from */
 			       WhereLevel * pLvl,	/* Level to add scanstatus() entry for */
 			       int addrExplain	/* Address of OP_Explain (or 0) */
     );
-#else
-#define sqlite3WhereAddScanStatus(a, b, c, d) ((void)d)
-#endif
 Bitmask sqlite3WhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about the WHERE clause */
 				     int iLevel,	/* Which level of pWInfo->a[] should be coded */
 				     Bitmask notReady	/* Which tables are currently available */
@@ -539,3 +533,11 @@ void sqlite3WhereTabFuncArgs(Parse *, struct SrcList_item *, WhereClause *);
 #define WHERE_SKIPSCAN     0x00008000	/* Uses the skip-scan algorithm */
 #define WHERE_UNQ_WANTED   0x00010000	/* WHERE_ONEROW would have been helpful */
 #define WHERE_PARTIALIDX   0x00020000	/* The automatic index is partial */
+#define WHERE_KEY_ONLY     0x00040000	/* Only index key parts are read */
+
+/*
+ * Automatic indexes are not considered for spaces with less
+ * than 1000 tuples (LogEst=99): a nested scan of such a space is
+ * cheap, while building a transient index for it is not.
+ */
+#define SQL_AUTOINDEX_MIN_ROWS_LOG_EST 99
@@ -164,8 +164,8 @@ explainIndexRange(StrAccum * pStr, WhereLoop * pLoop)
 
 /*
  * This function is a no-op unless currently processing an EXPLAIN QUERY PLAN
- * command, or if either SQLITE_DEBUG or SQLITE_ENABLE_STMT_SCANSTATUS was
- * defined at compile-time. If it is not a no-op, a single OP_Explain opcode
+ * or EXPLAIN ANALYZE command, or if SQLITE_DEBUG was defined at
+ * compile-time. If it is not a no-op, a single OP_Explain opcode
  * is added to the output to describe the table scan strategy in pLevel.
  *
  * If an OP_Explain opcode is added to the VM, its address is returned.
@@ -180,8 +180,8 @@ sqlite3WhereExplainOneScan(Parse * pParse,	/* Parse context */
 			   u16 wctrlFlags)	/* Flags passed to sqlite3WhereBegin() */
 {
 	int ret = 0;
-#if !defined(SQLITE_DEBUG) && !defined(SQLITE_ENABLE_STMT_SCANSTATUS)
-	if (pParse->explain == 2)
+#if !defined(SQLITE_DEBUG)
+	if (pParse->explain >= 2)
 #endif
 	{
 		struct SrcList_item *pItem = &pTabList->a[pLevel->iFrom];
@@ -284,10 +284,9 @@ sqlite3WhereExplainOneScan(Parse * pParse,	/* Parse context */
 	return ret;
 }
 
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 /*
  * Configure the VM passed as the first argument with an
- * sqlite3_stmt_scanstatus() entry corresponding to the scan used to
+ * EXPLAIN ANALYZE entry corresponding to the scan used to
  * implement level pLvl. Argument pSrclist is a pointer to the FROM
  * clause that the scan reads data from.
  *
@@ -302,15 +301,16 @@ sqlite3WhereAddScanStatus(Vdbe * v,		/* Vdbe to add scanstatus entry to */
 {
 	const char *zObj = 0;
 	WhereLoop *pLoop = pLvl->pWLoop;
-	if (pLoop->pIndex != 0) {
-		zObj = pLoop->pIndex->zName;
+	if (pLoop->pIndex != NULL) {
+		zObj = pLoop->pIndex->def->name;
+	} else if (pLoop->index_def != NULL) {
+		zObj = pLoop->index_def->name;
 	} else {
 		zObj = pSrclist->a[pLvl->iFrom].zName;
 	}
 	sqlite3VdbeScanStatus(v, addrExplain, pLvl->addrBody, pLvl->addrVisit,
 			      pLoop->nOut, zObj);
 }
-#endif
 
 /*
  * Disable a term in the WHERE clause.  Except, do not disable the term
@@ -878,6 +878,74 @@ codeExprOrVector(Parse * pParse, Expr * p, int iReg, int nReg)
 	}
 }
 
+/**
+ * Push comparisons of numeric columns of the table scanned by a
+ * loop with constant expressions down to the cursor iterating
+ * over the table, so that the cursor can skip tuples failing them
+ * without passing each tuple through VDBE (see OP_CursorFilter).
+ * The terms are still coded as usual: a cursor filter doesn't
+ * handle all types and is dropped if its value isn't an integer.
+ *
+ * @param winfo WHERE clause.
+ * @param level Loop to generate filters for.
+ * @param cursor Cursor used by the loop to iterate.
+ */
+static void
+code_cursor_filters(WhereInfo *winfo, WhereLevel *level, int cursor)
+{
+	Parse *parse = winfo->pParse;
+	Vdbe *v = parse->pVdbe;
+	WhereClause *wc = &winfo->sWC;
+	WhereLoop *loop = level->pWLoop;
+	struct SrcList_item *src = &winfo->pTabList->a[level->iFrom];
+	int tab_cursor = src->iCursor;
+	Bitmask mask = sqlite3WhereGetMask(&winfo->sMaskSet, tab_cursor);
+	if (src->pSelect != NULL)
+		return;
+	struct space_def *def = src->pTab->def;
+	int filter_count = 0;
+	for (int i = 0; i < wc->nTerm &&
+	     filter_count < SQL_CURSOR_FILTER_MAX; i++) {
+		WhereTerm *term = &wc->a[i];
+		int op;
+		switch (term->eOperator) {
+		case WO_EQ: op = OP_Eq; break;
+		case WO_LT: op = OP_Lt; break;
+		case WO_LE: op = OP_Le; break;
+		case WO_GT: op = OP_Gt; break;
+		case WO_GE: op = OP_Ge; break;
+		default: continue;
+		}
+		if (term->leftCursor != tab_cursor || term->prereqRight != 0 ||
+		    (term->prereqAll & ~mask) != 0 || term->iField != 0 ||
+		    (term->wtFlags & (TERM_CODED | TERM_VNULL)) != 0)
+			continue;
+		Expr *expr = term->pExpr;
+		if (ExprHasProperty(expr, EP_FromJoin) ||
+		    sqlite3ExprSkipCollate(expr->pLeft)->op != TK_COLUMN ||
+		    sqlite3ExprIsVector(expr->pRight) ||
+		    !sqlite3ExprIsConstant(expr->pRight))
+			continue;
+		int fieldno = term->u.leftColumn;
+		if (fieldno < 0 || (uint32_t)fieldno >= def->field_count ||
+		    !sqlite3IsNumericAffinity(def->fields[fieldno].affinity))
+			continue;
+		/* Terms used to position the cursor are checked anyway. */
+		bool is_used = false;
+		for (int j = 0; j < loop->nLTerm && !is_used; j++)
+			is_used = loop->aLTerm[j] == term;
+		if (is_used)
+			continue;
+		int reg_free = 0;
+		int reg = sqlite3ExprCodeTemp(parse, expr->pRight, &reg_free);
+		sqlite3VdbeAddOp4Int(v, OP_CursorFilter, cursor, fieldno, reg,
+				     op);
+		sqlite3VdbeChangeP5(v, filter_count == 0);
+		sqlite3ReleaseTempReg(parse, reg_free);
+		filter_count++;
+	}
+}
+
 /*
  * Generate code for the start of the iLevel-th loop in the WHERE clause
  * implementation described by pWInfo.
@@ -942,6 +1010,26 @@ sqlite3WhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about t
 		VdbeComment((v, "init LEFT JOIN no-match flag"));
 	}
 
+	/*
+	 * Let the cursor of a scan skip tuples failing simple
+	 * comparisons. Not done for the right table of a LEFT
+	 * JOIN, for OR sub-clauses and skip-scans, which reuse
+	 * the cursor in special ways, and for one-row lookups,
+	 * where it is useless.
+	 */
+	if (pLevel->iLeftJoin == 0 && !pTabItem->fg.viaCoroutine &&
+	    (pWInfo->wctrlFlags & WHERE_OR_SUBCLAUSE) == 0 &&
+	    (pLoop->wsFlags & WHERE_ONEROW) == 0) {
+		if ((pLoop->wsFlags & WHERE_INDEXED) != 0) {
+			if (pLoop->nSkip == 0)
+				code_cursor_filters(pWInfo, pLevel,
+						    pLevel->iIdxCur);
+		} else if ((pLoop->wsFlags & WHERE_MULTI_OR) == 0 &&
+			   !pTabItem->fg.isRecursive) {
+			code_cursor_filters(pWInfo, pLevel, iCur);
+		}
+	}
+
 	/* Special case of a FROM clause subquery implemented as a co-routine */
 	if (pTabItem->fg.viaCoroutine) {
 		int regYield = pTabItem->regReturn;
@@ -1681,9 +1769,7 @@ sqlite3WhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about t
 		}
 	}
 
-#ifdef SQLITE_ENABLE_STMT_SCANSTATUS
 	pLevel->addrVisit = sqlite3VdbeCurrentAddr(v);
-#endif
 
 	/* Insert code to test every subexpression that can be completely
 	 * computed using the current set of tables.
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2010-2018, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "sql_stmt_cache.h"
+
+#include <small/rlist.h>
+
+#include "assoc.h"
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "schema.h"
+#include "sql.h"
+#include "sql/sqliteInt.h"
+#include "trivia/util.h"
+
+struct sql_stmt_cache_entry {
+	/** Link in sql_stmt_cache::lru, most recently used first. */
+	struct rlist in_lru;
+	/** Compiled statement. */
+	struct sqlite3_stmt *stmt;
+	/** Statement id, unique among cached statements. */
+	uint32_t id;
+	/** Value of schema_version the statement was compiled at. */
+	uint32_t schema_version;
+	/** Set while the statement is being executed. */
+	bool is_busy;
+	/** Hash of the statement text. */
+	uint32_t sql_hash;
+	/** Length of the statement text. */
+	uint32_t sql_len;
+	/** Statement text, may contain zero bytes. */
+	char sql[0];
+};
+
+#define mh_name _sql_stmt
+struct mh_sql_stmt_key_t {
+	const char *sql;
+	uint32_t len;
+	uint32_t hash;
+};
+#define mh_key_t struct mh_sql_stmt_key_t *
+struct mh_sql_stmt_node_t {
+	const char *sql;
+	uint32_t len;
+	uint32_t hash;
+	struct sql_stmt_cache_entry *entry;
+};
+#define mh_node_t struct mh_sql_stmt_node_t
+
+#define mh_arg_t void *
+#define mh_hash(a, arg) ((a)->hash)
+#define mh_hash_key(a, arg) mh_hash(a, arg)
+#define mh_cmp(a, b, arg) ((a)->len != (b)->len || \
+			   memcmp((a)->sql, (b)->sql, (a)->len))
+#define mh_cmp_key(a, b, arg) mh_cmp(a, b, arg)
+#define MH_SOURCE 1
+#include "salad/mhash.h" /* Create mh_sql_stmt_t hash. */
+
+static struct sql_stmt_cache {
+	/** Statement id -> struct sql_stmt_cache_entry. */
+	struct mh_i32ptr_t *by_id;
+	/** Statement text -> struct sql_stmt_cache_entry. */
+	struct mh_sql_stmt_t *by_sql;
+	/** List of all cached statements, see entry::in_lru. */
+	struct rlist lru;
+	/** Number of cached statements. */
+	uint32_t count;
+	/** Max number of cached statements. */
+	uint32_t count_max;
+	/** Id to assign to the next cached statement. */
+	uint32_t next_id;
+} cache;
+
+void
+sql_stmt_cache_init(void)
+{
+	cache.by_id = mh_i32ptr_new();
+	cache.by_sql = mh_sql_stmt_new();
+	if (cache.by_id == NULL || cache.by_sql == NULL)
+		panic("failed to allocate SQL statement cache");
+	rlist_create(&cache.lru);
+	cache.count = 0;
+	cache.next_id = 1;
+}
+
+/**
+ * Remove an entry from the cache. The statement is finalized
+ * unless it is being executed, in which case it will be
+ * finalized by sql_stmt_cache_put().
+ */
+static void
+sql_stmt_cache_delete(struct sql_stmt_cache_entry *entry)
+{
+	mh_int_t i = mh_i32ptr_find(cache.by_id, entry->id, NULL);
+	assert(i != mh_end(cache.by_id));
+	assert(mh_i32ptr_node(cache.by_id, i)->val == entry);
+	mh_i32ptr_del(cache.by_id, i, NULL);
+	struct mh_sql_stmt_key_t key = {
+		entry->sql, entry->sql_len, entry->sql_hash
+	};
+	i = mh_sql_stmt_find(cache.by_sql, &key, NULL);
+	assert(i != mh_end(cache.by_sql));
+	mh_sql_stmt_del(cache.by_sql, i, NULL);
+	rlist_del_entry(entry, in_lru);
+	cache.count--;
+	if (!entry->is_busy)
+		sqlite3_finalize(entry->stmt);
+	free(entry);
+}
+
+/** Evict least recently used statements above the limit. */
+static void
+sql_stmt_cache_trim(void)
+{
+	while (cache.count > cache.count_max) {
+		struct sql_stmt_cache_entry *entry =
+			rlist_last_entry(&cache.lru,
+					 struct sql_stmt_cache_entry, in_lru);
+		sql_stmt_cache_delete(entry);
+	}
+}
+
+void
+sql_stmt_cache_free(void)
+{
+	cache.count_max = 0;
+	sql_stmt_cache_trim();
+	mh_i32ptr_delete(cache.by_id);
+	mh_sql_stmt_delete(cache.by_sql);
+	cache.by_id = NULL;
+	cache.by_sql = NULL;
+}
+
+void
+sql_stmt_cache_set_count(uint32_t count)
+{
+	cache.count_max = count;
+	sql_stmt_cache_trim();
+}
+
+/** Find a cached statement by id or return NULL. */
+static struct sql_stmt_cache_entry *
+sql_stmt_cache_find_id(uint32_t id)
+{
+	mh_int_t i = mh_i32ptr_find(cache.by_id, id, NULL);
+	if (i == mh_end(cache.by_id))
+		return NULL;
+	return (struct sql_stmt_cache_entry *)
+		mh_i32ptr_node(cache.by_id, i)->val;
+}
+
+/** Find a cached statement by text or return NULL. */
+static struct sql_stmt_cache_entry *
+sql_stmt_cache_find_sql(const char *sql, uint32_t len, uint32_t hash)
+{
+	struct mh_sql_stmt_key_t key = { sql, len, hash };
+	mh_int_t i = mh_sql_stmt_find(cache.by_sql, &key, NULL);
+	if (i == mh_end(cache.by_sql))
+		return NULL;
+	return mh_sql_stmt_node(cache.by_sql, i)->entry;
+}
+
+/** Compile a statement. */
+static struct sqlite3_stmt *
+sql_stmt_compile(const char *sql, uint32_t len)
+{
+	sqlite3 *db = sql_get();
+	if (db == NULL) {
+		diag_set(ClientError, ER_LOADING);
+		return NULL;
+	}
+	struct sqlite3_stmt *stmt;
+	if (sqlite3_prepare_v2(db, sql, len, &stmt, NULL) != SQLITE_OK) {
+		diag_set(ClientError, ER_SQL_EXECUTE, sqlite3_errmsg(db));
+		return NULL;
+	}
+	assert(stmt != NULL);
+	return stmt;
+}
+
+/**
+ * Add a compiled statement to the cache under a new id. The
+ * statement is marked busy. Failure to cache a statement isn't
+ * an error: the statement is finalized after use then.
+ *
+ * Returns the id of the statement or 0 if it wasn't cached.
+ */
+static uint32_t
+sql_stmt_cache_insert(const char *sql, uint32_t len, uint32_t hash,
+		      struct sqlite3_stmt *stmt)
+{
+	if (cache.count_max == 0)
+		return 0;
+	struct sql_stmt_cache_entry *entry = (struct sql_stmt_cache_entry *)
+		malloc(sizeof(*entry) + len);
+	if (entry == NULL)
+		return 0;
+	/* Ids are never reused while a statement is cached. */
+	while (cache.next_id == 0 ||
+	       sql_stmt_cache_find_id(cache.next_id) != NULL)
+		cache.next_id++;
+	entry->id = cache.next_id++;
+	entry->stmt = stmt;
+	entry->schema_version = schema_version;
+	entry->is_busy = true;
+	entry->sql_hash = hash;
+	entry->sql_len = len;
+	memcpy(entry->sql, sql, len);
+	struct mh_i32ptr_node_t node = { entry->id, entry };
+	if (mh_i32ptr_put(cache.by_id, &node, NULL, NULL) ==
+	    mh_end(cache.by_id)) {
+		free(entry);
+		return 0;
+	}
+	struct mh_sql_stmt_node_t sql_node = {
+		entry->sql, entry->sql_len, entry->sql_hash, entry
+	};
+	if (mh_sql_stmt_put(cache.by_sql, &sql_node, NULL, NULL) ==
+	    mh_end(cache.by_sql)) {
+		mh_i32ptr_remove(cache.by_id, &node, NULL);
+		free(entry);
+		return 0;
+	}
+	rlist_add_entry(&cache.lru, entry, in_lru);
+	cache.count++;
+	uint32_t id = entry->id;
+	sql_stmt_cache_trim();
+	return id;
+}
+
+struct sqlite3_stmt *
+sql_stmt_cache_get(const char *sql, uint32_t len, uint32_t *id)
+{
+	struct sql_stmt_cache_entry *entry;
+	uint32_t hash = 0;
+	if (sql != NULL) {
+		hash = mh_strn_hash(sql, len);
+		entry = sql_stmt_cache_find_sql(sql, len, hash);
+	} else {
+		entry = sql_stmt_cache_find_id(*id);
+		if (entry == NULL) {
+			diag_set(ClientError, ER_SQL_STMT_NOT_FOUND, *id);
+			return NULL;
+		}
+	}
+	if (entry == NULL) {
+		struct sqlite3_stmt *stmt = sql_stmt_compile(sql, len);
+		if (stmt == NULL)
+			return NULL;
+		*id = sql_stmt_cache_insert(sql, len, hash, stmt);
+		return stmt;
+	}
+	*id = entry->id;
+	rlist_move_entry(&cache.lru, entry, in_lru);
+	if (!entry->is_busy && entry->schema_version == schema_version) {
+		entry->is_busy = true;
+		return entry->stmt;
+	}
+	struct sqlite3_stmt *stmt = sql_stmt_compile(entry->sql,
+						     entry->sql_len);
+	if (stmt == NULL)
+		return NULL;
+	/*
+	 * A busy statement that is up to date stays in the cache:
+	 * the new one is private to the caller. A stale statement
+	 * is replaced under the same id. If it is busy, it will be
+	 * finalized by sql_stmt_cache_put().
+	 */
+	if (entry->schema_version == schema_version)
+		return stmt;
+	if (!entry->is_busy)
+		sqlite3_finalize(entry->stmt);
+	entry->stmt = stmt;
+	entry->schema_version = schema_version;
+	entry->is_busy = true;
+	return stmt;
+}
+
+void
+sql_stmt_cache_put(struct sqlite3_stmt *stmt, uint32_t id)
+{
+	struct sql_stmt_cache_entry *entry = id == 0 ? NULL :
+		sql_stmt_cache_find_id(id);
+	if (entry == NULL || entry->stmt != stmt) {
+		sqlite3_finalize(stmt);
+		return;
+	}
+	assert(entry->is_busy);
+	entry->is_busy = false;
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
@@ -0,0 +1,109 @@
+#ifndef TARANTOOL_BOX_SQL_STMT_CACHE_H_INCLUDED
+#define TARANTOOL_BOX_SQL_STMT_CACHE_H_INCLUDED
+/*
+ * Copyright 2010-2018, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct sqlite3_stmt;
+
+/**
+ * Cache of compiled SQL statements.
+ *
+ * Compiling a statement - parsing, name resolution, query
+ * planning and VDBE code generation - takes most of the time
+ * of a short query, so statements executed over IPROTO are
+ * kept compiled between executions. A cached statement gets
+ * a unique id, which is not reused while the statement is in
+ * the cache. The cache is looked up both by text, on EXECUTE
+ * of an SQL string, and by id, on EXECUTE of a statement
+ * returned by PREPARE. A statement recompiled after a schema
+ * change keeps its id.
+ *
+ * A statement compiled before the last schema change is
+ * recompiled on next use. A statement can't be executed by
+ * two fibers at once, so if a cached statement is busy, a
+ * private copy is compiled for the second fiber and finalized
+ * after use. The number of cached statements is limited by
+ * box.cfg.sql_cache_count. Least recently used statements are
+ * evicted first.
+ */
+
+/** Initialize the statement cache. */
+void
+sql_stmt_cache_init(void);
+
+/** Finalize all cached statements and free the cache. */
+void
+sql_stmt_cache_free(void);
+
+/**
+ * Set the max number of statements kept in the cache and evict
+ * extra statements. 0 disables the cache.
+ */
+void
+sql_stmt_cache_set_count(uint32_t count);
+
+/**
+ * Get a statement ready for execution, compiling it if needed.
+ * The statement must be returned with sql_stmt_cache_put() when
+ * it isn't needed anymore.
+ *
+ * @param sql SQL text of the statement or NULL to look up a
+ *        previously prepared statement by id.
+ * @param len Length of @a sql.
+ * @param[in,out] id Statement id to look up if @a sql is NULL.
+ *        Set to the id of the cached statement or 0 if the
+ *        statement couldn't be cached.
+ *
+ * @retval not NULL Compiled statement.
+ * @retval NULL Statement not found or compilation error,
+ *         diag is set.
+ */
+struct sqlite3_stmt *
+sql_stmt_cache_get(const char *sql, uint32_t len, uint32_t *id);
+
+/**
+ * Return a statement obtained with sql_stmt_cache_get() along
+ * with the id it returned. A cached statement is reset to be
+ * used again, others are finalized.
+ */
+void
+sql_stmt_cache_put(struct sqlite3_stmt *stmt, uint32_t id);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_SQL_STMT_CACHE_H_INCLUDED */
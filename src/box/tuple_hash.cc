@@ -318,6 +318,22 @@ tuple_hash_key_part(uint32_t *ph1, uint32_t *pcarry,
 	return tuple_hash_field(ph1, pcarry, &field, part->coll);
 }
 
+void
+tuple_hash_key_prefixes(const struct tuple *tuple,
+			const struct key_def *key_def, uint32_t part_count,
+			uint32_t *hashes)
+{
+	assert(part_count <= key_def->part_count);
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+	for (uint32_t i = 0; i < part_count; i++) {
+		total_size += tuple_hash_key_part(&h, &carry, tuple,
+						  &key_def->parts[i]);
+		hashes[i] = PMurHash32_Result(h, carry, total_size);
+	}
+}
+
 template <bool has_optional_parts>
 uint32_t
 tuple_hash_slowpath(const struct tuple *tuple, const struct key_def *key_def)
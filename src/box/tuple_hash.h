@@ -74,6 +74,19 @@ tuple_hash_key_part(uint32_t *ph1, uint32_t *pcarry,
 		    const struct tuple *tuple,
 		    const struct key_part *part);
 
+/**
+ * Calculate hash values of key prefixes of a tuple.
+ * @param tuple - a tuple
+ * @param key_def - key_def for field description
+ * @param part_count - number of prefixes to hash
+ * @param[out] hashes - hashes[i] is set to the hash of the first
+ *                      i + 1 key parts, part_count values in total
+ */
+void
+tuple_hash_key_prefixes(const struct tuple *tuple,
+			const struct key_def *key_def, uint32_t part_count,
+			uint32_t *hashes);
+
 /**
  * Calculates a common hash value for a tuple
  * @param tuple - a tuple
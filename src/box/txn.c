@@ -143,6 +143,7 @@ txn_begin(bool is_autocommit)
 	txn->n_rows = 0;
 	txn->is_autocommit = is_autocommit;
 	txn->has_triggers  = false;
+	txn->has_ndv_trigger = false;
 	txn->is_aborted = false;
 	txn->in_sub_stmt = 0;
 	txn->id = ++txn_id;
@@ -213,6 +214,26 @@ fail:
 	return NULL;
 }
 
+/**
+ * Account tuples written by a committed transaction in the
+ * statistics used by the SQL planner. Statements rolled back
+ * to a savepoint are not in the list anymore.
+ */
+static void
+txn_ndv_on_commit(struct trigger *trigger, void *event)
+{
+	(void) trigger;
+	struct txn *txn = (struct txn *) event;
+	struct txn_stmt *stmt;
+	stailq_foreach_entry(stmt, &txn->stmts, next) {
+		if (stmt->space != NULL && stmt->new_tuple != NULL &&
+		    space_has_ndv(stmt->space)) {
+			space_ndv_add(stmt->space, stmt->old_tuple,
+				      stmt->new_tuple);
+		}
+	}
+}
+
 /**
  * End a statement. In autocommit mode, end
  * the current transaction as well.
@@ -249,6 +270,13 @@ txn_commit_stmt(struct txn *txn, struct request *request)
 		if (trigger_run(&stmt->space->on_replace, txn) != 0)
 			goto fail;
 	}
+	if (stmt->space != NULL && stmt->new_tuple != NULL &&
+	    !txn->has_ndv_trigger && space_has_ndv(stmt->space)) {
+		trigger_create(&txn->on_commit_ndv, txn_ndv_on_commit,
+			       NULL, NULL);
+		txn_on_commit(txn, &txn->on_commit_ndv);
+		txn->has_ndv_trigger = true;
+	}
 	--txn->in_sub_stmt;
 	if (txn->is_autocommit && txn->in_sub_stmt == 0)
 		return txn_commit(txn);
@@ -317,6 +345,9 @@ txn_commit(struct txn *txn)
 			goto fail;
 		}
 	}
+	if (txn->has_triggers &&
+	    trigger_run(&txn->on_prepare, txn) != 0)
+		goto fail;
 	/*
 	 * Perform transaction conflict resolution. Engine == NULL when
 	 * we have a bunch of IPROTO_NOP statements.
@@ -325,6 +356,10 @@ txn_commit(struct txn *txn)
 		if (engine_prepare(txn->engine, txn) != 0)
 			goto fail;
 	}
+	/* Nothing may yield until the WAL write is submitted. */
+	if (txn->has_triggers &&
+	    trigger_run(&txn->on_write, txn) != 0)
+		goto fail;
 
 	if (txn->n_rows > 0) {
 		txn->signature = txn_write_to_wal(txn);
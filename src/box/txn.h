@@ -140,8 +140,10 @@ struct txn {
 	 * rolled back at commit.
 	 */
 	bool is_aborted;
-	/** True if on_commit and on_rollback lists are non-empty. */
+	/** True if transaction trigger lists are initialized. */
 	bool has_triggers;
+	/** True if on_commit_ndv is set. */
+	bool has_ndv_trigger;
 	/** The number of active nested statement-level transactions. */
 	int8_t in_sub_stmt;
 	/**
@@ -167,6 +169,17 @@ struct txn {
 	struct trigger fiber_on_stop;
 	 /** Commit and rollback triggers */
 	struct rlist on_commit, on_rollback;
+	/**
+	 * Commit trigger which accounts tuples written by the
+	 * transaction in the statistics used by the SQL planner,
+	 * see space_ndv_add().
+	 */
+	struct trigger on_commit_ndv;
+	/**
+	 * Triggers run by txn_commit() before the transaction
+	 * is prepared and right before it is written to WAL.
+	 */
+	struct rlist on_prepare, on_write;
 	struct sql_txn *psql_txn;
 };
 
@@ -220,6 +233,8 @@ txn_init_triggers(struct txn *txn)
 	if (txn->has_triggers == false) {
 		rlist_create(&txn->on_commit);
 		rlist_create(&txn->on_rollback);
+		rlist_create(&txn->on_prepare);
+		rlist_create(&txn->on_write);
 		txn->has_triggers = true;
 	}
 }
@@ -238,6 +253,31 @@ txn_on_rollback(struct txn *txn, struct trigger *trigger)
 	trigger_add(&txn->on_rollback, trigger);
 }
 
+/**
+ * Add a trigger invoked on commit before the transaction is
+ * prepared. The trigger may yield. If it fails, the transaction
+ * is rolled back.
+ */
+static inline void
+txn_on_prepare(struct txn *txn, struct trigger *trigger)
+{
+	txn_init_triggers(txn);
+	trigger_add(&txn->on_prepare, trigger);
+}
+
+/**
+ * Add a trigger invoked on commit after the transaction has
+ * been prepared, right before it is submitted to WAL. The
+ * trigger must not yield so that the order in which such
+ * triggers are run matches the order of WAL writes.
+ */
+static inline void
+txn_on_write(struct txn *txn, struct trigger *trigger)
+{
+	txn_init_triggers(txn);
+	trigger_add(&txn->on_write, trigger);
+}
+
 /**
  * Start a new statement. If no current transaction,
  * start a new transaction with autocommit = true.
@@ -44,6 +44,7 @@
 #include "vy_quota.h"
 #include "vy_scheduler.h"
 #include "vy_stat.h"
+#include "vy_tombstone.h"
 
 #include <math.h>
 #include <stdbool.h>
@@ -54,6 +55,7 @@
 #include <small/lsregion.h>
 #include <small/region.h>
 #include <small/mempool.h>
+#include <third_party/qsort_arg.h>
 
 #include "coio_task.h"
 #include "cbus.h"
@@ -227,6 +229,36 @@ static void
 vy_gc(struct vy_env *env, struct vy_recovery *recovery,
       unsigned int gc_mask, int64_t gc_lsn);
 
+/**
+ * Max number of tuples read from a secondary index that are
+ * looked up in the primary index at once, see
+ * vinyl_iterator_secondary_next().
+ */
+enum { VINYL_ITERATOR_BATCH_MAX = 32 };
+
+/** Primary index lookup done by a secondary index iterator. */
+struct vinyl_iterator_lookup {
+	/** Tuple read from the secondary index. */
+	struct tuple *key;
+	/** Tuple found in the primary index or NULL. */
+	struct tuple *result;
+};
+
+/**
+ * Versions of the data a batch of primary index lookups was
+ * read from, see vinyl_iterator_batch_is_stale().
+ */
+struct vinyl_iterator_batch_version {
+	/** Transaction write set version. */
+	uint32_t txw;
+	/** Versions of the secondary index in-memory trees. */
+	uint32_t mem_list;
+	uint32_t mem;
+	/** Versions of the primary index in-memory trees. */
+	uint32_t pk_mem_list;
+	uint32_t pk_mem;
+};
+
 struct vinyl_iterator {
 	struct iterator base;
 	/** Vinyl environment. */
@@ -250,6 +282,30 @@ struct vinyl_iterator {
 	struct vy_tx tx_autocommit;
 	/** Trigger invoked when tx ends to close the iterator. */
 	struct trigger on_tx_destroy;
+	/**
+	 * Tuples read from a secondary index and looked up in
+	 * the primary index, but not returned to the user yet.
+	 */
+	struct vinyl_iterator_lookup batch[VINYL_ITERATOR_BATCH_MAX];
+	/** Number of entries in the batch. */
+	int batch_count;
+	/** Position of the next entry to return in the batch. */
+	int batch_pos;
+	/**
+	 * Max number of entries to read into the batch next
+	 * time. Grows exponentially up to the max batch size
+	 * so as not to read ahead too much for short selects.
+	 */
+	int batch_size;
+	/** Set if the read iterator returned EOF. */
+	bool batch_eof;
+	/** Versions of the data the batch was read from. */
+	struct vinyl_iterator_batch_version batch_version;
+	/**
+	 * Tuple read from the secondary index for the last
+	 * returned entry of the batch or NULL.
+	 */
+	struct tuple *batch_last_key;
 };
 
 static const struct engine_vtab vinyl_engine_vtab;
@@ -971,6 +1027,8 @@ vinyl_index_def_change_requires_rebuild(struct index *index,
 
 	if (!old_def->opts.is_unique && new_def->opts.is_unique)
 		return true;
+	if (old_def->opts.is_covering != new_def->opts.is_covering)
+		return true;
 
 	assert(index_depends_on_pk(index));
 	const struct key_def *old_cmp_def = old_def->cmp_def;
@@ -1332,7 +1390,7 @@ vy_get(struct vy_lsm *lsm, struct vy_tx *tx,
 			return -1;
 		if (vy_point_lookup(lsm, tx, rv, key, &tuple) != 0)
 			return -1;
-		if (lsm->index_id > 0 && tuple != NULL) {
+		if (!vy_lsm_is_covering(lsm) && tuple != NULL) {
 			rc = vy_get_by_secondary_tuple(lsm, tx, rv,
 						       tuple, result);
 			tuple_unref(tuple);
@@ -1349,7 +1407,7 @@ vy_get(struct vy_lsm *lsm, struct vy_tx *tx,
 	struct vy_read_iterator itr;
 	vy_read_iterator_open(&itr, lsm, tx, ITER_EQ, key, rv);
 	while ((rc = vy_read_iterator_next(&itr, &tuple)) == 0) {
-		if (lsm->index_id == 0 || tuple == NULL) {
+		if (vy_lsm_is_covering(lsm) || tuple == NULL) {
 			*result = tuple;
 			if (tuple != NULL)
 				tuple_ref(tuple);
@@ -2272,6 +2330,87 @@ vinyl_space_execute_upsert(struct space *space, struct txn *txn,
 	return vy_upsert(env, tx, stmt, space, request);
 }
 
+/**
+ * Return true if a range deletion has already been committed
+ * to an LSM tree, i.e. a range tombstone was recovered from
+ * vylog for the WAL row that is being replayed.
+ */
+static bool
+vy_delete_range_is_committed(struct vy_env *env, struct vy_lsm *lsm)
+{
+	if (likely(env->status != VINYL_FINAL_RECOVERY_LOCAL))
+		return false;
+	if (rlist_empty(&lsm->tombstones))
+		return false;
+	struct vy_tombstone *last = rlist_last_entry(&lsm->tombstones,
+						     struct vy_tombstone,
+						     in_lsm);
+	return last->lsn >= vclock_sum(env->recovery_vclock);
+}
+
+/**
+ * Execute DELETE_RANGE request: delete all tuples whose primary
+ * keys are in range [key, end_key). An empty key stands for an
+ * unbounded range end.
+ *
+ * Instead of deleting tuples one by one, we insert a range
+ * tombstone into the LSM tree. To keep it cheap, we don't look
+ * up deleted tuples and so only allow range deletions in spaces
+ * that have neither secondary indexes nor triggers.
+ */
+static int
+vinyl_space_execute_delete_range(struct space *space, struct txn *txn,
+				 struct request *request)
+{
+	struct vy_env *env = vy_env(space->engine);
+	struct vy_tx *tx = txn->engine_tx;
+	if (request->index_id != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "delete_range() by a secondary index");
+		return -1;
+	}
+	if (space->index_count > 1) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "delete_range() in a space with secondary indexes");
+		return -1;
+	}
+	if (!rlist_empty(&space->on_replace) ||
+	    !rlist_empty(&space->before_replace)) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "delete_range() in a space with triggers");
+		return -1;
+	}
+	if (txn_check_singlestatement(txn, "delete_range()") != 0)
+		return -1;
+	struct vy_lsm *pk = vy_lsm_find(space, 0);
+	if (pk == NULL)
+		return -1;
+	if (vy_is_committed_one(env, pk) ||
+	    vy_delete_range_is_committed(env, pk))
+		return 0;
+
+	const char *keys[2] = { request->key, request->end_key };
+	for (int i = 0; i < 2; i++) {
+		if (keys[i] == NULL)
+			continue;
+		const char *key = keys[i];
+		uint32_t part_count = mp_decode_array(&key);
+		if (key_validate(space->index[0]->def, ITER_GE,
+				 key, part_count) != 0)
+			return -1;
+		if (part_count == 0)
+			keys[i] = NULL;
+	}
+	struct vy_tombstone *tombstone = vy_tombstone_new(vy_log_next_id(),
+					0, keys[0], keys[1],
+					pk->env->key_format);
+	if (tombstone == NULL)
+		return -1;
+	int rc = vy_tx_delete_range(tx, pk, tombstone);
+	vy_tombstone_unref(tombstone);
+	return rc;
+}
+
 static int
 vinyl_engine_begin(struct engine *engine, struct txn *txn)
 {
@@ -2294,7 +2433,7 @@ vinyl_engine_prepare(struct engine *engine, struct txn *txn)
 	struct vy_tx *tx = txn->engine_tx;
 	assert(tx != NULL);
 
-	if (tx->write_size > 0 &&
+	if ((tx->write_size > 0 || !rlist_empty(&tx->tombstones)) &&
 	    vinyl_check_wal(env, "DML") != 0)
 		return -1;
 
@@ -2357,6 +2496,32 @@ vinyl_engine_prepare(struct engine *engine, struct txn *txn)
 	return 0;
 }
 
+/**
+ * Log range deletions committed by a transaction to vylog and
+ * free them. We can't fail at this point so if the log write
+ * fails, the records are left in the log buffer to be flushed
+ * along with the next vylog transaction.
+ */
+static void
+vy_log_tx_tombstones(struct rlist *tombstones)
+{
+	if (rlist_empty(tombstones))
+		return;
+	vy_log_tx_begin();
+	struct vy_tx_tombstone *t;
+	rlist_foreach_entry(t, tombstones, in_tx) {
+		struct vy_tombstone *tombstone = t->tombstone;
+		vy_log_insert_tombstone(t->lsm->id, tombstone->id,
+					tuple_data_or_null(tombstone->begin),
+					tuple_data_or_null(tombstone->end),
+					tombstone->lsn);
+	}
+	vy_log_tx_try_commit();
+	struct vy_tx_tombstone *next_t;
+	rlist_foreach_entry_safe(t, tombstones, in_tx, next_t)
+		vy_tx_tombstone_delete(t);
+}
+
 static void
 vinyl_engine_commit(struct engine *engine, struct txn *txn)
 {
@@ -2372,13 +2537,20 @@ vinyl_engine_commit(struct engine *engine, struct txn *txn)
 	 */
 	size_t mem_used_before = lsregion_used(&env->mem_env.allocator);
 
-	vy_tx_commit(tx, txn->signature);
+	RLIST_HEAD(tombstones);
+	vy_tx_commit(tx, txn->signature, &tombstones);
 
 	size_t mem_used_after = lsregion_used(&env->mem_env.allocator);
 	assert(mem_used_after >= mem_used_before);
 	/* We can't abort the transaction at this point, use force. */
 	vy_quota_force_use(&env->quota, mem_used_after - mem_used_before);
 
+	/*
+	 * Writing to vylog may yield so we do it only after
+	 * the transaction has been committed in memory.
+	 */
+	vy_log_tx_tombstones(&tombstones);
+
 	txn->engine_tx = NULL;
 	if (!txn->is_autocommit)
 		trigger_clear(&txn->fiber_on_stop);
@@ -3214,7 +3386,7 @@ vinyl_space_apply_initial_join_row(struct space *space, struct request *request)
 
 	rc = vy_tx_prepare(tx);
 	if (rc == 0)
-		vy_tx_commit(tx, ++env->join_lsn);
+		vy_tx_commit(tx, ++env->join_lsn, NULL);
 	else
 		vy_tx_rollback(tx);
 
@@ -3656,9 +3828,26 @@ vinyl_iterator_last(struct iterator *base, struct tuple **ret)
 	return 0;
 }
 
+/** Release the entries of the batch not returned yet. */
+static void
+vinyl_iterator_clear_batch(struct vinyl_iterator *it)
+{
+	for (int i = it->batch_pos; i < it->batch_count; i++) {
+		struct vinyl_iterator_lookup *lookup = &it->batch[i];
+		tuple_unref(lookup->key);
+		if (lookup->result != NULL)
+			tuple_unref(lookup->result);
+	}
+	it->batch_pos = it->batch_count = 0;
+}
+
 static void
 vinyl_iterator_close(struct vinyl_iterator *it)
 {
+	vinyl_iterator_clear_batch(it);
+	if (it->batch_last_key != NULL)
+		tuple_unref(it->batch_last_key);
+	it->batch_last_key = NULL;
 	vy_read_iterator_close(&it->iterator);
 	vy_lsm_unref(it->lsm);
 	it->lsm = NULL;
@@ -3710,7 +3899,7 @@ vinyl_iterator_primary_next(struct iterator *base, struct tuple **ret)
 {
 	assert(base->next = vinyl_iterator_primary_next);
 	struct vinyl_iterator *it = (struct vinyl_iterator *)base;
-	assert(it->lsm->index_id == 0);
+	assert(vy_lsm_is_covering(it->lsm));
 
 	if (vinyl_iterator_check_tx(it) != 0)
 		goto fail;
@@ -3729,28 +3918,180 @@ fail:
 	return -1;
 }
 
+/**
+ * Iterator next method used by key iterators over secondary
+ * indexes, see vinyl_index_create_key_iterator(). Statements are
+ * returned as they are read from the LSM tree, without looking
+ * up full tuples in the primary index, so only the fields of
+ * the index cmp_def are guaranteed to be present.
+ */
 static int
-vinyl_iterator_secondary_next(struct iterator *base, struct tuple **ret)
+vinyl_iterator_key_next(struct iterator *base, struct tuple **ret)
 {
-	assert(base->next = vinyl_iterator_secondary_next);
+	assert(base->next = vinyl_iterator_key_next);
 	struct vinyl_iterator *it = (struct vinyl_iterator *)base;
 	assert(it->lsm->index_id > 0);
-	struct tuple *tuple;
 
-next:
 	if (vinyl_iterator_check_tx(it) != 0)
 		goto fail;
-
-	if (vy_read_iterator_next(&it->iterator, &tuple) != 0)
+	if (vy_read_iterator_next(&it->iterator, ret) != 0)
 		goto fail;
-
-	if (tuple == NULL) {
+	/*
+	 * Partial tuples must not get to the cache of a
+	 * non-covering index, so don't call
+	 * vy_read_iterator_cache_add() here.
+	 */
+	if (*ret == NULL) {
 		/* EOF. Close the iterator immediately. */
-		vy_read_iterator_cache_add(&it->iterator, NULL);
 		vinyl_iterator_close(it);
-		*ret = NULL;
+	} else {
+		tuple_bless(*ret);
+	}
+	return 0;
+fail:
+	vinyl_iterator_close(it);
+	return -1;
+}
+
+static int
+vinyl_iterator_lookup_f(va_list ap)
+{
+	struct vinyl_iterator *it = va_arg(ap, struct vinyl_iterator *);
+	struct vinyl_iterator_lookup *lookup =
+		va_arg(ap, struct vinyl_iterator_lookup *);
+	return vy_get_by_secondary_tuple(it->lsm, it->tx,
+					 vy_tx_read_view(it->tx),
+					 lookup->key, &lookup->result);
+}
+
+static int
+vinyl_iterator_lookup_cmp(const void *a, const void *b, void *arg)
+{
+	struct vinyl_iterator_lookup *l1 = *(struct vinyl_iterator_lookup **)a;
+	struct vinyl_iterator_lookup *l2 = *(struct vinyl_iterator_lookup **)b;
+	return vy_stmt_compare(l1->key, l2->key, (struct key_def *)arg);
+}
+
+/**
+ * Look up all tuples stored in the batch of a secondary index
+ * iterator in the primary index.
+ *
+ * If the primary index has data on disk, lookups are done
+ * concurrently, one fiber per lookup, so that disk reads are
+ * processed by reader threads in parallel. Lookups are started
+ * in the primary key order so that reads of adjacent keys are
+ * issued one after another.
+ */
+static int
+vinyl_iterator_lookup_batch(struct vinyl_iterator *it)
+{
+	struct vy_lsm *pk = it->lsm->pk;
+	int count = it->batch_count;
+	if (count == 1 || pk->run_count == 0) {
+		for (int i = 0; i < count; i++) {
+			struct vinyl_iterator_lookup *lookup = &it->batch[i];
+			if (vy_get_by_secondary_tuple(it->lsm, it->tx,
+					vy_tx_read_view(it->tx),
+					lookup->key, &lookup->result) != 0)
+				return -1;
+		}
 		return 0;
 	}
+
+	struct vinyl_iterator_lookup *sorted[VINYL_ITERATOR_BATCH_MAX];
+	for (int i = 0; i < count; i++)
+		sorted[i] = &it->batch[i];
+	qsort_arg(sorted, count, sizeof(*sorted),
+		  vinyl_iterator_lookup_cmp, pk->cmp_def);
+
+	struct fiber *fibers[VINYL_ITERATOR_BATCH_MAX];
+	int fiber_count = 0;
+	int rc = 0;
+	for (int i = 0; i < count; i++) {
+		struct fiber *f = fiber_new("vinyl.lookup",
+					    vinyl_iterator_lookup_f);
+		if (f == NULL) {
+			rc = -1;
+			break;
+		}
+		fiber_set_joinable(f, true);
+		fiber_start(f, it, sorted[i]);
+		fibers[fiber_count++] = f;
+	}
+	for (int i = 0; i < fiber_count; i++) {
+		if (fiber_join(fibers[i]) != 0)
+			rc = -1;
+	}
+	return rc;
+}
+
+static void
+vinyl_iterator_batch_version(struct vinyl_iterator *it,
+			     struct vinyl_iterator_batch_version *version)
+{
+	struct vy_lsm *lsm = it->lsm;
+	version->txw = it->tx->write_set_version;
+	version->mem_list = lsm->mem_list_version;
+	version->mem = lsm->mem->version;
+	version->pk_mem_list = lsm->pk->mem_list_version;
+	version->pk_mem = lsm->pk->mem->version;
+}
+
+/**
+ * Check if the tuples looked up in the primary index may have
+ * changed since the batch was read, because the transaction or
+ * a concurrent one wrote to the space since then.
+ */
+static bool
+vinyl_iterator_batch_is_stale(struct vinyl_iterator *it)
+{
+	struct vinyl_iterator_batch_version version;
+	vinyl_iterator_batch_version(it, &version);
+	return memcmp(&version, &it->batch_version, sizeof(version)) != 0;
+}
+
+/**
+ * Drop the entries of the batch not returned yet and reposition
+ * the read iterator after the last returned one so that they
+ * are read and looked up anew.
+ */
+static void
+vinyl_iterator_drop_batch(struct vinyl_iterator *it)
+{
+	vinyl_iterator_clear_batch(it);
+	vy_read_iterator_rewind(&it->iterator, it->batch_last_key);
+	it->batch_eof = false;
+	it->batch_size = 1;
+}
+
+/**
+ * Read the next batch of tuples from a secondary index and
+ * look them up in the primary index.
+ */
+static int
+vinyl_iterator_fill_batch(struct vinyl_iterator *it)
+{
+	assert(it->batch_pos == it->batch_count);
+	assert(!it->batch_eof);
+	it->batch_pos = it->batch_count = 0;
+	while (it->batch_count < it->batch_size) {
+		if (vinyl_iterator_check_tx(it) != 0)
+			return -1;
+		struct tuple *tuple;
+		if (vy_read_iterator_next(&it->iterator, &tuple) != 0)
+			return -1;
+		if (tuple == NULL) {
+			it->batch_eof = true;
+			break;
+		}
+		struct vinyl_iterator_lookup *lookup;
+		lookup = &it->batch[it->batch_count++];
+		lookup->key = tuple;
+		lookup->result = NULL;
+		tuple_ref(tuple);
+	}
+	if (it->batch_count == 0)
+		return 0;
 #ifndef NDEBUG
 	struct errinj *delay = errinj(ERRINJ_VY_DELAY_PK_LOOKUP,
 				      ERRINJ_BOOL);
@@ -3759,11 +4100,52 @@ next:
 			fiber_sleep(0.01);
 	}
 #endif
-	/* Get the full tuple from the primary index. */
-	if (vy_get_by_secondary_tuple(it->lsm, it->tx,
-				      vy_tx_read_view(it->tx),
-				      tuple, ret) != 0)
+	/* Get the full tuples from the primary index. */
+	if (vinyl_iterator_lookup_batch(it) != 0)
+		return -1;
+	/*
+	 * Lookups may yield, so remember the versions after
+	 * they are done: a batch that is stale right away
+	 * would be read over and over again under a steady
+	 * write load.
+	 */
+	vinyl_iterator_batch_version(it, &it->batch_version);
+	it->batch_size = MIN(it->batch_size * 2, VINYL_ITERATOR_BATCH_MAX);
+	return 0;
+}
+
+static int
+vinyl_iterator_secondary_next(struct iterator *base, struct tuple **ret)
+{
+	assert(base->next = vinyl_iterator_secondary_next);
+	struct vinyl_iterator *it = (struct vinyl_iterator *)base;
+	assert(it->lsm->index_id > 0);
+
+next:
+	if (vinyl_iterator_check_tx(it) != 0)
+		goto fail;
+
+	if (it->batch_pos < it->batch_count &&
+	    vinyl_iterator_batch_is_stale(it))
+		vinyl_iterator_drop_batch(it);
+
+	if (it->batch_pos == it->batch_count && !it->batch_eof &&
+	    vinyl_iterator_fill_batch(it) != 0)
 		goto fail;
+
+	if (it->batch_pos == it->batch_count) {
+		assert(it->batch_eof);
+		/* EOF. Close the iterator immediately. */
+		vy_read_iterator_cache_add(&it->iterator, NULL);
+		vinyl_iterator_close(it);
+		*ret = NULL;
+		return 0;
+	}
+	struct vinyl_iterator_lookup *lookup = &it->batch[it->batch_pos++];
+	if (it->batch_last_key != NULL)
+		tuple_unref(it->batch_last_key);
+	it->batch_last_key = lookup->key;
+	*ret = lookup->result;
 	if (*ret == NULL)
 		goto next;
 	vy_read_iterator_cache_add(&it->iterator, *ret);
@@ -3786,8 +4168,9 @@ vinyl_iterator_free(struct iterator *base)
 }
 
 static struct iterator *
-vinyl_index_create_iterator(struct index *base, enum iterator_type type,
-			    const char *key, uint32_t part_count)
+vinyl_index_create_iterator_impl(struct index *base, enum iterator_type type,
+				 const char *key, uint32_t part_count,
+				 bool key_only)
 {
 	struct vy_lsm *lsm = vy_lsm(base);
 	struct vy_env *env = vy_env(base->engine);
@@ -3811,14 +4194,21 @@ vinyl_index_create_iterator(struct index *base, enum iterator_type type,
 	}
 
 	iterator_create(&it->base, base);
-	if (lsm->index_id == 0)
+	if (vy_lsm_is_covering(lsm))
 		it->base.next = vinyl_iterator_primary_next;
+	else if (key_only)
+		it->base.next = vinyl_iterator_key_next;
 	else
 		it->base.next = vinyl_iterator_secondary_next;
 	it->base.free = vinyl_iterator_free;
 
 	it->env = env;
 	it->lsm = lsm;
+	it->batch_count = 0;
+	it->batch_pos = 0;
+	it->batch_size = 1;
+	it->batch_eof = false;
+	it->batch_last_key = NULL;
 	vy_lsm_ref(lsm);
 
 	struct vy_tx *tx = in_txn() ? in_txn()->engine_tx : NULL;
@@ -3842,6 +4232,22 @@ vinyl_index_create_iterator(struct index *base, enum iterator_type type,
 	return (struct iterator *)it;
 }
 
+static struct iterator *
+vinyl_index_create_iterator(struct index *base, enum iterator_type type,
+			    const char *key, uint32_t part_count)
+{
+	return vinyl_index_create_iterator_impl(base, type, key,
+						part_count, false);
+}
+
+static struct iterator *
+vinyl_index_create_key_iterator(struct index *base, enum iterator_type type,
+				const char *key, uint32_t part_count)
+{
+	return vinyl_index_create_iterator_impl(base, type, key,
+						part_count, true);
+}
+
 static int
 vinyl_index_get(struct index *index, const char *key,
 		uint32_t part_count, struct tuple **ret)
@@ -4229,6 +4635,8 @@ vinyl_space_build_index(struct space *src_space, struct index *new_index,
 						   new_format, tuple);
 			if (rc != 0)
 				break;
+			if (space_has_ndv(src_space))
+				index_ndv_add(new_index, NULL, tuple);
 		}
 		/*
 		 * Read iterator yields only when it reads runs.
@@ -4299,6 +4707,7 @@ static const struct space_vtab vinyl_space_vtab = {
 	/* .execute_delete = */ vinyl_space_execute_delete,
 	/* .execute_update = */ vinyl_space_execute_update,
 	/* .execute_upsert = */ vinyl_space_execute_upsert,
+	/* .execute_delete_range = */ vinyl_space_execute_delete_range,
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .init_system_space = */ generic_init_system_space,
@@ -4332,6 +4741,7 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .get = */ vinyl_index_get,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
+	/* .create_key_iterator = */ vinyl_index_create_key_iterator,
 	/* .create_snapshot_iterator = */
 		generic_index_create_snapshot_iterator,
 	/* .stat = */ vinyl_index_stat,
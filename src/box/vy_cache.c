@@ -495,6 +495,34 @@ vy_cache_on_write(struct vy_cache *cache, const struct tuple *stmt,
 	}
 }
 
+void
+vy_cache_on_delete_range(struct vy_cache *cache, const struct tuple *begin,
+			 const struct tuple *end)
+{
+	struct vy_cache_tree *tree = &cache->cache_tree;
+	while (true) {
+		struct vy_cache_tree_iterator itr;
+		if (begin != NULL) {
+			bool exact;
+			itr = vy_cache_tree_lower_bound(tree, begin, &exact);
+		} else {
+			itr = vy_cache_tree_iterator_first(tree);
+		}
+		struct vy_cache_entry **entry =
+			vy_cache_tree_iterator_get_elem(tree, &itr);
+		if (entry == NULL)
+			break;
+		if (end != NULL &&
+		    vy_stmt_compare((*entry)->stmt, end, cache->cmp_def) >= 0)
+			break;
+		/*
+		 * Deleting an entry breaks chains it participates
+		 * in so we don't need to care about links here.
+		 */
+		vy_cache_on_write(cache, (*entry)->stmt, NULL);
+	}
+}
+
 /**
  * Get a stmt by current position
  */
@@ -220,6 +220,17 @@ void
 vy_cache_on_write(struct vy_cache *cache, const struct tuple *stmt,
 		  struct tuple **deleted);
 
+/**
+ * Invalidate all cached values in range [begin, end) due to
+ * range deletion.
+ * @param cache - pointer to tuple cache.
+ * @param begin - begin of the range or NULL if unbounded.
+ * @param end - end of the range or NULL if unbounded.
+ */
+void
+vy_cache_on_delete_range(struct vy_cache *cache, const struct tuple *begin,
+			 const struct tuple *end);
+
 
 /**
  * Cache iterator
@@ -60,6 +60,41 @@ vy_history_append_stmt(struct vy_history *history, struct tuple *stmt)
 	return 0;
 }
 
+int
+vy_history_cut(struct vy_history *history, int64_t lsn,
+	       struct tuple_format *format)
+{
+	struct vy_history_node *node = NULL, *iter;
+	rlist_foreach_entry(iter, &history->stmts, link) {
+		if (vy_stmt_lsn(iter->stmt) < lsn) {
+			node = iter;
+			break;
+		}
+	}
+	if (node == NULL)
+		return 0;
+	/*
+	 * Create the DELETE before releasing the statement,
+	 * because it may be unrefable.
+	 */
+	struct tuple *delete = vy_stmt_new_surrogate_delete(format,
+							    node->stmt);
+	if (delete == NULL)
+		return -1;
+	vy_stmt_set_lsn(delete, lsn);
+	while (&node->link != &history->stmts) {
+		struct vy_history_node *next = rlist_next_entry(node, link);
+		rlist_del_entry(node, link);
+		if (node->is_refable)
+			tuple_unref(node->stmt);
+		mempool_free(history->pool, node);
+		node = next;
+	}
+	int rc = vy_history_append_stmt(history, delete);
+	tuple_unref(delete);
+	return rc;
+}
+
 void
 vy_history_cleanup(struct vy_history *history)
 {
@@ -141,6 +141,16 @@ vy_history_splice(struct vy_history *dst, struct vy_history *src)
 int
 vy_history_append_stmt(struct vy_history *history, struct tuple *stmt);
 
+/**
+ * Replace all statements of a history list that are older than
+ * the given LSN with a single DELETE having this LSN. Used for
+ * applying range tombstones. Returns 0 on success, -1 on memory
+ * allocation error.
+ */
+int
+vy_history_cut(struct vy_history *history, int64_t lsn,
+	       struct tuple_format *format);
+
 /**
  * Release all statements stored in the given history and
  * reinitialize the history list.
@@ -84,6 +84,7 @@ enum vy_log_key {
 	VY_LOG_KEY_MODIFY_LSN		= 13,
 	VY_LOG_KEY_DROP_LSN		= 14,
 	VY_LOG_KEY_GROUP_ID		= 15,
+	VY_LOG_KEY_TOMBSTONE_ID		= 16,
 };
 
 /** vy_log_key -> human readable name. */
@@ -104,6 +105,7 @@ static const char *vy_log_key_name[] = {
 	[VY_LOG_KEY_MODIFY_LSN]		= "modify_lsn",
 	[VY_LOG_KEY_DROP_LSN]		= "drop_lsn",
 	[VY_LOG_KEY_GROUP_ID]		= "group_id",
+	[VY_LOG_KEY_TOMBSTONE_ID]	= "tombstone_id",
 };
 
 /** vy_log_type -> human readable name. */
@@ -126,6 +128,8 @@ static const char *vy_log_type_name[] = {
 	[VY_LOG_PREPARE_LSM]		= "prepare_lsm",
 	[VY_LOG_REBOOTSTRAP]		= "rebootstrap",
 	[VY_LOG_ABORT_REBOOTSTRAP]	= "abort_rebootstrap",
+	[VY_LOG_INSERT_TOMBSTONE]	= "insert_tombstone",
+	[VY_LOG_DELETE_TOMBSTONE]	= "delete_tombstone",
 };
 
 /** Metadata log object. */
@@ -271,6 +275,10 @@ vy_log_record_snprint(char *buf, int size, const struct vy_log_record *record)
 		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
 			vy_log_key_name[VY_LOG_KEY_SLICE_ID],
 			record->slice_id);
+	if (record->tombstone_id > 0)
+		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
+			vy_log_key_name[VY_LOG_KEY_TOMBSTONE_ID],
+			record->tombstone_id);
 	if (record->create_lsn > 0)
 		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
 			vy_log_key_name[VY_LOG_KEY_CREATE_LSN],
@@ -392,6 +400,11 @@ vy_log_record_encode(const struct vy_log_record *record,
 		size += mp_sizeof_uint(record->slice_id);
 		n_keys++;
 	}
+	if (record->tombstone_id > 0) {
+		size += mp_sizeof_uint(VY_LOG_KEY_TOMBSTONE_ID);
+		size += mp_sizeof_uint(record->tombstone_id);
+		n_keys++;
+	}
 	if (record->create_lsn > 0) {
 		size += mp_sizeof_uint(VY_LOG_KEY_CREATE_LSN);
 		size += mp_sizeof_uint(record->create_lsn);
@@ -479,6 +492,10 @@ vy_log_record_encode(const struct vy_log_record *record,
 		pos = mp_encode_uint(pos, VY_LOG_KEY_SLICE_ID);
 		pos = mp_encode_uint(pos, record->slice_id);
 	}
+	if (record->tombstone_id > 0) {
+		pos = mp_encode_uint(pos, VY_LOG_KEY_TOMBSTONE_ID);
+		pos = mp_encode_uint(pos, record->tombstone_id);
+	}
 	if (record->create_lsn > 0) {
 		pos = mp_encode_uint(pos, VY_LOG_KEY_CREATE_LSN);
 		pos = mp_encode_uint(pos, record->create_lsn);
@@ -611,6 +628,9 @@ vy_log_record_decode(struct vy_log_record *record,
 		case VY_LOG_KEY_SLICE_ID:
 			record->slice_id = mp_decode_uint(&pos);
 			break;
+		case VY_LOG_KEY_TOMBSTONE_ID:
+			record->tombstone_id = mp_decode_uint(&pos);
+			break;
 		case VY_LOG_KEY_CREATE_LSN:
 			record->create_lsn = mp_decode_uint(&pos);
 			break;
@@ -1277,6 +1297,18 @@ vy_recovery_lookup_slice(struct vy_recovery *recovery, int64_t slice_id)
 	return mh_i64ptr_node(h, k)->val;
 }
 
+/** Lookup a range tombstone in vy_recovery::tombstone_hash map. */
+static struct vy_tombstone_recovery_info *
+vy_recovery_lookup_tombstone(struct vy_recovery *recovery,
+			     int64_t tombstone_id)
+{
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	mh_int_t k = mh_i64ptr_find(h, tombstone_id, NULL);
+	if (k == mh_end(h))
+		return NULL;
+	return mh_i64ptr_node(h, k)->val;
+}
+
 /**
  * Allocate a new LSM tree with the given ID and add it to
  * the recovery context.
@@ -1332,6 +1364,7 @@ vy_recovery_do_create_lsm(struct vy_recovery *recovery, int64_t id,
 	lsm->prepared = NULL;
 	rlist_create(&lsm->ranges);
 	rlist_create(&lsm->runs);
+	rlist_create(&lsm->tombstones);
 	/*
 	 * Keep newer LSM trees closer to the tail of the list
 	 * so that on log rotation we create/drop past incarnations
@@ -1516,6 +1549,19 @@ vy_recovery_forget_lsm(struct vy_recovery *recovery, int64_t id)
 	}
 	mh_i64ptr_del(h, k, NULL);
 	rlist_del_entry(lsm, in_recovery);
+	/*
+	 * Range tombstones aren't deleted explicitly when
+	 * the LSM tree is dropped so free them silently.
+	 */
+	struct vy_tombstone_recovery_info *tombstone, *next_tombstone;
+	rlist_foreach_entry_safe(tombstone, &lsm->tombstones, in_lsm,
+				 next_tombstone) {
+		h = recovery->tombstone_hash;
+		k = mh_i64ptr_find(h, tombstone->id, NULL);
+		assert(k != mh_end(h));
+		mh_i64ptr_del(h, k, NULL);
+		free(tombstone);
+	}
 	free(lsm->key_parts);
 	free(lsm);
 	return 0;
@@ -1921,6 +1967,104 @@ vy_recovery_delete_slice(struct vy_recovery *recovery, int64_t slice_id)
 	return 0;
 }
 
+/**
+ * Handle a VY_LOG_INSERT_TOMBSTONE log record.
+ * This function allocates a new range tombstone with ID
+ * @tombstone_id, inserts it into the hash, and adds it to
+ * the list of tombstones of the LSM tree with ID @lsm_id.
+ * Return 0 on success, -1 on failure (ID collision or OOM).
+ */
+static int
+vy_recovery_insert_tombstone(struct vy_recovery *recovery, int64_t lsm_id,
+			     int64_t tombstone_id, const char *begin,
+			     const char *end, int64_t lsn)
+{
+	if (vy_recovery_lookup_tombstone(recovery, tombstone_id) != NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Duplicate tombstone id %lld",
+				    (long long)tombstone_id));
+		return -1;
+	}
+	struct vy_lsm_recovery_info *lsm;
+	lsm = vy_recovery_lookup_lsm(recovery, lsm_id);
+	if (lsm == NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Tombstone %lld created for unregistered "
+				    "LSM tree %lld", (long long)tombstone_id,
+				    (long long)lsm_id));
+		return -1;
+	}
+
+	size_t size = sizeof(struct vy_tombstone_recovery_info);
+	const char *data;
+	data = begin;
+	if (data != NULL)
+		mp_next(&data);
+	size_t begin_size = data - begin;
+	size += begin_size;
+	data = end;
+	if (data != NULL)
+		mp_next(&data);
+	size_t end_size = data - end;
+	size += end_size;
+
+	struct vy_tombstone_recovery_info *tombstone = malloc(size);
+	if (tombstone == NULL) {
+		diag_set(OutOfMemory, size,
+			 "malloc", "struct vy_tombstone_recovery_info");
+		return -1;
+	}
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	struct mh_i64ptr_node_t node = { tombstone_id, tombstone };
+	if (mh_i64ptr_put(h, &node, NULL, NULL) == mh_end(h)) {
+		diag_set(OutOfMemory, 0, "mh_i64ptr_put", "mh_i64ptr_node_t");
+		free(tombstone);
+		return -1;
+	}
+	tombstone->id = tombstone_id;
+	tombstone->lsn = lsn;
+	if (begin != NULL) {
+		tombstone->begin = (void *)tombstone + sizeof(*tombstone);
+		memcpy(tombstone->begin, begin, begin_size);
+	} else
+		tombstone->begin = NULL;
+	if (end != NULL) {
+		tombstone->end = (void *)tombstone + sizeof(*tombstone) +
+				 begin_size;
+		memcpy(tombstone->end, end, end_size);
+	} else
+		tombstone->end = NULL;
+	rlist_add_tail_entry(&lsm->tombstones, tombstone, in_lsm);
+	if (recovery->max_id < tombstone_id)
+		recovery->max_id = tombstone_id;
+	return 0;
+}
+
+/**
+ * Handle a VY_LOG_DELETE_TOMBSTONE log record.
+ * This function frees the range tombstone with ID @tombstone_id.
+ * Return 0 on success, -1 if tombstone not found.
+ */
+static int
+vy_recovery_delete_tombstone(struct vy_recovery *recovery,
+			     int64_t tombstone_id)
+{
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	mh_int_t k = mh_i64ptr_find(h, tombstone_id, NULL);
+	if (k == mh_end(h)) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Tombstone %lld deleted but not registered",
+				    (long long)tombstone_id));
+		return -1;
+	}
+	struct vy_tombstone_recovery_info *tombstone;
+	tombstone = mh_i64ptr_node(h, k)->val;
+	mh_i64ptr_del(h, k, NULL);
+	rlist_del_entry(tombstone, in_lsm);
+	free(tombstone);
+	return 0;
+}
+
 /**
  * Mark all LSM trees created during rebootstrap as dropped so
  * that they will be purged on the next garbage collection.
@@ -2029,6 +2173,15 @@ vy_recovery_process_record(struct vy_recovery *recovery,
 		rc = vy_recovery_dump_lsm(recovery, record->lsm_id,
 					    record->dump_lsn);
 		break;
+	case VY_LOG_INSERT_TOMBSTONE:
+		rc = vy_recovery_insert_tombstone(recovery, record->lsm_id,
+				record->tombstone_id, record->begin,
+				record->end, record->create_lsn);
+		break;
+	case VY_LOG_DELETE_TOMBSTONE:
+		rc = vy_recovery_delete_tombstone(recovery,
+						  record->tombstone_id);
+		break;
 	case VY_LOG_TRUNCATE_LSM:
 		/* Not used anymore, ignore. */
 		rc = 0;
@@ -2158,6 +2311,7 @@ vy_recovery_new_f(va_list ap)
 	recovery->range_hash = NULL;
 	recovery->run_hash = NULL;
 	recovery->slice_hash = NULL;
+	recovery->tombstone_hash = NULL;
 	recovery->max_id = -1;
 	recovery->in_rebootstrap = false;
 
@@ -2166,11 +2320,13 @@ vy_recovery_new_f(va_list ap)
 	recovery->range_hash = mh_i64ptr_new();
 	recovery->run_hash = mh_i64ptr_new();
 	recovery->slice_hash = mh_i64ptr_new();
+	recovery->tombstone_hash = mh_i64ptr_new();
 	if (recovery->index_id_hash == NULL ||
 	    recovery->lsm_hash == NULL ||
 	    recovery->range_hash == NULL ||
 	    recovery->run_hash == NULL ||
-	    recovery->slice_hash == NULL) {
+	    recovery->slice_hash == NULL ||
+	    recovery->tombstone_hash == NULL) {
 		diag_set(OutOfMemory, 0, "mh_i64ptr_new", "mh_i64ptr_t");
 		goto fail_free;
 	}
@@ -2285,6 +2441,7 @@ vy_recovery_delete(struct vy_recovery *recovery)
 	struct vy_range_recovery_info *range, *next_range;
 	struct vy_slice_recovery_info *slice, *next_slice;
 	struct vy_run_recovery_info *run, *next_run;
+	struct vy_tombstone_recovery_info *tombstone, *next_tombstone;
 
 	rlist_foreach_entry_safe(lsm, &recovery->lsms, in_recovery, next_lsm) {
 		rlist_foreach_entry_safe(range, &lsm->ranges,
@@ -2296,6 +2453,9 @@ vy_recovery_delete(struct vy_recovery *recovery)
 		}
 		rlist_foreach_entry_safe(run, &lsm->runs, in_lsm, next_run)
 			free(run);
+		rlist_foreach_entry_safe(tombstone, &lsm->tombstones,
+					 in_lsm, next_tombstone)
+			free(tombstone);
 		free(lsm->key_parts);
 		free(lsm);
 	}
@@ -2309,6 +2469,8 @@ vy_recovery_delete(struct vy_recovery *recovery)
 		mh_i64ptr_delete(recovery->run_hash);
 	if (recovery->slice_hash != NULL)
 		mh_i64ptr_delete(recovery->slice_hash);
+	if (recovery->tombstone_hash != NULL)
+		mh_i64ptr_delete(recovery->tombstone_hash);
 	TRASH(recovery);
 	free(recovery);
 }
@@ -2334,6 +2496,7 @@ vy_log_append_lsm(struct xlog *xlog, struct vy_lsm_recovery_info *lsm)
 	struct vy_range_recovery_info *range;
 	struct vy_slice_recovery_info *slice;
 	struct vy_run_recovery_info *run;
+	struct vy_tombstone_recovery_info *tombstone;
 	struct vy_log_record record;
 
 	vy_log_record_init(&record);
@@ -2402,6 +2565,18 @@ vy_log_append_lsm(struct xlog *xlog, struct vy_lsm_recovery_info *lsm)
 		}
 	}
 
+	rlist_foreach_entry(tombstone, &lsm->tombstones, in_lsm) {
+		vy_log_record_init(&record);
+		record.type = VY_LOG_INSERT_TOMBSTONE;
+		record.lsm_id = lsm->id;
+		record.tombstone_id = tombstone->id;
+		record.begin = tombstone->begin;
+		record.end = tombstone->end;
+		record.create_lsn = tombstone->lsn;
+		if (vy_log_append_record(xlog, &record) != 0)
+			return -1;
+	}
+
 	if (lsm->drop_lsn >= 0) {
 		vy_log_record_init(&record);
 		record.type = VY_LOG_DROP_LSM;
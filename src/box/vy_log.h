@@ -217,6 +217,24 @@ enum vy_log_record_type {
 	 * See also VY_LOG_REBOOTSTRAP.
 	 */
 	VY_LOG_ABORT_REBOOTSTRAP	= 17,
+	/**
+	 * Insert a range tombstone into an LSM tree.
+	 * Requires vy_log_record::lsm_id, tombstone_id, begin, end,
+	 * create_lsn.
+	 *
+	 * A range tombstone deletes all statements of the LSM tree
+	 * in range [begin, end) older than create_lsn. It is written
+	 * when DELETE_RANGE is committed to WAL.
+	 */
+	VY_LOG_INSERT_TOMBSTONE		= 18,
+	/**
+	 * Delete a range tombstone.
+	 * Requires vy_log_record::tombstone_id.
+	 *
+	 * Written when there is no data left the tombstone can
+	 * cover.
+	 */
+	VY_LOG_DELETE_TOMBSTONE		= 19,
 
 	vy_log_record_type_MAX
 };
@@ -233,14 +251,16 @@ struct vy_log_record {
 	int64_t run_id;
 	/** Unique ID of the run slice. */
 	int64_t slice_id;
+	/** Unique ID of the range tombstone. */
+	int64_t tombstone_id;
 	/**
-	 * Msgpack key for start of the range/slice.
-	 * NULL if the range/slice starts from -inf.
+	 * Msgpack key for start of the range/slice/tombstone.
+	 * NULL if the range/slice/tombstone starts from -inf.
 	 */
 	const char *begin;
 	/**
-	 * Msgpack key for end of the range/slice.
-	 * NULL if the range/slice ends with +inf.
+	 * Msgpack key for end of the range/slice/tombstone.
+	 * NULL if the range/slice/tombstone ends with +inf.
 	 */
 	const char *end;
 	/** Ordinal index number in the space. */
@@ -255,7 +275,7 @@ struct vy_log_record {
 	struct key_part_def *key_parts;
 	/** Number of key parts. */
 	uint32_t key_part_count;
-	/** LSN of the WAL row that created the LSM tree. */
+	/** LSN of the WAL row that created the LSM tree/tombstone. */
 	int64_t create_lsn;
 	/** LSN of the WAL row that last modified the LSM tree. */
 	int64_t modify_lsn;
@@ -292,6 +312,8 @@ struct vy_recovery {
 	struct mh_i64ptr_t *run_hash;
 	/** ID -> vy_slice_recovery_info. */
 	struct mh_i64ptr_t *slice_hash;
+	/** ID -> vy_tombstone_recovery_info. */
+	struct mh_i64ptr_t *tombstone_hash;
 	/**
 	 * Maximal vinyl object ID, according to the metadata log,
 	 * or -1 in case no vinyl objects were recovered.
@@ -348,6 +370,11 @@ struct vy_lsm_recovery_info {
 	 * vy_run_recovery_info::in_lsm.
 	 */
 	struct rlist runs;
+	/**
+	 * List of all range tombstones of the LSM tree, linked
+	 * by vy_tombstone_recovery_info::in_lsm, in LSN order.
+	 */
+	struct rlist tombstones;
 	/**
 	 * Pointer to an LSM tree that is going to replace
 	 * this one after successful ALTER.
@@ -421,6 +448,20 @@ struct vy_slice_recovery_info {
 	char *end;
 };
 
+/** Range tombstone info stored in a recovery context. */
+struct vy_tombstone_recovery_info {
+	/** Link in vy_lsm_recovery_info::tombstones. */
+	struct rlist in_lsm;
+	/** ID of the tombstone. */
+	int64_t id;
+	/** LSN of the WAL row that created the tombstone. */
+	int64_t lsn;
+	/** Start of the deleted range, stored in MsgPack array. */
+	char *begin;
+	/** End of the deleted range, stored in MsgPack array. */
+	char *end;
+};
+
 /**
  * Initialize the metadata log.
  * @dir is the directory where log files are stored.
@@ -771,6 +812,33 @@ vy_log_delete_slice(int64_t slice_id)
 	vy_log_write(&record);
 }
 
+/** Helper to log a range tombstone insertion. */
+static inline void
+vy_log_insert_tombstone(int64_t lsm_id, int64_t tombstone_id,
+			const char *begin, const char *end, int64_t lsn)
+{
+	struct vy_log_record record;
+	vy_log_record_init(&record);
+	record.type = VY_LOG_INSERT_TOMBSTONE;
+	record.lsm_id = lsm_id;
+	record.tombstone_id = tombstone_id;
+	record.begin = begin;
+	record.end = end;
+	record.create_lsn = lsn;
+	vy_log_write(&record);
+}
+
+/** Helper to log a range tombstone deletion. */
+static inline void
+vy_log_delete_tombstone(int64_t tombstone_id)
+{
+	struct vy_log_record record;
+	vy_log_record_init(&record);
+	record.type = VY_LOG_DELETE_TOMBSTONE;
+	record.tombstone_id = tombstone_id;
+	vy_log_write(&record);
+}
+
 /** Helper to log LSM tree dump. */
 static inline void
 vy_log_dump_lsm(int64_t id, int64_t dump_lsn)
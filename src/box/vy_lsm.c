@@ -53,6 +53,7 @@
 #include "vy_upsert.h"
 #include "vy_history.h"
 #include "vy_read_set.h"
+#include "vy_tombstone.h"
 
 int
 vy_lsm_env_create(struct vy_lsm_env *env, const char *path,
@@ -145,10 +146,10 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 
 	lsm->cmp_def = cmp_def;
 	lsm->key_def = key_def;
-	if (index_def->iid == 0) {
+	if (index_def->iid == 0 || index_def->opts.is_covering) {
 		/*
 		 * Disk tuples can be returned to an user from a
-		 * primary key. And they must have field
+		 * primary or covering key. And they must have field
 		 * definitions as well as space->format tuples.
 		 */
 		lsm->disk_format = format;
@@ -206,6 +207,8 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 	lsm->opts = index_def->opts;
 	lsm->check_is_unique = lsm->opts.is_unique;
 	vy_lsm_read_set_new(&lsm->read_set);
+	rlist_create(&lsm->tombstones);
+	rlist_create(&lsm->disk_lookups);
 
 	lsm_env->lsm_count++;
 	return lsm;
@@ -249,6 +252,7 @@ vy_lsm_delete(struct vy_lsm *lsm)
 	assert(lsm->in_dump.pos == UINT32_MAX);
 	assert(lsm->in_compact.pos == UINT32_MAX);
 	assert(vy_lsm_read_set_empty(&lsm->read_set));
+	assert(rlist_empty(&lsm->disk_lookups));
 	assert(lsm->env->lsm_count > 0);
 
 	lsm->env->lsm_count--;
@@ -265,6 +269,11 @@ vy_lsm_delete(struct vy_lsm *lsm)
 	rlist_foreach_entry_safe(run, &lsm->runs, in_lsm, next_run)
 		vy_lsm_remove_run(lsm, run);
 
+	struct vy_tombstone *tombstone, *next_tombstone;
+	rlist_foreach_entry_safe(tombstone, &lsm->tombstones, in_lsm,
+				 next_tombstone)
+		vy_lsm_remove_tombstone(lsm, tombstone);
+
 	vy_range_tree_iter(lsm->tree, NULL, vy_range_tree_free_cb, NULL);
 	vy_range_heap_destroy(&lsm->range_heap);
 	tuple_format_unref(lsm->disk_format);
@@ -661,6 +670,22 @@ vy_lsm_recover(struct vy_lsm *lsm, struct vy_recovery *recovery,
 				    (long long)prev->id));
 		return -1;
 	}
+
+	/*
+	 * Recover range tombstones. They are stored in vylog
+	 * in the order they were committed.
+	 */
+	struct vy_tombstone_recovery_info *tombstone_info;
+	rlist_foreach_entry(tombstone_info, &lsm_info->tombstones, in_lsm) {
+		struct vy_tombstone *tombstone = vy_tombstone_new(
+				tombstone_info->id, tombstone_info->lsn,
+				tombstone_info->begin, tombstone_info->end,
+				lsm->env->key_format);
+		if (tombstone == NULL)
+			return -1;
+		vy_lsm_add_tombstone(lsm, tombstone);
+		vy_tombstone_unref(tombstone);
+	}
 	return 0;
 }
 
@@ -771,6 +796,79 @@ vy_lsm_delete_mem(struct vy_lsm *lsm, struct vy_mem *mem)
 	lsm->mem_list_version++;
 }
 
+void
+vy_lsm_add_tombstone(struct vy_lsm *lsm, struct vy_tombstone *tombstone)
+{
+	assert(rlist_empty(&tombstone->in_lsm));
+	assert(rlist_empty(&lsm->tombstones) ||
+	       rlist_last_entry(&lsm->tombstones, struct vy_tombstone,
+				in_lsm)->lsn < tombstone->lsn);
+	rlist_add_tail_entry(&lsm->tombstones, tombstone, in_lsm);
+	vy_tombstone_ref(tombstone);
+	/* Make iterators that yielded on disk restart. */
+	lsm->mem_list_version++;
+}
+
+void
+vy_lsm_remove_tombstone(struct vy_lsm *lsm, struct vy_tombstone *tombstone)
+{
+	assert(!rlist_empty(&tombstone->in_lsm));
+	rlist_del_entry(tombstone, in_lsm);
+	vy_tombstone_unref(tombstone);
+	lsm->mem_list_version++;
+}
+
+/**
+ * Return true if an in-memory tree may store a statement
+ * covered by a range tombstone. Note, min_lsn of an empty
+ * tree is INT64_MAX.
+ */
+static bool
+vy_lsm_tombstone_covers_mem(struct vy_tombstone *tombstone,
+			    struct vy_mem *mem)
+{
+	return mem->min_lsn < tombstone->lsn;
+}
+
+bool
+vy_lsm_tombstone_is_used(struct vy_lsm *lsm, struct vy_tombstone *tombstone)
+{
+	struct vy_mem *mem;
+	if (vy_lsm_tombstone_covers_mem(tombstone, lsm->mem))
+		return true;
+	rlist_foreach_entry(mem, &lsm->sealed, in_sealed) {
+		if (vy_lsm_tombstone_covers_mem(tombstone, mem))
+			return true;
+	}
+	struct vy_run *run;
+	rlist_foreach_entry(run, &lsm->runs, in_lsm) {
+		if (run->info.min_lsn >= tombstone->lsn ||
+		    run->info.min_key == NULL)
+			continue;
+		if (vy_tombstone_overlaps_range(tombstone, run->info.min_key,
+						run->info.max_key,
+						lsm->cmp_def))
+			return true;
+	}
+	return false;
+}
+
+int
+vy_lsm_apply_tombstones(struct vy_lsm *lsm, struct vy_history *history,
+			int64_t vlsn)
+{
+	if (rlist_empty(&lsm->tombstones))
+		return 0;
+	struct tuple *stmt = vy_history_last_stmt(history);
+	if (stmt == NULL)
+		return 0;
+	int64_t lsn = vy_tombstone_list_lsn(&lsm->tombstones, stmt,
+					    vlsn, lsm->cmp_def);
+	if (lsn == 0)
+		return 0;
+	return vy_history_cut(history, lsn, lsm->mem_format);
+}
+
 int
 vy_lsm_set(struct vy_lsm *lsm, struct vy_mem *mem,
 	   const struct tuple *stmt, const struct tuple **region_stmt)
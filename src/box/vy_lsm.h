@@ -52,12 +52,14 @@ extern "C" {
 struct histogram;
 struct tuple;
 struct tuple_format;
+struct vy_history;
 struct vy_lsm;
 struct vy_mem;
 struct vy_mem_env;
 struct vy_recovery;
 struct vy_run;
 struct vy_run_env;
+struct vy_tombstone;
 
 typedef void
 (*vy_upsert_thresh_cb)(struct vy_lsm *lsm, struct tuple *stmt, void *arg);
@@ -290,6 +292,19 @@ struct vy_lsm {
 	 * this LSM tree.
 	 */
 	vy_lsm_read_set_t read_set;
+	/**
+	 * List of range tombstones that may cover statements
+	 * stored in this LSM tree, sorted by LSN in ascending
+	 * order. Linked by vy_tombstone::in_lsm.
+	 */
+	struct rlist tombstones;
+	/**
+	 * List of point lookups that are currently reading this
+	 * LSM tree from disk. Linked by vy_disk_lookup::in_lsm.
+	 * Used to avoid reading the same key from disk by
+	 * concurrent fibers, see vy_point_lookup().
+	 */
+	struct rlist disk_lookups;
 };
 
 /** Return LSM tree name. Used for logging. */
@@ -300,6 +315,18 @@ vy_lsm_name(struct vy_lsm *lsm);
 size_t
 vy_lsm_mem_tree_size(struct vy_lsm *lsm);
 
+/**
+ * Return true if an LSM tree stores full tuples on disk, i.e.
+ * it is either the primary index or a covering secondary index.
+ * Statements read from such an LSM tree can be returned to the
+ * user as is.
+ */
+static inline bool
+vy_lsm_is_covering(struct vy_lsm *lsm)
+{
+	return lsm->index_id == 0 || lsm->opts.is_covering;
+}
+
 /** Allocate a new LSM tree object. */
 struct vy_lsm *
 vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
@@ -473,6 +500,41 @@ vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range);
 void
 vy_lsm_force_compaction(struct vy_lsm *lsm);
 
+/**
+ * Add a range tombstone to an LSM tree. The tombstone must be
+ * newer than all tombstones already added to the LSM tree.
+ */
+void
+vy_lsm_add_tombstone(struct vy_lsm *lsm, struct vy_tombstone *tombstone);
+
+/** Remove a range tombstone from an LSM tree. */
+void
+vy_lsm_remove_tombstone(struct vy_lsm *lsm, struct vy_tombstone *tombstone);
+
+/**
+ * Return true if a range tombstone may still cover a statement
+ * stored in an LSM tree, either in memory or on disk. Otherwise
+ * the tombstone may be removed.
+ */
+bool
+vy_lsm_tombstone_is_used(struct vy_lsm *lsm, struct vy_tombstone *tombstone);
+
+/**
+ * Apply range tombstones visible from a read view to a key
+ * history: all statements covered by the newest tombstone are
+ * replaced with a DELETE having the tombstone LSN.
+ *
+ * @param lsm      LSM tree the history was collected from.
+ * @param history  Key history.
+ * @param vlsn     LSN of the read view.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+vy_lsm_apply_tombstones(struct vy_lsm *lsm, struct vy_history *history,
+			int64_t vlsn);
+
 /**
  * Insert a statement into the in-memory index of an LSM tree. If
  * the region_stmt is NULL and the statement is successfully inserted
@@ -38,6 +38,7 @@
 #include <small/rlist.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
 
 #include "vy_lsm.h"
 #include "vy_stmt.h"
@@ -144,7 +145,7 @@ vy_point_lookup_scan_slice(struct vy_lsm *lsm, struct vy_slice *slice,
 	struct vy_run_iterator run_itr;
 	vy_run_iterator_open(&run_itr, &lsm->stat.disk.iterator, slice,
 			     ITER_EQ, key, rv, lsm->cmp_def, lsm->key_def,
-			     lsm->disk_format, lsm->index_id == 0);
+			     lsm->disk_format, vy_lsm_is_covering(lsm));
 	struct vy_history slice_history;
 	vy_history_create(&slice_history, &lsm->env->history_node_pool);
 	int rc = vy_run_iterator_next(&run_itr, &slice_history);
@@ -191,6 +192,43 @@ vy_point_lookup_scan_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
 	return rc;
 }
 
+/**
+ * Point lookup that is reading an LSM tree from disk.
+ *
+ * A hot key that is missing in the cache may be looked up by
+ * many fibers at the same time. To avoid reading it from disk
+ * more than once, a fiber that is about to read disk checks if
+ * the key is already being read by another fiber and if it is,
+ * waits for the read to complete and then retries the lookup,
+ * which will most likely hit the cache populated by the first
+ * fiber, see vy_get().
+ */
+struct vy_disk_lookup {
+	/** Link in vy_lsm::disk_lookups. */
+	struct rlist in_lsm;
+	/** Key that is being looked up. */
+	struct tuple *key;
+	/** Signalled when the disk read is complete. */
+	struct fiber_cond cond;
+};
+
+/**
+ * Wait for a concurrent disk lookup of the given key to
+ * complete. Return true if there was one, false otherwise.
+ */
+static bool
+vy_point_lookup_wait_disk(struct vy_lsm *lsm, struct tuple *key)
+{
+	struct vy_disk_lookup *lookup;
+	rlist_foreach_entry(lookup, &lsm->disk_lookups, in_lsm) {
+		if (vy_stmt_compare(key, lookup->key, lsm->cmp_def) == 0) {
+			fiber_cond_wait(&lookup->cond);
+			return true;
+		}
+	}
+	return false;
+}
+
 int
 vy_point_lookup(struct vy_lsm *lsm, struct vy_tx *tx,
 		const struct vy_read_view **rv,
@@ -218,16 +256,50 @@ vy_point_lookup(struct vy_lsm *lsm, struct vy_tx *tx,
 	if (rc != 0 || vy_history_is_terminal(&history))
 		goto done;
 
+	/*
+	 * Only lookups from the global read view populate the
+	 * cache so there's no point in waiting for a concurrent
+	 * disk read otherwise.
+	 */
+	bool is_cacheable = ((*rv)->vlsn == INT64_MAX &&
+			     lsm->cache.env->mem_quota > 0);
+	bool can_wait = is_cacheable;
 restart:
 	rc = vy_point_lookup_scan_mems(lsm, rv, key, &mem_history);
 	if (rc != 0 || vy_history_is_terminal(&mem_history))
 		goto done;
 
+	if (can_wait && vy_point_lookup_wait_disk(lsm, key)) {
+		/*
+		 * The key has just been read from disk by another
+		 * fiber. Retry the lookup starting from the cache.
+		 * Wait only once though, because the key may not
+		 * get to the cache, e.g. if it's missing.
+		 */
+		can_wait = false;
+		vy_history_cleanup(&mem_history);
+		rc = vy_point_lookup_scan_cache(lsm, rv, key, &history);
+		if (rc != 0 || vy_history_is_terminal(&history))
+			goto done;
+		goto restart;
+	}
+
 	/* Save version before yield */
 	uint32_t mem_version = lsm->mem->version;
 	uint32_t mem_list_version = lsm->mem_list_version;
 
+	struct vy_disk_lookup lookup;
+	if (is_cacheable) {
+		lookup.key = key;
+		fiber_cond_create(&lookup.cond);
+		rlist_add_tail_entry(&lsm->disk_lookups, &lookup, in_lsm);
+	}
 	rc = vy_point_lookup_scan_slices(lsm, rv, key, &disk_history);
+	if (is_cacheable) {
+		rlist_del_entry(&lookup, in_lsm);
+		fiber_cond_broadcast(&lookup.cond);
+		fiber_cond_destroy(&lookup.cond);
+	}
 	if (rc != 0)
 		goto done;
 
@@ -269,6 +341,8 @@ done:
 	vy_history_splice(&history, &mem_history);
 	vy_history_splice(&history, &disk_history);
 
+	if (rc == 0)
+		rc = vy_lsm_apply_tombstones(lsm, &history, (*rv)->vlsn);
 	if (rc == 0) {
 		int upserts_applied;
 		rc = vy_history_apply(&history, lsm->cmp_def, lsm->mem_format,
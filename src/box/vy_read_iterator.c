@@ -38,6 +38,14 @@
 #include "vy_lsm.h"
 #include "vy_stat.h"
 
+static bool
+vy_read_src_heap_less(heap_t *heap, struct heap_node *n1,
+		      struct heap_node *n2);
+
+#define HEAP_NAME vy_read_src_heap
+#define HEAP_LESS vy_read_src_heap_less
+#include "salad/heap.h"
+
 /**
  * Merge source, support structure for vy_read_iterator.
  * Contains source iterator and merge state.
@@ -56,6 +64,8 @@ struct vy_read_src {
 	uint32_t front_id;
 	/** History of the key the iterator is positioned at. */
 	struct vy_history history;
+	/** Link in vy_read_iterator::disk_heap. */
+	struct heap_node heap_node;
 };
 
 /**
@@ -188,6 +198,30 @@ vy_read_iterator_cmp_stmt(struct vy_read_iterator *itr,
 		vy_tuple_compare(a, b, itr->lsm->cmp_def);
 }
 
+/**
+ * Comparator of the disk source heap: the source positioned
+ * at the statement that goes first in the iterator output is
+ * on top. Sources positioned at the same key are ordered by
+ * age, newest first.
+ */
+static bool
+vy_read_src_heap_less(heap_t *heap, struct heap_node *n1,
+		      struct heap_node *n2)
+{
+	struct vy_read_iterator *itr = container_of(heap,
+			struct vy_read_iterator, disk_heap);
+	struct vy_read_src *src1 = container_of(n1, struct vy_read_src,
+						heap_node);
+	struct vy_read_src *src2 = container_of(n2, struct vy_read_src,
+						heap_node);
+	int cmp = vy_read_iterator_cmp_stmt(itr,
+			vy_history_last_stmt(&src1->history),
+			vy_history_last_stmt(&src2->history));
+	if (cmp != 0)
+		return cmp < 0;
+	return src1 < src2;
+}
+
 /**
  * Return true if the statement matches search criteria
  * and older sources don't need to be scanned.
@@ -240,6 +274,7 @@ vy_read_iterator_evaluate_src(struct vy_read_iterator *itr,
 	if (cmp < 0 && vy_history_is_terminal(&src->history) &&
 	    vy_read_iterator_is_exact_match(itr, stmt)) {
 		itr->skipped_src = src_id + 1;
+		itr->disk_heap_is_valid = false;
 		*stop = true;
 	}
 }
@@ -323,7 +358,14 @@ vy_read_iterator_scan_cache(struct vy_read_iterator *itr,
 
 	vy_read_iterator_evaluate_src(itr, src, next_key, stop);
 	if (is_interval) {
+		/*
+		 * The cache has a chain for the next key so disk
+		 * sources don't need to be scanned. They will have
+		 * to be repositioned when the chain ends, so the
+		 * disk source heap has to be rebuilt then.
+		 */
 		itr->skipped_src = itr->cache_src + 1;
+		itr->disk_heap_is_valid = false;
 		*stop = true;
 	}
 	return 0;
@@ -380,6 +422,100 @@ vy_read_iterator_scan_disk(struct vy_read_iterator *itr, uint32_t disk_src,
 	return 0;
 }
 
+/**
+ * Fill the disk source heap after all disk sources have been
+ * positioned and evaluated by vy_read_iterator_scan_disk().
+ * On memory error the heap is simply not used.
+ */
+static void
+vy_read_iterator_build_disk_heap(struct vy_read_iterator *itr)
+{
+	heap_t *heap = &itr->disk_heap;
+	heap->size = 0;
+	itr->disk_heap_is_valid = false;
+	for (uint32_t i = itr->disk_src; i < itr->src_count; i++) {
+		struct vy_read_src *src = &itr->src[i];
+		if (vy_read_src_heap_insert(heap, &src->heap_node) != 0)
+			return;
+	}
+	itr->disk_heap_is_valid = true;
+}
+
+/**
+ * Mark all disk sources positioned at the given statement
+ * as used for the next key. Starts from the given heap node
+ * and descends only while the statement matches, so this
+ * takes as many comparisons as there are matching sources
+ * plus their children.
+ */
+static void
+vy_read_iterator_mark_disk_front(struct vy_read_iterator *itr,
+				 heap_off_t pos, struct tuple *stmt)
+{
+	heap_t *heap = &itr->disk_heap;
+	if (pos >= heap->size)
+		return;
+	struct vy_read_src *src = container_of(heap->harr[pos],
+					       struct vy_read_src, heap_node);
+	if (vy_read_iterator_cmp_stmt(itr, vy_history_last_stmt(&src->history),
+				      stmt) != 0)
+		return;
+	src->front_id = itr->front_id;
+	vy_read_iterator_mark_disk_front(itr, 2 * pos + 1, stmt);
+	vy_read_iterator_mark_disk_front(itr, 2 * pos + 2, stmt);
+}
+
+/**
+ * Heap based alternative to calling vy_read_iterator_scan_disk()
+ * for each disk source. Used when all disk sources were evaluated
+ * on the previous iteration, i.e. in the middle of a range scan.
+ * Instead of comparing the statement of each source with the
+ * next key candidate, only sources that were used on the previous
+ * iteration are advanced and reinserted in the heap, then the
+ * heap top is compared with the next key candidate. This makes
+ * the cost of an iteration logarithmic in the number of runs.
+ */
+static NODISCARD int
+vy_read_iterator_merge_disk(struct vy_read_iterator *itr,
+			    struct tuple **next_key)
+{
+	assert(itr->disk_heap_is_valid);
+	heap_t *heap = &itr->disk_heap;
+	struct heap_node *node;
+	struct vy_read_src *src;
+
+	while ((node = vy_read_src_heap_top(heap)) != NULL) {
+		src = container_of(node, struct vy_read_src, heap_node);
+		if (src->front_id != itr->prev_front_id)
+			break;
+		/*
+		 * Reset front_id so that the source isn't advanced
+		 * again if it stays on top of the heap.
+		 */
+		src->front_id = 0;
+		if (vy_run_iterator_next(&src->run_iterator,
+					 &src->history) != 0) {
+			itr->disk_heap_is_valid = false;
+			return -1;
+		}
+		vy_read_src_heap_update(heap, node);
+	}
+	itr->skipped_src = itr->src_count;
+	if (node == NULL)
+		return 0;
+
+	struct tuple *stmt = vy_history_last_stmt(&src->history);
+	int cmp = vy_read_iterator_cmp_stmt(itr, stmt, *next_key);
+	if (cmp < 0) {
+		assert(stmt != NULL);
+		*next_key = stmt;
+		itr->front_id++;
+	}
+	if (cmp <= 0)
+		vy_read_iterator_mark_disk_front(itr, 0, stmt);
+	return 0;
+}
+
 /**
  * Restore the position of the active in-memory tree iterator
  * after a yield caused by a disk read and update 'next_key'
@@ -491,6 +627,13 @@ restart:
 rescan_disk:
 	/* The following code may yield as it needs to access disk. */
 	vy_read_iterator_pin_slices(itr);
+	if (itr->disk_heap_is_valid) {
+		if (vy_read_iterator_merge_disk(itr, &next_key) != 0) {
+			vy_read_iterator_unpin_slices(itr);
+			return -1;
+		}
+		goto disk_done;
+	}
 	for (uint32_t i = itr->disk_src; i < itr->src_count; i++) {
 		if (vy_read_iterator_scan_disk(itr, i, &next_key, &stop) != 0) {
 			vy_read_iterator_unpin_slices(itr);
@@ -499,6 +642,13 @@ rescan_disk:
 		if (stop)
 			break;
 	}
+	/*
+	 * If all disk sources have been evaluated, switch to
+	 * the heap based merge on the next iteration.
+	 */
+	if (!stop)
+		vy_read_iterator_build_disk_heap(itr);
+disk_done:
 	vy_read_iterator_unpin_slices(itr);
 	/*
 	 * The list of in-memory indexes and/or the range tree could
@@ -616,6 +766,7 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 	 * format with the same identifier to fully match the
 	 * format in vy_mem.
 	 */
+	itr->disk_heap_is_valid = false;
 	rlist_foreach_entry(slice, &itr->curr_range->slices, in_range) {
 		struct vy_read_src *sub_src = vy_read_iterator_add_src(itr);
 		vy_run_iterator_open(&sub_src->run_iterator,
@@ -623,7 +774,7 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 				     iterator_type, itr->key,
 				     itr->read_view, lsm->cmp_def,
 				     lsm->key_def, lsm->disk_format,
-				     lsm->index_id == 0);
+				     vy_lsm_is_covering(lsm));
 	}
 }
 
@@ -663,6 +814,7 @@ vy_read_iterator_cleanup(struct vy_read_iterator *itr)
 	itr->disk_src = UINT32_MAX;
 	itr->skipped_src = UINT32_MAX;
 	itr->src_count = 0;
+	itr->disk_heap_is_valid = false;
 }
 
 void
@@ -677,6 +829,7 @@ vy_read_iterator_open(struct vy_read_iterator *itr, struct vy_lsm *lsm,
 	itr->iterator_type = iterator_type;
 	itr->key = key;
 	itr->read_view = rv;
+	vy_read_src_heap_create(&itr->disk_heap);
 
 	if (tuple_field_count(key) == 0) {
 		/*
@@ -804,8 +957,11 @@ vy_read_iterator_apply_history(struct vy_read_iterator *itr,
 	}
 
 	int upserts_applied = 0;
-	int rc = vy_history_apply(&history, lsm->cmp_def, lsm->mem_format,
-				  true, &upserts_applied, ret);
+	int rc = vy_lsm_apply_tombstones(lsm, &history,
+					 (**itr->read_view).vlsn);
+	if (rc == 0)
+		rc = vy_history_apply(&history, lsm->cmp_def, lsm->mem_format,
+				      true, &upserts_applied, ret);
 
 	lsm->stat.upsert.applied += upserts_applied;
 	vy_history_cleanup(&history);
@@ -915,6 +1071,22 @@ vy_read_iterator_cache_add(struct vy_read_iterator *itr, struct tuple *stmt)
 	itr->last_cached_stmt = stmt;
 }
 
+void
+vy_read_iterator_rewind(struct vy_read_iterator *itr, struct tuple *last)
+{
+	if (last != NULL)
+		tuple_ref(last);
+	if (itr->last_stmt != NULL)
+		tuple_unref(itr->last_stmt);
+	itr->last_stmt = last;
+	/*
+	 * The first iteration restores the iterator anyway,
+	 * see vy_read_iterator_advance().
+	 */
+	if (last != NULL)
+		vy_read_iterator_restore(itr);
+}
+
 /**
  * Close the iterator and free resources
  */
@@ -926,6 +1098,7 @@ vy_read_iterator_close(struct vy_read_iterator *itr)
 	if (itr->last_cached_stmt != NULL)
 		tuple_unref(itr->last_cached_stmt);
 	vy_read_iterator_cleanup(itr);
+	vy_read_src_heap_destroy(&itr->disk_heap);
 	free(itr->src);
 	TRASH(itr);
 }
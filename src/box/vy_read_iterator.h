@@ -36,6 +36,8 @@
 
 #include "iterator_type.h"
 #include "trivia/util.h"
+#define HEAP_FORWARD_DECLARATION
+#include "salad/heap.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -117,6 +119,18 @@ struct vy_read_iterator {
 	 * front_id from the previous iteration.
 	 */
 	uint32_t prev_front_id;
+	/**
+	 * Heap of disk sources ordered by the statement each
+	 * of them is positioned at. Used instead of evaluating
+	 * disk sources one by one when scanning a range with
+	 * many runs, see vy_read_iterator_merge_disk().
+	 */
+	heap_t disk_heap;
+	/**
+	 * Set if all disk sources were evaluated on the previous
+	 * iteration and so disk_heap reflects their positions.
+	 */
+	bool disk_heap_is_valid;
 };
 
 /**
@@ -165,6 +179,18 @@ vy_read_iterator_next(struct vy_read_iterator *itr, struct tuple **result);
 void
 vy_read_iterator_cache_add(struct vy_read_iterator *itr, struct tuple *stmt);
 
+/**
+ * Reposition the iterator so that the next call to
+ * vy_read_iterator_next() returns the statement following
+ * @last or the first statement if @last is NULL. Used by
+ * callers that read ahead and have to discard what they read.
+ * @param itr  Read iterator.
+ * @param last Statement previously returned by the iterator
+ *             or NULL.
+ */
+void
+vy_read_iterator_rewind(struct vy_read_iterator *itr, struct tuple *last);
+
 /**
  * Close the iterator and free resources.
  */
@@ -2016,7 +2016,7 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		const char *dirpath, uint32_t space_id, uint32_t iid,
 		const struct key_def *cmp_def, const struct key_def *key_def,
-		uint64_t page_size, double bloom_fpr)
+		bool is_primary, uint64_t page_size, double bloom_fpr)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2025,6 +2025,7 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->iid = iid;
 	writer->cmp_def = cmp_def;
 	writer->key_def = key_def;
+	writer->is_primary = is_primary;
 	writer->page_size = page_size;
 	writer->bloom_fpr = bloom_fpr;
 	if (bloom_fpr < 1) {
@@ -2129,7 +2130,7 @@ vy_run_writer_write_to_page(struct vy_run_writer *writer, struct tuple *stmt)
 	}
 	*offset = page->unpacked_size;
 	if (vy_run_dump_stmt(stmt, &writer->data_xlog, page,
-			     writer->cmp_def, writer->iid == 0) != 0)
+			     writer->cmp_def, writer->is_primary) != 0)
 		return -1;
 	int64_t lsn = vy_stmt_lsn(stmt);
 	run->info.min_lsn = MIN(run->info.min_lsn, lsn);
@@ -2289,6 +2290,7 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 	assert(run->page_info == NULL);
 	struct region *region = &fiber()->gc;
 	size_t mem_used = region_used(region);
+	bool is_primary = iid == 0 || opts->is_covering;
 
 	struct xlog_cursor cursor;
 	char path[PATH_MAX];
@@ -2336,7 +2338,8 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 			}
 			++page_row_count;
 			struct tuple *tuple = vy_stmt_decode(&xrow, cmp_def,
-							     format, iid == 0);
+							     format,
+							     is_primary);
 			if (tuple == NULL)
 				goto close_err;
 			if (bloom_builder != NULL) {
@@ -583,6 +583,11 @@ struct vy_run_writer {
 	const struct key_def *cmp_def;
 	/** Key definition to calculate bloom. */
 	const struct key_def *key_def;
+	/**
+	 * Set if statements are stored as full tuples, i.e. the
+	 * run belongs to a primary or a covering index.
+	 */
+	bool is_primary;
 	/**
 	 * Minimal page size. When a page becames bigger, it is
 	 * dumped.
@@ -612,7 +617,7 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		const char *dirpath, uint32_t space_id, uint32_t iid,
 		const struct key_def *cmp_def, const struct key_def *key_def,
-		uint64_t page_size, double bloom_fpr);
+		bool is_primary, uint64_t page_size, double bloom_fpr);
 
 /**
  * Write a specified statement into a run.
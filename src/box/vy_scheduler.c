@@ -53,7 +53,10 @@
 #include "vy_log.h"
 #include "vy_mem.h"
 #include "vy_range.h"
+#include "vy_read_view.h"
 #include "vy_run.h"
+#include "vy_stmt.h"
+#include "vy_tombstone.h"
 #include "vy_write_iterator.h"
 #include "trivia/util.h"
 
@@ -672,6 +675,7 @@ vy_task_write_run(struct vy_task *task)
 	if (vy_run_writer_create(&writer, task->new_run, lsm->env->path,
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
+				 vy_lsm_is_covering(lsm),
 				 task->page_size, task->bloom_fpr) != 0)
 		goto fail;
 
@@ -712,6 +716,103 @@ fail:
 	return -1;
 }
 
+/**
+ * Pass committed range tombstones of an LSM tree to a write
+ * iterator so that it could discard deleted statements.
+ */
+static int
+vy_task_add_tombstones(struct vy_stmt_stream *wi, struct vy_lsm *lsm)
+{
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &lsm->tombstones, in_lsm) {
+		if (tombstone->lsn > MAX_LSN) {
+			/* Prepared, but not committed yet. */
+			break;
+		}
+		if (vy_write_iterator_new_tombstone(wi, tombstone) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Delete range tombstones that don't cover any statements
+ * stored in an LSM tree anymore. Called after a dump or
+ * compaction task is complete.
+ */
+static void
+vy_task_gc_tombstones(struct vy_lsm *lsm)
+{
+	RLIST_HEAD(unused);
+	struct vy_tombstone *tombstone, *next;
+	rlist_foreach_entry_safe(tombstone, &lsm->tombstones, in_lsm, next) {
+		if (tombstone->lsn > MAX_LSN)
+			break;
+		/*
+		 * A tombstone referenced by anyone but the LSM tree
+		 * is either used by a write task or hasn't been
+		 * logged by the committing transaction yet.
+		 */
+		if (tombstone->refs > 1)
+			continue;
+		if (vy_lsm_tombstone_is_used(lsm, tombstone))
+			continue;
+		rlist_move_tail_entry(&unused, tombstone, in_lsm);
+		lsm->mem_list_version++;
+	}
+	if (rlist_empty(&unused))
+		return;
+	/*
+	 * Failure to log tombstone deletion isn't critical:
+	 * the tombstone will be deleted after recovery then.
+	 * Note, vylog may yield so the tombstones must be
+	 * removed from the LSM tree beforehand.
+	 */
+	vy_log_tx_begin();
+	rlist_foreach_entry(tombstone, &unused, in_lsm)
+		vy_log_delete_tombstone(tombstone->id);
+	vy_log_tx_try_commit();
+	rlist_foreach_entry_safe(tombstone, &unused, in_lsm, next) {
+		rlist_del_entry(tombstone, in_lsm);
+		say_info("%s: deleted range tombstone %lld",
+			 vy_lsm_name(lsm), (long long)tombstone->id);
+		vy_tombstone_unref(tombstone);
+	}
+}
+
+/**
+ * Return true if all statements of a run slice are deleted by
+ * a range tombstone and aren't visible from any read view, i.e.
+ * the slice can be dropped by compaction without reading it.
+ */
+static bool
+vy_task_slice_is_deleted(struct vy_scheduler *scheduler,
+			 struct vy_lsm *lsm, struct vy_slice *slice)
+{
+	struct vy_run *run = slice->run;
+	if (run->info.min_key == NULL)
+		return false;
+	int64_t oldest_vlsn = INT64_MAX;
+	if (!rlist_empty(scheduler->read_views)) {
+		struct vy_read_view *rv = rlist_first_entry(
+				scheduler->read_views, struct vy_read_view,
+				in_read_views);
+		oldest_vlsn = rv->vlsn;
+	}
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &lsm->tombstones, in_lsm) {
+		if (tombstone->lsn > MAX_LSN)
+			break;
+		if (run->info.max_lsn < tombstone->lsn &&
+		    oldest_vlsn >= tombstone->lsn &&
+		    vy_tombstone_covers_range(tombstone, run->info.min_key,
+					      run->info.max_key,
+					      lsm->cmp_def))
+			return true;
+	}
+	return false;
+}
+
 static int
 vy_task_dump_execute(struct vy_task *task)
 {
@@ -872,6 +973,8 @@ delete_mems:
 
 	say_info("%s: dump completed", vy_lsm_name(lsm));
 
+	vy_task_gc_tombstones(lsm);
+
 	vy_scheduler_complete_dump(scheduler);
 	return 0;
 
@@ -1005,7 +1108,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_lsm *lsm,
 	struct vy_stmt_stream *wi;
 	bool is_last_level = (lsm->run_count == 0);
 	wi = vy_write_iterator_new(task->cmp_def, lsm->disk_format,
-				   lsm->index_id == 0, is_last_level,
+				   vy_lsm_is_covering(lsm), is_last_level,
 				   scheduler->read_views);
 	if (wi == NULL)
 		goto err_wi;
@@ -1015,6 +1118,8 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_lsm *lsm,
 		if (vy_write_iterator_new_mem(wi, mem) != 0)
 			goto err_wi_sub;
 	}
+	if (vy_task_add_tombstones(wi, lsm) != 0)
+		goto err_wi_sub;
 
 	task->new_run = new_run;
 	task->wi = wi;
@@ -1204,6 +1309,8 @@ vy_task_compact_complete(struct vy_task *task)
 
 	say_info("%s: completed compacting range %s",
 		 vy_lsm_name(lsm), vy_range_str(range));
+
+	vy_task_gc_tombstones(lsm);
 	return 0;
 }
 
@@ -1272,15 +1379,22 @@ vy_task_compact_new(struct vy_scheduler *scheduler, struct vy_lsm *lsm,
 	struct vy_stmt_stream *wi;
 	bool is_last_level = (range->compact_priority == range->slice_count);
 	wi = vy_write_iterator_new(task->cmp_def, lsm->disk_format,
-				   lsm->index_id == 0, is_last_level,
+				   vy_lsm_is_covering(lsm), is_last_level,
 				   scheduler->read_views);
 	if (wi == NULL)
 		goto err_wi;
 
 	struct vy_slice *slice;
 	int n = range->compact_priority;
+	if (vy_task_add_tombstones(wi, lsm) != 0)
+		goto err_wi_sub;
 	rlist_foreach_entry(slice, &range->slices, in_range) {
-		if (vy_write_iterator_new_slice(wi, slice) != 0)
+		/*
+		 * Don't read slices deleted by a range tombstone,
+		 * just drop them along with compacted slices.
+		 */
+		if (!vy_task_slice_is_deleted(scheduler, lsm, slice) &&
+		    vy_write_iterator_new_slice(wi, slice) != 0)
 			goto err_wi_sub;
 		new_run->dump_lsn = MAX(new_run->dump_lsn,
 					slice->run->dump_lsn);
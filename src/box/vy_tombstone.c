@@ -0,0 +1,151 @@
+/*
+ * Copyright 2010-2018, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "vy_tombstone.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <small/rlist.h>
+
+#include "diag.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "vy_stmt.h"
+
+struct vy_tombstone *
+vy_tombstone_new(int64_t id, int64_t lsn, const char *begin,
+		 const char *end, struct tuple_format *key_format)
+{
+	struct vy_tombstone *tombstone = malloc(sizeof(*tombstone));
+	if (tombstone == NULL) {
+		diag_set(OutOfMemory, sizeof(*tombstone),
+			 "malloc", "struct vy_tombstone");
+		return NULL;
+	}
+	tombstone->begin = NULL;
+	tombstone->end = NULL;
+	if (begin != NULL) {
+		tombstone->begin = vy_key_from_msgpack(key_format, begin);
+		if (tombstone->begin == NULL)
+			goto fail;
+	}
+	if (end != NULL) {
+		tombstone->end = vy_key_from_msgpack(key_format, end);
+		if (tombstone->end == NULL)
+			goto fail;
+	}
+	tombstone->id = id;
+	tombstone->lsn = lsn;
+	tombstone->refs = 1;
+	rlist_create(&tombstone->in_lsm);
+	return tombstone;
+fail:
+	if (tombstone->begin != NULL)
+		tuple_unref(tombstone->begin);
+	free(tombstone);
+	return NULL;
+}
+
+void
+vy_tombstone_delete(struct vy_tombstone *tombstone)
+{
+	assert(tombstone->refs == 0);
+	assert(rlist_empty(&tombstone->in_lsm));
+	if (tombstone->begin != NULL)
+		tuple_unref(tombstone->begin);
+	if (tombstone->end != NULL)
+		tuple_unref(tombstone->end);
+	TRASH(tombstone);
+	free(tombstone);
+}
+
+bool
+vy_tombstone_covers(const struct vy_tombstone *tombstone,
+		    const struct tuple *stmt, const struct key_def *cmp_def)
+{
+	if (tombstone->begin != NULL &&
+	    vy_stmt_compare(stmt, tombstone->begin, cmp_def) < 0)
+		return false;
+	if (tombstone->end != NULL &&
+	    vy_stmt_compare(stmt, tombstone->end, cmp_def) >= 0)
+		return false;
+	return true;
+}
+
+bool
+vy_tombstone_covers_range(const struct vy_tombstone *tombstone,
+			  const char *min_key, const char *max_key,
+			  const struct key_def *cmp_def)
+{
+	if (tombstone->begin != NULL &&
+	    vy_stmt_compare_with_raw_key(tombstone->begin, min_key,
+					 cmp_def) > 0)
+		return false;
+	if (tombstone->end != NULL &&
+	    vy_stmt_compare_with_raw_key(tombstone->end, max_key,
+					 cmp_def) <= 0)
+		return false;
+	return true;
+}
+
+bool
+vy_tombstone_overlaps_range(const struct vy_tombstone *tombstone,
+			    const char *min_key, const char *max_key,
+			    const struct key_def *cmp_def)
+{
+	if (tombstone->begin != NULL &&
+	    vy_stmt_compare_with_raw_key(tombstone->begin, max_key,
+					 cmp_def) > 0)
+		return false;
+	if (tombstone->end != NULL &&
+	    vy_stmt_compare_with_raw_key(tombstone->end, min_key,
+					 cmp_def) <= 0)
+		return false;
+	return true;
+}
+
+int64_t
+vy_tombstone_list_lsn(struct rlist *list, const struct tuple *stmt,
+		      int64_t vlsn, const struct key_def *cmp_def)
+{
+	/* Newer tombstones are closer to the tail. */
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry_reverse(tombstone, list, in_lsm) {
+		if (tombstone->lsn > vlsn)
+			continue;
+		if (vy_tombstone_covers(tombstone, stmt, cmp_def))
+			return tombstone->lsn;
+	}
+	return 0;
+}
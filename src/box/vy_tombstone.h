@@ -0,0 +1,160 @@
+#ifndef INCLUDES_TARANTOOL_BOX_VY_TOMBSTONE_H
+#define INCLUDES_TARANTOOL_BOX_VY_TOMBSTONE_H
+/*
+ * Copyright 2010-2018, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <small/rlist.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct key_def;
+struct tuple;
+struct tuple_format;
+
+/**
+ * Range tombstone.
+ *
+ * A range tombstone is written by DELETE_RANGE. It deletes all
+ * statements of an LSM tree whose keys fall in [begin, end) and
+ * whose LSN is less than the tombstone LSN. In other words, it
+ * works as if a DELETE with the tombstone LSN were inserted for
+ * each key of the range, but takes O(1) space.
+ *
+ * Keys are compared by prefix, i.e. a partial end key excludes
+ * all keys starting with it.
+ *
+ * Tombstones are applied by readers on the fly (see
+ * vy_lsm_apply_tombstones()) and by the write iterator, which
+ * drops covered statements on dump and compaction. A tombstone
+ * is deleted as soon as there is no data on disk or in memory
+ * it may cover.
+ */
+struct vy_tombstone {
+	/** Link in vy_lsm::tombstones. */
+	struct rlist in_lsm;
+	/** Unique ID of this tombstone, as stored in vylog. */
+	int64_t id;
+	/**
+	 * LSN of the WAL row that created the tombstone or
+	 * MAX_LSN + psn if the tombstone has been prepared,
+	 * but not committed yet.
+	 */
+	int64_t lsn;
+	/** Begin of the range or NULL if unbounded (SELECT). */
+	struct tuple *begin;
+	/** End of the range or NULL if unbounded (SELECT). */
+	struct tuple *end;
+	/** Reference counter. */
+	int refs;
+};
+
+/**
+ * Create a range tombstone.
+ * @param id         Tombstone ID.
+ * @param lsn        Tombstone LSN.
+ * @param begin      Begin of the range or NULL.
+ * @param end        End of the range or NULL.
+ * @param key_format Format of keys.
+ *
+ * @retval not NULL  The new tombstone.
+ * @retval NULL      Memory error.
+ */
+struct vy_tombstone *
+vy_tombstone_new(int64_t id, int64_t lsn, const char *begin,
+		 const char *end, struct tuple_format *key_format);
+
+/** Free a range tombstone. Called when refs reach 0. */
+void
+vy_tombstone_delete(struct vy_tombstone *tombstone);
+
+/** Increment the reference counter of a range tombstone. */
+static inline void
+vy_tombstone_ref(struct vy_tombstone *tombstone)
+{
+	assert(tombstone->refs >= 0);
+	tombstone->refs++;
+}
+
+/**
+ * Decrement the reference counter of a range tombstone,
+ * free it when the counter reaches zero.
+ */
+static inline void
+vy_tombstone_unref(struct vy_tombstone *tombstone)
+{
+	assert(tombstone->refs > 0);
+	if (--tombstone->refs == 0)
+		vy_tombstone_delete(tombstone);
+}
+
+/** Return true if a range tombstone covers a statement key. */
+bool
+vy_tombstone_covers(const struct vy_tombstone *tombstone,
+		    const struct tuple *stmt, const struct key_def *cmp_def);
+
+/**
+ * Return true if a range tombstone covers all keys in range
+ * [min_key, max_key]. Keys are raw MsgPack arrays.
+ */
+bool
+vy_tombstone_covers_range(const struct vy_tombstone *tombstone,
+			  const char *min_key, const char *max_key,
+			  const struct key_def *cmp_def);
+
+/**
+ * Return true if a range tombstone intersects with range
+ * [min_key, max_key]. Keys are raw MsgPack arrays.
+ */
+bool
+vy_tombstone_overlaps_range(const struct vy_tombstone *tombstone,
+			    const char *min_key, const char *max_key,
+			    const struct key_def *cmp_def);
+
+/**
+ * Return LSN of the newest tombstone from the given list that
+ * covers a statement and is visible from a read view, or 0 if
+ * there is no such tombstone. The list must be sorted by LSN
+ * in ascending order.
+ */
+int64_t
+vy_tombstone_list_lsn(struct rlist *list, const struct tuple *stmt,
+		      int64_t vlsn, const struct key_def *cmp_def);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_BOX_VY_TOMBSTONE_H */
@@ -58,6 +58,7 @@
 #include "vy_history.h"
 #include "vy_read_set.h"
 #include "vy_read_view.h"
+#include "vy_tombstone.h"
 
 int
 write_set_cmp(struct txv *a, struct txv *b)
@@ -222,6 +223,31 @@ txv_delete(struct txv *v)
 	mempool_free(&xm->txv_mempool, v);
 }
 
+static struct vy_tx_tombstone *
+vy_tx_tombstone_new(struct vy_lsm *lsm, struct vy_tombstone *tombstone)
+{
+	struct vy_tx_tombstone *t = malloc(sizeof(*t));
+	if (t == NULL) {
+		diag_set(OutOfMemory, sizeof(*t), "malloc",
+			 "struct vy_tx_tombstone");
+		return NULL;
+	}
+	t->lsm = lsm;
+	vy_lsm_ref(lsm);
+	t->tombstone = tombstone;
+	vy_tombstone_ref(tombstone);
+	t->is_prepared = false;
+	return t;
+}
+
+void
+vy_tx_tombstone_delete(struct vy_tx_tombstone *t)
+{
+	vy_tombstone_unref(t->tombstone);
+	vy_lsm_unref(t->lsm);
+	free(t);
+}
+
 static struct vy_read_interval *
 vy_read_interval_new(struct vy_tx *tx, struct vy_lsm *lsm,
 		     struct tuple *left, bool left_belongs,
@@ -282,6 +308,7 @@ vy_tx_create(struct tx_manager *xm, struct vy_tx *tx)
 	write_set_new(&tx->write_set);
 	tx->write_set_version = 0;
 	tx->write_size = 0;
+	rlist_create(&tx->tombstones);
 	tx->xm = xm;
 	tx->state = VINYL_TX_READY;
 	tx->read_view = (struct vy_read_view *)xm->p_global_read_view;
@@ -305,6 +332,10 @@ vy_tx_destroy(struct vy_tx *tx)
 		txv_delete(v);
 	}
 
+	struct vy_tx_tombstone *t, *next_t;
+	rlist_foreach_entry_safe(t, &tx->tombstones, in_tx, next_t)
+		vy_tx_tombstone_delete(t);
+
 	vy_tx_read_set_iter(&tx->read_set, NULL, vy_tx_read_set_free_cb, NULL);
 }
 
@@ -312,7 +343,8 @@ vy_tx_destroy(struct vy_tx *tx)
 static bool
 vy_tx_is_ro(struct vy_tx *tx)
 {
-	return write_set_empty(&tx->write_set);
+	return write_set_empty(&tx->write_set) &&
+	       rlist_empty(&tx->tombstones);
 }
 
 /** Return true if the transaction is in read view. */
@@ -371,6 +403,73 @@ vy_tx_abort_readers(struct vy_tx *tx, struct txv *v)
 	}
 }
 
+/**
+ * Return true if a read interval may intersect with a range
+ * deleted by a tombstone. Boundaries are checked conservatively.
+ */
+static bool
+vy_tx_tombstone_conflicts(struct vy_tx_tombstone *t,
+			  struct vy_read_interval *interval)
+{
+	struct vy_tombstone *tombstone = t->tombstone;
+	const struct key_def *cmp_def = t->lsm->cmp_def;
+	if (tombstone->begin != NULL &&
+	    vy_stmt_compare(interval->right, tombstone->begin, cmp_def) < 0)
+		return false;
+	if (tombstone->end != NULL &&
+	    vy_stmt_compare(interval->left, tombstone->end, cmp_def) > 0)
+		return false;
+	return true;
+}
+
+/**
+ * Send to read view all transactions that are reading keys
+ * from a range deleted by transaction @tx.
+ *
+ * The interval tree is ordered by left boundaries, so we have
+ * to scan it linearly to find all intervals intersecting with
+ * the range.
+ */
+static int
+vy_tx_send_range_to_read_view(struct vy_tx *tx, struct vy_tx_tombstone *t)
+{
+	vy_lsm_read_set_t *read_set = &t->lsm->read_set;
+	struct vy_read_interval *interval;
+	for (interval = vy_lsm_read_set_first(read_set); interval != NULL;
+	     interval = vy_lsm_read_set_next(read_set, interval)) {
+		struct vy_tx *abort = interval->tx;
+		if (abort == tx || abort->state != VINYL_TX_READY ||
+		    vy_tx_is_in_read_view(abort))
+			continue;
+		if (!vy_tx_tombstone_conflicts(t, interval))
+			continue;
+		struct vy_read_view *rv = tx_manager_read_view(tx->xm);
+		if (rv == NULL)
+			return -1;
+		abort->read_view = rv;
+	}
+	return 0;
+}
+
+/**
+ * Abort all transactions that are reading keys from a range
+ * deleted by transaction @tx.
+ */
+static void
+vy_tx_abort_range_readers(struct vy_tx *tx, struct vy_tx_tombstone *t)
+{
+	vy_lsm_read_set_t *read_set = &t->lsm->read_set;
+	struct vy_read_interval *interval;
+	for (interval = vy_lsm_read_set_first(read_set); interval != NULL;
+	     interval = vy_lsm_read_set_next(read_set, interval)) {
+		struct vy_tx *abort = interval->tx;
+		if (abort == tx || abort->state != VINYL_TX_READY)
+			continue;
+		if (vy_tx_tombstone_conflicts(t, interval))
+			abort->state = VINYL_TX_ABORT;
+	}
+}
+
 struct vy_tx *
 vy_tx_begin(struct tx_manager *xm)
 {
@@ -499,6 +598,11 @@ vy_tx_prepare(struct vy_tx *tx)
 		if (vy_tx_send_to_read_view(tx, v))
 			return -1;
 	}
+	struct vy_tx_tombstone *t;
+	rlist_foreach_entry(t, &tx->tombstones, in_tx) {
+		if (vy_tx_send_range_to_read_view(tx, t) != 0)
+			return -1;
+	}
 
 	/*
 	 * Flush transactional changes to the LSM tree.
@@ -558,12 +662,26 @@ vy_tx_prepare(struct vy_tx *tx)
 			return -1;
 		v->region_stmt = *region_stmt;
 	}
+
+	/*
+	 * Make range deletions visible to the read view of
+	 * prepared statements and drop deleted keys from the
+	 * cache, because it must only store the newest tuples.
+	 */
+	rlist_foreach_entry(t, &tx->tombstones, in_tx) {
+		struct vy_tombstone *tombstone = t->tombstone;
+		tombstone->lsn = MAX_LSN + tx->psn;
+		vy_lsm_add_tombstone(t->lsm, tombstone);
+		vy_cache_on_delete_range(&t->lsm->cache, tombstone->begin,
+					 tombstone->end);
+		t->is_prepared = true;
+	}
 	xm->last_prepared_tx = tx;
 	return 0;
 }
 
 void
-vy_tx_commit(struct vy_tx *tx, int64_t lsn)
+vy_tx_commit(struct vy_tx *tx, int64_t lsn, struct rlist *tombstones)
 {
 	assert(tx->state == VINYL_TX_COMMIT);
 	struct tx_manager *xm = tx->xm;
@@ -589,6 +707,11 @@ vy_tx_commit(struct vy_tx *tx, int64_t lsn)
 		if (v->mem != NULL)
 			vy_mem_unpin(v->mem);
 	}
+	struct vy_tx_tombstone *t;
+	rlist_foreach_entry(t, &tx->tombstones, in_tx)
+		t->tombstone->lsn = lsn;
+	if (tombstones != NULL)
+		rlist_splice_tail(tombstones, &tx->tombstones);
 
 	/* Update read views of dependant transactions. */
 	if (tx->read_view != &xm->global_read_view)
@@ -634,6 +757,13 @@ vy_tx_rollback_after_prepare(struct vy_tx *tx)
 		if (v->mem != NULL)
 			vy_mem_unpin(v->mem);
 	}
+	struct vy_tx_tombstone *t;
+	rlist_foreach_entry(t, &tx->tombstones, in_tx) {
+		if (t->is_prepared) {
+			vy_lsm_remove_tombstone(t->lsm, t->tombstone);
+			t->is_prepared = false;
+		}
+	}
 
 	/* Abort read views of dependent transactions. */
 	if (tx->read_view != &xm->global_read_view)
@@ -644,6 +774,8 @@ vy_tx_rollback_after_prepare(struct vy_tx *tx)
 	while ((v = write_set_inext(&it)) != NULL) {
 		vy_tx_abort_readers(tx, v);
 	}
+	rlist_foreach_entry(t, &tx->tombstones, in_tx)
+		vy_tx_abort_range_readers(tx, t);
 }
 
 void
@@ -680,6 +812,16 @@ vy_tx_rollback_to_savepoint(struct vy_tx *tx, void *svp)
 		tx->write_set_version++;
 		txv_delete(v);
 	}
+	/*
+	 * Range deletions are only allowed in single-statement
+	 * transactions so rolling back to a save point discards
+	 * them all.
+	 */
+	struct vy_tx_tombstone *t, *next_t;
+	rlist_foreach_entry_safe(t, &tx->tombstones, in_tx, next_t) {
+		rlist_del_entry(t, in_tx);
+		vy_tx_tombstone_delete(t);
+	}
 }
 
 int
@@ -883,6 +1025,18 @@ vy_tx_set(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt)
 	return 0;
 }
 
+int
+vy_tx_delete_range(struct vy_tx *tx, struct vy_lsm *lsm,
+		   struct vy_tombstone *tombstone)
+{
+	assert(tx->state == VINYL_TX_READY);
+	struct vy_tx_tombstone *t = vy_tx_tombstone_new(lsm, tombstone);
+	if (t == NULL)
+		return -1;
+	rlist_add_tail_entry(&tx->tombstones, t, in_tx);
+	return 0;
+}
+
 void
 vy_txw_iterator_open(struct vy_txw_iterator *itr,
 		     struct vy_txw_iterator_stat *stat,
@@ -56,6 +56,7 @@ struct tx_manager;
 struct vy_mem;
 struct vy_tx;
 struct vy_history;
+struct vy_tombstone;
 
 /** Transaction state. */
 enum tx_state {
@@ -131,6 +132,18 @@ write_set_search_key(write_set_t *tree, struct vy_lsm *lsm,
 	return write_set_search(tree, &key);
 }
 
+/** Range deletion done by a transaction. */
+struct vy_tx_tombstone {
+	/** Link in vy_tx::tombstones. */
+	struct rlist in_tx;
+	/** LSM tree the range is deleted from. */
+	struct vy_lsm *lsm;
+	/** Range tombstone. */
+	struct vy_tombstone *tombstone;
+	/** Set if the tombstone was added to the LSM tree. */
+	bool is_prepared;
+};
+
 /** Transaction object. */
 struct vy_tx {
 	/** Transaction manager. */
@@ -155,6 +168,11 @@ struct vy_tx {
 	 * the write set.
 	 */
 	size_t write_size;
+	/**
+	 * Range deletions done by the transaction.
+	 * Linked by vy_tx_tombstone::in_tx.
+	 */
+	struct rlist tombstones;
 	/** Current state of the transaction.*/
 	enum tx_state state;
 	/**
@@ -281,9 +299,14 @@ vy_tx_prepare(struct vy_tx *tx);
 /**
  * Commit a transaction with a given LSN and destroy
  * the tx object.
+ *
+ * If @tombstones is not NULL, range deletions done by the
+ * transaction are moved to this list so that the caller can
+ * log them after commit. The caller is supposed to free them
+ * with vy_tx_tombstone_delete().
  */
 void
-vy_tx_commit(struct vy_tx *tx, int64_t lsn);
+vy_tx_commit(struct vy_tx *tx, int64_t lsn, struct rlist *tombstones);
 
 /**
  * Rollback a transaction and destroy the tx object.
@@ -354,6 +377,26 @@ vy_tx_track_point(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt);
 int
 vy_tx_set(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt);
 
+/**
+ * Add a range deletion to a transaction. The tombstone is
+ * inserted into the LSM tree when the transaction is prepared.
+ * Its LSN is assigned by the transaction.
+ *
+ * @param tx         Transaction.
+ * @param lsm        LSM tree to delete the range from.
+ * @param tombstone  Range tombstone, referenced on success.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+vy_tx_delete_range(struct vy_tx *tx, struct vy_lsm *lsm,
+		   struct vy_tombstone *tombstone);
+
+/** Free a range deletion returned by vy_tx_commit(). */
+void
+vy_tx_tombstone_delete(struct vy_tx_tombstone *t);
+
 /**
  * Iterator over the write set of a transaction.
  */
@@ -32,6 +32,7 @@
 #include "vy_mem.h"
 #include "vy_run.h"
 #include "vy_upsert.h"
+#include "vy_tombstone.h"
 #include "column_mask.h"
 #include "fiber.h"
 
@@ -195,6 +196,18 @@ struct vy_write_iterator {
 	 * Last statement returned to the caller, pinned in memory.
 	 */
 	struct tuple *last_stmt;
+	/**
+	 * Range tombstones that may cover statements of the
+	 * sources, sorted by LSN in ascending order.
+	 */
+	struct vy_tombstone **tombstones;
+	/** Number of elements in @tombstones. */
+	int tombstone_count;
+	/**
+	 * DELETE inserted into the history of the current key
+	 * on behalf of a range tombstone or NULL.
+	 */
+	struct tuple *range_delete_stmt;
 	/**
 	 * Read views of the same key sorted by LSN in descending
 	 * order, starting from INT64_MAX.
@@ -406,6 +419,7 @@ vy_write_iterator_stop(struct vy_stmt_stream *vstream)
 		vy_stmt_unref_if_possible(stream->last_stmt);
 		stream->last_stmt = NULL;
 	}
+	assert(stream->range_delete_stmt == NULL);
 }
 
 /**
@@ -417,6 +431,9 @@ vy_write_iterator_close(struct vy_stmt_stream *vstream)
 	assert(vstream->iface->close == vy_write_iterator_close);
 	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
 	vy_write_iterator_stop(vstream);
+	for (int i = 0; i < stream->tombstone_count; i++)
+		vy_tombstone_unref(stream->tombstones[i]);
+	free(stream->tombstones);
 	tuple_format_unref(stream->format);
 	free(stream);
 }
@@ -453,6 +470,47 @@ vy_write_iterator_new_slice(struct vy_stmt_stream *vstream,
 	return 0;
 }
 
+/**
+ * Add a range tombstone to the iterator.
+ * @return 0 on success or -1 on error (diag is set).
+ */
+NODISCARD int
+vy_write_iterator_new_tombstone(struct vy_stmt_stream *vstream,
+				struct vy_tombstone *tombstone)
+{
+	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	assert(stream->tombstone_count == 0 ||
+	       stream->tombstones[stream->tombstone_count - 1]->lsn <
+	       tombstone->lsn);
+	size_t size = (stream->tombstone_count + 1) *
+		      sizeof(*stream->tombstones);
+	struct vy_tombstone **tombstones = realloc(stream->tombstones, size);
+	if (tombstones == NULL) {
+		diag_set(OutOfMemory, size, "realloc", "tombstones");
+		return -1;
+	}
+	vy_tombstone_ref(tombstone);
+	tombstones[stream->tombstone_count++] = tombstone;
+	stream->tombstones = tombstones;
+	return 0;
+}
+
+/**
+ * Return LSN of the newest range tombstone covering a key
+ * or 0 if the key isn't covered by any tombstone.
+ */
+static int64_t
+vy_write_iterator_tombstone_lsn(struct vy_write_iterator *stream,
+				const struct tuple *key)
+{
+	for (int i = stream->tombstone_count - 1; i >= 0; i--) {
+		struct vy_tombstone *tombstone = stream->tombstones[i];
+		if (vy_tombstone_covers(tombstone, key, stream->cmp_def))
+			return tombstone->lsn;
+	}
+	return 0;
+}
+
 /**
  * Go to the next tuple in terms of sorted (merged) input steams.
  * @return 0 on success or not 0 on error (diag is set).
@@ -613,24 +671,49 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	int64_t current_rv_lsn = vy_write_iterator_get_vlsn(stream, 0);
 	int64_t merge_until_lsn = vy_write_iterator_get_vlsn(stream, 1);
 	uint64_t key_mask = stream->cmp_def->column_mask;
+	int64_t tombstone_lsn = vy_write_iterator_tombstone_lsn(stream,
+								src->tuple);
+	assert(stream->range_delete_stmt == NULL);
 
 	while (true) {
-		*is_first_insert = vy_stmt_type(src->tuple) == IPROTO_INSERT;
+		struct tuple *tuple = src->tuple;
+		if (vy_stmt_lsn(tuple) < tombstone_lsn) {
+			/*
+			 * The key is covered by a range tombstone.
+			 * Insert a DELETE with the tombstone LSN
+			 * before the first statement older than the
+			 * tombstone and process it as if it was read
+			 * from a source. This makes sure read views
+			 * newer than the tombstone don't see older
+			 * statements.
+			 */
+			tuple = vy_stmt_new_surrogate_delete(stream->format,
+							     src->tuple);
+			if (tuple == NULL) {
+				rc = -1;
+				break;
+			}
+			vy_stmt_set_lsn(tuple, tombstone_lsn);
+			stream->range_delete_stmt = tuple;
+			tombstone_lsn = 0;
+		}
+
+		*is_first_insert = vy_stmt_type(tuple) == IPROTO_INSERT;
 
 		if (!stream->is_primary &&
-		    vy_stmt_type(src->tuple) == IPROTO_REPLACE) {
+		    vy_stmt_type(tuple) == IPROTO_REPLACE) {
 			/*
 			 * If a REPLACE stored in a secondary index was
 			 * generated by an update operation, it can be
 			 * turned into an INSERT.
 			 */
-			uint64_t stmt_mask = vy_stmt_column_mask(src->tuple);
+			uint64_t stmt_mask = vy_stmt_column_mask(tuple);
 			if (stmt_mask != UINT64_MAX &&
 			    !key_update_can_be_skipped(stmt_mask, key_mask))
 				*is_first_insert = true;
 		}
 
-		if (vy_stmt_lsn(src->tuple) > current_rv_lsn) {
+		if (vy_stmt_lsn(tuple) > current_rv_lsn) {
 			/*
 			 * Skip statements invisible to the current read
 			 * view but older than the previous read view,
@@ -638,10 +721,10 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 			 */
 			goto next_lsn;
 		}
-		while (vy_stmt_lsn(src->tuple) <= merge_until_lsn) {
+		while (vy_stmt_lsn(tuple) <= merge_until_lsn) {
 			/*
 			 * Skip read views which see the same
-			 * version of the key, until src->tuple is
+			 * version of the key, until tuple is
 			 * between merge_until_lsn and
 			 * current_rv_lsn.
 			 */
@@ -657,7 +740,7 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 * @sa vy_write_iterator for details about this
 		 * and other optimizations.
 		 */
-		if (vy_stmt_type(src->tuple) == IPROTO_DELETE &&
+		if (vy_stmt_type(tuple) == IPROTO_DELETE &&
 		    stream->is_last_level && merge_until_lsn == 0) {
 			current_rv_lsn = 0; /* Force skip */
 			goto next_lsn;
@@ -667,10 +750,10 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 * Optimization 2: skip statements overwritten
 		 * by a REPLACE or DELETE.
 		 */
-		if (vy_stmt_type(src->tuple) == IPROTO_REPLACE ||
-		    vy_stmt_type(src->tuple) == IPROTO_INSERT ||
-		    vy_stmt_type(src->tuple) == IPROTO_DELETE) {
-			uint64_t stmt_mask = vy_stmt_column_mask(src->tuple);
+		if (vy_stmt_type(tuple) == IPROTO_REPLACE ||
+		    vy_stmt_type(tuple) == IPROTO_INSERT ||
+		    vy_stmt_type(tuple) == IPROTO_DELETE) {
+			uint64_t stmt_mask = vy_stmt_column_mask(tuple);
 			/*
 			 * Optimization 3: skip statements which
 			 * do not change this secondary key.
@@ -679,7 +762,7 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 			    key_update_can_be_skipped(key_mask, stmt_mask))
 				goto next_lsn;
 
-			rc = vy_write_iterator_push_rv(stream, src->tuple,
+			rc = vy_write_iterator_push_rv(stream, tuple,
 						       current_rv_i);
 			if (rc != 0)
 				break;
@@ -692,13 +775,17 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 			goto next_lsn;
 		}
 
-		assert(vy_stmt_type(src->tuple) == IPROTO_UPSERT);
-		rc = vy_write_iterator_push_rv(stream, src->tuple,
+		assert(vy_stmt_type(tuple) == IPROTO_UPSERT);
+		rc = vy_write_iterator_push_rv(stream, tuple,
 					       current_rv_i);
 		if (rc != 0)
 			break;
 		++*count;
 next_lsn:
+		if (tuple == stream->range_delete_stmt) {
+			/* Now process the covered statement. */
+			continue;
+		}
 		rc = vy_write_iterator_merge_step(stream);
 		if (rc != 0)
 			break;
@@ -837,6 +924,16 @@ vy_read_view_merge(struct vy_write_iterator *stream, struct tuple *hint,
 	return 0;
 }
 
+/** Release the DELETE inserted on behalf of a range tombstone. */
+static inline void
+vy_write_iterator_drop_range_delete(struct vy_write_iterator *stream)
+{
+	if (stream->range_delete_stmt != NULL) {
+		vy_stmt_unref_if_possible(stream->range_delete_stmt);
+		stream->range_delete_stmt = NULL;
+	}
+}
+
 /**
  * Split the current key into a sequence of read view
  * statements. @sa struct vy_write_iterator comment for details
@@ -885,13 +982,28 @@ vy_write_iterator_build_read_views(struct vy_write_iterator *stream, int *count)
 		assert(rv->history == NULL);
 		if (rv->tuple == NULL)
 			continue;
+		if (rv->tuple == stream->range_delete_stmt) {
+			/*
+			 * Don't write DELETEs inserted on behalf of
+			 * range tombstones: a tombstone isn't deleted
+			 * while there are statements it may cover.
+			 * Still, use the DELETE as a hint for newer
+			 * read views.
+			 */
+			hint = rv->tuple;
+			vy_stmt_unref_if_possible(rv->tuple);
+			rv->tuple = NULL;
+			continue;
+		}
 		stream->rv_used_count++;
 		++*count;
 		hint = rv->tuple;
 	}
+	vy_write_iterator_drop_range_delete(stream);
 	region_truncate(region, used);
 	return 0;
 error:
+	vy_write_iterator_drop_range_delete(stream);
 	region_truncate(region, used);
 	return -1;
 }
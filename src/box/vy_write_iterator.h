@@ -218,6 +218,7 @@ struct tuple_format;
 struct tuple;
 struct vy_mem;
 struct vy_slice;
+struct vy_tombstone;
 
 /**
  * Open an empty write iterator. To add sources to the iterator
@@ -250,5 +251,16 @@ NODISCARD int
 vy_write_iterator_new_slice(struct vy_stmt_stream *stream,
 			    struct vy_slice *slice);
 
+/**
+ * Add a range tombstone to the iterator. Statements covered by
+ * the tombstone are discarded unless they are visible from a read
+ * view older than the tombstone. Tombstones must be added in the
+ * LSN order and be committed.
+ * @return 0 on success, -1 on error (diag is set).
+ */
+NODISCARD int
+vy_write_iterator_new_tombstone(struct vy_stmt_stream *stream,
+				struct vy_tombstone *tombstone);
+
 #endif /* INCLUDES_TARANTOOL_BOX_VY_WRITE_STREAM_H */
 
@@ -33,6 +33,7 @@
 #include "vclock.h"
 #include "fiber.h"
 #include "fio.h"
+#include "tt_pthread.h"
 #include "errinj.h"
 #include "error.h"
 #include "exception.h"
@@ -43,6 +44,7 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include "replication.h"
+#include "small/ibuf.h"
 
 
 const char *wal_mode_STRS[] = { "none", "write", "fsync", NULL };
@@ -55,6 +57,38 @@ wal_write(struct journal *, struct journal_entry *);
 static int64_t
 wal_write_in_wal_mode_none(struct journal *, struct journal_entry *);
 
+enum {
+	/** Size of the in-memory ring of recently written rows. */
+	WAL_RING_SIZE = 16 * 1024 * 1024,
+	/** Max amount of data returned by wal_ring_read() at once. */
+	WAL_RING_READ_MAX = 256 * 1024,
+};
+
+/**
+ * In-memory ring of rows recently written to the WAL.
+ *
+ * Relays that are close to the end of the WAL read rows from
+ * the ring instead of re-reading and decoding WAL files, see
+ * wal_ring_read(). The ring is filled by the WAL thread and
+ * read by relay threads, hence the mutex. It is only allocated
+ * while there are WAL watchers.
+ *
+ * Each row is stored as struct wal_ring_row followed by the
+ * encoded row. Rows may wrap around the end of the buffer.
+ */
+struct wal_ring {
+	/** Protects all members below. */
+	pthread_mutex_t mutex;
+	/** Ring buffer or NULL if there are no WAL watchers. */
+	char *buf;
+	/** Logical offset of the oldest row stored in the ring. */
+	int64_t begin;
+	/** Logical offset following the newest row. */
+	int64_t end;
+	/** WAL vclock preceding the oldest row stored in the ring. */
+	struct vclock vclock;
+};
+
 /* WAL thread. */
 struct wal_thread {
 	/** 'wal' thread doing the writes. */
@@ -119,6 +153,8 @@ struct wal_writer
 	 * Used for replication relays.
 	 */
 	struct rlist watchers;
+	/** Rows recently written to the WAL, for relays. */
+	struct wal_ring ring;
 };
 
 struct wal_msg {
@@ -287,6 +323,9 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 	vclock_copy(&writer->vclock, vclock);
 
 	rlist_create(&writer->watchers);
+
+	tt_pthread_mutex_init(&writer->ring.mutex, NULL);
+	writer->ring.buf = NULL;
 }
 
 /** Destroy a WAL writer structure. */
@@ -294,6 +333,8 @@ static void
 wal_writer_destroy(struct wal_writer *writer)
 {
 	xdir_destroy(&writer->wal_dir);
+	free(writer->ring.buf);
+	tt_pthread_mutex_destroy(&writer->ring.mutex);
 }
 
 /** WAL thread routine. */
@@ -668,6 +709,137 @@ wal_assign_lsn(struct wal_writer *writer, struct xrow_header **row,
 	}
 }
 
+/** Copy data to the ring at the given logical offset. */
+static void
+wal_ring_copy_in(struct wal_ring *ring, int64_t pos,
+		 const void *data, size_t size)
+{
+	size_t offset = pos % WAL_RING_SIZE;
+	size_t n = MIN(size, WAL_RING_SIZE - offset);
+	memcpy(ring->buf + offset, data, n);
+	memcpy(ring->buf, (const char *)data + n, size - n);
+}
+
+/** Copy data from the ring at the given logical offset. */
+static void
+wal_ring_copy_out(struct wal_ring *ring, int64_t pos,
+		  void *data, size_t size)
+{
+	size_t offset = pos % WAL_RING_SIZE;
+	size_t n = MIN(size, WAL_RING_SIZE - offset);
+	memcpy(data, ring->buf + offset, n);
+	memcpy((char *)data + n, ring->buf, size - n);
+}
+
+/**
+ * Evict the oldest rows from the ring until there is enough
+ * room for @size bytes. The ring vclock follows evicted rows.
+ */
+static void
+wal_ring_evict(struct wal_ring *ring, size_t size)
+{
+	while (ring->begin < ring->end &&
+	       ring->end - ring->begin + size > WAL_RING_SIZE) {
+		struct wal_ring_row hdr;
+		wal_ring_copy_out(ring, ring->begin, &hdr, sizeof(hdr));
+		vclock_follow(&ring->vclock, hdr.replica_id, hdr.lsn);
+		ring->begin += sizeof(hdr) + hdr.size;
+	}
+}
+
+/** Append a row written to the WAL to the ring. */
+static void
+wal_ring_append(struct wal_ring *ring, struct xrow_header *row)
+{
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_header_encode(row, 0, iov, 0);
+	struct wal_ring_row hdr;
+	hdr.size = 0;
+	hdr.replica_id = row->replica_id;
+	hdr.lsn = row->lsn;
+	for (int i = 0; i < iovcnt; i++)
+		hdr.size += iov[i].iov_len;
+	size_t size = sizeof(hdr) + hdr.size;
+	if (iovcnt < 0 || size > WAL_RING_SIZE) {
+		/*
+		 * The row can't be stored. Drop all rows and
+		 * move the ring past it so that relays fall back
+		 * on reading WAL files.
+		 */
+		diag_clear(diag_get());
+		wal_ring_evict(ring, WAL_RING_SIZE);
+		ring->begin = ring->end;
+		vclock_follow(&ring->vclock, row->replica_id, row->lsn);
+		return;
+	}
+	wal_ring_evict(ring, size);
+	wal_ring_copy_in(ring, ring->end, &hdr, sizeof(hdr));
+	ring->end += sizeof(hdr);
+	for (int i = 0; i < iovcnt; i++) {
+		wal_ring_copy_in(ring, ring->end, iov[i].iov_base,
+				 iov[i].iov_len);
+		ring->end += iov[i].iov_len;
+	}
+}
+
+/**
+ * Append rows of requests that have been successfully written
+ * to the WAL to the ring so that relays can send them without
+ * reading WAL files.
+ */
+static void
+wal_ring_write(struct wal_writer *writer, struct stailq *commit)
+{
+	struct wal_ring *ring = &writer->ring;
+	if (ring->buf == NULL)
+		return;
+	tt_pthread_mutex_lock(&ring->mutex);
+	struct journal_entry *entry;
+	stailq_foreach_entry(entry, commit, fifo) {
+		struct xrow_header **row = entry->rows;
+		for (; row < entry->rows + entry->n_rows; row++)
+			wal_ring_append(ring, *row);
+	}
+	tt_pthread_mutex_unlock(&ring->mutex);
+}
+
+ssize_t
+wal_ring_read(int64_t *pos, const struct vclock *vclock, struct ibuf *buf)
+{
+	struct wal_ring *ring = &wal_writer_singleton.ring;
+	ssize_t rc = -1;
+	tt_pthread_mutex_lock(&ring->mutex);
+	if (ring->buf == NULL)
+		goto out;
+	if (*pos < 0) {
+		/*
+		 * The reader may start from the ring only if
+		 * it has all rows preceding the oldest row.
+		 */
+		int cmp = vclock_compare(&ring->vclock, vclock);
+		if (cmp != 0 && cmp != -1)
+			goto out;
+		*pos = ring->begin;
+	}
+	if (*pos < ring->begin)
+		goto out; /* rows were evicted */
+	int64_t end = *pos;
+	while (end < ring->end && end - *pos < WAL_RING_READ_MAX) {
+		struct wal_ring_row hdr;
+		wal_ring_copy_out(ring, end, &hdr, sizeof(hdr));
+		end += sizeof(hdr) + hdr.size;
+	}
+	char *data = (char *)ibuf_alloc(buf, end - *pos);
+	if (data == NULL)
+		goto out;
+	wal_ring_copy_out(ring, *pos, data, end - *pos);
+	rc = end - *pos;
+	*pos = end;
+out:
+	tt_pthread_mutex_unlock(&ring->mutex);
+	return rc;
+}
+
 static void
 wal_write_to_disk(struct cmsg *msg)
 {
@@ -759,6 +931,7 @@ done:
 		stailq_concat(&wal_msg->rollback, &rollback);
 		wal_writer_begin_rollback(writer);
 	}
+	wal_ring_write(writer, &wal_msg->commit);
 	fiber_gc();
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 }
@@ -1040,6 +1213,20 @@ wal_watcher_attach(void *arg)
 	assert(rlist_empty(&watcher->next));
 	rlist_add_tail_entry(&writer->watchers, watcher, next);
 
+	struct wal_ring *ring = &writer->ring;
+	if (ring->buf == NULL) {
+		char *buf = (char *)malloc(WAL_RING_SIZE);
+		if (buf == NULL) {
+			say_warn("failed to allocate WAL ring, "
+				 "relays will read WAL files");
+		}
+		tt_pthread_mutex_lock(&ring->mutex);
+		ring->buf = buf;
+		ring->begin = ring->end = 0;
+		vclock_copy(&ring->vclock, &writer->vclock);
+		tt_pthread_mutex_unlock(&ring->mutex);
+	}
+
 	/*
 	 * Notify the watcher right after registering it
 	 * so that it can process existing WALs.
@@ -1054,6 +1241,16 @@ wal_watcher_detach(void *arg)
 
 	assert(!rlist_empty(&watcher->next));
 	rlist_del_entry(watcher, next);
+
+	struct wal_writer *writer = &wal_writer_singleton;
+	if (rlist_empty(&writer->watchers)) {
+		/* Nobody reads the ring, free it. */
+		struct wal_ring *ring = &writer->ring;
+		tt_pthread_mutex_lock(&ring->mutex);
+		free(ring->buf);
+		ring->buf = NULL;
+		tt_pthread_mutex_unlock(&ring->mutex);
+	}
 }
 
 void
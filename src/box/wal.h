@@ -40,6 +40,7 @@ struct fiber;
 struct vclock;
 struct wal_writer;
 struct tt_uuid;
+struct ibuf;
 
 enum wal_mode { WAL_NONE = 0, WAL_WRITE, WAL_FSYNC, WAL_MODE_MAX };
 
@@ -138,6 +139,43 @@ void
 wal_clear_watcher(struct wal_watcher *watcher,
 		  void (*process_cb)(struct cbus_endpoint *));
 
+/**
+ * Header of a row returned by wal_ring_read().
+ * It is followed by the encoded row.
+ */
+struct wal_ring_row {
+	/** Size of the encoded row. */
+	uint32_t size;
+	/** Replica ID of the row. */
+	uint32_t replica_id;
+	/** LSN of the row. */
+	int64_t lsn;
+};
+
+/**
+ * Read rows written to the WAL from the in-memory ring of
+ * recent rows. Used by relays to avoid reading WAL files when
+ * they are close to the end of the WAL. Thread-safe.
+ *
+ * @param pos     Position in the ring. A negative value means
+ *                that the reader hasn't been positioned yet.
+ *                In this case the reader is positioned at the
+ *                oldest row stored in the ring provided @vclock
+ *                includes all rows preceding it. Advanced past
+ *                the returned rows on success.
+ * @param vclock  Vclock of the reader.
+ * @param buf     Buffer to append rows to. Each row is stored
+ *                as struct wal_ring_row followed by the row
+ *                encoded with xrow_header_encode().
+ *
+ * @retval >0  Size of appended data.
+ * @retval  0  No new rows.
+ * @retval -1  Rows following the reader position aren't in
+ *             memory anymore and must be read from WAL files.
+ */
+ssize_t
+wal_ring_read(int64_t *pos, const struct vclock *vclock, struct ibuf *buf);
+
 void
 wal_atfork();
 
@@ -310,6 +310,34 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 	return 0;
 }
 
+ssize_t
+xlog_meta_instance_uuid_offset(const char *data, size_t size)
+{
+	const char *end = (const char *)memmem(data, size, "\n\n", 2);
+	if (end == NULL)
+		return -1;
+	const char *pos = data;
+	while (pos < end) {
+		const char *eol = (const char *)memchr(pos, '\n',
+						       end + 1 - pos);
+		const char *key_end = (const char *)memchr(pos, ':',
+							   eol - pos);
+		if (key_end != NULL &&
+		    (xlog_meta_key_equal(pos, key_end, INSTANCE_UUID_KEY) ||
+		     xlog_meta_key_equal(pos, key_end,
+					 INSTANCE_UUID_KEY_V12))) {
+			const char *val = key_end + 1;
+			while (*val == ' ' || *val == '\t')
+				++val;
+			if (eol - val != UUID_STR_LEN)
+				return -1;
+			return val - data;
+		}
+		pos = eol + 1;
+	}
+	return -1;
+}
+
 /* struct xlog }}} */
 
 /* {{{ struct xdir */
@@ -260,6 +260,19 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		 const struct vclock *vclock,
 		 const struct vclock *prev_vclock);
 
+/**
+ * Find the instance UUID in the text header of a log file.
+ * Used to adopt files copied from another instance.
+ *
+ * @param data Beginning of the file.
+ * @param size Size of @a data.
+ *
+ * @retval >= 0 Offset of the UUID string in @a data.
+ * @retval -1   The header is incomplete or has no UUID.
+ */
+ssize_t
+xlog_meta_instance_uuid_offset(const char *data, size_t size);
+
 /* }}} */
 
 /**
@@ -42,6 +42,7 @@
 #include "vclock.h"
 #include "scramble.h"
 #include "iproto_constants.h"
+#include "schema_def.h"
 
 static_assert(IPROTO_DATA < 0x7f && IPROTO_METADATA < 0x7f &&
 	      IPROTO_SQL_INFO < 0x7f, "encoded IPROTO_BODY keys must fit into "\
@@ -601,6 +602,10 @@ error:
 			request->tuple_meta = value;
 			request->tuple_meta_end = data;
 			break;
+		case IPROTO_END_KEY:
+			request->end_key = value;
+			request->end_key_end = data;
+			break;
 		default:
 			break;
 		}
@@ -635,6 +640,10 @@ request_str(const struct request *request)
 		pos += snprintf(pos, end - pos, ", key: ");
 		pos += mp_snprint(pos, end - pos, request->key);
 	}
+	if (request->end_key != NULL) {
+		pos += snprintf(pos, end - pos, ", end_key: ");
+		pos += mp_snprint(pos, end - pos, request->end_key);
+	}
 	if (request->tuple != NULL) {
 		pos += snprintf(pos, end - pos, ", tuple: ");
 		pos += mp_snprint(pos, end - pos, request->tuple);
@@ -655,7 +664,9 @@ xrow_encode_dml(const struct request *request, struct iovec *iov)
 	uint32_t key_len = request->key_end - request->key;
 	uint32_t ops_len = request->ops_end - request->ops;
 	uint32_t tuple_meta_len = request->tuple_meta_end - request->tuple_meta;
-	uint32_t len = MAP_LEN_MAX + key_len + ops_len + tuple_meta_len;
+	uint32_t end_key_len = request->end_key_end - request->end_key;
+	uint32_t len = MAP_LEN_MAX + key_len + ops_len + tuple_meta_len +
+		       end_key_len;
 	char *begin = (char *) region_alloc(&fiber()->gc, len);
 	if (begin == NULL) {
 		diag_set(OutOfMemory, len, "region_alloc", "begin");
@@ -684,6 +695,12 @@ xrow_encode_dml(const struct request *request, struct iovec *iov)
 		pos += key_len;
 		map_size++;
 	}
+	if (request->end_key) {
+		pos = mp_encode_uint(pos, IPROTO_END_KEY);
+		memcpy(pos, request->end_key, end_key_len);
+		pos += end_key_len;
+		map_size++;
+	}
 	if (request->ops) {
 		pos = mp_encode_uint(pos, IPROTO_OPS);
 		memcpy(pos, request->ops, ops_len);
@@ -1026,21 +1043,60 @@ err:
 	return -1;
 }
 
+int
+xrow_decode_space_id(const struct xrow_header *row, uint32_t *space_id)
+{
+	if (row->bodycnt == 0)
+		return -1;
+	const char *data = (const char *) row->body[0].iov_base;
+	if (mp_typeof(*data) != MP_MAP)
+		return -1;
+	uint32_t map_size = mp_decode_map(&data);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*data) != MP_UINT) {
+			mp_next(&data); /* key */
+			mp_next(&data); /* value */
+			continue;
+		}
+		if (mp_decode_uint(&data) != IPROTO_SPACE_ID) {
+			mp_next(&data); /* value */
+			continue;
+		}
+		if (mp_typeof(*data) != MP_UINT)
+			return -1;
+		*space_id = mp_decode_uint(&data);
+		return 0;
+	}
+	return -1;
+}
+
 int
 xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
-		      const struct vclock *vclock)
+		      const struct vclock *vclock, uint32_t compression,
+		      const uint32_t *space_filter,
+		      uint32_t space_filter_size, double batch_delay)
 {
 	memset(row, 0, sizeof(*row));
 	size_t size = XROW_BODY_LEN_MAX + mp_sizeof_vclock(vclock);
+	if (space_filter != NULL)
+		size += mp_sizeof_array(space_filter_size) +
+			space_filter_size * mp_sizeof_uint(UINT32_MAX);
 	char *buf = (char *) region_alloc(&fiber()->gc, size);
 	if (buf == NULL) {
 		diag_set(OutOfMemory, size, "region_alloc", "buf");
 		return -1;
 	}
 	char *data = buf;
-	data = mp_encode_map(data, 4);
+	uint32_t map_size = 4;
+	if (compression != IPROTO_COMPRESSION_NONE)
+		map_size++;
+	if (space_filter != NULL)
+		map_size++;
+	if (batch_delay > 0)
+		map_size++;
+	data = mp_encode_map(data, map_size);
 	data = mp_encode_uint(data, IPROTO_CLUSTER_UUID);
 	data = xrow_encode_uuid(data, replicaset_uuid);
 	data = mp_encode_uint(data, IPROTO_INSTANCE_UUID);
@@ -1049,6 +1105,20 @@ xrow_encode_subscribe(struct xrow_header *row,
 	data = mp_encode_vclock(data, vclock);
 	data = mp_encode_uint(data, IPROTO_SERVER_VERSION);
 	data = mp_encode_uint(data, tarantool_version_id());
+	if (compression != IPROTO_COMPRESSION_NONE) {
+		data = mp_encode_uint(data, IPROTO_COMPRESSION);
+		data = mp_encode_uint(data, compression);
+	}
+	if (space_filter != NULL) {
+		data = mp_encode_uint(data, IPROTO_SPACE_FILTER);
+		data = mp_encode_array(data, space_filter_size);
+		for (uint32_t i = 0; i < space_filter_size; i++)
+			data = mp_encode_uint(data, space_filter[i]);
+	}
+	if (batch_delay > 0) {
+		data = mp_encode_uint(data, IPROTO_BATCH_DELAY);
+		data = mp_encode_double(data, batch_delay);
+	}
 	assert(data <= buf + size);
 	row->body[0].iov_base = buf;
 	row->body[0].iov_len = (data - buf);
@@ -1057,11 +1127,36 @@ xrow_encode_subscribe(struct xrow_header *row,
 	return 0;
 }
 
+/**
+ * Check that a SPACE_FILTER value is an array of valid space
+ * ids. The value must be valid MsgPack.
+ */
+static int
+xrow_check_space_filter(const char *data)
+{
+	if (mp_typeof(*data) != MP_ARRAY)
+		return -1;
+	uint32_t count = mp_decode_array(&data);
+	for (uint32_t i = 0; i < count; i++) {
+		if (mp_typeof(*data) != MP_UINT ||
+		    mp_decode_uint(&data) > BOX_SPACE_MAX)
+			return -1;
+	}
+	return 0;
+}
+
 int
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 		      struct tt_uuid *instance_uuid, struct vclock *vclock,
-		      uint32_t *version_id)
+		      uint32_t *version_id, uint32_t *compression,
+		      const char **space_filter, double *batch_delay)
 {
+	if (compression != NULL)
+		*compression = IPROTO_COMPRESSION_NONE;
+	if (space_filter != NULL)
+		*space_filter = NULL;
+	if (batch_delay != NULL)
+		*batch_delay = 0;
 	if (row->bodycnt == 0) {
 		diag_set(ClientError, ER_INVALID_MSGPACK, "request body");
 		return -1;
@@ -1116,6 +1211,37 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 			}
 			*version_id = mp_decode_uint(&d);
 			break;
+		case IPROTO_COMPRESSION:
+			if (compression == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_UINT) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "invalid COMPRESSION");
+				return -1;
+			}
+			*compression = mp_decode_uint(&d);
+			break;
+		case IPROTO_SPACE_FILTER:
+			if (space_filter == NULL)
+				goto skip;
+			if (xrow_check_space_filter(d) != 0) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "invalid SPACE_FILTER");
+				return -1;
+			}
+			*space_filter = d;
+			mp_next(&d);
+			break;
+		case IPROTO_BATCH_DELAY:
+			if (batch_delay == NULL)
+				goto skip;
+			if (mp_read_double(&d, batch_delay) != 0 ||
+			    *batch_delay < 0) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "invalid BATCH_DELAY");
+				return -1;
+			}
+			break;
 		default: skip:
 			mp_next(&d); /* value */
 		}
@@ -1124,21 +1250,46 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 }
 
 int
-xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid)
+xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid,
+		 const struct vclock *vclock, uint32_t stream_id,
+		 uint32_t stream_count, bool files)
 {
 	memset(row, 0, sizeof(*row));
 
 	size_t size = 64;
+	if (vclock != NULL)
+		size += mp_sizeof_vclock(vclock);
 	char *buf = (char *) region_alloc(&fiber()->gc, size);
 	if (buf == NULL) {
 		diag_set(OutOfMemory, size, "region_alloc", "buf");
 		return -1;
 	}
+	uint32_t map_size = 1;
+	if (vclock != NULL)
+		map_size++;
+	if (stream_count > 1)
+		map_size += 2;
+	if (files)
+		map_size++;
 	char *data = buf;
-	data = mp_encode_map(data, 1);
+	data = mp_encode_map(data, map_size);
 	data = mp_encode_uint(data, IPROTO_INSTANCE_UUID);
 	/* Greet the remote replica with our replica UUID */
 	data = xrow_encode_uuid(data, instance_uuid);
+	if (vclock != NULL) {
+		data = mp_encode_uint(data, IPROTO_VCLOCK);
+		data = mp_encode_vclock(data, vclock);
+	}
+	if (stream_count > 1) {
+		data = mp_encode_uint(data, IPROTO_JOIN_STREAM_ID);
+		data = mp_encode_uint(data, stream_id);
+		data = mp_encode_uint(data, IPROTO_JOIN_STREAM_COUNT);
+		data = mp_encode_uint(data, stream_count);
+	}
+	if (files) {
+		data = mp_encode_uint(data, IPROTO_JOIN_FILES);
+		data = mp_encode_bool(data, true);
+	}
 	assert(data <= buf + size);
 
 	row->body[0].iov_base = buf;
@@ -1148,22 +1299,228 @@ xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid)
 	return 0;
 }
 
+int
+xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid,
+		 struct vclock *vclock, uint32_t *stream_id,
+		 uint32_t *stream_count, bool *files)
+{
+	if (stream_id != NULL)
+		*stream_id = 0;
+	if (stream_count != NULL)
+		*stream_count = 1;
+	if (files != NULL)
+		*files = false;
+	if (row->bodycnt == 0) {
+		diag_set(ClientError, ER_INVALID_MSGPACK, "request body");
+		return -1;
+	}
+	assert(row->bodycnt == 1);
+	const char *data = (const char *) row->body[0].iov_base;
+	const char *end = data + row->body[0].iov_len;
+	const char *d = data;
+	if (mp_check(&d, end) != 0 || mp_typeof(*data) != MP_MAP) {
+		diag_set(ClientError, ER_INVALID_MSGPACK, "request body");
+		return -1;
+	}
+
+	d = data;
+	uint32_t map_size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*d) != MP_UINT) {
+			mp_next(&d); /* key */
+			mp_next(&d); /* value */
+			continue;
+		}
+		uint8_t key = mp_decode_uint(&d);
+		uint32_t *value;
+		switch (key) {
+		case IPROTO_INSTANCE_UUID:
+			if (instance_uuid == NULL)
+				goto skip;
+			if (xrow_decode_uuid(&d, instance_uuid) != 0)
+				return -1;
+			break;
+		case IPROTO_VCLOCK:
+			if (vclock == NULL)
+				goto skip;
+			if (mp_decode_vclock(&d, vclock) != 0) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "invalid VCLOCK");
+				return -1;
+			}
+			break;
+		case IPROTO_JOIN_STREAM_ID:
+		case IPROTO_JOIN_STREAM_COUNT:
+			value = key == IPROTO_JOIN_STREAM_ID ?
+				stream_id : stream_count;
+			if (value == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_UINT) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "invalid JOIN_STREAM");
+				return -1;
+			}
+			*value = mp_decode_uint(&d);
+			break;
+		case IPROTO_JOIN_FILES:
+			if (files == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_BOOL) {
+				diag_set(ClientError, ER_INVALID_MSGPACK,
+					 "invalid JOIN_FILES");
+				return -1;
+			}
+			*files = mp_decode_bool(&d);
+			break;
+		default: skip:
+			mp_next(&d); /* value */
+		}
+	}
+	return 0;
+}
+
+int
+xrow_encode_join_file(struct xrow_header *row, const char *name,
+		      const char *data, uint32_t size)
+{
+	memset(row, 0, sizeof(*row));
+
+	uint32_t name_len = strlen(name);
+	size_t buf_size = mp_sizeof_map(2) +
+			  mp_sizeof_uint(IPROTO_FILE_NAME) +
+			  mp_sizeof_str(name_len) +
+			  mp_sizeof_uint(IPROTO_DATA) +
+			  mp_sizeof_binl(size);
+	char *buf = (char *) region_alloc(&fiber()->gc, buf_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, buf_size, "region_alloc", "buf");
+		return -1;
+	}
+	char *d = buf;
+	d = mp_encode_map(d, 2);
+	d = mp_encode_uint(d, IPROTO_FILE_NAME);
+	d = mp_encode_str(d, name, name_len);
+	d = mp_encode_uint(d, IPROTO_DATA);
+	d = mp_encode_binl(d, size);
+	assert(d + size == buf + buf_size);
+
+	/* Don't copy the chunk, the caller keeps it until sent. */
+	row->body[0].iov_base = buf;
+	row->body[0].iov_len = d - buf;
+	row->body[1].iov_base = (void *) data;
+	row->body[1].iov_len = size;
+	row->bodycnt = 2;
+	row->type = IPROTO_JOIN_FILE;
+	return 0;
+}
+
+int
+xrow_decode_join_file(struct xrow_header *row, const char **name,
+		      uint32_t *name_len, const char **data, uint32_t *size)
+{
+	if (row->bodycnt == 0)
+		goto error;
+	assert(row->bodycnt == 1);
+	const char *d = (const char *) row->body[0].iov_base;
+	const char *end = d + row->body[0].iov_len;
+	const char *p = d;
+	if (mp_check(&p, end) != 0 || mp_typeof(*d) != MP_MAP)
+		goto error;
+	*name = NULL;
+	*data = NULL;
+	uint32_t map_size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*d) != MP_UINT) {
+			mp_next(&d); /* key */
+			mp_next(&d); /* value */
+			continue;
+		}
+		uint64_t key = mp_decode_uint(&d);
+		if (key == IPROTO_FILE_NAME && mp_typeof(*d) == MP_STR) {
+			*name = mp_decode_str(&d, name_len);
+		} else if (key == IPROTO_DATA && mp_typeof(*d) == MP_BIN) {
+			*data = mp_decode_bin(&d, size);
+		} else {
+			mp_next(&d); /* value */
+		}
+	}
+	if (*name == NULL || *data == NULL)
+		goto error;
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_MSGPACK, "JOIN_FILE body");
+	return -1;
+}
+
+int
+xrow_encode_join_response(struct xrow_header *row,
+			  const struct vclock *vclock, uint32_t stream_count,
+			  bool files)
+{
+	memset(row, 0, sizeof(*row));
+
+	/* Add vclock to response body */
+	size_t size = 16 + mp_sizeof_vclock(vclock);
+	char *buf = (char *) region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc", "buf");
+		return -1;
+	}
+	char *data = buf;
+	uint32_t map_size = 1;
+	if (stream_count > 1)
+		map_size++;
+	if (files)
+		map_size++;
+	data = mp_encode_map(data, map_size);
+	data = mp_encode_uint(data, IPROTO_VCLOCK);
+	data = mp_encode_vclock(data, vclock);
+	if (stream_count > 1) {
+		data = mp_encode_uint(data, IPROTO_JOIN_STREAM_COUNT);
+		data = mp_encode_uint(data, stream_count);
+	}
+	if (files) {
+		data = mp_encode_uint(data, IPROTO_JOIN_FILES);
+		data = mp_encode_bool(data, true);
+	}
+	assert(data <= buf + size);
+	row->body[0].iov_base = buf;
+	row->body[0].iov_len = (data - buf);
+	row->bodycnt = 1;
+	row->type = IPROTO_OK;
+	return 0;
+}
+
 int
 xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock)
+{
+	return xrow_encode_subscribe_response(row, vclock,
+					      IPROTO_COMPRESSION_NONE);
+}
+
+int
+xrow_encode_subscribe_response(struct xrow_header *row,
+			       const struct vclock *vclock,
+			       uint32_t compression)
 {
 	memset(row, 0, sizeof(*row));
 
 	/* Add vclock to response body */
-	size_t size = 8 + mp_sizeof_vclock(vclock);
+	size_t size = 16 + mp_sizeof_vclock(vclock);
 	char *buf = (char *) region_alloc(&fiber()->gc, size);
 	if (buf == NULL) {
 		diag_set(OutOfMemory, size, "region_alloc", "buf");
 		return -1;
 	}
 	char *data = buf;
-	data = mp_encode_map(data, 1);
+	data = mp_encode_map(data, compression != IPROTO_COMPRESSION_NONE ?
+				   2 : 1);
 	data = mp_encode_uint(data, IPROTO_VCLOCK);
 	data = mp_encode_vclock(data, vclock);
+	if (compression != IPROTO_COMPRESSION_NONE) {
+		data = mp_encode_uint(data, IPROTO_COMPRESSION);
+		data = mp_encode_uint(data, compression);
+	}
 	assert(data <= buf + size);
 	row->body[0].iov_base = buf;
 	row->body[0].iov_len = (data - buf);
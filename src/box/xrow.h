@@ -143,6 +143,9 @@ struct request {
 	/** Tuple metadata. */
 	const char *tuple_meta;
 	const char *tuple_meta_end;
+	/** Exclusive upper bound of DELETE_RANGE. */
+	const char *end_key;
+	const char *end_key_end;
 	/** Base field offset for UPDATE/UPSERT, e.g. 0 for C and 1 for Lua. */
 	int index_base;
 };
@@ -264,12 +267,33 @@ xrow_decode_ballot(struct xrow_header *row, struct ballot *ballot);
 void
 xrow_encode_vote(struct xrow_header *row);
 
+/**
+ * Look up space id in the body of a DML row without decoding
+ * the rest of it. The body must be valid MsgPack, so use this
+ * only for rows read from local files.
+ * @param row Row to decode.
+ * @param[out] space_id.
+ *
+ * @retval  0 Success.
+ * @retval -1 The row doesn't have space id.
+ */
+int
+xrow_decode_space_id(const struct xrow_header *row, uint32_t *space_id);
+
 /**
  * Encode SUBSCRIBE command.
  * @param[out] Row.
  * @param replicaset_uuid Replica set uuid.
  * @param instance_uuid Instance uuid.
  * @param vclock Replication clock.
+ * @param compression Requested stream compression,
+ *        see enum iproto_compression.
+ * @param space_filter Ids of user spaces to receive rows of,
+ *        rows of other user spaces are replaced with NOPs.
+ *        NULL to receive all rows.
+ * @param space_filter_size Number of entries in space_filter.
+ * @param batch_delay Max time the master may hold rows to send
+ *        them in one write, in seconds. 0 for the default.
  *
  * @retval  0 Success.
  * @retval -1 Memory error.
@@ -278,15 +302,24 @@ int
 xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
-		      const struct vclock *vclock);
+		      const struct vclock *vclock, uint32_t compression,
+		      const uint32_t *space_filter,
+		      uint32_t space_filter_size, double batch_delay);
 
 /**
- * Decode SUBSCRIBE command.
+ * Decode SUBSCRIBE command or a response to it.
  * @param row Row to decode.
  * @param[out] replicaset_uuid.
  * @param[out] instance_uuid.
  * @param[out] vclock.
  * @param[out] version_id.
+ * @param[out] compression. Left IPROTO_COMPRESSION_NONE
+ *             if the row doesn't have the key.
+ * @param[out] space_filter. MsgPack array of space ids
+ *             pointing into the row body or NULL if the row
+ *             doesn't have the key.
+ * @param[out] batch_delay. Left 0 if the row doesn't have
+ *             the key.
  *
  * @retval  0 Success.
  * @retval -1 Memory or format error.
@@ -294,32 +327,83 @@ xrow_encode_subscribe(struct xrow_header *row,
 int
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 		      struct tt_uuid *instance_uuid, struct vclock *vclock,
-		      uint32_t *version_id);
+		      uint32_t *version_id, uint32_t *compression,
+		      const char **space_filter, double *batch_delay);
 
 /**
  * Encode JOIN command.
+ *
+ * Initial data may be sent over several connections at once.
+ * The first one asks for stream_count streams and gets the
+ * number of streams the master agreed to in the response
+ * along with the checkpoint vclock. Each of the other
+ * connections then asks for its stream by id, passing the
+ * checkpoint vclock.
+ *
+ * Instead of rows, the replica may ask for checkpoint files,
+ * which are then sent as is, see xrow_encode_join_file().
+ *
  * @param[out] row Row to encode into.
  * @param instance_uuid.
+ * @param vclock Checkpoint vclock or NULL for the first stream.
+ * @param stream_id Stream index, 0 for the first stream.
+ * @param stream_count Number of streams.
+ * @param files Ask for checkpoint files rather than rows.
  *
  * @retval  0 Success.
  * @retval -1 Memory error.
  */
 int
-xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid);
+xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid,
+		 const struct vclock *vclock, uint32_t stream_id,
+		 uint32_t stream_count, bool files);
 
 /**
- * Decode JOIN command.
+ * Decode JOIN command or a response to it.
  * @param row Row to decode.
  * @param[out] instance_uuid.
+ * @param[out] vclock.
+ * @param[out] stream_id. Set to 0 if the row doesn't have it.
+ * @param[out] stream_count. Set to 1 if the row doesn't have it.
+ * @param[out] files. Set to false if the row doesn't have it.
  *
  * @retval  0 Success.
  * @retval -1 Memory or format error.
  */
-static inline int
-xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid)
-{
-	return xrow_decode_subscribe(row, NULL, instance_uuid, NULL, NULL);
-}
+int
+xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid,
+		 struct vclock *vclock, uint32_t *stream_id,
+		 uint32_t *stream_count, bool *files);
+
+/**
+ * Encode a chunk of a checkpoint file sent on JOIN.
+ * @param[out] row Row to encode into.
+ * @param name File name relative to the engine directory.
+ * @param data Chunk data.
+ * @param size Chunk size.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+xrow_encode_join_file(struct xrow_header *row, const char *name,
+		      const char *data, uint32_t size);
+
+/**
+ * Decode a chunk of a checkpoint file sent on JOIN.
+ * The output pointers point into the row body.
+ * @param row Row to decode.
+ * @param[out] name File name, not null-terminated.
+ * @param[out] name_len File name length.
+ * @param[out] data Chunk data.
+ * @param[out] size Chunk size.
+ *
+ * @retval  0 Success.
+ * @retval -1 Format error.
+ */
+int
+xrow_decode_join_file(struct xrow_header *row, const char **name,
+		      uint32_t *name_len, const char **data, uint32_t *size);
 
 /**
  * Encode end of stream command (a response to JOIN command).
@@ -332,6 +416,38 @@ xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid)
 int
 xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock);
 
+/**
+ * Encode a response to JOIN command.
+ * @param row[out] Row to encode into.
+ * @param vclock Vclock of the checkpoint sent to the replica.
+ * @param stream_count Number of streams the initial data is
+ *        sent over, see xrow_encode_join().
+ * @param files Set if checkpoint files are sent instead
+ *        of rows.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+xrow_encode_join_response(struct xrow_header *row,
+			  const struct vclock *vclock, uint32_t stream_count,
+			  bool files);
+
+/**
+ * Encode a response to SUBSCRIBE command.
+ * @param row[out] Row to encode into.
+ * @param vclock Current vclock of the master.
+ * @param compression Compression of the stream that follows,
+ *        see enum iproto_compression.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+xrow_encode_subscribe_response(struct xrow_header *row,
+			       const struct vclock *vclock,
+			       uint32_t compression);
+
 /**
  * Decode end of stream command (a response to JOIN command).
  * @param row Row to decode.
@@ -343,7 +459,8 @@ xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock);
 static inline int
 xrow_decode_vclock(struct xrow_header *row, struct vclock *vclock)
 {
-	return xrow_decode_subscribe(row, NULL, NULL, vclock, NULL);
+	return xrow_decode_subscribe(row, NULL, NULL, vclock, NULL, NULL, NULL,
+				     NULL);
 }
 
 /**
@@ -670,10 +787,13 @@ static inline void
 xrow_encode_subscribe_xc(struct xrow_header *row,
 			 const struct tt_uuid *replicaset_uuid,
 			 const struct tt_uuid *instance_uuid,
-			 const struct vclock *vclock)
+			 const struct vclock *vclock, uint32_t compression,
+			 const uint32_t *space_filter,
+			 uint32_t space_filter_size, double batch_delay)
 {
 	if (xrow_encode_subscribe(row, replicaset_uuid, instance_uuid,
-				  vclock) != 0)
+				  vclock, compression, space_filter,
+				  space_filter_size, batch_delay) != 0)
 		diag_raise();
 }
 
@@ -682,27 +802,65 @@ static inline void
 xrow_decode_subscribe_xc(struct xrow_header *row,
 			 struct tt_uuid *replicaset_uuid,
 		         struct tt_uuid *instance_uuid, struct vclock *vclock,
-			 uint32_t *replica_version_id)
+			 uint32_t *replica_version_id, uint32_t *compression,
+			 const char **space_filter, double *batch_delay)
 {
 	if (xrow_decode_subscribe(row, replicaset_uuid, instance_uuid,
-				  vclock, replica_version_id) != 0)
+				  vclock, replica_version_id,
+				  compression, space_filter,
+				  batch_delay) != 0)
 		diag_raise();
 }
 
 /** @copydoc xrow_encode_join. */
 static inline void
 xrow_encode_join_xc(struct xrow_header *row,
-		    const struct tt_uuid *instance_uuid)
+		    const struct tt_uuid *instance_uuid,
+		    const struct vclock *vclock, uint32_t stream_id,
+		    uint32_t stream_count, bool files)
 {
-	if (xrow_encode_join(row, instance_uuid) != 0)
+	if (xrow_encode_join(row, instance_uuid, vclock,
+			     stream_id, stream_count, files) != 0)
 		diag_raise();
 }
 
 /** @copydoc xrow_decode_join. */
 static inline void
-xrow_decode_join_xc(struct xrow_header *row, struct tt_uuid *instance_uuid)
+xrow_decode_join_xc(struct xrow_header *row, struct tt_uuid *instance_uuid,
+		    struct vclock *vclock, uint32_t *stream_id,
+		    uint32_t *stream_count, bool *files)
 {
-	if (xrow_decode_join(row, instance_uuid) != 0)
+	if (xrow_decode_join(row, instance_uuid, vclock,
+			     stream_id, stream_count, files) != 0)
+		diag_raise();
+}
+
+/** @copydoc xrow_encode_join_file. */
+static inline void
+xrow_encode_join_file_xc(struct xrow_header *row, const char *name,
+			 const char *data, uint32_t size)
+{
+	if (xrow_encode_join_file(row, name, data, size) != 0)
+		diag_raise();
+}
+
+/** @copydoc xrow_decode_join_file. */
+static inline void
+xrow_decode_join_file_xc(struct xrow_header *row, const char **name,
+			 uint32_t *name_len, const char **data,
+			 uint32_t *size)
+{
+	if (xrow_decode_join_file(row, name, name_len, data, size) != 0)
+		diag_raise();
+}
+
+/** @copydoc xrow_encode_join_response. */
+static inline void
+xrow_encode_join_response_xc(struct xrow_header *row,
+			     const struct vclock *vclock,
+			     uint32_t stream_count, bool files)
+{
+	if (xrow_encode_join_response(row, vclock, stream_count, files) != 0)
 		diag_raise();
 }
 
@@ -714,6 +872,16 @@ xrow_encode_vclock_xc(struct xrow_header *row, const struct vclock *vclock)
 		diag_raise();
 }
 
+/** @copydoc xrow_encode_subscribe_response. */
+static inline void
+xrow_encode_subscribe_response_xc(struct xrow_header *row,
+				  const struct vclock *vclock,
+				  uint32_t compression)
+{
+	if (xrow_encode_subscribe_response(row, vclock, compression) != 0)
+		diag_raise();
+}
+
 /** @copydoc xrow_decode_vclock. */
 static inline void
 xrow_decode_vclock_xc(struct xrow_header *row, struct vclock *vclock)
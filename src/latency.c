@@ -89,6 +89,14 @@ latency_collect(struct latency *latency, double value)
 	histogram_collect(latency->histogram, value_usec);
 }
 
+void
+latency_merge(struct latency *dst, const struct latency *src)
+{
+	histogram_merge(dst->histogram, src->histogram);
+	/* Every counter has one zero observation, see latency_create(). */
+	histogram_discard(dst->histogram, 0);
+}
+
 double
 latency_get(struct latency *latency, int pct)
 {
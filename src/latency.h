@@ -70,6 +70,13 @@ latency_reset(struct latency *latency);
 void
 latency_collect(struct latency *latency, double value);
 
+/**
+ * Add all observations collected by latency counter @src
+ * to latency counter @dst.
+ */
+void
+latency_merge(struct latency *dst, const struct latency *src);
+
 /**
  * Get accumulated latency value, in seconds.
  * Returns @pct-th percentile of all observations.
@@ -0,0 +1,126 @@
+#ifndef TARANTOOL_HLL_H_INCLUDED
+#define TARANTOOL_HLL_H_INCLUDED
+/*
+ * Copyright 2010-2018, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * HyperLogLog sketch estimating the number of distinct values
+ * in a multiset using a small fixed amount of memory:
+ *  Flajolet, P.; Fusy, E.; Gandouet, O.; Meunier, F. (2007)
+ *  "HyperLogLog: the analysis of a near-optimal cardinality
+ *  estimation algorithm"
+ *  http://algo.inria.fr/flajolet/Publications/FlFuGaMe07.pdf
+ *
+ * Values are added by their 32-bit hashes. The standard error of
+ * the estimate is 1.04 / sqrt(HLL_REGISTER_COUNT), i.e. about 3%.
+ * Values can't be removed from a sketch.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "bit/bit.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/** Number of hash bits used to select a register. */
+	HLL_PRECISION = 10,
+	/** Number of registers in a sketch. */
+	HLL_REGISTER_COUNT = 1 << HLL_PRECISION,
+};
+
+/**
+ * HyperLogLog sketch.
+ */
+struct hll {
+	/**
+	 * Each register stores the max rank, i.e. the position
+	 * of the leftmost 1 bit, of the hashes mapped to it.
+	 */
+	uint8_t registers[HLL_REGISTER_COUNT];
+};
+
+/* {{{ API declaration */
+
+/**
+ * Initialize an empty sketch.
+ * @param hll - the sketch
+ */
+static void
+hll_create(struct hll *hll);
+
+/**
+ * Add a value to the sketch.
+ * @param hll - the sketch
+ * @param hash - hash of the value
+ */
+static void
+hll_add(struct hll *hll, uint32_t hash);
+
+/**
+ * Estimate the number of distinct values added to the sketch.
+ * @param hll - the sketch
+ * @return - estimated number of distinct values
+ */
+uint64_t
+hll_estimate(const struct hll *hll);
+
+/* }}} API declaration */
+
+/* {{{ API definition */
+
+static inline void
+hll_create(struct hll *hll)
+{
+	memset(hll->registers, 0, sizeof(hll->registers));
+}
+
+static inline void
+hll_add(struct hll *hll, uint32_t hash)
+{
+	/* Higher bits select a register, the rest give a rank. */
+	uint32_t idx = hash >> (32 - HLL_PRECISION);
+	uint32_t rest = hash << HLL_PRECISION;
+	uint8_t rank = rest == 0 ? 32 - HLL_PRECISION + 1 :
+		       bit_clz_u32(rest) + 1;
+	if (rank > hll->registers[idx])
+		hll->registers[idx] = rank;
+}
+
+/* }}} API definition */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_HLL_H_INCLUDED */
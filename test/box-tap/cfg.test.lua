@@ -6,7 +6,7 @@ local socket = require('socket')
 local fio = require('fio')
 local uuid = require('uuid')
 local msgpack = require('msgpack')
-test:plan(101)
+test:plan(110)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -33,6 +33,15 @@ invalid('replication_sync_lag', 0)
 invalid('replication_connect_timeout', -1)
 invalid('replication_connect_timeout', 0)
 invalid('replication_connect_quorum', -1)
+invalid('replication_apply_workers', 0)
+invalid('replication_apply_workers', 65)
+invalid('replication_join_streams', 0)
+invalid('replication_join_streams', 17)
+invalid('replication_spaces', 280)
+invalid('replication_spaces', {'test'})
+invalid('replication_batch_delay', -1)
+invalid('sql_cache_count', -1)
+invalid('sql_temp_memory_max', -1)
 invalid('wal_mode', 'invalid')
 invalid('rows_per_wal', -1)
 invalid('listen', '//!')
@@ -0,0 +1,115 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+
+-- Rows of this space may be applied concurrently.
+s1 = box.schema.space.create('test1', {engine = engine})
+_ = s1:create_index('pk')
+_ = s1:create_index('sk', {unique = false, parts = {2, 'unsigned'}})
+-- Rows of this space are applied serially.
+s2 = box.schema.space.create('test2', {engine = engine})
+_ = s2:create_index('pk')
+_ = s2:create_index('sk', {unique = true, parts = {2, 'unsigned'}})
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:cmd("switch replica")
+-- Rows are applied serially by default.
+box.cfg.replication_apply_workers
+box.cfg{replication_apply_workers = 4}
+replication = box.cfg.replication
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+test_run:cmd("switch default")
+
+test_run:cmd("setopt delimiter ';'")
+function write(n)
+    for i = 1, n do
+        if i % 100 == 1 then box.begin() end
+        local k = i % 10
+        s1:replace{k, i}
+        s1:update(k, {{'+', 2, 1}})
+        s2:replace{i % 100, i}
+        if i % 100 == 0 then box.commit() end
+    end
+    for k = 0, 9, 2 do s1:delete(k) end
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- Rows modifying the same key are applied in the order
+-- they were written on the master.
+write(1000)
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+test_run:cmd("switch replica")
+box.space.test1:select()
+box.space.test2:count()
+box.space.test2.index.sk:min()
+box.space.test2.index.sk:max()
+box.info.replication[1].upstream.status
+
+-- Apply rows serially.
+box.cfg{replication_apply_workers = 1}
+replication = box.cfg.replication
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+test_run:cmd("switch default")
+
+box.space.test1:truncate()
+box.space.test2:truncate()
+write(500)
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+test_run:cmd("switch replica")
+box.space.test1:select()
+box.space.test2:count()
+box.space.test2.index.sk:min()
+box.space.test2.index.sk:max()
+box.info.replication[1].upstream.status
+
+-- A conflicting row doesn't prevent other rows of the same
+-- batch from being applied.
+box.cfg{replication_skip_conflict = true}
+box.space.test1:insert{100, 0}
+test_run:cmd("switch default")
+box.begin() for i = 99, 101 do s1:insert{i, i} end box.commit()
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+test_run:cmd("switch replica")
+box.space.test1:select({99}, {iterator = 'GE'})
+box.info.replication[1].upstream.status
+box.cfg{replication_skip_conflict = false}
+
+-- A row that failed to apply is received again on resubscribe
+-- and no row received after it is committed before it.
+box.cfg{replication_apply_workers = 4}
+replication = box.cfg.replication
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+box.space.test1:insert{200, 0}
+test_run:cmd("switch default")
+for i = 200, 209 do s1:insert{i, i} end
+test_run:cmd("switch replica")
+fiber = require('fiber')
+while box.info.replication[1].upstream.status ~= 'stopped' do fiber.sleep(0.01) end
+box.info.replication[1].upstream.message
+box.space.test1:select({200}, {iterator = 'GE'})
+box.space.test1:delete{200}
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+test_run:cmd("switch default")
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+test_run:cmd("switch replica")
+box.space.test1:select({200}, {iterator = 'GE'})
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s1:drop()
+s2:drop()
+box.schema.user.revoke('guest', 'replication')
@@ -0,0 +1,44 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:cmd("switch replica")
+box.cfg.replication_batch_delay
+box.cfg{replication_batch_delay = -1}
+
+-- Let the master hold rows for a while to send them at once.
+box.cfg{replication_batch_delay = 0.1}
+replication = box.cfg.replication
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- Rows committed one by one arrive in full.
+for i = 1, 1000 do s:replace{i} end
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+test_run:cmd("switch replica")
+box.space.test:count()
+test_run:cmd("switch default")
+
+-- Rows committed after a pause are sent once the delay expires.
+s:replace{1001}
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+test_run:cmd("switch replica")
+box.space.test:get(1001)
+box.cfg{replication_batch_delay = 0}
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
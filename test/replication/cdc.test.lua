@@ -0,0 +1,87 @@
+env = require('test_run')
+test_run = env.new()
+net = require('net.box')
+fiber = require('fiber')
+msgpack = require('msgpack')
+urilib = require('uri')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+
+test_run:cmd("setopt delimiter ';'")
+function encode_map(t)
+    return msgpack.encode(setmetatable(t, {__serialize = 'map'}))
+end;
+function cdc_write(sock, header, body)
+    local data = encode_map(header) .. encode_map(body)
+    sock:write(msgpack.encode(#data) .. data)
+end;
+function cdc_read(sock)
+    local len = msgpack.decode(sock:read({chunk = 5}))
+    local data = sock:read({chunk = len})
+    local header, pos = msgpack.decode(data)
+    local body = {}
+    if pos <= #data then
+        body = msgpack.decode(data, pos)
+    end
+    return header, body
+end;
+-- Read rows until the given number of rows of the test space
+-- is received, acknowledging everything received.
+function cdc_read_rows(sock, vclock, count)
+    local rows = {}
+    while #rows < count do
+        local header, body = cdc_read(sock)
+        if header[0x03] ~= nil then
+            vclock[header[0x02]] = header[0x03]
+        end
+        if body[0x10] == s.id then
+            table.insert(rows, string.format('%d %s %s', header[0x00],
+                                             body[0x36],
+                                             table.concat(body[0x21], ',')))
+        end
+        cdc_write(sock, {[0x00] = 0}, {[0x26] = vclock})
+    end
+    return rows
+end;
+function cdc_consumer()
+    for _, consumer in ipairs(box.info.gc().consumers) do
+        if consumer.name:match('^cdc') then
+            return consumer
+        end
+    end
+end;
+test_run:cmd("setopt delimiter ''");
+
+vclock = {}
+for id, lsn in pairs(box.info.vclock) do vclock[id] = lsn end
+uri = urilib.parse(tostring(box.cfg.listen))
+sock = net.establish_connection(uri.host, uri.service)
+-- The client sends its version to make the relay collect WALs
+-- only once it acknowledges rows stored in them.
+major, minor, patch = box.info.version:match('^(%d+)%.(%d+)%.(%d+)')
+version_id = major * 65536 + minor * 256 + patch
+cdc_write(sock, {[0x00] = 70, [0x01] = 1}, {[0x26] = vclock, [0x06] = version_id})
+-- The response carries the current vclock.
+header, body = cdc_read(sock)
+header[0x00]
+body[0x26] ~= nil
+while cdc_consumer() == nil do fiber.sleep(0.01) end
+
+-- Rows are streamed with the space name attached.
+s:insert{1}
+s:insert{2}
+cdc_read_rows(sock, vclock, 2)
+
+-- The name follows renames made after the request.
+s:rename('test2')
+s:replace{2, 2}
+cdc_read_rows(sock, vclock, 1)
+
+-- The gc consumer is dropped as soon as the client disconnects.
+sock:close()
+while cdc_consumer() ~= nil do fiber.sleep(0.01) end
+
+s:drop()
+box.schema.user.revoke('guest', 'replication')
@@ -0,0 +1,63 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+fiber = require('fiber')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:cmd("switch replica")
+-- The stream isn't compressed by default.
+box.cfg.replication_compression
+box.info.replication[1].upstream.compression
+
+-- Compression is negotiated on subscribe.
+box.cfg{replication_compression = true}
+replication = box.cfg.replication
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+box.info.replication[1].upstream.status
+box.info.replication[1].upstream.compression
+test_run:cmd("switch default")
+
+for i = 1, 1000 do s:replace{i, string.rep('x', 100)} end
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+
+-- Counters of the relay are updated on replica ACKs.
+downstream = box.info.replication[2].downstream
+downstream.compression
+while box.info.replication[2].downstream.uncompressed_bytes < 100000 do fiber.sleep(0.01) end
+downstream = box.info.replication[2].downstream
+downstream.compressed_bytes < downstream.uncompressed_bytes
+
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test:get(1000)
+upstream = box.info.replication[1].upstream
+upstream.uncompressed_bytes > 100000
+upstream.compressed_bytes < upstream.uncompressed_bytes
+
+-- Switch compression off.
+box.cfg{replication_compression = false}
+box.cfg{replication = {}}
+box.cfg{replication = replication}
+box.info.replication[1].upstream.status
+box.info.replication[1].upstream.compression
+test_run:cmd("switch default")
+s:delete(1)
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+box.info.replication[2].downstream.compression
+test_run:cmd("switch replica")
+box.space.test:count()
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
@@ -0,0 +1,44 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+box.begin() for i = 1, 1000 do s:insert{i, 1000 - i} end box.commit()
+box.snapshot()
+-- Written after the checkpoint, sent on final join.
+for i = 1001, 1100 do s:insert{i, i} end
+s:delete{1}
+
+-- The replica receives the checkpoint files as is.
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica_join_files.lua'")
+test_run:cmd("start server replica")
+test_run:grep_log('default', 'sent checkpoint file') ~= nil
+test_run:grep_log('replica', 'received checkpoint file .*%.snap') ~= nil
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test.index.sk:count()
+box.space.test:min()
+box.space.test:max()
+box.space.test.index.sk:min()
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- The replica adopted the files and can restart from them.
+s:insert{1101, 1101}
+test_run:cmd("restart server replica")
+test_run:cmd("switch replica")
+fiber = require('fiber')
+while box.space.test:get(1101) == nil do fiber.sleep(0.01) end
+box.space.test:count()
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
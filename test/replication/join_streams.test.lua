@@ -0,0 +1,39 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+
+s1 = box.schema.space.create('test1', {engine = engine})
+_ = s1:create_index('pk')
+_ = s1:create_index('sk', {parts = {2, 'unsigned'}})
+s2 = box.schema.space.create('test2', {engine = engine})
+_ = s2:create_index('pk', {parts = {1, 'string'}})
+box.begin() for i = 1, 20000 do s1:insert{i, 20000 - i} end box.commit()
+box.begin() for i = 1, 10000 do s2:insert{tostring(i)} end box.commit()
+box.snapshot()
+-- Written after the checkpoint, sent on final join.
+s1:insert{20001, 20001}
+
+-- Initial data is split among four streams.
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica_join_streams.lua'")
+test_run:cmd("start server replica with args='4'")
+test_run:grep_log('default', 'initial data stream 3 sent') ~= nil
+test_run:cmd("switch replica")
+box.cfg.replication_join_streams
+box.space.test1:count()
+box.space.test1.index.sk:count()
+box.space.test1:min()
+box.space.test1:max()
+box.space.test1.index.sk:min()
+box.space.test2:count()
+box.space.test2:get('5000')
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s1:drop()
+s2:drop()
+box.schema.user.revoke('guest', 'replication')
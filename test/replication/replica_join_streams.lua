@@ -0,0 +1,12 @@
+#!/usr/bin/env tarantool
+
+local STREAMS = tonumber(arg[1])
+
+box.cfg({
+    listen              = os.getenv("LISTEN"),
+    replication         = os.getenv("MASTER"),
+    memtx_memory        = 107374182,
+    replication_join_streams = STREAMS,
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,39 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+fiber = require('fiber')
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+
+for i = 1, 100 do s:replace{i, string.rep('x', 100)} end
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+
+-- Counters of the relay are updated on replica ACKs.
+while box.info.replication[2].downstream.rows.total < 100 do fiber.sleep(0.01) end
+downstream = box.info.replication[2].downstream
+downstream.bytes.total > 100 * 100
+downstream.rows.rps >= 0
+latency = downstream.latency.send
+latency.p50 >= 0 and latency.p50 <= latency.p99
+
+test_run:cmd("switch replica")
+upstream = box.info.replication[1].upstream
+upstream.rows.total >= 100
+upstream.bytes.total > 100 * 100
+latency = upstream.latency.receive
+latency.p50 >= 0 and latency.p50 <= latency.p99
+latency = upstream.latency.apply
+latency.p50 >= 0 and latency.p50 <= latency.p99
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
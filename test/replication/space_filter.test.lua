@@ -0,0 +1,41 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+
+s1 = box.schema.space.create('test1', {engine = engine})
+_ = s1:create_index('pk')
+s2 = box.schema.space.create('test2', {engine = engine})
+_ = s2:create_index('pk')
+s1:insert{1}
+s2:insert{1}
+
+-- The replica receives rows of test1 only.
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica_space_filter.lua'")
+test_run:cmd("start server replica with args='" .. s1.id .. "'")
+
+for i = 2, 10 do s1:insert{i} s2:insert{i} end
+-- DDL is replicated regardless of the filter.
+s3 = box.schema.space.create('test3', {engine = engine})
+_ = s3:create_index('pk')
+s3:insert{1}
+vclock = test_run:get_vclock('default')
+_ = test_run:wait_vclock("replica", vclock)
+
+test_run:cmd("switch replica")
+box.space.test1:count()
+-- Only the row sent on initial join.
+box.space.test2:count()
+box.space.test3 ~= nil
+box.space.test3:count()
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s1:drop()
+s2:drop()
+s3:drop()
+box.schema.user.revoke('guest', 'replication')
@@ -0,0 +1,48 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- A join of a large space on a column without an index builds a
+-- transient index over the inner space once and looks it up for
+-- each outer row instead of scanning the inner space each time.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT)")
+box.sql.execute("CREATE TABLE t2(id INT PRIMARY KEY, b INT, c TEXT)")
+for i = 1, 100 do box.space.T1:insert{i, i % 50} end
+_ = box.space.T1:insert{101, box.null}
+for i = 1, 2000 do box.space.T2:insert{i, i % 200, 'c'..i} end
+_ = box.space.T2:insert{2001, box.null, 'null'}
+
+box.sql.execute("EXPLAIN QUERY PLAN SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b")
+box.sql.execute("SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b")
+box.sql.execute("SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b")
+box.sql.execute("SELECT t1.a, count(*) FROM t1, t2 WHERE t1.a = t2.b AND t1.a < 3 GROUP BY t1.a")
+box.sql.execute("SELECT t1.id, t2.c FROM t1, t2 WHERE t1.a = t2.b AND t1.id = 7 AND t2.id < 500")
+-- Other terms are checked for each row found in the index.
+box.sql.execute("SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b AND t2.id > 1000")
+
+-- The index is built anew for each execution.
+box.sql.execute("DELETE FROM t2 WHERE b = 0")
+box.sql.execute("SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b")
+box.begin() box.space.T2:insert{3000, 1, 'new'} res = box.sql.execute("SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b") box.rollback()
+res
+box.sql.execute("SELECT count(*) FROM t1, t2 WHERE t1.a = t2.b")
+
+-- Collation of the comparison is used by the index.
+box.sql.execute("CREATE TABLE t3(id INT PRIMARY KEY, s TEXT COLLATE \"unicode_ci\")")
+box.sql.execute("CREATE TABLE t4(id INT PRIMARY KEY, s TEXT)")
+for i = 1, 1200 do box.space.T3:insert{i, 'k'..(i % 100)} end
+for i = 1, 100 do box.space.T4:insert{i, 'K'..i} end
+box.sql.execute("SELECT count(*) FROM t4, t3 WHERE t4.s = t3.s")
+
+-- Primary key parts keep their own collation in the index key.
+box.sql.execute("CREATE TABLE t5(s TEXT PRIMARY KEY)")
+for i = 1, 600 do box.space.T5:insert{'k'..i} box.space.T5:insert{'K'..i} end
+box.sql.execute("SELECT count(*) FROM t4, t5 WHERE t4.s = t5.s COLLATE \"unicode_ci\"")
+
+box.sql.execute("DROP TABLE t1")
+box.sql.execute("DROP TABLE t2")
+box.sql.execute("DROP TABLE t3")
+box.sql.execute("DROP TABLE t4")
+box.sql.execute("DROP TABLE t5")
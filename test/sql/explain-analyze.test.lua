@@ -0,0 +1,48 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- EXPLAIN ANALYZE runs the statement and reports for each loop
+-- of the query plan how many times it was started, how many rows
+-- it visited and how much time was spent in it.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT, b INT)")
+box.sql.execute("CREATE INDEX t1a ON t1(a)")
+box.sql.execute("CREATE TABLE t2(id INT PRIMARY KEY, c INT)")
+for i = 1, 100 do box.space.T1:insert{i, i % 10, i} end
+for i = 1, 10 do box.space.T2:insert{i, i} end
+
+-- Time depends on the machine, so check and cut it off.
+test_run:cmd("setopt delimiter ';'")
+function analyze(sql)
+    local res = box.sql.execute('EXPLAIN ANALYZE ' .. sql)
+    for _, row in ipairs(res) do
+        assert(row[7] == nil or row[7] >= 0)
+        row[7] = nil
+    end
+    return res
+end;
+test_run:cmd("setopt delimiter ''");
+
+res = box.sql.execute("EXPLAIN ANALYZE SELECT * FROM t1")
+table.concat(res[0], ', ')
+type(res[1][7])
+analyze("SELECT * FROM t1")
+analyze("SELECT b FROM t1 WHERE a = 3")
+analyze("SELECT t2.c, t1.b FROM t2 CROSS JOIN t1 WHERE t1.a = t2.id")
+-- Steps without a loop have no statistics.
+analyze("SELECT b FROM t1 WHERE a = 3 ORDER BY b")
+
+-- The statement is really executed.
+res = analyze("UPDATE t1 SET b = 0 WHERE a = 5")
+res[1][5], res[1][6]
+box.sql.execute("SELECT count(*) FROM t1 WHERE b = 0")
+
+-- ANALYZE command is still parsed after EXPLAIN ANALYZE.
+res = box.sql.execute("EXPLAIN ANALYZE ANALYZE t1")
+#res
+box.space._sql_stat1:count('T1') > 0
+
+box.sql.execute("DROP TABLE t1")
+box.sql.execute("DROP TABLE t2")
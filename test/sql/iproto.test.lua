@@ -201,6 +201,48 @@ future4:wait_result()
 cn:close()
 box.sql.execute('drop table test')
 
+--
+-- Prepared statements.
+--
+cn = remote.connect(box.cfg.listen)
+cn:execute('create table test (id integer primary key, a integer)')
+stmt = cn:prepare('insert into test values (?, ?)')
+type(stmt.stmt_id)
+stmt.bind_count
+for i = 1, 3 do cn:execute(stmt.stmt_id, {i, i * 10}) end
+stmt = cn:prepare('select * from test where id = ?')
+stmt.bind_count
+cn:execute(stmt.stmt_id, {2})
+-- Preparing a cached statement again returns the same id.
+cn:prepare('select * from test where id = ?').stmt_id == stmt.stmt_id
+-- Executing by text hits the same cache entry.
+cn:execute('select * from test where id = ?', {3})
+-- The statement is recompiled after a schema change.
+box.sql.execute('create index test_a on test(a)')
+cn:execute(stmt.stmt_id, {1})
+cn:prepare('select * from not_existing_table')
+-- Statements are evicted when the cache limit is lowered.
+box.cfg{sql_cache_count = 0}
+ok, err = pcall(cn.execute, cn, stmt.stmt_id, {1})
+ok, err.code == box.error.SQL_STMT_NOT_FOUND
+-- Nothing can be prepared while the cache is disabled.
+cn:prepare('select * from test where id = ?')
+box.cfg{sql_cache_count = 256}
+cn:execute('drop table test')
+
+-- Big result sets are streamed in chunks if requested.
+cn:execute('create table test (id integer primary key)')
+for i = 1, 10 do cn:execute('insert into test values (?)', {i}) end
+chunks = {}
+res = cn:execute('select * from test', nil, {chunk_size = 4}, {on_push = table.insert, on_push_ctx = chunks})
+#chunks, #chunks[1], #chunks[2]
+chunks[1][1][1], chunks[2][4][1]
+res
+cn:execute('select * from test where id > 8', nil, {chunk_size = 2})
+cn:execute('select * from test', nil, {chunk_size = 0})
+cn:execute('drop table test')
+cn:close()
+
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
 space = nil
 
@@ -0,0 +1,39 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- Statements that use only columns stored in a secondary index
+-- (its own key parts and the primary key parts) read the index
+-- alone and don't look up full tuples in the primary index.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT, b INT, c INT)")
+box.sql.execute("CREATE INDEX t1ab ON t1(a, b)")
+for i = 1, 10 do box.space.T1:insert{i, i % 3, i, i * 10} end
+box.snapshot()
+function pk_lookups() return engine == 'vinyl' and box.space.T1.index[0]:stat().lookup or 0 end
+
+lookups = pk_lookups()
+box.sql.execute("SELECT a, b FROM t1 WHERE a = 1")
+box.sql.execute("SELECT id, b FROM t1 WHERE a = 2 ORDER BY b DESC")
+box.sql.execute("SELECT a, count(*) FROM t1 GROUP BY a")
+pk_lookups() - lookups
+
+-- Columns not stored in the index require full tuples.
+lookups = pk_lookups()
+box.sql.execute("SELECT a, c FROM t1 WHERE a = 0")
+engine == 'memtx' or pk_lookups() > lookups
+
+-- Mix of on-disk and in-memory statements.
+box.sql.execute("UPDATE t1 SET b = b + 100 WHERE id > 8")
+box.sql.execute("DELETE FROM t1 WHERE id = 4")
+box.sql.execute("SELECT a, b FROM t1 WHERE a = 1")
+box.begin() box.space.T1:replace{11, 1, 0, 0} res = box.sql.execute("SELECT a, b FROM t1 WHERE a = 1") box.rollback()
+res
+box.sql.execute("SELECT a, b FROM t1 WHERE a = 1")
+
+-- DML statements still see full tuples.
+box.sql.execute("UPDATE t1 SET c = a + b WHERE a = 2")
+box.sql.execute("SELECT id, c FROM t1 WHERE a = 2")
+
+box.sql.execute("DROP TABLE t1")
@@ -0,0 +1,22 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- Without ANALYZE the planner estimates selectivity of indexes
+-- using the number of distinct key values maintained on writes.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT, b INT)")
+box.sql.execute("CREATE INDEX t1a ON t1(a)")
+box.sql.execute("CREATE INDEX t1b ON t1(b)")
+for i = 1, 2000 do box.space.T1:insert{i, i % 3, i % 2} end
+
+box.sql.execute("EXPLAIN QUERY PLAN SELECT count(*) FROM t1 WHERE a = 1 AND b = 1")
+box.sql.execute("SELECT count(*) FROM t1 WHERE a = 1 AND b = 1")
+
+-- Data shift is picked up without ANALYZE.
+for i = 1, 2000 do box.space.T1:replace{i, i % 3, i} end
+box.sql.execute("EXPLAIN QUERY PLAN SELECT id FROM t1 WHERE a = 1 AND b = 7")
+box.sql.execute("SELECT id FROM t1 WHERE a = 1 AND b = 7")
+
+box.sql.execute("DROP TABLE t1")
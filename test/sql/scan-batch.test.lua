@@ -0,0 +1,42 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- Read-only statements fetch tuples from memtx iterators in
+-- batches. Check scans crossing batch boundaries.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT, b INT)")
+box.sql.execute("CREATE INDEX t1a ON t1(a)")
+for i = 1, 3000 do box.space.T1:insert{i, i % 100, i * 2} end
+
+-- Only memtx cursors of read-only statements are batched.
+test_run:cmd("setopt delimiter ';'")
+function batch_count(sql)
+    local count = box.sql.debug().sql_batch_count
+    box.sql.execute(sql)
+    return box.sql.debug().sql_batch_count - count
+end;
+test_run:cmd("setopt delimiter ''");
+batch_count("SELECT sum(b) FROM t1 WHERE b > 0") > 0 == (engine == 'memtx')
+batch_count("SELECT id FROM t1 WHERE a = 5") > 0 == (engine == 'memtx')
+batch_count("UPDATE t1 SET b = b WHERE a = 5")
+batch_count("INSERT INTO t1 SELECT id + 10000, a, b FROM t1 WHERE id = 0")
+
+-- Full scan.
+box.sql.execute("SELECT count(*), sum(b), min(b), max(b) FROM t1 WHERE b > 0")
+-- Range scans stopped in the middle of a batch.
+box.sql.execute("SELECT id FROM t1 WHERE id > 1020 LIMIT 3")
+box.sql.execute("SELECT id FROM t1 ORDER BY id DESC LIMIT 2")
+-- Inner loop of a join is repositioned for each outer row.
+box.sql.execute("SELECT count(*) FROM t1 AS x, t1 AS y WHERE x.a = y.a AND x.id <= 10")
+box.sql.execute("SELECT id FROM t1 WHERE id IN (SELECT id FROM t1 WHERE a = 0) AND id > 2900")
+
+-- Statements modifying the scanned space are not batched.
+box.sql.execute("UPDATE t1 SET b = b + 1 WHERE a = 1")
+box.sql.execute("SELECT sum(b) FROM t1 WHERE a = 1")
+box.sql.execute("INSERT INTO t1 SELECT id + 3000, a, b FROM t1")
+box.sql.execute("SELECT count(*), max(id) FROM t1")
+
+-- Cleanup
+box.sql.execute("DROP TABLE t1")
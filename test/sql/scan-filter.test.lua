@@ -0,0 +1,40 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- Comparisons of numeric columns with integer constants are
+-- pushed down to cursors, which skip failing tuples. Values of
+-- other types must be left to VDBE.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT, b INT)")
+box.sql.execute("CREATE INDEX t1a ON t1(a)")
+for i = 1, 100 do box.space.T1:insert{i, i % 10, i} end
+box.sql.execute("INSERT INTO t1 VALUES (101, 5, NULL)")
+box.sql.execute("INSERT INTO t1 VALUES (102, 5, 'abc')")
+box.sql.execute("INSERT INTO t1 VALUES (103, 5, 150.5)")
+box.sql.execute("INSERT INTO t1 VALUES (105, 5, -50)")
+
+box.sql.execute("SELECT id FROM t1 WHERE b > 95")
+box.sql.execute("SELECT count(*) FROM t1 WHERE b < 0")
+box.sql.execute("SELECT count(*) FROM t1 WHERE b = 7")
+box.sql.execute("SELECT count(*) FROM t1 WHERE b = '7'")
+box.sql.execute("SELECT count(*) FROM t1 WHERE b > 99.5")
+box.sql.execute("SELECT id FROM t1 WHERE a = 5 AND b >= 100")
+box.sql.execute("SELECT count(*) FROM t1 AS x JOIN t1 AS y ON x.id = y.a WHERE y.b > 50 AND x.b < 3")
+box.sql.execute("SELECT x.id, y.id FROM t1 AS x LEFT JOIN t1 AS y ON y.id = x.id + 200 WHERE x.b = 7")
+
+-- Skipped tuples are accounted as visited by VDBE.
+function search_count(sql) local c = box.sql.debug().sql_search_count box.sql.execute(sql) return box.sql.debug().sql_search_count - c end
+search_count("SELECT * FROM t1 WHERE b > 1000") == search_count("SELECT * FROM t1 WHERE b + 0 > 1000")
+search_count("SELECT * FROM t1 WHERE a = 5 AND b > 1000") == search_count("SELECT * FROM t1 WHERE a = 5 AND b + 0 > 1000")
+search_count("SELECT * FROM t1 WHERE b < -100") == search_count("SELECT * FROM t1 WHERE b + 0 < -100")
+
+-- DML.
+box.sql.execute("DELETE FROM t1 WHERE b > 90 AND b < 95")
+box.sql.execute("SELECT count(*) FROM t1")
+box.sql.execute("UPDATE t1 SET b = b + 1000 WHERE b >= 99 AND b <= 100")
+box.sql.execute("SELECT id, b FROM t1 WHERE b > 1000")
+
+-- Cleanup
+box.sql.execute("DROP TABLE t1")
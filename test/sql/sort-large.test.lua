@@ -0,0 +1,39 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- Large in-memory sorts are done with qsort_arg() in a separate
+-- thread. Check that the result is ordered and the sort is
+-- stable.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, b INT, c TEXT)")
+box.begin() for i = 1, 20000 do box.space.T1:insert{i, i % 1000, tostring(i)} end box.commit()
+test_run:cmd("setopt delimiter ';'")
+function is_sorted(rows)
+    for i = 2, #rows do
+        local a, b = rows[i - 1], rows[i]
+        if a[1] < b[1] or (a[1] == b[1] and a[2] > b[2]) then
+            return false
+        end
+    end
+    return true
+end;
+test_run:cmd("setopt delimiter ''");
+
+res = box.sql.execute("SELECT b, id FROM t1 ORDER BY b DESC")
+#res
+is_sorted(res)
+res = box.sql.execute("SELECT c FROM t1 ORDER BY c LIMIT 3")
+res
+res = box.sql.execute("SELECT b, count(*) FROM t1 GROUP BY b")
+#res
+ok = true for i, row in ipairs(res) do ok = ok and row[1] == i - 1 and row[2] == 20 end
+ok
+
+-- Inside a transaction the sort is done in the tx thread.
+box.begin() res = box.sql.execute("SELECT b, id FROM t1 ORDER BY b DESC") box.commit()
+#res
+is_sorted(res)
+
+box.sql.execute("DROP TABLE t1")
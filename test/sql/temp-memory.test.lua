@@ -0,0 +1,35 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+box.sql.execute('pragma sql_default_engine=\''..engine..'\'')
+
+--
+-- Ephemeral tables are allocated on their own arenas. Memory
+-- taken by ephemeral tables of one statement can be limited.
+--
+box.sql.execute("CREATE TABLE t1(id INT PRIMARY KEY, a INT, b TEXT)")
+box.begin() for i = 1, 2000 do box.space.T1:insert{i, i % 100, string.rep('x', 100)..i} end box.commit()
+
+-- DISTINCT is computed with an ephemeral table.
+box.sql.execute("SELECT count(*) FROM (SELECT DISTINCT b FROM t1)")
+box.sql.execute("SELECT count(*) FROM (SELECT DISTINCT a FROM t1)")
+
+box.cfg{sql_temp_memory_max = 64 * 1024}
+ok, err = pcall(box.sql.execute, "SELECT count(*) FROM (SELECT DISTINCT b FROM t1)")
+ok, err:match("Check '(.-)'")
+box.sql.execute("SELECT count(*) FROM (SELECT DISTINCT a FROM t1)")
+-- Memory of tuples deleted from an ephemeral table is reused.
+box.sql.execute("SELECT id FROM t1 ORDER BY b LIMIT 3")
+box.cfg{sql_temp_memory_max = 0}
+box.sql.execute("SELECT count(*) FROM (SELECT DISTINCT b FROM t1)")
+
+-- A sort table cleared for each group of a partially ordered
+-- scan does not keep memory of the previous groups.
+box.sql.execute("CREATE TABLE t2(a INT, id INT, b TEXT, PRIMARY KEY(a, id))")
+box.begin() for i = 1, 2000 do box.space.T2:insert{i % 100, i, string.rep('x', 100)..string.format('%04d', i)} end box.commit()
+box.cfg{sql_temp_memory_max = 64 * 1024}
+box.sql.execute("SELECT a, id FROM t2 ORDER BY a, b LIMIT 3")
+box.sql.execute("SELECT a, id FROM t2 ORDER BY a, b LIMIT 3 OFFSET 1990")
+box.cfg{sql_temp_memory_max = 0}
+
+box.sql.execute("DROP TABLE t1")
+box.sql.execute("DROP TABLE t2")
@@ -0,0 +1,75 @@
+#include <stdint.h>
+#include <math.h>
+#include "salad/hll.h"
+#include "unit.h"
+
+/** Murmur3 finalizer, a cheap hash with good avalanche. */
+static uint32_t
+hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x85ebca6b;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35;
+	x ^= x >> 16;
+	return x;
+}
+
+static void
+test_empty(void)
+{
+	plan(1);
+	struct hll hll;
+	hll_create(&hll);
+	is(hll_estimate(&hll), 0, "empty sketch");
+	check_plan();
+}
+
+static void
+test_estimate(void)
+{
+	const uint32_t counts[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+	plan(lengthof(counts));
+	struct hll hll;
+	hll_create(&hll);
+	uint32_t added = 0;
+	for (unsigned i = 0; i < lengthof(counts); i++) {
+		for (; added < counts[i]; added++)
+			hll_add(&hll, hash(added));
+		double error = fabs((double)hll_estimate(&hll) - counts[i]) /
+			       counts[i];
+		ok(error < 0.1, "%u distinct values", counts[i]);
+	}
+	check_plan();
+}
+
+static void
+test_duplicates(void)
+{
+	plan(2);
+	struct hll hll;
+	hll_create(&hll);
+	for (uint32_t i = 0; i < 5000; i++)
+		hll_add(&hll, hash(i));
+	uint64_t estimate = hll_estimate(&hll);
+	for (uint32_t k = 0; k < 10; k++) {
+		for (uint32_t i = 0; i < 5000; i++)
+			hll_add(&hll, hash(i));
+	}
+	is(hll_estimate(&hll), estimate, "duplicates are not counted");
+	hll_create(&hll);
+	for (uint32_t i = 0; i < 100000; i++)
+		hll_add(&hll, hash(i % 7));
+	is(hll_estimate(&hll), 7, "few distinct values");
+	check_plan();
+}
+
+int
+main(void)
+{
+	plan(3);
+	test_empty();
+	test_estimate();
+	test_duplicates();
+	return check_plan();
+}
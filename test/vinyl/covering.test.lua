@@ -0,0 +1,56 @@
+test_run = require('test_run').new()
+
+--
+-- Covering secondary indexes store full tuples and so can be
+-- read without looking up the primary index.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}, covering = true})
+box.space._index:get{s.id, sk.id}[5]
+
+for i = 1, 10 do s:replace{i, 100 - i, i * 10} end
+box.snapshot()
+s:update(1, {{'=', 3, 'a'}})
+s:update(2, {{'+', 2, 100}})
+s:delete(3)
+
+lookup = pk:stat().lookup
+sk:select({}, {limit = 3})
+sk:get(99)
+sk:get(98)
+sk:get(97)
+sk:get(198)
+sk:select({96}, {iterator = 'le'})
+pk:stat().lookup - lookup
+
+-- Full tuples must survive dump and compaction.
+box.snapshot()
+sk:select()
+sk:compact()
+while sk:stat().run_count > 1 do require('fiber').sleep(0.01) end
+sk:select()
+pk:stat().lookup - lookup
+
+-- And recovery.
+test_run:cmd('restart server default')
+s = box.space.test
+pk = s.index.pk
+sk = s.index.sk
+lookup = pk:stat().lookup
+sk:select()
+sk:get(99)
+pk:stat().lookup - lookup
+
+-- Changing the option rebuilds the index.
+sk:alter{covering = false}
+box.space._index:get{s.id, sk.id}[5]
+lookup = pk:stat().lookup
+sk:get(99)
+pk:stat().lookup - lookup
+sk:alter{covering = true}
+sk:select()
+
+s:create_index('sk2', {parts = {3, 'unsigned'}, covering = 1})
+
+s:drop()
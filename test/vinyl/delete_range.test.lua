@@ -0,0 +1,55 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+--
+-- Range deletions.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}})
+for i = 1, 5 do for j = 1, 3 do s:replace{i, j} end end
+s:delete_range({2}, {4})
+s:select()
+-- Full key boundaries.
+s:delete_range({4, 2}, {5, 2})
+s:select()
+-- A statement written after a range deletion is visible.
+s:replace{3, 3}
+s:select()
+s:get{3, 3}
+s:get{4, 2}
+-- Unbounded ranges.
+s:delete_range({}, {3})
+s:select()
+s:delete_range({5})
+s:select()
+-- Range deletions survive dump, compaction, and restart.
+for i = 1, 10 do s:replace{i, i} end
+box.snapshot()
+s:delete_range({3}, {8})
+box.snapshot()
+s:select()
+pk:compact()
+while pk:stat().run_count > 1 do fiber.sleep(0.01) end
+pk:stat().run_count
+pk:stat().rows
+s:select()
+s:delete_range({9})
+test_run:cmd('restart server default')
+s = box.space.test
+s:select()
+-- Errors.
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+s:delete_range({1}, {2})
+s.index.sk:delete_range({1}, {2})
+s.index.sk:drop()
+_ = s:on_replace(function() end)
+s:delete_range({1}, {2})
+s:on_replace(nil, s:on_replace()[1])
+box.begin() s:replace{1, 1} s:delete_range({1}, {2})
+box.rollback()
+s:delete_range({'a'}, {2})
+s:select()
+s:drop()
+s = box.schema.space.create('test', {engine = 'memtx'})
+_ = s:create_index('pk')
+s:delete_range({1}, {2})
+s:drop()
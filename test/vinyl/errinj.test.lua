@@ -736,3 +736,23 @@ s.index.sk:select()
 s.index.sk:stat().memory.rows
 
 s:drop()
+
+--
+-- Concurrent lookups of the same key read it from disk only once.
+--
+errinj = box.error.injection
+fiber = require('fiber')
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+_ = s:replace{1, 1}
+box.snapshot()
+lookup = s.index.pk:stat().disk.iterator.lookup
+errinj.set('ERRINJ_VY_READ_PAGE_TIMEOUT', 0.05)
+ch = fiber.channel(5)
+for i = 1, 5 do fiber.create(function() ch:put(s:get{1}) end) end
+result = {}
+for i = 1, 5 do table.insert(result, ch:get()) end
+errinj.set('ERRINJ_VY_READ_PAGE_TIMEOUT', 0)
+result
+s.index.pk:stat().disk.iterator.lookup - lookup
+s:drop()
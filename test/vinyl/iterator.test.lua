@@ -814,3 +814,75 @@ c:get() -- error
 box.commit()
 
 s:drop()
+
+--
+-- Secondary index iterator looks up tuples in the primary
+-- index in batches. Check that the order and visibility of
+-- tuples is preserved.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+for i = 1, 100 do s:replace{i, 1000 - i} end
+box.snapshot()
+for i = 1, 100, 3 do s:replace{i, 1000 - i, i} end
+for i = 2, 100, 5 do s:delete{i} end
+t = sk:select()
+#t
+ok = true
+for i = 2, #t do if t[i - 1][2] >= t[i][2] then ok = false end end
+ok
+t[1]
+t[2]
+sk:select({950}, {iterator = 'LE', limit = 3})
+#sk:select({950}, {iterator = 'GE'})
+s:drop()
+
+--
+-- Read iterator merges disk sources using a heap. Check the
+-- result against a model in both directions, both with a cold
+-- and a warm cache.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {run_count_per_level = 100})
+for r = 1, 10 do for i = r, 200, 10 do s:replace{i, r} end box.snapshot() end
+for i = 1, 200, 3 do s:replace{i, 0} end
+for i = 1, 200, 7 do s:delete{i} end
+box.snapshot()
+for i = 2, 200, 11 do s:upsert({i, 0}, {{'+', 2, 100}}) end
+pk:stat().run_count
+model = {}
+for i = 1, 200 do model[i] = (i - 1) % 10 + 1 end
+for i = 1, 200, 3 do model[i] = 0 end
+for i = 1, 200, 7 do model[i] = nil end
+for i = 2, 200, 11 do model[i] = model[i] and model[i] + 100 or 0 end
+function match(i, k, it) if k == nil then return true elseif it == 'GE' then return i >= k elseif it == 'GT' then return i > k elseif it == 'LE' then return i <= k else return i < k end end
+function check(k, it) local t = pk:select(k, {iterator = it}) local dir = (it == 'LE' or it == 'LT') and -1 or 1 local j = 1 for i = (dir > 0 and 1 or 200), (dir > 0 and 200 or 1), dir do if model[i] ~= nil and match(i, k, it) then if t[j] == nil or t[j][1] ~= i or t[j][2] ~= model[i] then return false end j = j + 1 end end return j == #t + 1 end
+check(nil, 'GE')
+check(nil, 'LE')
+check(100, 'GT')
+check(100, 'LT')
+check(57, 'GE')
+check(57, 'LE')
+-- Warm cache.
+check(nil, 'GE')
+check(nil, 'LE')
+check(57, 'GE')
+check(57, 'LE')
+pk:select({57}, {iterator = 'GE', limit = 5})
+s:drop()
+
+--
+-- Tuples looked up ahead are not returned if the space is
+-- written to while the iterator is open.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+for i = 1, 100 do s:replace{i, i} end
+box.snapshot()
+box.begin() t = {} for _, v in sk:pairs() do table.insert(t, v) if v[1] == 10 then s:delete{11} s:replace{12, 12, 'new'} end end box.commit()
+#t
+t[10]
+t[11]
+s:drop()